@@ -0,0 +1,105 @@
+#include "common/BinaryLog.h"
+
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+
+/*
+	Offline decoder for .blog files written by the engine's binary log mode.
+	Prints each entry in the same "[date time - LEVEL]  message" layout as the
+	text log.
+
+		blog-decode <input.blog> [output.log]
+*/
+
+static std::wstring FormatTime(int64_t microseconds) {
+	time_t seconds = static_cast<time_t>(microseconds / 1000000);
+	tm ltm;
+#ifdef _WIN32
+	localtime_s(&ltm, &seconds);
+#else
+	localtime_r(&seconds, &ltm);
+#endif
+
+	wchar_t buffer[32];
+	wcsftime(buffer, 32, L"%d/%m/%y %H:%M:%S", &ltm);
+	return buffer;
+}
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		std::cerr << "usage: blog-decode <input.blog> [output.log]" << std::endl;
+		return 1;
+	}
+
+	std::ifstream input(argv[1], std::ios_base::binary);
+	if (!input.is_open()) {
+		std::cerr << "unable to open " << argv[1] << std::endl;
+		return 1;
+	}
+	std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+	std::wofstream file;
+	if (argc > 2) {
+		file.open(argv[2]);
+	}
+	std::wostream& output = file.is_open() ? static_cast<std::wostream&>(file) : std::wcout;
+
+	blog::Reader reader = { bytes.data(), bytes.data() + bytes.size() };
+	uint32_t magic = 0, version = 0;
+	if (!reader.Read(magic) || !reader.Read(version) || magic != blog::Magic || version != blog::Version) {
+		std::cerr << argv[1] << " is not a version " << blog::Version << " .blog file" << std::endl;
+		return 1;
+	}
+
+	std::unordered_map<uint32_t, blog::Format> formats;
+	while (reader.Cursor < reader.End) {
+		blog::RecordType type = {};
+		reader.Read(type);
+
+		switch (type) {
+			case blog::RecordType::Format: {
+				uint32_t id;
+				blog::Format format;
+				if (!reader.Read(id) || !reader.ReadString(format.Level) || !reader.ReadString(format.Text)) {
+					break;
+				}
+				blog::ParseFormat(format.Text.c_str(), format.Args);
+				formats[id] = std::move(format);
+				break;
+			}
+			case blog::RecordType::Entry: {
+				uint32_t id;
+				int64_t time;
+				uint16_t size;
+				if (!reader.Read(id) || !reader.Read(time) || !reader.Read(size) || reader.Cursor + size > reader.End) {
+					reader.Cursor = reader.End;
+					break;
+				}
+
+				blog::Reader args = { reader.Cursor, reader.Cursor + size };
+				reader.Cursor += size;
+
+				auto it = formats.find(id);
+				if (it == formats.end()) {
+					output << L"[" << FormatTime(time) << L" - ?????]  <unknown format " << id << L">\n";
+					break;
+				}
+				output << L"[" << FormatTime(time) << L" - " << it->second.Level << L"]  " << blog::FormatEntry(it->second, args);
+				break;
+			}
+			case blog::RecordType::Raw: {
+				std::wstring text;
+				if (reader.ReadString(text)) {
+					output << text;
+				}
+				break;
+			}
+			default:
+				std::cerr << "corrupt record at offset " << (reader.Cursor - bytes.data() - 1) << std::endl;
+				return 1;
+		}
+	}
+	return 0;
+}
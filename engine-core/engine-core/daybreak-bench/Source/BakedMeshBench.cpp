@@ -0,0 +1,159 @@
+#include "daybreak.h"
+#include "Bench.h"
+
+#include "common/MappedFile.h"
+#include "graphics/BakedMesh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+/*
+	Loading a .bmesh against building the same data at load time. A 64-mesh
+	synthetic model is baked to a temporary file once; then each load path
+	produces every mesh's vertex and index bytes ready for the upload:
+
+	- convert: per-vertex copies out of separate position/normal/uv streams
+	  into the vertex layout, as gfx::Model does after an Assimp import (the
+	  import itself is not counted, so this is a lower bound on that path)
+	- read: the whole file read into a heap buffer, then bmesh::View
+	- mapped: MappedFile and bmesh::View, the engine's path
+
+	Every path sums the bytes the upload would read, so page faults on the
+	mapping are part of its time. The file stays in the OS cache between
+	runs; a cold first boot also pays the disk read in read and mapped.
+*/
+
+namespace {
+
+	struct SourceMesh {
+		std::vector<float>		Positions;
+		std::vector<float>		Normals;
+		std::vector<float>		UVs;
+		std::vector<uint32_t>	Faces;
+	};
+
+	SourceMesh Grid(uint32_t size, float phase) {
+		SourceMesh mesh;
+		for (uint32_t y = 0; y <= size; y++) {
+			for (uint32_t x = 0; x <= size; x++) {
+				float u = static_cast<float>(x) / size, v = static_cast<float>(y) / size;
+				mesh.Positions.insert(mesh.Positions.end(), { u, v, 0.1f * std::sin(u * 9.0f + phase) });
+				mesh.Normals.insert(mesh.Normals.end(), { 0.0f, 0.0f, 1.0f });
+				mesh.UVs.insert(mesh.UVs.end(), { u, v });
+			}
+		}
+		for (uint32_t y = 0; y < size; y++) {
+			for (uint32_t x = 0; x < size; x++) {
+				uint32_t a = y * (size + 1) + x, b = a + 1, c = a + size + 1, d = c + 1;
+				mesh.Faces.insert(mesh.Faces.end(), { a, c, b, b, c, d });
+			}
+		}
+		return mesh;
+	}
+
+	void Convert(const SourceMesh& source, bmesh::MeshData& mesh) {
+		size_t vertexCount = source.Positions.size() / 3;
+		mesh.Vertices.resize(vertexCount);
+		for (size_t i = 0; i < vertexCount; i++) {
+			bmesh::Vertex& vertex = mesh.Vertices[i];
+			vertex = {};
+			memcpy(vertex.Position, &source.Positions[i * 3], sizeof(vertex.Position));
+			memcpy(vertex.Normal, &source.Normals[i * 3], sizeof(vertex.Normal));
+			memcpy(vertex.UV, &source.UVs[i * 2], sizeof(vertex.UV));
+		}
+		mesh.Indices = source.Faces;
+	}
+
+	uint64_t Sum(const void* data, size_t size) {
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		uint64_t sum = 0;
+		for (size_t i = 0; i < size; i++) {
+			sum += bytes[i];
+		}
+		return sum;
+	}
+
+	uint64_t SumView(const bmesh::View& view) {
+		uint64_t sum = 0;
+		for (uint32_t i = 0; i < view.MeshCount(); i++) {
+			const bmesh::MeshRecord& mesh = view.Mesh(i);
+			sum += Sum(view.Vertices(mesh), static_cast<size_t>(view.VertexStride()) * mesh.VertexCount);
+			sum += Sum(view.Indices(mesh), static_cast<size_t>(mesh.IndexSize) * mesh.IndexCount);
+		}
+		return sum;
+	}
+}
+
+BENCH(BakedLoad) {
+	size_t runs = bench::Scaled(100);
+	uint32_t largest = bench::Quick() ? 64 : 256;
+
+	std::vector<SourceMesh> sources;
+	std::vector<bmesh::MeshData> baked(64);
+	for (size_t i = 0; i < baked.size(); i++) {
+		sources.push_back(Grid(std::max<uint32_t>(8, largest / static_cast<uint32_t>(1 + i / 4)), static_cast<float>(i)));
+		Convert(sources[i], baked[i]);
+	}
+
+	std::filesystem::path path = std::filesystem::temp_directory_path() / "daybreak-bench.bmesh";
+	double writeMs = bench::TimeMs([&] {
+		std::ofstream output(path, std::ios_base::binary | std::ios_base::trunc);
+		bmesh::Write(output, baked);
+	});
+	size_t fileSize = static_cast<size_t>(std::filesystem::file_size(path));
+	printf("  %zu meshes, %.1f MB baked in %.1f ms, %zu runs\n", baked.size(), fileSize / (1024.0 * 1024.0), writeMs, runs);
+	printf("  %-8s %10s %10s\n", "path", "ms/load", "vs mapped");
+
+	uint64_t sums[3] = {};
+	double ms[3];
+	ms[0] = bench::TimeMs([&] {
+		for (size_t run = 0; run < runs; run++) {
+			std::vector<bmesh::MeshData> meshes(sources.size());
+			for (size_t i = 0; i < sources.size(); i++) {
+				Convert(sources[i], meshes[i]);
+				sums[0] += Sum(meshes[i].Vertices.data(), meshes[i].Vertices.size() * sizeof(bmesh::Vertex));
+				sums[0] += Sum(meshes[i].Indices.data(), meshes[i].Indices.size() * sizeof(uint32_t));
+			}
+		}
+	}) / runs;
+
+	ms[1] = bench::TimeMs([&] {
+		for (size_t run = 0; run < runs; run++) {
+			std::ifstream input(path, std::ios_base::binary);
+			// View needs a buffer on a bmesh::Alignment boundary.
+			struct alignas(bmesh::Alignment) Block { uint8_t Bytes[bmesh::Alignment]; };
+			std::vector<Block> buffer((fileSize + sizeof(Block) - 1) / sizeof(Block));
+			input.read(reinterpret_cast<char*>(buffer.data()), fileSize);
+
+			bmesh::View view;
+			if (view.Open(buffer.data(), fileSize)) {
+				sums[1] += SumView(view);
+			}
+		}
+	}) / runs;
+
+	ms[2] = bench::TimeMs([&] {
+		for (size_t run = 0; run < runs; run++) {
+			MappedFile mapping;
+			bmesh::View view;
+			if (mapping.Open(path) && view.Open(mapping.Data(), mapping.Size())) {
+				sums[2] += SumView(view);
+			}
+		}
+	}) / runs;
+
+	const char* names[] = { "convert", "read", "mapped" };
+	for (int i = 0; i < 3; i++) {
+		printf("  %-8s %10.2f %9.1fx\n", names[i], ms[i], ms[i] / ms[2]);
+	}
+
+	// Baked indices are 16-bit where the mesh allows, so only the two file
+	// paths must agree.
+	if (sums[1] != sums[2]) {
+		printf("  mismatch: read and mapped loads differ\n");
+	}
+	std::filesystem::remove(path);
+}
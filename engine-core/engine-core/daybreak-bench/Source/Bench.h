@@ -0,0 +1,45 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+/*
+	Minimal harness for the headless benchmarks, shaped like daybreak-tests:
+	every BENCH registers itself and BenchMain.cpp runs them in order (or only
+	those whose name contains the first non-flag argument). Each prints its own
+	table. -quick shrinks the work so ctest can run them as a smoke test.
+*/
+namespace bench {
+
+	struct Case {
+		const char*	Name;
+		void		(*Run)();
+	};
+
+	std::vector<Case>& Cases();
+	bool Quick();
+
+	// full normally, a twentieth of it (at least 1) under -quick.
+	inline size_t Scaled(size_t full) {
+		return Quick() ? (full / 20 > 0 ? full / 20 : 1) : full;
+	}
+
+	template<typename Function>
+	double TimeMs(Function function) {
+		auto start = std::chrono::steady_clock::now();
+		function();
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	struct Registrar {
+		Registrar(const char* name, void (*run)()) {
+			Cases().push_back({ name, run });
+		}
+	};
+}
+
+#define BENCH(name) \
+	static void name(); \
+	static bench::Registrar name##Registrar(#name, name); \
+	static void name()
@@ -0,0 +1,41 @@
+#include "Bench.h"
+
+#include <cstring>
+
+namespace bench {
+
+	static bool g_quick = false;
+
+	std::vector<Case>& Cases() {
+		static std::vector<Case> cases;
+		return cases;
+	}
+
+	bool Quick() {
+		return g_quick;
+	}
+}
+
+int main(int argc, char** argv) {
+	const char* filter = nullptr;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-quick") == 0) {
+			bench::g_quick = true;
+		} else {
+			filter = argv[i];
+		}
+	}
+
+	for (const bench::Case& benchCase : bench::Cases()) {
+		if (filter && !strstr(benchCase.Name, filter)) {
+			continue;
+		}
+
+		printf("%s\n", benchCase.Name);
+		fflush(stdout);
+		double ms = bench::TimeMs(benchCase.Run);
+		printf("  (%.1f ms)\n", ms);
+		fflush(stdout);
+	}
+	return 0;
+}
@@ -0,0 +1,120 @@
+#include "daybreak.h"
+#include "Bench.h"
+
+#include "core/JobSystem.h"
+
+#include <cmath>
+
+/*
+	Job system scaling: per-job overhead of Run/Wait, and ParallelFor speedup
+	on a compute-bound loop, for 1 to 16 threads (workers plus the main
+	thread). Speedup is against the same loop run serially without the job
+	system. On a machine with fewer hardware threads than the pool the extra
+	workers only add overhead, which the table shows as well.
+*/
+
+static const uint32_t ThreadCounts[] = { 1, 2, 4, 8, 16 };
+
+// One thread is the job system switched off, where jobs run inline.
+static void StartThreads(uint32_t threads) {
+	if (threads > 1) {
+		jobs::JobSystem::Initialize(threads - 1);
+	}
+}
+
+static float Work(size_t index) {
+	float value = static_cast<float>(index);
+	for (int i = 0; i < 64; i++) {
+		value = std::sin(value) * 1.0001f + 0.5f;
+	}
+	return value;
+}
+
+BENCH(RunWaitOverhead) {
+	size_t jobs = bench::Scaled(200000);
+	printf("  %u hardware threads, %zu empty jobs\n", std::thread::hardware_concurrency(), jobs);
+	printf("  %-8s %14s %14s\n", "threads", "ns/job (main)", "ns/job (jobs)");
+
+	for (uint32_t threads : ThreadCounts) {
+		StartThreads(threads);
+
+		// Submitted from the main thread, then from inside jobs (which push
+		// onto the worker's own deque).
+		std::atomic<size_t> ran = 0;
+		jobs::Counter fromMain;
+		double mainMs = bench::TimeMs([&] {
+			for (size_t i = 0; i < jobs; i++) {
+				jobs::JobSystem::Run([&ran] { ran.fetch_add(1, std::memory_order_relaxed); }, &fromMain);
+			}
+			jobs::JobSystem::Wait(fromMain);
+		});
+
+		jobs::Counter spawners, fromJobs;
+		double jobsMs = bench::TimeMs([&] {
+			size_t perSpawner = jobs / 64;
+			for (int spawner = 0; spawner < 64; spawner++) {
+				jobs::JobSystem::Run([&, perSpawner] {
+					for (size_t i = 0; i < perSpawner; i++) {
+						jobs::JobSystem::Run([&ran] { ran.fetch_add(1, std::memory_order_relaxed); }, &fromJobs);
+					}
+				}, &spawners);
+			}
+			jobs::JobSystem::Wait(spawners);
+			jobs::JobSystem::Wait(fromJobs);
+		});
+
+		jobs::JobSystem::Shutdown();
+		printf("  %-8u %14.0f %14.0f\n", threads, mainMs * 1e6 / jobs, jobsMs * 1e6 / (jobs / 64 * 64));
+		fflush(stdout);
+	}
+}
+
+BENCH(ParallelForScaling) {
+	size_t count = bench::Scaled(1000000);
+	std::vector<float> results(count);
+
+	double serialMs = bench::TimeMs([&] {
+		for (size_t i = 0; i < count; i++) {
+			results[i] = Work(i);
+		}
+	});
+	printf("  %zu items, serial %.1f ms\n", count, serialMs);
+	printf("  %-8s %10s %10s %10s\n", "threads", "ms", "speedup", "grain");
+
+	for (uint32_t threads : ThreadCounts) {
+		StartThreads(threads);
+		for (size_t grain : { static_cast<size_t>(0), static_cast<size_t>(256) }) {
+			double ms = bench::TimeMs([&] {
+				jobs::JobSystem::ParallelFor(count, grain, [&](size_t begin, size_t end) {
+					for (size_t i = begin; i < end; i++) {
+						results[i] = Work(i);
+					}
+				});
+			});
+			printf("  %-8u %10.1f %10.2f %10s\n", threads, ms, serialMs / ms, grain ? "256" : "auto");
+		}
+		jobs::JobSystem::Shutdown();
+		fflush(stdout);
+	}
+}
+
+BENCH(DependencyChain) {
+	size_t links = bench::Scaled(100000);
+	printf("  %-8s %14s\n", "threads", "ns/link");
+
+	// Each job is released by the previous one's counter draining.
+	for (uint32_t threads : ThreadCounts) {
+		StartThreads(threads);
+		std::vector<jobs::Counter> counters(links);
+		double ms = bench::TimeMs([&] {
+			jobs::JobSystem::Run([] {}, &counters[0]);
+			for (size_t i = 1; i < links; i++) {
+				jobs::JobSystem::RunAfter(counters[i - 1], [] {}, &counters[i]);
+			}
+			jobs::JobSystem::Wait(counters[links - 1]);
+		});
+		jobs::JobSystem::Shutdown();
+		printf("  %-8u %14.0f\n", threads, ms * 1e6 / links);
+		fflush(stdout);
+	}
+}
@@ -0,0 +1,153 @@
+#include "daybreak.h"
+#include "Bench.h"
+
+#include "common/AsyncLogWriter.h"
+
+#include <algorithm>
+#include <cstdarg>
+#include <filesystem>
+
+/*
+	Per-call latency of a log statement on the calling thread: the old
+	synchronous Logger path (format, open, append, close) against the
+	asynchronous ring in text and binary mode with 1 to 8 threads logging at
+	once. Latency is what the caller sees; the writer thread's file I/O is off
+	the clock except when a full ring makes the caller wait (a stall).
+
+	Flooding runs every thread flat out, so the writer's file throughput sets
+	the pace and stalls are expected. Paced runs log bursts of 64 lines per
+	2 ms, closer to a game frame.
+*/
+
+static const int LoggingThreadCounts[] = { 1, 2, 4, 8 };
+
+struct Percentiles {
+	double	P50;
+	double	P99;
+	double	P999;
+	double	Max;
+};
+
+static Percentiles Summarize(std::vector<double>& nanoseconds) {
+	std::sort(nanoseconds.begin(), nanoseconds.end());
+	auto at = [&](double fraction) { return nanoseconds[static_cast<size_t>(fraction * (nanoseconds.size() - 1))]; };
+	return { at(0.5), at(0.99), at(0.999), nanoseconds.back() };
+}
+
+template<typename Function>
+static double TimeNs(Function function) {
+	auto start = std::chrono::steady_clock::now();
+	function();
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+static std::wstring BenchFile(const wchar_t* name) {
+	std::filesystem::path directory = std::filesystem::temp_directory_path() / "daybreak-bench";
+	std::filesystem::create_directories(directory);
+	return (directory / name).wstring();
+}
+
+/*
+	Both paths echo every line to the debugger output, which is stderr in the
+	headless build. The echo is part of the cost, so it stays, but out of the
+	results.
+*/
+static void SilenceDebugOutput() {
+	static bool silenced = freopen("/dev/null", "w", stderr) != nullptr;
+	(void)silenced;
+}
+
+static void Push(AsyncLogWriter& writer, const wchar_t* fmt, ...) {
+	va_list args;
+	va_start(args, fmt);
+	writer.Push(L"INFO", fmt, args);
+	va_end(args);
+}
+
+static void PrintHeader() {
+	printf("  %-8s %10s %10s %10s %10s %12s %8s\n", "threads", "p50 ns", "p99 ns", "p99.9 ns", "max ns", "calls/s", "stalls");
+}
+
+static void PrintRow(int threads, Percentiles latency, double callsPerSecond, uint64_t stalls) {
+	printf("  %-8d %10.0f %10.0f %10.0f %10.0f %12.0f %8llu\n", threads, latency.P50, latency.P99, latency.P999, latency.Max, callsPerSecond, static_cast<unsigned long long>(stalls));
+	fflush(stdout);
+}
+
+static void AsyncLatency(bool binary, bool paced) {
+	size_t perThread = bench::Scaled(paced ? 20000 : 200000);
+	SilenceDebugOutput();
+	PrintHeader();
+
+	for (int threads : LoggingThreadCounts) {
+		std::wstring path = BenchFile(binary ? L"latency.blog" : L"latency.log");
+		std::filesystem::remove(path);
+
+		std::vector<std::vector<double>> latencies(threads, std::vector<double>(perThread));
+		uint64_t stalls;
+		double ms;
+		{
+			AsyncLogWriter writer(path, binary);
+			ms = bench::TimeMs([&] {
+				std::vector<std::thread> loggers;
+				for (int thread = 0; thread < threads; thread++) {
+					loggers.emplace_back([&, thread] {
+						for (size_t i = 0; i < perThread; i++) {
+							latencies[thread][i] = TimeNs([&] {
+								Push(writer, L"[Bench] thread %d frame %zu took %.3f ms\n", thread, i, 16.6);
+							});
+							if (paced && i % 64 == 63) {
+								std::this_thread::sleep_for(std::chrono::milliseconds(2));
+							}
+						}
+					});
+				}
+				for (std::thread& logger : loggers) {
+					logger.join();
+				}
+			});
+			stalls = writer.StallCount();
+		}
+
+		std::vector<double> all;
+		for (const std::vector<double>& perThreadLatencies : latencies) {
+			all.insert(all.end(), perThreadLatencies.begin(), perThreadLatencies.end());
+		}
+		PrintRow(threads, Summarize(all), all.size() / (ms / 1000.0), stalls);
+	}
+}
+
+BENCH(SynchronousLogger) {
+	GameSettings settings;
+	GameSettings::set_game_name(L"LogLatencyBench");
+	Logger logger;
+	SilenceDebugOutput();
+
+	size_t calls = bench::Scaled(20000);
+	std::vector<double> latencies(calls);
+	double ms = bench::TimeMs([&] {
+		for (size_t i = 0; i < calls; i++) {
+			latencies[i] = TimeNs([&] {
+				Logger::info(L"[Bench] thread %d frame %zu took %.3f ms\n", 0, i, 16.6);
+			});
+		}
+	});
+
+	PrintHeader();
+	PrintRow(1, Summarize(latencies), calls / (ms / 1000.0), 0);
+}
+
+BENCH(AsyncTextFlood) {
+	AsyncLatency(false, false);
+}
+
+BENCH(AsyncBinaryFlood) {
+	AsyncLatency(true, false);
+}
+
+BENCH(AsyncTextPaced) {
+	AsyncLatency(false, true);
+}
+
+BENCH(AsyncBinaryPaced) {
+	AsyncLatency(true, true);
+}
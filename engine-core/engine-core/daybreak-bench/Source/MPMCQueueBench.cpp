@@ -0,0 +1,127 @@
+#include "Bench.h"
+
+#include "common/MPMCQueue.h"
+
+#include <mutex>
+#include <queue>
+#include <thread>
+
+/*
+	Throughput of MPMCQueue against the mutex + std::queue it replaced, with
+	n producers and n consumers for n = 1..16 over a 1024-entry queue (the job
+	system's injection queue is 4096).
+*/
+
+// The old collection::ThreadSafeQueue, kept here as the baseline.
+template<typename T>
+class MutexQueue {
+	public:
+		void Push(T value) {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_queue.push(std::move(value));
+		}
+
+		bool Pop(T& value) {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_queue.empty()) {
+				return false;
+			}
+			value = std::move(m_queue.front());
+			m_queue.pop();
+			return true;
+		}
+
+	private:
+		std::queue<T>	m_queue;
+		std::mutex		m_mutex;
+};
+
+template<typename Queue>
+static double MillionsPerSecond(Queue& queue, uint32_t threads, uint64_t items) {
+	std::atomic<uint64_t> received = 0;
+	uint64_t perProducer = items / threads;
+	uint64_t total = perProducer * threads;
+
+	double ms = bench::TimeMs([&] {
+		std::vector<std::thread> workers;
+		for (uint32_t producer = 0; producer < threads; producer++) {
+			workers.emplace_back([&] {
+				for (uint64_t i = 0; i < perProducer; i++) {
+					queue.Push(i);
+				}
+			});
+		}
+		for (uint32_t consumer = 0; consumer < threads; consumer++) {
+			workers.emplace_back([&] {
+				uint64_t value;
+				while (received.load(std::memory_order_relaxed) < total) {
+					if (queue.Pop(value)) {
+						received.fetch_add(1, std::memory_order_relaxed);
+					} else {
+						std::this_thread::yield();
+					}
+				}
+			});
+		}
+		for (std::thread& worker : workers) {
+			worker.join();
+		}
+	});
+	return total / (ms * 1000.0);
+}
+
+BENCH(PushPopThroughput) {
+	uint64_t items = bench::Scaled(4000000);
+	printf("  %u hardware threads, %llu items per run\n", std::thread::hardware_concurrency(), static_cast<unsigned long long>(items));
+	printf("  %-20s %12s %12s\n", "producers/consumers", "MPMC Mops/s", "mutex Mops/s");
+
+	for (uint32_t threads : { 1, 2, 4, 8, 16 }) {
+		collection::MPMCQueue<uint64_t> lockFree(1024);
+		MutexQueue<uint64_t> locked;
+		double lockFreeRate = MillionsPerSecond(lockFree, threads, items);
+		double lockedRate = MillionsPerSecond(locked, threads, items);
+		printf("  %-20u %12.2f %12.2f\n", threads, lockFreeRate, lockedRate);
+		fflush(stdout);
+	}
+}
+
+BENCH(PopBatchThroughput) {
+	uint64_t items = bench::Scaled(4000000);
+	printf("  %-20s %12s %12s\n", "consumers", "Pop Mops/s", "batch Mops/s");
+
+	// One producer filling ahead of the consumers, as with job submission.
+	for (uint32_t consumers : { 1, 2, 4, 8, 16 }) {
+		double rates[2];
+		for (int batched = 0; batched < 2; batched++) {
+			collection::MPMCQueue<uint64_t> queue(1024);
+			std::atomic<uint64_t> received = 0;
+			double ms = bench::TimeMs([&] {
+				std::vector<std::thread> workers;
+				workers.emplace_back([&] {
+					for (uint64_t i = 0; i < items; i++) {
+						queue.Push(i);
+					}
+				});
+				for (uint32_t consumer = 0; consumer < consumers; consumer++) {
+					workers.emplace_back([&] {
+						uint64_t values[16];
+						while (received.load(std::memory_order_relaxed) < items) {
+							size_t count = batched ? queue.PopBatch(values, 16) : (queue.Pop(values[0]) ? 1 : 0);
+							if (count) {
+								received.fetch_add(count, std::memory_order_relaxed);
+							} else {
+								std::this_thread::yield();
+							}
+						}
+					});
+				}
+				for (std::thread& worker : workers) {
+					worker.join();
+				}
+			});
+			rates[batched] = items / (ms * 1000.0);
+		}
+		printf("  %-20u %12.2f %12.2f\n", consumers, rates[0], rates[1]);
+		fflush(stdout);
+	}
+}
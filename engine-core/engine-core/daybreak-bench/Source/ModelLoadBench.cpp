@@ -0,0 +1,158 @@
+#include "daybreak.h"
+#include "Bench.h"
+
+#include "core/JobSystem.h"
+#include "graphics/BakedMesh.h"
+#include "graphics/MeshOptimize.h"
+#include "graphics/MeshSimplify.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+/*
+	Load time of a 64-submesh asset against thread count. Each submesh goes
+	through the CPU side of gfx::Model::LoadFromFile: conversion from
+	Assimp-style separate streams into a preallocated vertex array, vertex
+	cache/overdraw/fetch optimization and LOD generation, one job per mesh.
+	The results are then staged into one upload block the way
+	CommandList::CopyBuffers does. Assimp and D3D12 are not involved, so the
+	numbers are the part of the load the job system can spread out.
+
+	Submeshes vary in size like a real asset: a few large ones and a tail of
+	small props, so the speedup is bounded by the largest mesh.
+*/
+
+static const uint32_t ThreadCounts[] = { 1, 2, 4, 8, 16 };
+static const size_t SubmeshCount = 64;
+
+namespace {
+
+	// Separate streams and triangle faces, as in an aiMesh.
+	struct SourceMesh {
+		std::vector<float>		Positions;
+		std::vector<float>		Normals;
+		std::vector<float>		UVs;
+		std::vector<uint32_t>	Faces;
+	};
+
+	// A bumpy torus of columns x rows quads; the wrapped edges are UV seams.
+	SourceMesh Torus(uint32_t columns, uint32_t rows, float phase) {
+		SourceMesh mesh;
+		for (uint32_t row = 0; row <= rows; row++) {
+			for (uint32_t column = 0; column <= columns; column++) {
+				float u = static_cast<float>(column) / columns, v = static_cast<float>(row) / rows;
+				float a = u * 6.2831853f, b = v * 6.2831853f;
+				float tube = 0.3f + 0.02f * std::sin(a * 7.0f + phase) * std::cos(b * 5.0f);
+				float ring = 1.0f + tube * std::cos(b);
+				mesh.Positions.insert(mesh.Positions.end(), { ring * std::cos(a), tube * std::sin(b), ring * std::sin(a) });
+				mesh.Normals.insert(mesh.Normals.end(), { std::cos(b) * std::cos(a), std::sin(b), std::cos(b) * std::sin(a) });
+				mesh.UVs.insert(mesh.UVs.end(), { u, v });
+			}
+		}
+		for (uint32_t row = 0; row < rows; row++) {
+			for (uint32_t column = 0; column < columns; column++) {
+				uint32_t a = row * (columns + 1) + column, b = a + 1, c = a + columns + 1, d = c + 1;
+				mesh.Faces.insert(mesh.Faces.end(), { a, c, b, b, c, d });
+			}
+		}
+		return mesh;
+	}
+
+	void Convert(const SourceMesh& source, bmesh::MeshData& mesh) {
+		size_t vertexCount = source.Positions.size() / 3;
+		mesh.Vertices.resize(vertexCount);
+		for (size_t i = 0; i < vertexCount; i++) {
+			bmesh::Vertex& vertex = mesh.Vertices[i];
+			vertex = {};
+			memcpy(vertex.Position, &source.Positions[i * 3], sizeof(vertex.Position));
+			memcpy(vertex.Normal, &source.Normals[i * 3], sizeof(vertex.Normal));
+			memcpy(vertex.UV, &source.UVs[i * 2], sizeof(vertex.UV));
+			vertex.Color[0] = 0.196f;
+			vertex.Color[1] = 0.573f;
+			vertex.Color[2] = 0.035f;
+		}
+		mesh.Indices = source.Faces;
+	}
+
+	void Process(const SourceMesh& source, bmesh::MeshData& mesh) {
+		Convert(source, mesh);
+		meshops::OptimizeMesh(mesh.Vertices, mesh.Indices);
+
+		std::vector<meshops::LodLevel> levels = meshops::GenerateLods(
+			mesh.Vertices[0].Position, sizeof(bmesh::Vertex), mesh.Vertices[0].UV, sizeof(bmesh::Vertex), mesh.Vertices.size(),
+			mesh.Indices.data(), mesh.Indices.size()
+		);
+		for (const meshops::LodLevel& level : levels) {
+			mesh.Indices.insert(mesh.Indices.end(), level.Indices.begin(), level.Indices.end());
+		}
+	}
+
+	size_t Stage(const std::vector<bmesh::MeshData>& meshes, std::vector<uint8_t>& upload) {
+		std::vector<size_t> offsets(meshes.size() * 2);
+		size_t uploadSize = 0;
+		for (size_t i = 0; i < meshes.size(); i++) {
+			offsets[i * 2] = uploadSize;
+			uploadSize = AlignUp(uploadSize + meshes[i].Vertices.size() * sizeof(bmesh::Vertex), 16);
+			offsets[i * 2 + 1] = uploadSize;
+			uploadSize = AlignUp(uploadSize + meshes[i].Indices.size() * sizeof(uint32_t), 16);
+		}
+
+		upload.resize(uploadSize);
+		jobs::JobSystem::ParallelFor(meshes.size(), 1, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				memcpy(upload.data() + offsets[i * 2], meshes[i].Vertices.data(), meshes[i].Vertices.size() * sizeof(bmesh::Vertex));
+				memcpy(upload.data() + offsets[i * 2 + 1], meshes[i].Indices.data(), meshes[i].Indices.size() * sizeof(uint32_t));
+			}
+		});
+		return uploadSize;
+	}
+}
+
+BENCH(SubmeshLoadScaling) {
+	// Four large meshes, then progressively smaller ones.
+	uint32_t largest = bench::Quick() ? 48 : 192;
+	std::vector<SourceMesh> sources;
+	size_t triangles = 0;
+	for (size_t i = 0; i < SubmeshCount; i++) {
+		uint32_t columns = std::max<uint32_t>(8, static_cast<uint32_t>(largest / (1 + i / 4)));
+		sources.push_back(Torus(columns, columns / 2, static_cast<float>(i)));
+		triangles += sources.back().Faces.size() / 3;
+	}
+
+	printf("  %zu submeshes, %zu triangles, %u hardware threads\n", SubmeshCount, triangles, std::thread::hardware_concurrency());
+	printf("  %-8s %10s %10s %10s %10s\n", "threads", "process", "stage", "total ms", "speedup");
+
+	double serialMs = 0.0, serialProcessMs = 0.0, largestMeshMs = 0.0;
+	for (uint32_t threads : ThreadCounts) {
+		if (threads > 1) {
+			jobs::JobSystem::Initialize(threads - 1);
+		}
+
+		std::vector<bmesh::MeshData> meshes(SubmeshCount);
+		std::vector<double> meshMs(SubmeshCount);
+		std::vector<uint8_t> upload;
+		double processMs = bench::TimeMs([&] {
+			jobs::JobSystem::ParallelFor(SubmeshCount, 1, [&](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; i++) {
+					meshMs[i] = bench::TimeMs([&] { Process(sources[i], meshes[i]); });
+				}
+			});
+		});
+		double stageMs = bench::TimeMs([&] { Stage(meshes, upload); });
+		jobs::JobSystem::Shutdown();
+
+		double totalMs = processMs + stageMs;
+		if (threads == 1) {
+			serialMs = totalMs;
+			serialProcessMs = processMs;
+			largestMeshMs = *std::max_element(meshMs.begin(), meshMs.end());
+		}
+		printf("  %-8u %10.1f %10.1f %10.1f %10.2f\n", threads, processMs, stageMs, totalMs, serialMs / totalMs);
+		fflush(stdout);
+	}
+
+	// No schedule finishes processing before the largest mesh does.
+	printf("  largest submesh %.1f of %.1f ms serial: speedup bound %.1fx\n", largestMeshMs, serialProcessMs, serialProcessMs / largestMeshMs);
+}
@@ -0,0 +1,214 @@
+#include "daybreak.h"
+#include "Bench.h"
+
+#include "common/OffsetAllocator.h"
+
+#include <map>
+#include <random>
+
+/*
+	memory::OffsetAllocator against a best-fit free list kept in std::map (the
+	usual first attempt: free blocks by size for the search, by offset for
+	merging). Both run the same random churn at a steady number of live
+	allocations; the table shows the cost of a Free/Allocate pair and how
+	many allocations failed. TLSF rounds requests up to a bin, so on a nearly
+	full heap it can fail where best fit would not; the failure column shows
+	whether that happened. Its node pool is sized for the largest run.
+*/
+
+namespace {
+
+	class MapAllocator {
+		public:
+			struct Allocation {
+				uint32_t	Offset = memory::OffsetAllocator::NoSpace;
+				uint32_t	Size = 0;
+
+				bool IsValid() const { return Offset != memory::OffsetAllocator::NoSpace; }
+			};
+
+			explicit MapAllocator(uint32_t size) {
+				Insert(0, size);
+			}
+
+			Allocation Allocate(uint32_t size) {
+				Allocation allocation;
+				auto fit = m_bySize.lower_bound(size);
+				if (fit == m_bySize.end()) {
+					return allocation;
+				}
+
+				uint32_t blockSize = fit->first;
+				uint32_t offset = fit->second;
+				m_bySize.erase(fit);
+				m_byOffset.erase(offset);
+				if (blockSize > size) {
+					Insert(offset + size, blockSize - size);
+				}
+
+				allocation.Offset = offset;
+				allocation.Size = size;
+				return allocation;
+			}
+
+			void Free(Allocation allocation) {
+				uint32_t offset = allocation.Offset;
+				uint32_t size = allocation.Size;
+
+				auto next = m_byOffset.lower_bound(offset);
+				if (next != m_byOffset.end() && next->first == offset + size) {
+					size += next->second;
+					Erase(next);
+				}
+				auto prev = m_byOffset.lower_bound(offset);
+				if (prev != m_byOffset.begin()) {
+					--prev;
+					if (prev->first + prev->second == offset) {
+						offset = prev->first;
+						size += prev->second;
+						Erase(prev);
+					}
+				}
+				Insert(offset, size);
+			}
+
+		private:
+			void Insert(uint32_t offset, uint32_t size) {
+				m_byOffset.emplace(offset, size);
+				m_bySize.emplace(size, offset);
+			}
+
+			void Erase(std::map<uint32_t, uint32_t>::iterator block) {
+				auto range = m_bySize.equal_range(block->second);
+				for (auto i = range.first; i != range.second; ++i) {
+					if (i->second == block->first) {
+						m_bySize.erase(i);
+						break;
+					}
+				}
+				m_byOffset.erase(block);
+			}
+
+			std::map<uint32_t, uint32_t>		m_byOffset;
+			std::multimap<uint32_t, uint32_t>	m_bySize;
+	};
+
+	struct TlsfAllocator {
+		memory::OffsetAllocator Allocator;
+
+		explicit TlsfAllocator(uint32_t size) :
+			Allocator(size, 512 * 1024) {
+		}
+
+		memory::OffsetAllocator::Allocation Allocate(uint32_t size) { return Allocator.Allocate(size); }
+		void Free(memory::OffsetAllocator::Allocation allocation) { Allocator.Free(allocation); }
+	};
+
+	struct Result {
+		double	NsPerPair;
+		size_t	Failures;
+	};
+
+	/*
+		Fills the heap to liveCount allocations, then frees a random one and
+		allocates a new one per step. Sizes are mostly small with a tail of
+		large ones, like descriptor ranges and buffer suballocations.
+	*/
+	template<typename Allocator>
+	Result Churn(uint32_t heapSize, size_t liveCount, size_t steps, uint32_t maxSize) {
+		Allocator allocator(heapSize);
+		std::mt19937 random(11);
+		auto nextSize = [&] {
+			return random() % 8 == 0 ? 1 + random() % maxSize : 1 + random() % 64;
+		};
+
+		std::vector<decltype(allocator.Allocate(1))> live;
+		live.reserve(liveCount);
+		while (live.size() < liveCount) {
+			auto allocation = allocator.Allocate(nextSize());
+			if (allocation.IsValid()) {
+				live.push_back(allocation);
+			}
+		}
+
+		size_t failures = 0;
+		double ms = bench::TimeMs([&] {
+			for (size_t step = 0; step < steps; step++) {
+				size_t index = random() % live.size();
+				allocator.Free(live[index]);
+
+				auto allocation = allocator.Allocate(nextSize());
+				if (allocation.IsValid()) {
+					live[index] = allocation;
+				} else {
+					failures++;
+					live[index] = live.back();
+					live.pop_back();
+				}
+			}
+		});
+		return { ms * 1e6 / steps, failures };
+	}
+}
+
+BENCH(ChurnAllocateFree) {
+	size_t steps = bench::Scaled(2000000);
+	const uint32_t HeapSize = 64u << 20;
+	printf("  %zu free+allocate pairs on a %u MB heap\n", steps, HeapSize >> 20);
+	printf("  %-8s %-8s %12s %10s %12s %10s\n", "live", "maxsize", "tlsf ns", "fails", "map ns", "fails");
+
+	for (size_t liveCount : { 1000, 10000, 100000 }) {
+		for (uint32_t maxSize : { 1024u, 65536u }) {
+			// Keep the expected live footprint under the heap so both mostly succeed.
+			if (liveCount * (maxSize / 16 + 32) > HeapSize) {
+				continue;
+			}
+			Result tlsf = Churn<TlsfAllocator>(HeapSize, liveCount, steps, maxSize);
+			Result map = Churn<MapAllocator>(HeapSize, liveCount, steps, maxSize);
+			printf("  %-8zu %-8u %12.1f %10zu %12.1f %10zu\n", liveCount, maxSize, tlsf.NsPerPair, tlsf.Failures, map.NsPerPair, map.Failures);
+			fflush(stdout);
+		}
+	}
+}
+
+/*
+	Only exact-size requests for a non-bin-aligned block, so every Allocate
+	goes through the exact-fit fallback. Bins are filled with many smaller
+	blocks of the same bin first: the fallback only checks the bin head, so
+	its cost does not grow with them.
+*/
+BENCH(ExactFitFallback) {
+	size_t steps = bench::Scaled(2000000);
+	printf("  %-10s %12s\n", "bin size", "ns/pair");
+
+	for (uint32_t crowd : { 0u, 100u, 10000u }) {
+		// crowd blocks of 961 and one of 1000 (same bin), separated by used
+		// single units so they cannot merge.
+		memory::OffsetAllocator allocator((961 + 1) * crowd + 1000 + 1, 2 * crowd + 8);
+		std::vector<memory::OffsetAllocator::Allocation> blocks;
+		memory::OffsetAllocator::Allocation target = allocator.Allocate(1000);
+		allocator.Allocate(1);
+		for (uint32_t i = 0; i < crowd; i++) {
+			blocks.push_back(allocator.Allocate(961));
+			allocator.Allocate(1);
+		}
+		for (auto block : blocks) {
+			allocator.Free(block);
+		}
+		allocator.Free(target);
+
+		size_t failures = 0;
+		double ms = bench::TimeMs([&] {
+			for (size_t step = 0; step < steps; step++) {
+				memory::OffsetAllocator::Allocation allocation = allocator.Allocate(1000);
+				if (!allocation.IsValid()) {
+					failures++;
+					continue;
+				}
+				allocator.Free(allocation);
+			}
+		});
+		printf("  %-10u %12.1f%s\n", crowd + 1, ms * 1e6 / steps, failures ? "  (failed)" : "");
+		fflush(stdout);
+	}
+}
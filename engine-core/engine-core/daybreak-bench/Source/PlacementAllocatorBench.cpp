@@ -0,0 +1,153 @@
+#include "daybreak.h"
+#include "Bench.h"
+
+#include "common/PlacementAllocator.h"
+
+#include <random>
+
+/*
+	Fragmentation of memory::PlacementAllocator under streaming-style churn:
+	a working set of textures and buffers is loaded, then resources are
+	replaced at random for a number of rounds. After each phase the table
+	shows how much heap memory is reserved against what was asked for,
+	and the largest block still free. "committed" is what the same live set
+	would cost as committed resources, each rounded up to 64KB. Dedicated
+	requests are committed either way and left out of both.
+*/
+
+using memory::PlacementAllocator;
+
+static const uint64_t KB = 1024;
+static const uint64_t MB = 1024 * KB;
+
+namespace {
+
+	struct Request {
+		uint64_t					Size;
+		uint64_t					Alignment;
+		PlacementAllocator::Category	Category;
+	};
+
+	/*
+		Mostly small buffers and textures, a tail of large mip chains, and the
+		occasional 2x MSAA render target with 4MB alignment.
+	*/
+	Request NextRequest(std::mt19937& random) {
+		uint32_t kind = random() % 100;
+		if (kind < 45) {
+			return { 1 + random() % (256 * KB), 4 * KB, PlacementAllocator::Category::Buffer };
+		}
+		if (kind < 92) {
+			uint64_t side = 64u << (random() % 4);	// 64 to 512 texels
+			return { side * side * 4 * 4 / 3, 64 * KB, PlacementAllocator::Category::Texture };
+		}
+		if (kind < 98) {
+			uint64_t side = 1024u << (random() % 2);
+			return { side * side * 4 * 4 / 3, 64 * KB, PlacementAllocator::Category::Texture };
+		}
+		return { 1920ull * 1080 * 4 * 2, 4 * MB, PlacementAllocator::Category::RenderTarget };
+	}
+
+	uint64_t CommittedSize(uint64_t size) {
+		return (size + 64 * KB - 1) / (64 * KB) * (64 * KB);
+	}
+
+	void Report(const char* phase, const PlacementAllocator& allocator, uint64_t committed, double nsPerOp) {
+		PlacementAllocator::Statistics stats = allocator.Stats();
+		printf("  %-10s %6u %10.1f %10.1f %10.1f %10.1f %7.1f%% %10.1f %8.0f\n",
+			phase,
+			stats.Heaps,
+			static_cast<double>(stats.HeapBytes) / MB,
+			static_cast<double>(stats.RequestedBytes) / MB,
+			static_cast<double>(stats.ReservedBytes) / MB,
+			static_cast<double>(committed) / MB,
+			stats.HeapBytes ? 100.0 * stats.RequestedBytes / stats.HeapBytes : 0.0,
+			static_cast<double>(stats.LargestFreeBlock) / MB,
+			nsPerOp);
+		fflush(stdout);
+	}
+}
+
+BENCH(StreamingChurn) {
+	size_t workingSet = 3000;
+	size_t rounds = 4;
+	size_t perRound = bench::Scaled(200000);
+
+	printf("  %zu live resources, %zu replacements per round\n", workingSet, perRound);
+	printf("  %-10s %6s %10s %10s %10s %10s %8s %10s %8s\n",
+		"phase", "heaps", "heap MB", "asked MB", "reserve MB", "commit MB", "used", "largest", "ns/op");
+
+	PlacementAllocator allocator;
+	std::mt19937 random(17);
+	std::vector<PlacementAllocator::Placement> live;
+	uint64_t committed = 0;
+	size_t dedicated = 0;
+
+	double loadMs = bench::TimeMs([&] {
+		while (live.size() < workingSet) {
+			Request request = NextRequest(random);
+			PlacementAllocator::Placement placement = allocator.Allocate(request.Size, request.Alignment, request.Category);
+			dedicated += placement.Dedicated;
+			committed += placement.IsPlaced() ? CommittedSize(request.Size) : 0;
+			live.push_back(placement);
+		}
+	});
+	Report("load", allocator, committed, loadMs * 1e6 / workingSet);
+
+	for (size_t round = 1; round <= rounds; round++) {
+		double ms = bench::TimeMs([&] {
+			for (size_t i = 0; i < perRound; i++) {
+				PlacementAllocator::Placement& placement = live[random() % live.size()];
+				committed -= placement.IsPlaced() ? CommittedSize(placement.RequestedSize) : 0;
+				allocator.Free(placement);
+
+				Request request = NextRequest(random);
+				placement = allocator.Allocate(request.Size, request.Alignment, request.Category);
+				dedicated += placement.Dedicated;
+				committed += placement.IsPlaced() ? CommittedSize(request.Size) : 0;
+			}
+		});
+
+		char phase[16];
+		snprintf(phase, sizeof(phase), "churn %zu", round);
+		Report(phase, allocator, committed, ms * 1e6 / perRound);
+	}
+
+	for (const auto& placement : live) {
+		allocator.Free(placement);
+	}
+	Report("freed", allocator, 0, 0.0);
+	printf("  %zu requests went to dedicated resources\n", dedicated);
+}
+
+/*
+	Worst case for the size-class pools: fill with one class, then keep one
+	slot in every few alive. Pages stay pinned by their survivors, so page
+	memory does not fall with the live set.
+*/
+BENCH(PoolPinning) {
+	printf("  %-10s %10s %10s %10s %8s\n", "kept", "asked MB", "page MB", "pages", "used");
+
+	for (size_t keepEvery : { 1, 2, 4, 16, 64 }) {
+		PlacementAllocator allocator;
+		std::vector<PlacementAllocator::Placement> placements;
+		for (int i = 0; i < 4096; i++) {
+			placements.push_back(allocator.Allocate(64 * KB, 64 * KB, PlacementAllocator::Category::Buffer));
+		}
+		for (size_t i = 0; i < placements.size(); i++) {
+			if (i % keepEvery != 0) {
+				allocator.Free(placements[i]);
+			}
+		}
+
+		PlacementAllocator::Statistics stats = allocator.Stats();
+		uint64_t pageBytes = static_cast<uint64_t>(stats.PoolPages) * 4 * MB;
+		printf("  1 in %-5zu %10.1f %10.1f %10u %7.1f%%\n",
+			keepEvery,
+			static_cast<double>(stats.RequestedBytes) / MB,
+			static_cast<double>(pageBytes) / MB,
+			stats.PoolPages,
+			100.0 * stats.RequestedBytes / pageBytes);
+		fflush(stdout);
+	}
+}
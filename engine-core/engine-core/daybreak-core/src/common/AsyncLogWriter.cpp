@@ -0,0 +1,366 @@
+#include "daybreak.h"
+#include "AsyncLogWriter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+
+/*
+	Bounded little-endian byte writer for binary records. Writes that do not
+	fit are dropped and the writer is marked as full.
+*/
+struct RecordEncoder {
+	uint8_t*	Cursor;
+	uint8_t*	End;
+
+	template<typename T>
+	bool Write(const T& value) {
+		if (Cursor + sizeof(T) > End) {
+			Cursor = End;
+			return false;
+		}
+		memcpy(Cursor, &value, sizeof(T));
+		Cursor += sizeof(T);
+		return true;
+	}
+
+	bool WriteString(const wchar_t* text) {
+		size_t length = wcslen(text);
+		size_t room = Cursor + sizeof(uint16_t) < End ? (End - Cursor - sizeof(uint16_t)) / sizeof(uint16_t) : 0;
+		length = std::min(std::min(length, room), size_t(UINT16_MAX));
+
+		if (!Write(static_cast<uint16_t>(length))) {
+			return false;
+		}
+		for (size_t i = 0; i < length; i++) {
+			Write(static_cast<uint16_t>(text[i]));
+		}
+		return true;
+	}
+
+	bool WriteString(const char* text) {
+		size_t length = strlen(text);
+		size_t room = Cursor + sizeof(uint16_t) < End ? End - Cursor - sizeof(uint16_t) : 0;
+		length = std::min(std::min(length, room), size_t(UINT16_MAX));
+
+		if (!Write(static_cast<uint16_t>(length))) {
+			return false;
+		}
+		memcpy(Cursor, text, length);
+		Cursor += length;
+		return true;
+	}
+};
+
+AsyncLogWriter::AsyncLogWriter(const std::wstring& filePath, bool binary, size_t capacity) :
+	m_enqueuePosition(0),
+	m_dequeuePosition(0),
+	m_stalls(0),
+	m_binary(binary),
+	m_cachedSecond(0),
+	m_cachedTimestamp{ 0 },
+	m_running(true) {
+
+	size_t slots = 1;
+	while (slots < capacity) {
+		slots <<= 1;
+	}
+
+	m_mask = slots - 1;
+	m_records = std::make_unique<Record[]>(slots);
+	for (size_t i = 0; i < slots; i++) {
+		m_records[i].Sequence.store(i, std::memory_order_relaxed);
+	}
+
+	if (m_binary) {
+		std::error_code error;
+		bool empty = std::filesystem::file_size(filePath, error) == 0 || error;
+
+		m_binaryBatch.reserve(slots * 64);
+		m_binaryFile.open(std::filesystem::path(filePath), std::ios_base::app | std::ios_base::binary);
+		if (m_binaryFile.is_open() && empty) {
+			m_binaryFile.write(reinterpret_cast<const char*>(&blog::Magic), sizeof(blog::Magic));
+			m_binaryFile.write(reinterpret_cast<const char*>(&blog::Version), sizeof(blog::Version));
+		}
+	} else {
+		m_batch.reserve(slots * 128);
+		m_file.open(std::filesystem::path(filePath), std::ios_base::app);
+	}
+	m_writerThread = std::thread(&AsyncLogWriter::WriterThread, this);
+}
+
+AsyncLogWriter::~AsyncLogWriter() {
+	{
+		std::lock_guard<std::mutex> lock(m_wakeMutex);
+		m_running = false;
+	}
+	m_wakeCV.notify_one();
+	m_writerThread.join();
+
+	Flush();
+	m_file.close();
+	m_binaryFile.close();
+}
+
+void AsyncLogWriter::Push(const wchar_t* level, const wchar_t* fmt, va_list args) {
+	if (m_binary) {
+		PushBinary(level, fmt, args);
+		return;
+	}
+
+	uint64_t position;
+	Record* record = Acquire(position);
+
+	_vsnwprintf_s(record->Text, MaxRecordLength, _TRUNCATE, fmt, args);
+	record->Level = level;
+	record->Time = std::chrono::system_clock::now();
+
+	Publish(record, position);
+}
+
+void AsyncLogWriter::PushRaw(const wchar_t* text) {
+	if (m_binary) {
+		PushBinaryRaw(text);
+		return;
+	}
+
+	uint64_t position;
+	Record* record = Acquire(position);
+
+	wcsncpy_s(record->Text, text, _TRUNCATE);
+	record->Level = nullptr;
+
+	Publish(record, position);
+}
+
+void AsyncLogWriter::Flush() {
+	std::lock_guard<std::mutex> lock(m_drainMutex);
+	while (Drain());
+	m_file.flush();
+	m_binaryFile.flush();
+}
+
+bool AsyncLogWriter::FlushOnCrash() {
+	// The filter runs on the faulting thread; if that is the writer it may be
+	// part way through a drain with the mutex held.
+	if (std::this_thread::get_id() == m_writerThread.get_id()) {
+		return false;
+	}
+
+	std::unique_lock<std::mutex> lock(m_drainMutex, std::defer_lock);
+	for (int attempt = 0; !lock.try_lock(); attempt++) {
+		if (attempt == CrashLockAttempts) {
+			return false;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	for (int pass = 0; pass < CrashDrainPasses && Drain(); pass++);
+	m_file.flush();
+	m_binaryFile.flush();
+	return true;
+}
+
+AsyncLogWriter::Record* AsyncLogWriter::Acquire(uint64_t& position) {
+	position = m_enqueuePosition.load(std::memory_order_relaxed);
+	bool stalled = false;
+
+	for (;;) {
+		Record& record = m_records[position & m_mask];
+		uint64_t sequence = record.Sequence.load(std::memory_order_acquire);
+		int64_t diff = static_cast<int64_t>(sequence) - static_cast<int64_t>(position);
+
+		if (diff == 0) {
+			if (m_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+				return &record;
+			}
+		} else if (diff < 0) {
+			// Ring is full -- the writer is behind. Nudge it and retry.
+			if (!stalled) {
+				m_stalls.fetch_add(1, std::memory_order_relaxed);
+				stalled = true;
+			}
+			m_wakeCV.notify_one();
+			std::this_thread::yield();
+			position = m_enqueuePosition.load(std::memory_order_relaxed);
+		} else {
+			position = m_enqueuePosition.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+void AsyncLogWriter::Publish(Record* record, uint64_t position) {
+	record->Sequence.store(position + 1, std::memory_order_release);
+}
+
+const AsyncLogWriter::FormatInfo& AsyncLogWriter::LookupFormat(const wchar_t* level, const wchar_t* fmt) {
+	FormatKey key = { level, fmt };
+	{
+		std::shared_lock<std::shared_mutex> lock(m_formatMutex);
+		auto it = m_formats.find(key);
+		if (it != m_formats.end()) {
+			return it->second;
+		}
+	}
+
+	std::unique_lock<std::shared_mutex> lock(m_formatMutex);
+	auto it = m_formats.find(key);
+	if (it != m_formats.end()) {
+		return it->second;
+	}
+
+	FormatInfo info;
+	info.Id = static_cast<uint32_t>(m_formats.size());
+	blog::ParseFormat(fmt, info.Args);
+
+	// The definition is queued while the lock is held, so it always lands in the
+	// ring ahead of any entry that refers to it.
+	uint64_t position;
+	Record* record = Acquire(position);
+	RecordEncoder encoder = { record->Data, record->Data + sizeof(record->Data) };
+	encoder.Write(blog::RecordType::Format);
+	encoder.Write(info.Id);
+	encoder.WriteString(level);
+	encoder.WriteString(fmt);
+	record->Size = static_cast<uint32_t>(encoder.Cursor - record->Data);
+	Publish(record, position);
+
+	return m_formats.emplace(key, std::move(info)).first->second;
+}
+
+void AsyncLogWriter::PushBinary(const wchar_t* level, const wchar_t* fmt, va_list args) {
+	const FormatInfo& format = LookupFormat(level, fmt);
+	int64_t time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+	uint64_t position;
+	Record* record = Acquire(position);
+	RecordEncoder encoder = { record->Data, record->Data + sizeof(record->Data) };
+	encoder.Write(blog::RecordType::Entry);
+	encoder.Write(format.Id);
+	encoder.Write(time);
+
+	uint8_t* size = encoder.Cursor;
+	encoder.Write(uint16_t(0));
+	uint8_t* payload = encoder.Cursor;
+
+	va_list list;
+	va_copy(list, args);
+	for (blog::ArgType type : format.Args) {
+		switch (type) {
+			case blog::ArgType::Int32:
+				encoder.Write(va_arg(list, int32_t));
+				break;
+			case blog::ArgType::Int64:
+				encoder.Write(va_arg(list, int64_t));
+				break;
+			case blog::ArgType::Double:
+				encoder.Write(va_arg(list, double));
+				break;
+			case blog::ArgType::Pointer:
+				encoder.Write(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(va_arg(list, void*))));
+				break;
+			case blog::ArgType::WideString: {
+				const wchar_t* text = va_arg(list, const wchar_t*);
+				encoder.WriteString(text ? text : L"(null)");
+				break;
+			}
+			case blog::ArgType::NarrowString: {
+				const char* text = va_arg(list, const char*);
+				encoder.WriteString(text ? text : "(null)");
+				break;
+			}
+		}
+	}
+	va_end(list);
+
+	uint16_t payloadSize = static_cast<uint16_t>(encoder.Cursor - payload);
+	memcpy(size, &payloadSize, sizeof(payloadSize));
+	record->Size = static_cast<uint32_t>(encoder.Cursor - record->Data);
+
+	Publish(record, position);
+}
+
+void AsyncLogWriter::PushBinaryRaw(const wchar_t* text) {
+	uint64_t position;
+	Record* record = Acquire(position);
+	RecordEncoder encoder = { record->Data, record->Data + sizeof(record->Data) };
+	encoder.Write(blog::RecordType::Raw);
+	encoder.WriteString(text);
+	record->Size = static_cast<uint32_t>(encoder.Cursor - record->Data);
+
+	Publish(record, position);
+}
+
+bool AsyncLogWriter::Drain() {
+	m_batch.clear();
+	m_binaryBatch.clear();
+
+	size_t drained = 0;
+	while (drained <= m_mask) {
+		Record& record = m_records[m_dequeuePosition & m_mask];
+		if (record.Sequence.load(std::memory_order_acquire) != m_dequeuePosition + 1) {
+			break;
+		}
+
+		if (m_binary) {
+			m_binaryBatch.append(reinterpret_cast<const char*>(record.Data), record.Size);
+		} else if (record.Level) {
+			time_t now = std::chrono::system_clock::to_time_t(record.Time);
+			if (now != m_cachedSecond) {
+				tm ltm;
+				localtime_s(&ltm, &now);
+				wcsftime(m_cachedTimestamp, _countof(m_cachedTimestamp), L"%d/%m/%y %T", &ltm);
+				m_cachedSecond = now;
+			}
+
+			m_batch += L"[";
+			m_batch += m_cachedTimestamp;
+			m_batch += L" - ";
+			m_batch += record.Level;
+			m_batch += L"]  ";
+			OutputDebugString(record.Text);
+			m_batch += record.Text;
+		} else {
+			m_batch += record.Text;
+		}
+
+		record.Sequence.store(m_dequeuePosition + m_mask + 1, std::memory_order_release);
+		m_dequeuePosition++;
+		drained++;
+	}
+
+	if (drained > 0 && m_binaryFile.is_open()) {
+		m_binaryFile.write(m_binaryBatch.data(), m_binaryBatch.size());
+	} else if (drained > 0 && m_file.is_open()) {
+		m_file << m_batch;
+	}
+	return drained > 0;
+}
+
+void AsyncLogWriter::WriterThread() {
+	while (m_running) {
+		bool wrote = false;
+		uint64_t enqueued;
+		{
+			std::lock_guard<std::mutex> lock(m_drainMutex);
+			while (Drain()) {
+				wrote = true;
+			}
+			if (wrote) {
+				m_file.flush();
+				m_binaryFile.flush();
+			}
+			enqueued = m_enqueuePosition.load(std::memory_order_relaxed);
+		}
+
+		// Producers only notify once the ring is full, and then the enqueue
+		// position has moved on since the drain; waking on !m_running alone
+		// would leave them stalled until the timeout.
+		if (!wrote) {
+			std::unique_lock<std::mutex> lock(m_wakeMutex);
+			m_wakeCV.wait_for(lock, std::chrono::milliseconds(10), [this, enqueued] {
+				return !m_running || m_enqueuePosition.load(std::memory_order_relaxed) != enqueued;
+			});
+		}
+	}
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "BinaryLog.h"
+
+/*
+	Multi-producer log sink. Callers on any thread format their message straight
+	into a slot of a lock-free ring; a single background writer drains the ring in
+	batches to a log file that is opened once and kept open for the session.
+
+	In binary mode nothing is formatted at the call site: a record holds only the
+	format-string id and the raw argument bytes, and the file is written in the
+	.blog layout described in BinaryLog.h.
+*/
+class DAYBREAK_API AsyncLogWriter {
+	public:
+		static const size_t MaxRecordLength = 1024;
+		static const int CrashLockAttempts = 20;
+		static const int CrashDrainPasses = 4;
+
+		AsyncLogWriter(const std::wstring& filePath, bool binary = false, size_t capacity = 1024);
+		~AsyncLogWriter();
+
+		AsyncLogWriter(const AsyncLogWriter& copy) = delete;
+		AsyncLogWriter& operator=(const AsyncLogWriter& other) = delete;
+
+		/*
+			Formats a record into the ring. Never touches the file; blocks only
+			if the ring is full and the writer has fallen behind. fmt must have
+			static storage in binary mode since its address identifies it.
+		*/
+		void Push(const wchar_t* level, const wchar_t* fmt, va_list args);
+
+		/*
+			Queues text that is written verbatim (no timestamp or level prefix).
+		*/
+		void PushRaw(const wchar_t* text);
+
+		/*
+			Drains everything queued so far and flushes the file. Safe to call
+			from any thread; blocks while the writer is mid-drain.
+		*/
+		void Flush();
+
+		/*
+			Flush for a crash handler, which must not block on a lock the faulting
+			thread may hold. Gives up if the writer is the faulting thread or does
+			not let go of the drain within a few milliseconds, and drains at most
+			a few rings' worth so producers still running cannot keep it here.
+			Returns whether anything was attempted.
+		*/
+		bool FlushOnCrash();
+
+		bool IsOpen() const { return m_binary ? m_binaryFile.is_open() : m_file.is_open(); }
+		bool IsBinary() const { return m_binary; }
+		uint64_t StallCount() const { return m_stalls.load(std::memory_order_relaxed); }
+
+	private:
+		struct Record {
+			std::atomic<uint64_t>					Sequence;
+			const wchar_t*							Level;
+			std::chrono::system_clock::time_point	Time;
+			uint32_t								Size;
+			union {
+				wchar_t								Text[MaxRecordLength];
+				uint8_t								Data[MaxRecordLength * sizeof(wchar_t)];
+			};
+		};
+
+		struct FormatKey {
+			const wchar_t* Level;
+			const wchar_t* Format;
+
+			bool operator==(const FormatKey& other) const { return Level == other.Level && Format == other.Format; }
+		};
+
+		struct FormatKeyHash {
+			size_t operator()(const FormatKey& key) const {
+				return std::hash<const void*>()(key.Format) ^ (std::hash<const void*>()(key.Level) << 1);
+			}
+		};
+
+		struct FormatInfo {
+			uint32_t					Id;
+			std::vector<blog::ArgType>	Args;
+		};
+
+		Record* Acquire(uint64_t& position);
+		void Publish(Record* record, uint64_t position);
+
+		const FormatInfo& LookupFormat(const wchar_t* level, const wchar_t* fmt);
+		void PushBinary(const wchar_t* level, const wchar_t* fmt, va_list args);
+		void PushBinaryRaw(const wchar_t* text);
+
+		bool Drain();
+		void WriterThread();
+
+		std::unique_ptr<Record[]>	m_records;
+		size_t						m_mask;
+
+		alignas(64) std::atomic<uint64_t>	m_enqueuePosition;
+		alignas(64) uint64_t				m_dequeuePosition;
+		std::atomic<uint64_t>				m_stalls;
+
+		bool					m_binary;
+		std::wofstream			m_file;
+		std::wstring			m_batch;
+		std::ofstream			m_binaryFile;
+		std::string				m_binaryBatch;
+		time_t					m_cachedSecond;
+		wchar_t					m_cachedTimestamp[32];
+
+		std::unordered_map<FormatKey, FormatInfo, FormatKeyHash>	m_formats;
+		std::shared_mutex											m_formatMutex;
+
+		std::thread				m_writerThread;
+		std::atomic_bool		m_running;
+		std::mutex				m_drainMutex;
+		std::mutex				m_wakeMutex;
+		std::condition_variable	m_wakeCV;
+};
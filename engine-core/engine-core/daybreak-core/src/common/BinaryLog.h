@@ -0,0 +1,299 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <cwchar>
+#include <string>
+#include <vector>
+
+/*
+	On-disk layout of .blog files. The engine writes each format string once
+	(as a Format record) and from then on only its id and the raw argument bytes
+	(as Entry records). Formatting is deferred to the blog-decode tool.
+
+	All integers are little-endian and records are byte-packed. Strings are
+	stored as a uint16_t code-unit count followed by UTF-16 code units; narrow
+	string arguments use the same count followed by raw bytes.
+
+		File	: Magic, Version, Record...
+		Format	: RecordType::Format, uint32_t id, string level, string format
+		Entry	: RecordType::Entry, uint32_t id, int64_t time (us since epoch), uint16_t size, bytes[size]
+		Raw		: RecordType::Raw, string text
+
+	This header is shared with the decoder and must stay free of engine includes.
+*/
+namespace blog {
+
+	static const uint32_t Magic = 0x474F4C42; // "BLOG"
+	static const uint32_t Version = 1;
+
+	enum class RecordType : uint8_t {
+		Format = 1,
+		Entry = 2,
+		Raw = 3
+	};
+
+	/*
+		How a single printf conversion is stored in an Entry. Integers are
+		widened to their va_arg promotion; strings are copied inline.
+	*/
+	enum class ArgType : uint8_t {
+		Int32,
+		Int64,
+		Double,
+		Pointer,
+		WideString,
+		NarrowString
+	};
+
+	/*
+		Walks a wide printf format string (MSVC semantics: %s is a wide string,
+		%S and %hs are narrow) and appends the storage type of each argument it
+		consumes, including '*' widths and precisions.
+	*/
+	inline void ParseFormat(const wchar_t* fmt, std::vector<ArgType>& args) {
+		for (const wchar_t* c = fmt; *c; c++) {
+			if (*c != L'%') {
+				continue;
+			}
+			c++;
+			if (*c == L'%') {
+				continue;
+			}
+
+			while (*c && wcschr(L"-+ #0", *c)) {
+				c++;
+			}
+			if (*c == L'*') {
+				args.push_back(ArgType::Int32);
+				c++;
+			}
+			while (*c >= L'0' && *c <= L'9') {
+				c++;
+			}
+			if (*c == L'.') {
+				c++;
+				if (*c == L'*') {
+					args.push_back(ArgType::Int32);
+					c++;
+				}
+				while (*c >= L'0' && *c <= L'9') {
+					c++;
+				}
+			}
+
+			bool wide = false, narrow = false, longlong = false;
+			for (;; c++) {
+				if (*c == L'l') {
+					// A single 'l' is a long: 32 bits on Windows, 64 on LP64.
+					longlong = wide || sizeof(long) == 8;
+					wide = true;
+				} else if (*c == L'h') {
+					narrow = true;
+				} else if (*c == L'j' || *c == L'z' || *c == L't') {
+					longlong = sizeof(void*) == 8;
+				} else if (*c == L'I') {
+					if (c[1] == L'6' && c[2] == L'4') {
+						longlong = true;
+						c += 2;
+					} else if (c[1] == L'3' && c[2] == L'2') {
+						c += 2;
+					} else {
+						longlong = sizeof(void*) == 8;
+					}
+				} else if (*c != L'L') {
+					break;
+				}
+			}
+
+			switch (*c) {
+				case L'd': case L'i': case L'u': case L'o': case L'x': case L'X':
+					args.push_back(longlong ? ArgType::Int64 : ArgType::Int32);
+					break;
+				case L'c': case L'C':
+					args.push_back(ArgType::Int32);
+					break;
+				case L'f': case L'F': case L'e': case L'E': case L'g': case L'G': case L'a': case L'A':
+					args.push_back(ArgType::Double);
+					break;
+				case L'p':
+					args.push_back(ArgType::Pointer);
+					break;
+				case L's':
+					args.push_back(narrow ? ArgType::NarrowString : ArgType::WideString);
+					break;
+				case L'S':
+					args.push_back(wide ? ArgType::WideString : ArgType::NarrowString);
+					break;
+				case L'\0':
+					return;
+				default:
+					break;
+			}
+		}
+	}
+
+	/*
+		Decoding side, shared by blog-decode and the tests.
+	*/
+
+	struct Format {
+		std::wstring			Level;
+		std::wstring			Text;
+		std::vector<ArgType>	Args;
+	};
+
+	struct Reader {
+		const uint8_t*	Cursor;
+		const uint8_t*	End;
+
+		template<typename T>
+		bool Read(T& value) {
+			if (Cursor + sizeof(T) > End) {
+				Cursor = End;
+				return false;
+			}
+			memcpy(&value, Cursor, sizeof(T));
+			Cursor += sizeof(T);
+			return true;
+		}
+
+		bool ReadString(std::wstring& text) {
+			uint16_t length = 0;
+			if (!Read(length) || Cursor + length * sizeof(uint16_t) > End) {
+				return false;
+			}
+			text.resize(length);
+			for (uint16_t i = 0; i < length; i++) {
+				uint16_t unit = 0;
+				Read(unit);
+				text[i] = static_cast<wchar_t>(unit);
+			}
+			return true;
+		}
+
+		bool ReadNarrowString(std::wstring& text) {
+			uint16_t length = 0;
+			if (!Read(length) || Cursor + length > End) {
+				return false;
+			}
+			text.assign(Cursor, Cursor + length);
+			Cursor += length;
+			return true;
+		}
+	};
+
+	/*
+		Re-runs the printf formatting the engine skipped. The argument types come
+		from the same ParseFormat pass the engine used to encode them; each
+		conversion is rebuilt with portable length modifiers and any '*' width or
+		precision resolved from the stored arguments.
+	*/
+	inline std::wstring FormatEntry(const Format& format, Reader args) {
+		std::wstring out;
+		wchar_t buffer[1024];
+		size_t next = 0;
+
+		const wchar_t* c = format.Text.c_str();
+		while (*c) {
+			if (*c != L'%') {
+				out += *c++;
+				continue;
+			}
+			if (c[1] == L'%') {
+				out += L'%';
+				c += 2;
+				continue;
+			}
+
+			std::wstring spec = L"%";
+			c++;
+			while (*c && wcschr(L"-+ #0", *c)) {
+				spec += *c++;
+			}
+
+			int32_t star = 0;
+			if (*c == L'*') {
+				args.Read(star);
+				next++;
+				spec += std::to_wstring(star);
+				c++;
+			}
+			while (*c >= L'0' && *c <= L'9') {
+				spec += *c++;
+			}
+			if (*c == L'.') {
+				spec += *c++;
+				if (*c == L'*') {
+					args.Read(star);
+					next++;
+					spec += std::to_wstring(star);
+					c++;
+				}
+				while (*c >= L'0' && *c <= L'9') {
+					spec += *c++;
+				}
+			}
+
+			while (*c && wcschr(L"lhjztLI36", *c)) {
+				c++;
+			}
+			wchar_t conversion = *c;
+			if (!conversion) {
+				break;
+			}
+			c++;
+
+			if (!wcschr(L"diuoxXcCfFeEgGaApsS", conversion) || next >= format.Args.size()) {
+				continue;
+			}
+
+			buffer[0] = 0;
+			switch (format.Args[next++]) {
+				case ArgType::Int32: {
+					int32_t value = 0;
+					args.Read(value);
+					if (conversion == L'c' || conversion == L'C') {
+						swprintf(buffer, 1024, (spec + L"lc").c_str(), static_cast<wchar_t>(value));
+					} else {
+						swprintf(buffer, 1024, (spec + conversion).c_str(), value);
+					}
+					break;
+				}
+				case ArgType::Int64: {
+					int64_t value = 0;
+					args.Read(value);
+					swprintf(buffer, 1024, (spec + L"ll" + conversion).c_str(), static_cast<long long>(value));
+					break;
+				}
+				case ArgType::Double: {
+					double value = 0;
+					args.Read(value);
+					swprintf(buffer, 1024, (spec + conversion).c_str(), value);
+					break;
+				}
+				case ArgType::Pointer: {
+					// Laid out the way MSVC prints %p, then padded by the spec's
+					// flags and width.
+					uint64_t value = 0;
+					args.Read(value);
+					wchar_t digits[17];
+					swprintf(digits, 17, L"%016llX", static_cast<unsigned long long>(value));
+					swprintf(buffer, 1024, (spec + L"ls").c_str(), digits);
+					break;
+				}
+				case ArgType::WideString:
+				case ArgType::NarrowString: {
+					std::wstring text;
+					bool read = format.Args[next - 1] == ArgType::WideString ? args.ReadString(text) : args.ReadNarrowString(text);
+					if (read) {
+						swprintf(buffer, 1024, (spec + L"ls").c_str(), text.c_str());
+					}
+					break;
+				}
+			}
+			out += buffer;
+		}
+		return out;
+	}
+}
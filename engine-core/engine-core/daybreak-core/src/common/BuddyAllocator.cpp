@@ -0,0 +1,124 @@
+#include "daybreak.h"
+#include "BuddyAllocator.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+namespace memory {
+
+	BuddyAllocator::BuddyAllocator(uint64_t size, uint64_t minBlockSize) :
+		m_size(size),
+		m_minBlockSize(minBlockSize),
+		m_freeSize(0),
+		m_freeOrders(0) {
+
+		assert(std::has_single_bit(size) && std::has_single_bit(minBlockSize) && size >= minBlockSize);
+
+		uint64_t blocks = size / minBlockSize;
+		m_maxOrder = static_cast<uint32_t>(std::countr_zero(blocks));
+		assert(m_maxOrder < 32 && "Too many orders.");
+
+		m_freeHeads.assign(m_maxOrder + 1, Unused);
+		m_next.assign(static_cast<size_t>(blocks), Unused);
+		m_prev.assign(static_cast<size_t>(blocks), Unused);
+		m_order.assign(static_cast<size_t>(blocks), 0);
+		m_isFree.assign(static_cast<size_t>(blocks), 0);
+
+		PushFree(0, m_maxOrder);
+		m_freeSize = m_size;
+	}
+
+	uint64_t BuddyAllocator::Allocate(uint64_t size) {
+		uint32_t order = OrderFor(size);
+		if (order > m_maxOrder) {
+			return NoSpace;
+		}
+
+		uint32_t candidates = m_freeOrders & ~((1u << order) - 1);
+		if (candidates == 0) {
+			return NoSpace;
+		}
+
+		uint32_t blockOrder = std::countr_zero(candidates);
+		uint32_t block = m_freeHeads[blockOrder];
+		RemoveFree(block, blockOrder);
+
+		// Split down to the requested order, freeing the upper halves.
+		while (blockOrder > order) {
+			blockOrder--;
+			PushFree(block + (1u << blockOrder), blockOrder);
+		}
+
+		m_order[block] = static_cast<uint8_t>(order);
+		m_freeSize -= m_minBlockSize << order;
+		return static_cast<uint64_t>(block) * m_minBlockSize;
+	}
+
+	void BuddyAllocator::Free(uint64_t offset) {
+		assert(offset % m_minBlockSize == 0 && offset < m_size && "Invalid buddy offset.");
+
+		uint32_t block = static_cast<uint32_t>(offset / m_minBlockSize);
+		uint32_t order = m_order[block];
+		assert(!m_isFree[block] && "Double free.");
+		m_freeSize += m_minBlockSize << order;
+
+		// Merge with the buddy for as long as it is a whole free block.
+		while (order < m_maxOrder) {
+			uint32_t buddy = block ^ (1u << order);
+			if (!m_isFree[buddy] || m_order[buddy] != order) {
+				break;
+			}
+			RemoveFree(buddy, order);
+			block = std::min(block, buddy);
+			order++;
+		}
+		PushFree(block, order);
+	}
+
+	uint64_t BuddyAllocator::BlockSize(uint64_t size) const {
+		return m_minBlockSize << OrderFor(size);
+	}
+
+	uint64_t BuddyAllocator::LargestFreeBlock() const {
+		if (m_freeOrders == 0) {
+			return 0;
+		}
+		return m_minBlockSize << (31 - std::countl_zero(m_freeOrders));
+	}
+
+	uint32_t BuddyAllocator::OrderFor(uint64_t size) const {
+		uint64_t blocks = std::max<uint64_t>((size + m_minBlockSize - 1) / m_minBlockSize, 1);
+		return static_cast<uint32_t>(std::countr_zero(std::bit_ceil(blocks)));
+	}
+
+	void BuddyAllocator::PushFree(uint32_t block, uint32_t order) {
+		uint32_t head = m_freeHeads[order];
+		m_next[block] = head;
+		m_prev[block] = Unused;
+		if (head != Unused) {
+			m_prev[head] = block;
+		}
+		m_freeHeads[order] = block;
+
+		m_order[block] = static_cast<uint8_t>(order);
+		m_isFree[block] = 1;
+		m_freeOrders |= 1u << order;
+	}
+
+	void BuddyAllocator::RemoveFree(uint32_t block, uint32_t order) {
+		if (m_prev[block] != Unused) {
+			m_next[m_prev[block]] = m_next[block];
+		} else {
+			m_freeHeads[order] = m_next[block];
+		}
+		if (m_next[block] != Unused) {
+			m_prev[m_next[block]] = m_prev[block];
+		}
+
+		m_isFree[block] = 0;
+		if (m_freeHeads[order] == Unused) {
+			m_freeOrders &= ~(1u << order);
+		}
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace memory {
+
+	/*
+		Binary buddy allocator over a power-of-two range of offsets. Requests are
+		rounded up to a power-of-two multiple of the minimum block size, and every
+		block starts at a multiple of its own size, which is what makes it suitable
+		for placements with large alignment requirements. Free blocks of each order
+		sit in intrusive lists indexed by block, so Allocate and Free only walk the
+		orders, never the blocks.
+
+		Only offsets are managed. Not thread-safe.
+	*/
+	class DAYBREAK_API BuddyAllocator {
+		public:
+			static constexpr uint64_t NoSpace = UINT64_MAX;
+
+			// size and minBlockSize must be powers of two.
+			BuddyAllocator(uint64_t size, uint64_t minBlockSize);
+
+			/*
+				Returns an offset aligned to the rounded block size, or NoSpace.
+				Pass max(size, alignment) to get a stricter alignment.
+			*/
+			uint64_t Allocate(uint64_t size);
+			void Free(uint64_t offset);
+
+			// Size of the block a request of size bytes would occupy.
+			uint64_t BlockSize(uint64_t size) const;
+
+			uint64_t Size() const { return m_size; }
+			uint64_t FreeSize() const { return m_freeSize; }
+			uint64_t LargestFreeBlock() const;
+			bool IsEmpty() const { return m_freeSize == m_size; }
+
+		private:
+			static constexpr uint32_t Unused = UINT32_MAX;
+
+			uint32_t OrderFor(uint64_t size) const;
+			void PushFree(uint32_t block, uint32_t order);
+			void RemoveFree(uint32_t block, uint32_t order);
+
+			uint64_t				m_size;
+			uint64_t				m_minBlockSize;
+			uint32_t				m_maxOrder;
+			uint64_t				m_freeSize;
+			uint32_t				m_freeOrders;	// Bit n set if order n has a free block.
+
+			std::vector<uint32_t>	m_freeHeads;
+			std::vector<uint32_t>	m_next;
+			std::vector<uint32_t>	m_prev;
+			std::vector<uint8_t>	m_order;		// Valid at the first block of every allocated or free block.
+			std::vector<uint8_t>	m_isFree;
+	};
+}
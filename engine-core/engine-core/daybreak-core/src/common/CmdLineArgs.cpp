@@ -3,24 +3,83 @@
 
 #include <algorithm>
 
+static uint32_t g_workerCount = 0;
+static uint32_t g_tickRate = 0;
+static uint32_t g_profileFrames = 0;
+static bool g_exportFrameStats = false;
+
+static void ReadKey(std::wstring key) {
+	if (key[0] == '-') {
+		key.erase(0, 1);
+		std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+		CmdLine::ReadArgument(key.c_str());
+	}
+}
+
+/*
+	Parses "name=N" into value; false if argument is a different option.
+*/
+static bool ReadValue(const wchar_t* argument, const wchar_t* name, uint32_t& value) {
+	size_t length = wcslen(name);
+	if (wcsncmp(argument, name, length) != 0 || argument[length] != L'=') {
+		return false;
+	}
+	value = static_cast<uint32_t>(wcstoul(argument + length + 1, nullptr, 10));
+	return true;
+}
+
+#ifdef WIN32
+
 void CmdLine::ReadArguments() {
 	int argc = 0;
 	wchar_t** argv = CommandLineToArgvW(GetCommandLineW(), &argc);
 
 	for (int i = 1; i < argc; i++) {
-		std::wstring key = argv[i];
-		if (key[0] == '-') {
-			key.erase(0, 1);
-			std::transform(key.begin(), key.end(), key.begin(), ::tolower);
-			ReadArgument(key.c_str());
-		}
+		ReadKey(argv[i]);
+	}
+}
+
+#endif
+
+void CmdLine::ReadArguments(int argc, char** argv) {
+	for (int i = 1; i < argc; i++) {
+		std::string argument = argv[i];
+		ReadKey(std::wstring(argument.begin(), argument.end()));
 	}
 }
 
+uint32_t CmdLine::WorkerCount() {
+	return g_workerCount;
+}
+
+bool CmdLine::ExportFrameStats() {
+	return g_exportFrameStats;
+}
+
+uint32_t CmdLine::TickRate() {
+	return g_tickRate;
+}
+
+uint32_t CmdLine::ProfileFrames() {
+	return g_profileFrames;
+}
+
 void CmdLine::ReadArgument(const wchar_t* argument) {
 	if (wcscmp(argument, L"mtail") == 0) {
 		Logger::StartMTail();
 	}
+	if (wcscmp(argument, L"asynclog") == 0) {
+		Logger::EnableAsync();
+	}
+	if (wcscmp(argument, L"binarylog") == 0) {
+		Logger::EnableBinary();
+	}
+	if (wcscmp(argument, L"framestats") == 0) {
+		g_exportFrameStats = true;
+	}
+	if (wcscmp(argument, L"verbose") == 0) {
+		Logger::SetLevel(LogLevel::Trace);
+	}
 	if (wcscmp(argument, L"debug") == 0) {
 		Engine::SetMode(Engine::EngineMode::DEBUG);
 	}
@@ -29,5 +88,8 @@ void CmdLine::ReadArgument(const wchar_t* argument) {
 	}
 	if (wcscmp(argument, L"server") == 0) {
 		Engine::SetMode(Engine::EngineMode::SERVER);
-	}	
+	}
+	ReadValue(argument, L"workers", g_workerCount);
+	ReadValue(argument, L"tickrate", g_tickRate);
+	ReadValue(argument, L"profile", g_profileFrames);
 }
@@ -1,7 +1,24 @@
 #pragma once
 
+#include <cstdint>
+
 namespace CmdLine {
 
+#ifdef WIN32
 	void DAYBREAK_API ReadArguments();
+#endif
+	void DAYBREAK_API ReadArguments(int argc, char** argv);
 	void DAYBREAK_API ReadArgument(const wchar_t* argument);
-}
\ No newline at end of file
+
+	/* -workers=N: job system worker threads, 0 (default) sizes to the machine */
+	uint32_t DAYBREAK_API WorkerCount();
+
+	/* -framestats: write the frame-time ring to framestats.csv on shutdown */
+	bool DAYBREAK_API ExportFrameStats();
+
+	/* -tickrate=N: server ticks per second, 0 (default) keeps the game's rate */
+	uint32_t DAYBREAK_API TickRate();
+
+	/* -profile=N: capture the first N frames to profile.json and profile.prof */
+	uint32_t DAYBREAK_API ProfileFrames();
+}
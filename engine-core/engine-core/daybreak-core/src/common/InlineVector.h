@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace collection {
+
+	/*
+		Vector with a fixed capacity stored inline, so it never touches the heap.
+		Meant for short-lived scratch arrays on hot paths where the upper bound is
+		known; pushing past Capacity is a programming error.
+	*/
+	template<typename T, size_t Capacity>
+	class InlineVector {
+		public:
+			InlineVector();
+			~InlineVector();
+
+			InlineVector(const InlineVector& copy) = delete;
+			InlineVector& operator=(const InlineVector& other) = delete;
+
+			void PushBack(const T& value);
+			void PushBack(T&& value);
+			void Clear();
+
+			T* Data() { return reinterpret_cast<T*>(m_storage); }
+			const T* Data() const { return reinterpret_cast<const T*>(m_storage); }
+
+			T& operator[](size_t index) { return Data()[index]; }
+			const T& operator[](size_t index) const { return Data()[index]; }
+
+			T* begin() { return Data(); }
+			T* end() { return Data() + m_size; }
+			const T* begin() const { return Data(); }
+			const T* end() const { return Data() + m_size; }
+
+			size_t Size() const { return m_size; }
+			bool IsEmpty() const { return m_size == 0; }
+			bool IsFull() const { return m_size == Capacity; }
+
+		private:
+			alignas(T) unsigned char	m_storage[sizeof(T) * Capacity];
+			size_t						m_size;
+	};
+}
+
+template<typename T, size_t Capacity>
+collection::InlineVector<T, Capacity>::InlineVector() :
+	m_size(0) {
+}
+
+template<typename T, size_t Capacity>
+collection::InlineVector<T, Capacity>::~InlineVector() {
+	Clear();
+}
+
+template<typename T, size_t Capacity>
+void collection::InlineVector<T, Capacity>::PushBack(const T& value) {
+	assert(m_size < Capacity && "InlineVector capacity exceeded.");
+	new (Data() + m_size) T(value);
+	m_size++;
+}
+
+template<typename T, size_t Capacity>
+void collection::InlineVector<T, Capacity>::PushBack(T&& value) {
+	assert(m_size < Capacity && "InlineVector capacity exceeded.");
+	new (Data() + m_size) T(std::move(value));
+	m_size++;
+}
+
+template<typename T, size_t Capacity>
+void collection::InlineVector<T, Capacity>::Clear() {
+	for (size_t i = 0; i < m_size; i++) {
+		Data()[i].~T();
+	}
+	m_size = 0;
+}
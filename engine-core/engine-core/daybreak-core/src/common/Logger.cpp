@@ -1,25 +1,125 @@
 #include "daybreak.h"
+#include "AsyncLogWriter.h"
 
 #include <fstream>
-#include <Shlobj.h>
+#include <mutex>
 #include <cstdio>
-#include <tlhelp32.h>
+
+#ifdef WIN32
+	#include <Shlobj.h>
+	#include <tlhelp32.h>
+#endif
 
 Logger* Logger::inst;
+std::wstring Logger::g_logPath;
+AsyncLogWriter* Logger::g_asyncWriter = nullptr;
+
+static LogLevel g_minimumLevel = LogLevel::Debug;
+static uint32_t g_categoryMask = 0xFF;
+static std::mutex g_filterMutex;
+
+static uint64_t BuildFilter(LogLevel minimumLevel, uint32_t categoryMask) {
+	uint64_t filter = 0;
+	for (uint32_t level = static_cast<uint32_t>(minimumLevel); level <= static_cast<uint32_t>(LogLevel::Error); level++) {
+		filter |= static_cast<uint64_t>(categoryMask & 0xFF) << (level * 8);
+	}
+	return filter;
+}
+
+std::atomic<uint64_t> Logger::g_filter(BuildFilter(g_minimumLevel, g_categoryMask));
+
+#ifdef WIN32
+
+static LPTOP_LEVEL_EXCEPTION_FILTER g_previousExceptionFilter = nullptr;
+
+static LONG WINAPI FlushOnCrash(EXCEPTION_POINTERS* exception) {
+	Logger::FlushOnCrash();
+	return g_previousExceptionFilter ? g_previousExceptionFilter(exception) : EXCEPTION_CONTINUE_SEARCH;
+}
+
+static void ReportLogError() {
+	MessageBox(NULL, L"Unable to open log file...", L"Log Error", MB_OK);
+}
+
+#else
+
+static void ReportLogError() {
+	fputws(L"Unable to open log file...\n", stderr);
+}
+
+#endif
 
 Logger::Logger() {
 	inst = this;
+	g_logPath = log_dir() + L"/" + log_file();
 }
 
-Logger::~Logger() {}
+Logger::~Logger() {
+	if (g_asyncWriter) {
+#ifdef WIN32
+		SetUnhandledExceptionFilter(g_previousExceptionFilter);
+#endif
+
+		AsyncLogWriter* writer = g_asyncWriter;
+		g_asyncWriter = nullptr;
+		delete writer;
+	}
+}
+
+void Logger::EnableAsync() {
+	OpenAsyncWriter(false);
+}
+
+void Logger::EnableBinary() {
+	OpenAsyncWriter(true);
+}
+
+void Logger::OpenAsyncWriter(bool binary) {
+	if (g_asyncWriter) {
+		return;
+	}
+
+	std::wstring path = log_path();
+	if (binary) {
+		path = std::filesystem::path(path).replace_extension(L".blog").wstring();
+	}
+
+	g_asyncWriter = new AsyncLogWriter(path, binary);
+	if (!g_asyncWriter->IsOpen()) {
+		delete g_asyncWriter;
+		g_asyncWriter = nullptr;
+		ReportLogError();
+		return;
+	}
+#ifdef WIN32
+	g_previousExceptionFilter = SetUnhandledExceptionFilter(FlushOnCrash);
+#endif
+}
+
+void Logger::Flush() {
+	if (g_asyncWriter) {
+		g_asyncWriter->Flush();
+	}
+}
+
+void Logger::FlushOnCrash() {
+	if (g_asyncWriter) {
+		g_asyncWriter->FlushOnCrash();
+	}
+}
 
 void Logger::log(const wchar_t* level, const wchar_t* fmt, va_list args) {
+	if (g_asyncWriter) {
+		g_asyncWriter->Push(level, fmt, args);
+		return;
+	}
+
 	wchar_t buffer[4096];
 	vswprintf_s(buffer, fmt, args);
 	OutputDebugString(buffer);
 
 	std::wfstream outfile;
-	outfile.open(std::wstring(log_dir() + L"/" + log_file()), std::ios_base::app);
+	outfile.open(std::filesystem::path(log_path()), std::ios_base::app);
 
 	if (outfile.is_open()) {
 		std::wstring s = buffer;
@@ -27,7 +127,7 @@ void Logger::log(const wchar_t* level, const wchar_t* fmt, va_list args) {
 		outfile.close();
 		OutputDebugString(s.c_str());
 	} else {
-		MessageBox(NULL, L"Unable to open log file...", L"Log Error", MB_OK);
+		ReportLogError();
 	}
 }
 
@@ -57,6 +157,33 @@ void Logger::error(const wchar_t* fmt, ...) {
 	va_end(args);
 }
 
+void Logger::write(LogLevel level, const wchar_t* fmt, ...) {
+	static const wchar_t* levels[] = { L"TRCE", L"DEBG", L"INFO", L"ERROR" };
+	va_list args;
+
+	va_start(args, fmt);
+	log(levels[static_cast<uint32_t>(level)], fmt, args);
+	va_end(args);
+}
+
+void Logger::SetLevel(LogLevel level) {
+	std::lock_guard<std::mutex> lock(g_filterMutex);
+	g_minimumLevel = level;
+	g_filter.store(BuildFilter(g_minimumLevel, g_categoryMask), std::memory_order_relaxed);
+}
+
+void Logger::SetCategoryEnabled(LogCategory category, bool enabled) {
+	std::lock_guard<std::mutex> lock(g_filterMutex);
+	if (enabled) {
+		g_categoryMask |= 1u << static_cast<uint32_t>(category);
+	} else {
+		g_categoryMask &= ~(1u << static_cast<uint32_t>(category));
+	}
+	g_filter.store(BuildFilter(g_minimumLevel, g_categoryMask), std::memory_order_relaxed);
+}
+
+#ifdef WIN32
+
 std::wstring Logger::log_dir() {
 	wchar_t path[1024];
 	wchar_t* app_data_local;
@@ -72,6 +199,35 @@ std::wstring Logger::log_dir() {
 	return path;
 }
 
+#else
+
+std::wstring Logger::log_dir() {
+	// $XDG_DATA_HOME/<game>/Log, falling back to ~/.local/share.
+	std::filesystem::path path;
+	if (const char* dataHome = getenv("XDG_DATA_HOME")) {
+		path = dataHome;
+	} else if (const char* home = getenv("HOME")) {
+		path = std::filesystem::path(home) / ".local" / "share";
+	} else {
+		path = std::filesystem::temp_directory_path();
+	}
+	path /= GameSettings::game_name();
+	path /= "Log";
+
+	std::error_code error;
+	std::filesystem::create_directories(path, error);
+	return path.wstring();
+}
+
+#endif
+
+const std::wstring& Logger::log_path() {
+	if (g_logPath.empty()) {
+		g_logPath = log_dir() + L"/" + log_file();
+	}
+	return g_logPath;
+}
+
 std::wstring Logger::log_file() {
 	wchar_t file[1024];
 	wcscpy_s(file, GameSettings::game_name());
@@ -83,18 +239,24 @@ std::wstring Logger::log_file() {
 void Logger::log_debug_seperator()
 {
 	std::wstring s = L"\n------------------------------------------------------------------------------------\n\n";
+	if (g_asyncWriter) {
+		g_asyncWriter->PushRaw(s.c_str());
+		return;
+	}
 
 	std::wfstream outfile;
-	outfile.open(std::wstring(log_dir() + L"/" + log_file()), std::ios_base::app);
+	outfile.open(std::filesystem::path(log_path()), std::ios_base::app);
 
 	if (outfile.is_open()) {
 		outfile << s;
 		outfile.close();
 	} else {
-		MessageBox(NULL, L"Unable to open log file...", L"Log Error", MB_OK);
+		ReportLogError();
 	}
 }
 
+#ifdef WIN32
+
 bool Logger::is_mtail_running() {
 	bool exists = false;
 	PROCESSENTRY32 entry;
@@ -121,6 +283,18 @@ void Logger::StartMTail() {
 	WCHAR path[MAX_PATH] = { 0 };
 	GetCurrentDirectoryW(MAX_PATH, path);
 	std::wstring url = path + std::wstring(L"/mTAIL.exe");
-	std::wstring params = L" \"" + log_dir() + L"/" + log_file() + L"\" /start";
+	std::wstring params = L" \"" + log_path() + L"\" /start";
 	ShellExecute(0, NULL, url.c_str(), params.c_str(), NULL, SW_SHOWDEFAULT);
-}
\ No newline at end of file
+}
+
+#else
+
+bool Logger::is_mtail_running() {
+	return false;
+}
+
+void Logger::StartMTail() {
+	Logger::error(L"--MTail failed to start - Not supported on this platform\n");
+}
+
+#endif
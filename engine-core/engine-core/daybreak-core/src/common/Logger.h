@@ -1,16 +1,77 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <string>
 
+class AsyncLogWriter;
+
+enum class LogLevel : uint32_t {
+	Trace = 0,
+	Debug = 1,
+	Info = 2,
+	Error = 3
+};
+
+enum class LogCategory : uint32_t {
+	General = 0,
+	Render = 1,
+	Asset = 2,
+	DX12 = 3,
+	Input = 4
+};
+
+/*
+	Compile-time log filter. Statements below DAYBREAK_LOG_LEVEL, or whose category
+	bit is clear in DAYBREAK_LOG_CATEGORIES, are discarded along with their argument
+	expressions. Both can be overridden from the project's preprocessor definitions.
+*/
+#ifndef DAYBREAK_LOG_LEVEL
+	#ifdef _DEBUG
+		#define DAYBREAK_LOG_LEVEL 0
+	#else
+		#define DAYBREAK_LOG_LEVEL 2
+	#endif
+#endif
+
+#ifndef DAYBREAK_LOG_CATEGORIES
+	#define DAYBREAK_LOG_CATEGORIES 0xFFFFFFFF
+#endif
+
+#define DAYBREAK_LOG_COMPILED(level, category) \
+	(static_cast<uint32_t>(level) >= DAYBREAK_LOG_LEVEL && ((DAYBREAK_LOG_CATEGORIES >> static_cast<uint32_t>(category)) & 1))
+
+#define DAYBREAK_LOG(level, category, ...) \
+	do { \
+		if constexpr (DAYBREAK_LOG_COMPILED(LogLevel::level, LogCategory::category)) { \
+			if (Logger::IsEnabled(LogLevel::level, LogCategory::category)) { \
+				Logger::write(LogLevel::level, __VA_ARGS__); \
+			} \
+		} \
+	} while (0)
+
+#define LOG_TRACE(category, ...) DAYBREAK_LOG(Trace, category, __VA_ARGS__)
+#define LOG_DEBUG(category, ...) DAYBREAK_LOG(Debug, category, __VA_ARGS__)
+#define LOG_INFO(category, ...) DAYBREAK_LOG(Info, category, __VA_ARGS__)
+#define LOG_ERROR(category, ...) DAYBREAK_LOG(Error, category, __VA_ARGS__)
+
 class DAYBREAK_API Logger {
 	private:
 		static Logger* inst;
 		static Logger* instance() { return inst; }
 
+		static std::wstring g_logPath;
+		static AsyncLogWriter* g_asyncWriter;
+
+		// One bit per (level, category): bit = level * 8 + category.
+		static std::atomic<uint64_t> g_filter;
+
 		static std::wstring log_dir();
 		static std::wstring log_file();
+		static const std::wstring& log_path();
 
 		static void log(const wchar_t* level, const wchar_t* fmt, va_list args);
+		static void OpenAsyncWriter(bool binary);
 	
 	public:
 		Logger();
@@ -20,6 +81,40 @@ class DAYBREAK_API Logger {
 		static void debug(const wchar_t* fmt, ...);
 		static void error(const wchar_t* fmt, ...);
 
+		/*
+			Entry point for the LOG_* macros. Prefer the macros so that filtered
+			statements cost nothing.
+		*/
+		static void write(LogLevel level, const wchar_t* fmt, ...);
+
+		static bool IsEnabled(LogLevel level, LogCategory category) {
+			return (g_filter.load(std::memory_order_relaxed) >> (static_cast<uint32_t>(level) * 8 + static_cast<uint32_t>(category))) & 1;
+		}
+
+		/*
+			Runtime filter for the LOG_* macros. Only narrows what was compiled in.
+		*/
+		static void SetLevel(LogLevel level);
+		static void SetCategoryEnabled(LogCategory category, bool enabled);
+
+		/*
+			Switches info/debug/error to the asynchronous ring-buffer writer. The
+			log file is held open until the Logger is destroyed, and queued records
+			are flushed on shutdown or when the process crashes.
+		*/
+		static void EnableAsync();
+
+		/*
+			Like EnableAsync, but records only the format-string id and raw argument
+			bytes to a .blog file next to the text log. Use blog-decode to read it.
+		*/
+		static void EnableBinary();
+
+		static void Flush();
+
+		// Flush that never blocks indefinitely, for the unhandled exception filter.
+		static void FlushOnCrash();
+
 		static void log_debug_seperator();
 		static bool is_mtail_running();
 		static void StartMTail();
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <new>
+#include <thread>
+#include <utility>
+
+namespace collection {
+
+	/*
+		Bounded lock-free multi-producer/multi-consumer queue. Each cell carries a
+		sequence number that tells producers and consumers whether it is free for
+		the current lap of the ring, so Push and Pop never take a lock. Capacity is
+		rounded up to a power of two; the enqueue and dequeue cursors sit on their
+		own cache lines so producers and consumers do not false-share.
+
+		Push blocks (spinning, then yielding) while the queue is full and Pop never
+		blocks, matching the old mutex queue. TryPush and PopWait give the other
+		two combinations.
+	*/
+	template<typename T>
+	class MPMCQueue {
+		public:
+			static const size_t CacheLineSize = 64;
+
+			explicit MPMCQueue(size_t capacity = 1024);
+			~MPMCQueue();
+
+			MPMCQueue(const MPMCQueue& copy) = delete;
+			MPMCQueue& operator=(const MPMCQueue& other) = delete;
+
+			void Push(T value);
+
+			/*
+				Returns false if the queue is full, in which case value is left
+				untouched.
+			*/
+			bool TryPush(T&& value);
+
+			bool Pop(T& value);
+			void PopWait(T& value);
+
+			/*
+				Pops up to maxCount values into values[0..n) and returns n. Claims the
+				whole run of ready cells with a single CAS.
+			*/
+			size_t PopBatch(T* values, size_t maxCount);
+
+			bool IsEmpty() const;
+			size_t Size() const;
+			size_t Capacity() const { return m_mask + 1; }
+
+		private:
+			struct alignas(CacheLineSize) Cell {
+				std::atomic<size_t>	Sequence;
+				alignas(T) unsigned char	Storage[sizeof(T)];
+
+				T* Value() { return std::launder(reinterpret_cast<T*>(Storage)); }
+			};
+
+			static void Backoff(uint32_t& spins);
+
+			std::unique_ptr<Cell[]>	m_cells;
+			size_t					m_mask;
+
+			alignas(CacheLineSize) std::atomic<size_t>	m_enqueuePosition;
+			alignas(CacheLineSize) std::atomic<size_t>	m_dequeuePosition;
+	};
+}
+
+template<typename T>
+collection::MPMCQueue<T>::MPMCQueue(size_t capacity) :
+	m_enqueuePosition(0),
+	m_dequeuePosition(0) {
+
+	size_t slots = 2;
+	while (slots < capacity) {
+		slots <<= 1;
+	}
+
+	m_mask = slots - 1;
+	m_cells = std::make_unique<Cell[]>(slots);
+	for (size_t i = 0; i < slots; i++) {
+		m_cells[i].Sequence.store(i, std::memory_order_relaxed);
+	}
+}
+
+template<typename T>
+collection::MPMCQueue<T>::~MPMCQueue() {
+	size_t enqueue = m_enqueuePosition.load(std::memory_order_acquire);
+	for (size_t position = m_dequeuePosition.load(std::memory_order_acquire); position != enqueue; position++) {
+		m_cells[position & m_mask].Value()->~T();
+	}
+}
+
+template<typename T>
+void collection::MPMCQueue<T>::Push(T value) {
+	uint32_t spins = 0;
+	while (!TryPush(std::move(value))) {
+		Backoff(spins);
+	}
+}
+
+template<typename T>
+bool collection::MPMCQueue<T>::TryPush(T&& value) {
+	size_t position = m_enqueuePosition.load(std::memory_order_relaxed);
+
+	for (;;) {
+		Cell& cell = m_cells[position & m_mask];
+		size_t sequence = cell.Sequence.load(std::memory_order_acquire);
+		intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+		if (diff == 0) {
+			if (m_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+				new (cell.Storage) T(std::move(value));
+				cell.Sequence.store(position + 1, std::memory_order_release);
+				return true;
+			}
+		} else if (diff < 0) {
+			return false;
+		} else {
+			position = m_enqueuePosition.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+template<typename T>
+bool collection::MPMCQueue<T>::Pop(T& value) {
+	size_t position = m_dequeuePosition.load(std::memory_order_relaxed);
+
+	for (;;) {
+		Cell& cell = m_cells[position & m_mask];
+		size_t sequence = cell.Sequence.load(std::memory_order_acquire);
+		intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+
+		if (diff == 0) {
+			if (m_dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+				T* stored = cell.Value();
+				value = std::move(*stored);
+				stored->~T();
+				cell.Sequence.store(position + m_mask + 1, std::memory_order_release);
+				return true;
+			}
+		} else if (diff < 0) {
+			return false;
+		} else {
+			position = m_dequeuePosition.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+template<typename T>
+void collection::MPMCQueue<T>::PopWait(T& value) {
+	uint32_t spins = 0;
+	while (!Pop(value)) {
+		Backoff(spins);
+	}
+}
+
+template<typename T>
+size_t collection::MPMCQueue<T>::PopBatch(T* values, size_t maxCount) {
+	size_t position = m_dequeuePosition.load(std::memory_order_relaxed);
+	size_t count;
+
+	for (;;) {
+		// Count the run of cells that are ready for this lap.
+		count = 0;
+		while (count < maxCount) {
+			size_t ready = position + count;
+			if (m_cells[ready & m_mask].Sequence.load(std::memory_order_acquire) != ready + 1) {
+				break;
+			}
+			count++;
+		}
+
+		if (count == 0) {
+			return 0;
+		}
+		if (m_dequeuePosition.compare_exchange_weak(position, position + count, std::memory_order_relaxed)) {
+			break;
+		}
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		Cell& cell = m_cells[(position + i) & m_mask];
+		T* stored = cell.Value();
+		values[i] = std::move(*stored);
+		stored->~T();
+		cell.Sequence.store(position + i + m_mask + 1, std::memory_order_release);
+	}
+	return count;
+}
+
+template<typename T>
+bool collection::MPMCQueue<T>::IsEmpty() const {
+	return Size() == 0;
+}
+
+template<typename T>
+size_t collection::MPMCQueue<T>::Size() const {
+	size_t dequeue = m_dequeuePosition.load(std::memory_order_acquire);
+	size_t enqueue = m_enqueuePosition.load(std::memory_order_acquire);
+	return enqueue > dequeue ? enqueue - dequeue : 0;
+}
+
+template<typename T>
+void collection::MPMCQueue<T>::Backoff(uint32_t& spins) {
+	if (++spins < 64) {
+		return;
+	}
+	std::this_thread::yield();
+}
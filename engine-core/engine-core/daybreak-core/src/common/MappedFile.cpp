@@ -0,0 +1,111 @@
+#include "daybreak.h"
+#include "MappedFile.h"
+
+#ifndef WIN32
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+#ifdef WIN32
+
+MappedFile::MappedFile() :
+	m_file(INVALID_HANDLE_VALUE),
+	m_mapping(nullptr),
+	m_data(nullptr),
+	m_size(0) {}
+
+bool MappedFile::Open(const std::filesystem::path& path) {
+	Close();
+
+	m_file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (m_file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0) {
+		Close();
+		return false;
+	}
+
+	m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!m_mapping) {
+		Close();
+		return false;
+	}
+
+	m_data = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!m_data) {
+		Close();
+		return false;
+	}
+	m_size = static_cast<size_t>(size.QuadPart);
+	return true;
+}
+
+void MappedFile::Close() {
+	if (m_data) {
+		UnmapViewOfFile(m_data);
+	}
+	if (m_mapping) {
+		CloseHandle(m_mapping);
+	}
+	if (m_file != INVALID_HANDLE_VALUE) {
+		CloseHandle(m_file);
+	}
+
+	m_file = INVALID_HANDLE_VALUE;
+	m_mapping = nullptr;
+	m_data = nullptr;
+	m_size = 0;
+}
+
+#else
+
+MappedFile::MappedFile() :
+	m_data(nullptr),
+	m_size(0) {}
+
+bool MappedFile::Open(const std::filesystem::path& path) {
+	Close();
+
+	int file = open(path.c_str(), O_RDONLY);
+	if (file < 0) {
+		return false;
+	}
+
+	struct stat status;
+	if (fstat(file, &status) != 0 || status.st_size == 0) {
+		close(file);
+		return false;
+	}
+
+	// The mapping holds its own reference to the file.
+	void* data = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if (data == MAP_FAILED) {
+		return false;
+	}
+
+	madvise(data, static_cast<size_t>(status.st_size), MADV_WILLNEED);
+	m_data = data;
+	m_size = static_cast<size_t>(status.st_size);
+	return true;
+}
+
+void MappedFile::Close() {
+	if (m_data) {
+		munmap(const_cast<void*>(m_data), m_size);
+	}
+
+	m_data = nullptr;
+	m_size = 0;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+	Close();
+}
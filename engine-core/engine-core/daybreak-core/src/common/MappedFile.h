@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+/*
+	Read-only memory mapping of a whole file. Opening only sets up the mapping;
+	pages are read in by the OS the first time they are touched, so callers that
+	copy straight out of Data() never stage the file in a heap buffer.
+*/
+class DAYBREAK_API MappedFile {
+	public:
+		MappedFile();
+		~MappedFile();
+
+		MappedFile(const MappedFile& copy) = delete;
+		MappedFile& operator=(const MappedFile& other) = delete;
+
+		bool Open(const std::filesystem::path& path);
+		void Close();
+
+		bool IsOpen() const { return m_data != nullptr; }
+		const void* Data() const { return m_data; }
+		size_t Size() const { return m_size; }
+
+	private:
+#ifdef WIN32
+		HANDLE		m_file;
+		HANDLE		m_mapping;
+#endif
+		const void*	m_data;
+		size_t		m_size;
+};
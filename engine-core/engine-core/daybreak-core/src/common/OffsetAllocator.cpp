@@ -0,0 +1,324 @@
+/*
+	Based on OffsetAllocator by Sebastian Aaltonen
+	(https://github.com/sebbbi/OffsetAllocator), MIT License,
+	Copyright (c) 2023 Sebastian Aaltonen. See THIRD_PARTY_LICENSES.md.
+*/
+#include "daybreak.h"
+#include "OffsetAllocator.h"
+
+#include <bit>
+#include <cassert>
+
+namespace memory {
+
+	namespace {
+		const uint32_t MantissaBits = 3;
+		const uint32_t MantissaValue = 1 << MantissaBits;
+		const uint32_t MantissaMask = MantissaValue - 1;
+
+		/*
+			Bin index of a size: exponent in the high bits, 3-bit mantissa in the
+			low bits. Sizes below 8 are stored exactly. Rounding up guarantees every
+			block in the bin is at least size; rounding down is where a block of
+			that size is filed.
+		*/
+		uint32_t SizeToBinRoundUp(uint32_t size) {
+			uint32_t exponent = 0;
+			uint32_t mantissa = 0;
+
+			if (size < MantissaValue) {
+				mantissa = size;
+			} else {
+				uint32_t highestSetBit = 31 - std::countl_zero(size);
+				uint32_t mantissaStartBit = highestSetBit - MantissaBits;
+				exponent = mantissaStartBit + 1;
+				mantissa = (size >> mantissaStartBit) & MantissaMask;
+
+				uint32_t lowBitsMask = (1u << mantissaStartBit) - 1;
+				if ((size & lowBitsMask) != 0) {
+					// May carry into the exponent, which is still the right bin.
+					mantissa++;
+				}
+			}
+			return (exponent << MantissaBits) + mantissa;
+		}
+
+		uint32_t SizeToBinRoundDown(uint32_t size) {
+			uint32_t exponent = 0;
+			uint32_t mantissa = 0;
+
+			if (size < MantissaValue) {
+				mantissa = size;
+			} else {
+				uint32_t highestSetBit = 31 - std::countl_zero(size);
+				uint32_t mantissaStartBit = highestSetBit - MantissaBits;
+				exponent = mantissaStartBit + 1;
+				mantissa = (size >> mantissaStartBit) & MantissaMask;
+			}
+			return (exponent << MantissaBits) | mantissa;
+		}
+
+		uint32_t BinToSize(uint32_t bin) {
+			uint32_t exponent = bin >> MantissaBits;
+			uint32_t mantissa = bin & MantissaMask;
+			if (exponent == 0) {
+				return mantissa;
+			}
+			return (mantissa | MantissaValue) << (exponent - 1);
+		}
+
+		uint32_t FindLowestSetBitAfter(uint32_t bitMask, uint32_t startBitIndex) {
+			if (startBitIndex >= 32) {
+				return OffsetAllocator::NoSpace;
+			}
+			uint32_t bitsAfter = bitMask & ~((1u << startBitIndex) - 1);
+			if (bitsAfter == 0) {
+				return OffsetAllocator::NoSpace;
+			}
+			return std::countr_zero(bitsAfter);
+		}
+	}
+
+	OffsetAllocator::OffsetAllocator(uint32_t size, uint32_t maxAllocations) :
+		m_size(size),
+		m_maxAllocations(maxAllocations) {
+		Reset();
+	}
+
+	void OffsetAllocator::Reset() {
+		m_freeStorage = 0;
+		m_usedBinsTop = 0;
+		for (uint32_t i = 0; i < NumTopBins; i++) {
+			m_usedBins[i] = 0;
+		}
+		for (uint32_t i = 0; i < NumLeafBins; i++) {
+			m_binIndices[i] = Unused;
+		}
+
+		m_nodes.assign(m_maxAllocations, Node());
+		m_freeNodes.resize(m_maxAllocations);
+
+		// Pop order is 0, 1, 2... so the first nodes are handed out first.
+		for (uint32_t i = 0; i < m_maxAllocations; i++) {
+			m_freeNodes[i] = m_maxAllocations - i - 1;
+		}
+		m_freeNodeCount = m_maxAllocations;
+
+		if (m_size > 0) {
+			InsertNodeIntoBin(m_size, 0);
+		}
+	}
+
+	OffsetAllocator::Allocation OffsetAllocator::Allocate(uint32_t size) {
+		Allocation allocation;
+
+		// A split needs a node for the remainder.
+		if (size == 0 || m_freeNodeCount == 0) {
+			return allocation;
+		}
+
+		uint32_t nodeIndex = FindFreeNode(size);
+		if (nodeIndex == Unused) {
+			return allocation;
+		}
+
+		RemoveNodeFromBin(nodeIndex);
+
+		Node& node = m_nodes[nodeIndex];
+		uint32_t nodeTotalSize = node.Size;
+		node.Size = size;
+		node.Used = true;
+
+		uint32_t remainderSize = nodeTotalSize - size;
+		if (remainderSize > 0) {
+			uint32_t remainderIndex = InsertNodeIntoBin(remainderSize, node.Offset + size);
+
+			Node& remainder = m_nodes[remainderIndex];
+			if (node.NeighborNext != Unused) {
+				m_nodes[node.NeighborNext].NeighborPrev = remainderIndex;
+			}
+			remainder.NeighborPrev = nodeIndex;
+			remainder.NeighborNext = node.NeighborNext;
+			node.NeighborNext = remainderIndex;
+		}
+
+		allocation.Offset = node.Offset;
+		allocation.Metadata = nodeIndex;
+		return allocation;
+	}
+
+	void OffsetAllocator::Free(Allocation allocation) {
+		assert(allocation.Metadata < m_maxAllocations && "Invalid allocation.");
+
+		uint32_t nodeIndex = allocation.Metadata;
+		Node& node = m_nodes[nodeIndex];
+		assert(node.Used && "Double free.");
+
+		uint32_t offset = node.Offset;
+		uint32_t size = node.Size;
+
+		if (node.NeighborPrev != Unused && !m_nodes[node.NeighborPrev].Used) {
+			// The previous block is free: absorb it.
+			uint32_t prevIndex = node.NeighborPrev;
+			Node& prev = m_nodes[prevIndex];
+			offset = prev.Offset;
+			size += prev.Size;
+
+			RemoveNodeFromBin(prevIndex);
+			node.NeighborPrev = prev.NeighborPrev;
+			ReleaseNode(prevIndex);
+		}
+
+		if (node.NeighborNext != Unused && !m_nodes[node.NeighborNext].Used) {
+			// The next block is free: absorb it.
+			uint32_t nextIndex = node.NeighborNext;
+			Node& next = m_nodes[nextIndex];
+			size += next.Size;
+
+			RemoveNodeFromBin(nextIndex);
+			node.NeighborNext = next.NeighborNext;
+			ReleaseNode(nextIndex);
+		}
+
+		uint32_t neighborPrev = node.NeighborPrev;
+		uint32_t neighborNext = node.NeighborNext;
+		ReleaseNode(nodeIndex);
+
+		uint32_t combinedIndex = InsertNodeIntoBin(size, offset);
+		Node& combined = m_nodes[combinedIndex];
+		combined.NeighborPrev = neighborPrev;
+		combined.NeighborNext = neighborNext;
+		if (neighborPrev != Unused) {
+			m_nodes[neighborPrev].NeighborNext = combinedIndex;
+		}
+		if (neighborNext != Unused) {
+			m_nodes[neighborNext].NeighborPrev = combinedIndex;
+		}
+	}
+
+	bool OffsetAllocator::CanAllocate(uint32_t size) const {
+		return size > 0 && m_freeNodeCount > 0 && FindFreeNode(size) != Unused;
+	}
+
+	uint32_t OffsetAllocator::LargestFreeSize() const {
+		if (m_usedBinsTop == 0) {
+			return 0;
+		}
+		uint32_t topBinIndex = 31 - std::countl_zero(m_usedBinsTop);
+		uint32_t leafBinIndex = 31 - std::countl_zero(static_cast<uint32_t>(m_usedBins[topBinIndex]));
+		return BinToSize((topBinIndex << TopBinsIndexShift) | leafBinIndex);
+	}
+
+	uint32_t OffsetAllocator::FindFreeNode(uint32_t size) const {
+		uint32_t minBinIndex = SizeToBinRoundUp(size);
+		uint32_t minTopBinIndex = minBinIndex >> TopBinsIndexShift;
+		uint32_t minLeafBinIndex = minBinIndex & LeafBinsIndexMask;
+
+		// Smallest non-empty bin at or above the rounded-up size.
+		uint32_t topBinIndex = minTopBinIndex;
+		uint32_t leafBinIndex = NoSpace;
+		if (m_usedBinsTop & (1u << topBinIndex)) {
+			leafBinIndex = FindLowestSetBitAfter(m_usedBins[topBinIndex], minLeafBinIndex);
+		}
+		if (leafBinIndex == NoSpace) {
+			topBinIndex = FindLowestSetBitAfter(m_usedBinsTop, minTopBinIndex + 1);
+			if (topBinIndex != NoSpace) {
+				leafBinIndex = std::countr_zero(static_cast<uint32_t>(m_usedBins[topBinIndex]));
+			}
+		}
+		if (leafBinIndex != NoSpace) {
+			return m_binIndices[(topBinIndex << TopBinsIndexShift) | leafBinIndex];
+		}
+
+		// Every block in the bin the size itself files into is within one bin step
+		// of it, so one of them may still be big enough. Only the head is checked
+		// (InsertNodeIntoBin keeps the larger blocks there) so this stays O(1).
+		uint32_t binIndex = SizeToBinRoundDown(size);
+		if (binIndex != minBinIndex) {
+			uint32_t headIndex = m_binIndices[binIndex];
+			if (headIndex != Unused && m_nodes[headIndex].Size >= size) {
+				return headIndex;
+			}
+		}
+		return Unused;
+	}
+
+	uint32_t OffsetAllocator::InsertNodeIntoBin(uint32_t size, uint32_t offset) {
+		uint32_t binIndex = SizeToBinRoundDown(size);
+		uint32_t topBinIndex = binIndex >> TopBinsIndexShift;
+		uint32_t leafBinIndex = binIndex & LeafBinsIndexMask;
+
+		if (m_binIndices[binIndex] == Unused) {
+			m_usedBins[topBinIndex] |= 1 << leafBinIndex;
+			m_usedBinsTop |= 1u << topBinIndex;
+		}
+
+		assert(m_freeNodeCount > 0 && "Out of allocator nodes.");
+		uint32_t nodeIndex = m_freeNodes[--m_freeNodeCount];
+		uint32_t headIndex = m_binIndices[binIndex];
+
+		Node& node = m_nodes[nodeIndex];
+		node.Offset = offset;
+		node.Size = size;
+		node.NeighborPrev = Unused;
+		node.NeighborNext = Unused;
+		node.Used = false;
+
+		if (headIndex != Unused && m_nodes[headIndex].Size > size) {
+			// Smaller than the head: file it second, so FindFreeNode's exact-fit
+			// check still sees the larger block.
+			Node& head = m_nodes[headIndex];
+			node.BinListPrev = headIndex;
+			node.BinListNext = head.BinListNext;
+			if (head.BinListNext != Unused) {
+				m_nodes[head.BinListNext].BinListPrev = nodeIndex;
+			}
+			head.BinListNext = nodeIndex;
+		} else {
+			node.BinListPrev = Unused;
+			node.BinListNext = headIndex;
+			if (headIndex != Unused) {
+				m_nodes[headIndex].BinListPrev = nodeIndex;
+			}
+			m_binIndices[binIndex] = nodeIndex;
+		}
+
+		m_freeStorage += size;
+		return nodeIndex;
+	}
+
+	void OffsetAllocator::RemoveNodeFromBin(uint32_t nodeIndex) {
+		Node& node = m_nodes[nodeIndex];
+
+		if (node.BinListPrev != Unused) {
+			// Not the head: just unlink.
+			m_nodes[node.BinListPrev].BinListNext = node.BinListNext;
+			if (node.BinListNext != Unused) {
+				m_nodes[node.BinListNext].BinListPrev = node.BinListPrev;
+			}
+		} else {
+			uint32_t binIndex = SizeToBinRoundDown(node.Size);
+			uint32_t topBinIndex = binIndex >> TopBinsIndexShift;
+			uint32_t leafBinIndex = binIndex & LeafBinsIndexMask;
+
+			m_binIndices[binIndex] = node.BinListNext;
+			if (node.BinListNext != Unused) {
+				m_nodes[node.BinListNext].BinListPrev = Unused;
+			} else {
+				// The bin is now empty.
+				m_usedBins[topBinIndex] &= ~(1 << leafBinIndex);
+				if (m_usedBins[topBinIndex] == 0) {
+					m_usedBinsTop &= ~(1u << topBinIndex);
+				}
+			}
+		}
+
+		node.BinListPrev = Unused;
+		node.BinListNext = Unused;
+		m_freeStorage -= node.Size;
+	}
+
+	void OffsetAllocator::ReleaseNode(uint32_t nodeIndex) {
+		m_freeNodes[m_freeNodeCount++] = nodeIndex;
+	}
+}
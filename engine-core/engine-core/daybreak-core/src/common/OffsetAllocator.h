@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace memory {
+
+	/*
+		Two-level segregated-fit (TLSF) allocator over a range of offsets. Free
+		blocks are binned by size on a 3-bit-mantissa floating point scale: 32
+		top-level bins of 8 sub-bins each, with one bitmask per level, so finding
+		a block that fits is a couple of bit scans. Blocks are split on allocation
+		and merged with free neighbours on Free(), both in constant time. Node
+		storage is preallocated, so Allocate and Free never touch the heap.
+
+		Requests are rounded up to their bin so any block found is guaranteed to
+		fit. If that finds nothing, the head of the request's own bin is checked
+		before giving up, so a page whose only free block is the exact size asked
+		for still succeeds. Only the head is looked at, to keep this constant
+		time; a free block is filed at the head of its bin when it is at least as
+		large as the current head, so the head is usually the bin's largest.
+
+		Only offsets are managed; the allocator knows nothing about what backs
+		them. Not thread-safe.
+
+		Based on OffsetAllocator by Sebastian Aaltonen
+		(https://github.com/sebbbi/OffsetAllocator), MIT License,
+		Copyright (c) 2023 Sebastian Aaltonen. See THIRD_PARTY_LICENSES.md.
+	*/
+	class DAYBREAK_API OffsetAllocator {
+		public:
+			static constexpr uint32_t NoSpace = UINT32_MAX;
+
+			struct Allocation {
+				uint32_t	Offset = NoSpace;
+				uint32_t	Metadata = NoSpace;		// Node index, needed by Free().
+
+				bool IsValid() const { return Offset != NoSpace; }
+			};
+
+			/*
+				maxAllocations bounds the number of live allocations plus free blocks
+				at any one time.
+			*/
+			OffsetAllocator(uint32_t size, uint32_t maxAllocations = 128 * 1024);
+
+			OffsetAllocator(const OffsetAllocator& copy) = delete;
+			OffsetAllocator& operator=(const OffsetAllocator& other) = delete;
+
+			Allocation Allocate(uint32_t size);
+			void Free(Allocation allocation);
+			void Reset();
+
+			bool CanAllocate(uint32_t size) const;
+			uint32_t Size() const { return m_size; }
+			uint32_t FreeSize() const { return m_freeStorage; }
+
+			// Lower bound on the largest block that can currently be allocated.
+			uint32_t LargestFreeSize() const;
+
+		private:
+			static const uint32_t NumTopBins = 32;
+			static const uint32_t BinsPerLeaf = 8;
+			static const uint32_t TopBinsIndexShift = 3;
+			static const uint32_t LeafBinsIndexMask = 0x7;
+			static const uint32_t NumLeafBins = NumTopBins * BinsPerLeaf;
+			static const uint32_t Unused = UINT32_MAX;
+
+			struct Node {
+				uint32_t	Offset;
+				uint32_t	Size;
+				uint32_t	BinListPrev;
+				uint32_t	BinListNext;
+				uint32_t	NeighborPrev;
+				uint32_t	NeighborNext;
+				bool		Used;
+			};
+
+			uint32_t FindFreeNode(uint32_t size) const;
+			uint32_t InsertNodeIntoBin(uint32_t size, uint32_t offset);
+			void RemoveNodeFromBin(uint32_t nodeIndex);
+			void ReleaseNode(uint32_t nodeIndex);
+
+			uint32_t				m_size;
+			uint32_t				m_maxAllocations;
+			uint32_t				m_freeStorage;
+
+			uint32_t				m_usedBinsTop;
+			uint8_t					m_usedBins[NumTopBins];
+			uint32_t				m_binIndices[NumLeafBins];
+
+			std::vector<Node>		m_nodes;
+			std::vector<uint32_t>	m_freeNodes;
+			uint32_t				m_freeNodeCount;
+	};
+}
@@ -0,0 +1,185 @@
+#include "daybreak.h"
+#include "PlacementAllocator.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+namespace memory {
+
+	PlacementAllocator::PlacementAllocator() :
+		PlacementAllocator(Desc()) {
+	}
+
+	PlacementAllocator::PlacementAllocator(const Desc& desc) :
+		m_desc(desc),
+		m_reservedBytes(0),
+		m_requestedBytes(0),
+		m_poolPages(0),
+		m_dedicatedAllocations(0) {
+
+		assert(std::has_single_bit(m_desc.HeapSize) && std::has_single_bit(m_desc.MinBlockSize));
+		assert(std::has_single_bit(m_desc.PoolPageSize) && m_desc.PoolPageSize <= m_desc.HeapSize);
+		assert(m_desc.MaxPoolSize <= m_desc.PoolPageSize && SizeClassFor(m_desc.MaxPoolSize) < MaxSizeClasses);
+	}
+
+	PlacementAllocator::Placement PlacementAllocator::Allocate(uint64_t size, uint64_t alignment, Category category) {
+		Placement placement;
+		if (size == 0) {
+			return placement;
+		}
+
+		alignment = std::max(alignment, m_desc.MinBlockSize);
+		uint64_t blockSize = std::bit_ceil(std::max(size, alignment));
+
+		if (blockSize > m_desc.HeapSize / 2) {
+			placement.Dedicated = true;
+			placement.Size = size;
+			placement.RequestedSize = size;
+			m_dedicatedAllocations++;
+			return placement;
+		}
+
+		if (alignment == m_desc.MinBlockSize && size <= m_desc.MaxPoolSize) {
+			placement = AllocateFromPool(size, category);
+		} else {
+			placement = AllocateBlock(blockSize, category);
+		}
+
+		placement.RequestedSize = size;
+		m_reservedBytes += placement.Size;
+		m_requestedBytes += size;
+		return placement;
+	}
+
+	void PlacementAllocator::Free(const Placement& placement) {
+		if (placement.Dedicated) {
+			m_dedicatedAllocations--;
+			return;
+		}
+		if (!placement.IsPlaced()) {
+			return;
+		}
+
+		m_reservedBytes -= placement.Size;
+		m_requestedBytes -= placement.RequestedSize;
+
+		if (placement.Page != NoPage) {
+			FreeToPool(placement);
+		} else {
+			m_heaps[placement.Heap]->Buddy.Free(placement.Offset);
+		}
+	}
+
+	PlacementAllocator::Statistics PlacementAllocator::Stats() const {
+		Statistics stats = {};
+		stats.Heaps = HeapCount();
+		stats.HeapBytes = static_cast<uint64_t>(stats.Heaps) * m_desc.HeapSize;
+		stats.ReservedBytes = m_reservedBytes;
+		stats.RequestedBytes = m_requestedBytes;
+		stats.PoolPages = m_poolPages;
+		stats.DedicatedAllocations = m_dedicatedAllocations;
+
+		for (const auto& heap : m_heaps) {
+			stats.LargestFreeBlock = std::max(stats.LargestFreeBlock, heap->Buddy.LargestFreeBlock());
+		}
+		return stats;
+	}
+
+	uint32_t PlacementAllocator::SizeClassFor(uint64_t size) const {
+		uint64_t blocks = std::max<uint64_t>((size + m_desc.MinBlockSize - 1) / m_desc.MinBlockSize, 1);
+		return static_cast<uint32_t>(std::countr_zero(std::bit_ceil(blocks)));
+	}
+
+	PlacementAllocator::Placement PlacementAllocator::AllocateBlock(uint64_t blockSize, Category category) {
+		Placement placement;
+		placement.Size = blockSize;
+
+		for (uint32_t i = 0; i < m_heaps.size(); i++) {
+			Heap& heap = *m_heaps[i];
+			if (heap.HeapCategory != category) {
+				continue;
+			}
+
+			uint64_t offset = heap.Buddy.Allocate(blockSize);
+			if (offset != BuddyAllocator::NoSpace) {
+				placement.Heap = i;
+				placement.Offset = offset;
+				return placement;
+			}
+		}
+
+		m_heaps.push_back(std::make_unique<Heap>(category, m_desc.HeapSize, m_desc.MinBlockSize));
+		placement.Heap = HeapCount() - 1;
+		placement.Offset = m_heaps.back()->Buddy.Allocate(blockSize);
+		assert(placement.Offset != BuddyAllocator::NoSpace);
+		return placement;
+	}
+
+	PlacementAllocator::Placement PlacementAllocator::AllocateFromPool(uint64_t size, Category category) {
+		uint32_t sizeClass = SizeClassFor(size);
+		auto& pagesWithSpace = m_pagesWithSpace[static_cast<uint32_t>(category)][sizeClass];
+
+		if (pagesWithSpace.empty()) {
+			Placement block = AllocateBlock(m_desc.PoolPageSize, category);
+
+			uint32_t pageIndex;
+			if (!m_unusedPages.empty()) {
+				pageIndex = m_unusedPages.back();
+				m_unusedPages.pop_back();
+			} else {
+				pageIndex = static_cast<uint32_t>(m_pages.size());
+				m_pages.emplace_back();
+			}
+
+			PoolPage& page = m_pages[pageIndex];
+			page.Heap = block.Heap;
+			page.Offset = block.Offset;
+			page.SizeClass = sizeClass;
+			page.PageCategory = category;
+			page.SlotCount = static_cast<uint32_t>(m_desc.PoolPageSize / SizeClassBytes(sizeClass));
+			page.FreeSlots.clear();
+			for (uint32_t slot = page.SlotCount; slot > 0; slot--) {
+				page.FreeSlots.push_back(slot - 1);
+			}
+
+			pagesWithSpace.push_back(pageIndex);
+			m_poolPages++;
+		}
+
+		uint32_t pageIndex = pagesWithSpace.back();
+		PoolPage& page = m_pages[pageIndex];
+
+		Placement placement;
+		placement.Heap = page.Heap;
+		placement.Page = pageIndex;
+		placement.Slot = page.FreeSlots.back();
+		placement.Size = SizeClassBytes(sizeClass);
+		placement.Offset = page.Offset + placement.Slot * placement.Size;
+
+		page.FreeSlots.pop_back();
+		if (page.FreeSlots.empty()) {
+			pagesWithSpace.pop_back();
+		}
+		return placement;
+	}
+
+	void PlacementAllocator::FreeToPool(const Placement& placement) {
+		PoolPage& page = m_pages[placement.Page];
+		auto& pagesWithSpace = m_pagesWithSpace[static_cast<uint32_t>(page.PageCategory)][page.SizeClass];
+
+		page.FreeSlots.push_back(placement.Slot);
+		if (page.FreeSlots.size() == 1) {
+			pagesWithSpace.push_back(placement.Page);
+		}
+
+		// Hand an empty page back to its heap, unless it is the only one with
+		// room left in its class (avoids thrashing on alloc/free pairs).
+		if (page.FreeSlots.size() == page.SlotCount && pagesWithSpace.size() > 1) {
+			pagesWithSpace.erase(std::find(pagesWithSpace.begin(), pagesWithSpace.end(), placement.Page));
+			m_heaps[page.Heap]->Buddy.Free(page.Offset);
+			m_unusedPages.push_back(placement.Page);
+			m_poolPages--;
+		}
+	}
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "common/BuddyAllocator.h"
+
+namespace memory {
+
+	/*
+		Device-independent placement policy for GPU resources sub-allocated from
+		large heaps. Decides which heap and offset a resource goes to; the caller
+		creates the actual heaps and placed resources.
+
+		- Resources up to MaxPoolSize with at most MinBlockSize alignment go to
+		  size-class pools: power-of-two slot sizes from MinBlockSize to
+		  MaxPoolSize, carved out of PoolPageSize pages.
+		- Anything bigger, or with a stricter alignment (MSAA), gets a block from
+		  a per-heap buddy allocator. Pool pages come from the same buddies and
+		  are handed back when they empty.
+		- Requests above half a heap are reported as dedicated, for the caller to
+		  create as committed resources.
+
+		Heaps are never shared between categories, matching resource heap tier 1.
+		Not thread-safe.
+	*/
+	class DAYBREAK_API PlacementAllocator {
+		public:
+			enum class Category : uint8_t {
+				Buffer,
+				Texture,
+				RenderTarget,
+				Count
+			};
+
+			static constexpr uint32_t NoHeap = UINT32_MAX;
+			static constexpr uint32_t NoPage = UINT32_MAX;
+
+			struct Desc {
+				uint64_t	HeapSize = 64ull * 1024 * 1024;
+				uint64_t	MinBlockSize = 64ull * 1024;		// D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT
+				uint64_t	PoolPageSize = 4ull * 1024 * 1024;	// D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT
+				uint64_t	MaxPoolSize = 1024ull * 1024;
+			};
+
+			struct Placement {
+				uint32_t	Heap = NoHeap;
+				uint64_t	Offset = 0;
+				uint64_t	Size = 0;		// Bytes reserved, including rounding.
+				uint64_t	RequestedSize = 0;
+				uint32_t	Page = NoPage;	// Pool page, or NoPage for a buddy block.
+				uint32_t	Slot = 0;
+				bool		Dedicated = false;
+
+				bool IsPlaced() const { return Heap != NoHeap; }
+			};
+
+			struct Statistics {
+				uint32_t	Heaps;
+				uint64_t	HeapBytes;
+				uint64_t	ReservedBytes;		// Sum of Placement::Size for live placements.
+				uint64_t	RequestedBytes;		// Sum of the sizes asked for.
+				uint64_t	LargestFreeBlock;
+				uint32_t	PoolPages;
+				uint64_t	DedicatedAllocations;
+			};
+
+			PlacementAllocator();
+			explicit PlacementAllocator(const Desc& desc);
+
+			PlacementAllocator(const PlacementAllocator& copy) = delete;
+			PlacementAllocator& operator=(const PlacementAllocator& other) = delete;
+
+			/*
+				May add a heap; check HeapCount() afterwards. Returns a placement with
+				Dedicated set (and no heap) if the request should not be placed.
+			*/
+			Placement Allocate(uint64_t size, uint64_t alignment, Category category);
+			void Free(const Placement& placement);
+
+			uint32_t HeapCount() const { return static_cast<uint32_t>(m_heaps.size()); }
+			uint64_t HeapSize() const { return m_desc.HeapSize; }
+			Category HeapCategory(uint32_t heap) const { return m_heaps[heap]->HeapCategory; }
+
+			Statistics Stats() const;
+
+		private:
+			static const uint32_t CategoryCount = static_cast<uint32_t>(Category::Count);
+			static const uint32_t MaxSizeClasses = 16;
+
+			struct Heap {
+				Heap(Category category, uint64_t size, uint64_t minBlockSize) :
+					HeapCategory(category),
+					Buddy(size, minBlockSize) {}
+
+				Category		HeapCategory;
+				BuddyAllocator	Buddy;
+			};
+
+			struct PoolPage {
+				uint32_t				Heap;
+				uint64_t				Offset;
+				uint32_t				SizeClass;
+				Category				PageCategory;
+				std::vector<uint32_t>	FreeSlots;
+				uint32_t				SlotCount;
+			};
+
+			uint32_t SizeClassFor(uint64_t size) const;
+			uint64_t SizeClassBytes(uint32_t sizeClass) const { return m_desc.MinBlockSize << sizeClass; }
+
+			Placement AllocateBlock(uint64_t blockSize, Category category);
+			Placement AllocateFromPool(uint64_t size, Category category);
+			void FreeToPool(const Placement& placement);
+
+			Desc								m_desc;
+			std::vector<std::unique_ptr<Heap>>	m_heaps;
+
+			std::vector<PoolPage>				m_pages;
+			std::vector<uint32_t>				m_unusedPages;
+			std::vector<uint32_t>				m_pagesWithSpace[CategoryCount][MaxSizeClasses];
+
+			uint64_t							m_reservedBytes;
+			uint64_t							m_requestedBytes;
+			uint32_t							m_poolPages;
+			uint64_t							m_dedicatedAllocations;
+	};
+}
@@ -0,0 +1,327 @@
+#include "daybreak.h"
+#include "Profiler.h"
+
+#include <fstream>
+#include <iomanip>
+
+struct ProfileRecord {
+	const char*	Name;
+	int64_t		Start;
+	int64_t		End;
+	uint32_t	Depth;
+};
+
+/*
+	Owned by one thread, which is the only writer; exporters read the first
+	Count records. Records is allocated under g_threadsMutex, which exporters
+	hold. A new capture resets Count before publishing its Generation, so an
+	exporter that sees the current generation never reads an older count.
+*/
+struct ThreadBuffer {
+	uint32_t							Id;
+	std::string							Name;
+	std::atomic<uint32_t>				Generation;
+	uint32_t							Depth;
+	std::unique_ptr<ProfileRecord[]>	Records;
+	std::atomic<uint32_t>				Count;
+	std::atomic<uint32_t>				Dropped;
+};
+
+std::atomic<bool> Profiler::g_capturing(false);
+
+static std::mutex g_threadsMutex;
+static std::vector<std::unique_ptr<ThreadBuffer>> g_threads;
+static thread_local ThreadBuffer* t_buffer = nullptr;
+
+// Bumped per capture; buffers reset themselves when they see a new value.
+static std::atomic<uint32_t> g_generation(0);
+
+// Game thread only.
+static bool g_capturePending = false;
+static uint32_t g_captureFrames = 0;
+static uint32_t g_framesRemaining = 0;
+static int64_t g_captureStart = 0;
+static std::chrono::steady_clock::time_point g_captureStartTime;
+static std::wstring g_capturePath;
+
+/*
+	Nanoseconds per Timestamp() tick, measured over the capture so far.
+*/
+static double NanosecondsPerTick() {
+	int64_t ticks = Profiler::Timestamp() - g_captureStart;
+	double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - g_captureStartTime).count();
+	return ticks > 0 ? elapsed / ticks : 1.0;
+}
+
+static ThreadBuffer& RegisterThread() {
+	if (!t_buffer) {
+		std::lock_guard<std::mutex> lock(g_threadsMutex);
+		auto buffer = std::make_unique<ThreadBuffer>();
+		buffer->Id = static_cast<uint32_t>(g_threads.size());
+		buffer->Name = "Thread " + std::to_string(buffer->Id);
+		buffer->Generation.store(0, std::memory_order_relaxed);
+		buffer->Depth = 0;
+		buffer->Count.store(0, std::memory_order_relaxed);
+		buffer->Dropped.store(0, std::memory_order_relaxed);
+
+		t_buffer = buffer.get();
+		g_threads.push_back(std::move(buffer));
+	}
+	return *t_buffer;
+}
+
+static ThreadBuffer& CaptureBuffer() {
+	ThreadBuffer& buffer = RegisterThread();
+
+	// Pairs with the release in BeginFrame: a thread that sees the new
+	// generation also sees the previous capture's export finished, so it can
+	// start overwriting its records.
+	uint32_t generation = g_generation.load(std::memory_order_acquire);
+	if (buffer.Generation.load(std::memory_order_relaxed) != generation) {
+		if (!buffer.Records) {
+			std::lock_guard<std::mutex> lock(g_threadsMutex);
+			buffer.Records = std::make_unique<ProfileRecord[]>(Profiler::MaxRecordsPerThread);
+		}
+		buffer.Count.store(0, std::memory_order_relaxed);
+		buffer.Dropped.store(0, std::memory_order_relaxed);
+		buffer.Generation.store(generation, std::memory_order_release);
+	}
+	return buffer;
+}
+
+static void Append(ThreadBuffer& buffer, const char* name, int64_t start, int64_t end, uint32_t depth) {
+	uint32_t index = buffer.Count.load(std::memory_order_relaxed);
+	if (index >= Profiler::MaxRecordsPerThread) {
+		buffer.Dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	buffer.Records[index] = { name, start, end, depth };
+	buffer.Count.store(index + 1, std::memory_order_release);
+}
+
+uint32_t Profiler::Enter() {
+	return CaptureBuffer().Depth++;
+}
+
+void Profiler::Leave(const char* name, int64_t start, uint32_t depth) {
+	int64_t end = Timestamp();
+
+	// Enter() ran on this thread, so the buffer is registered.
+	ThreadBuffer& buffer = *t_buffer;
+	buffer.Depth--;
+	Append(buffer, name, start, end, depth);
+}
+
+void Profiler::BeginCapture(uint32_t frameCount, const std::wstring& path) {
+	if (frameCount == 0 || g_capturePending || IsCapturing()) {
+		return;
+	}
+
+#if !DAYBREAK_PROFILE
+	LOG_INFO(General, L"[Profiler] Markers are compiled out (DAYBREAK_PROFILE 0); the capture will be empty\n");
+#endif
+	g_captureFrames = frameCount;
+	g_capturePath = path;
+	g_capturePending = true;
+}
+
+void Profiler::BeginFrame() {
+	if (IsCapturing() && --g_framesRemaining == 0) {
+		EndCapture();
+	}
+
+	if (g_capturePending) {
+		g_capturePending = false;
+		g_framesRemaining = g_captureFrames;
+		g_captureStart = Timestamp();
+		g_captureStartTime = std::chrono::steady_clock::now();
+		g_generation.fetch_add(1, std::memory_order_release);
+		g_capturing.store(true, std::memory_order_release);
+	}
+
+	if (IsCapturing()) {
+		int64_t now = Timestamp();
+		Append(CaptureBuffer(), "Frame", now, now, FrameMarker);
+	}
+}
+
+void Profiler::SetThreadName(const char* name) {
+	ThreadBuffer& buffer = RegisterThread();
+	std::lock_guard<std::mutex> lock(g_threadsMutex);
+	buffer.Name = name;
+}
+
+/*
+	Copies what each thread has published so far. Threads may keep appending
+	while this runs; anything past the count read here is left out.
+*/
+struct ThreadCapture {
+	uint32_t					Id;
+	std::string					Name;
+	std::vector<ProfileRecord>	Records;
+	uint32_t					Dropped;
+};
+
+static std::vector<ThreadCapture> Snapshot() {
+	std::vector<ThreadCapture> captures;
+	uint32_t generation = g_generation.load(std::memory_order_relaxed);
+
+	std::lock_guard<std::mutex> lock(g_threadsMutex);
+	for (auto& buffer : g_threads) {
+		// Generation first: its release follows the reset of Count.
+		if (buffer->Generation.load(std::memory_order_acquire) != generation) {
+			continue;
+		}
+		uint32_t count = buffer->Count.load(std::memory_order_acquire);
+		if (count == 0) {
+			continue;
+		}
+
+		ThreadCapture capture;
+		capture.Id = buffer->Id;
+		capture.Name = buffer->Name;
+		capture.Records.assign(buffer->Records.get(), buffer->Records.get() + count);
+		capture.Dropped = buffer->Dropped.load(std::memory_order_relaxed);
+		captures.push_back(std::move(capture));
+	}
+	return captures;
+}
+
+static uint64_t DroppedScopes(const std::vector<ThreadCapture>& threads) {
+	uint64_t dropped = 0;
+	for (const ThreadCapture& thread : threads) {
+		dropped += thread.Dropped;
+	}
+	return dropped;
+}
+
+static void WriteJsonString(std::ofstream& file, const char* text) {
+	file << '"';
+	for (const char* c = text; *c; c++) {
+		if (*c == '"' || *c == '\\') {
+			file << '\\';
+		}
+		file << *c;
+	}
+	file << '"';
+}
+
+static bool WriteChromeTrace(const std::wstring& path, const std::vector<ThreadCapture>& threads, double nanosecondsPerTick) {
+	std::ofstream file(std::filesystem::path(path), std::ios_base::trunc);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	double scale = nanosecondsPerTick / 1000.0;
+	file << std::fixed << std::setprecision(3);
+	file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+
+	bool first = true;
+	for (const ThreadCapture& thread : threads) {
+		file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << thread.Id << ",\"args\":{\"name\":";
+		WriteJsonString(file, thread.Name.c_str());
+		file << ",\"dropped\":" << thread.Dropped << "}}";
+		first = false;
+
+		for (const ProfileRecord& record : thread.Records) {
+			double start = (record.Start - g_captureStart) * scale;
+			file << ",\n{\"name\":";
+			WriteJsonString(file, record.Name);
+			if (record.Depth == Profiler::FrameMarker) {
+				file << ",\"ph\":\"i\",\"s\":\"g\",\"ts\":" << start;
+			} else {
+				file << ",\"ph\":\"X\",\"ts\":" << start << ",\"dur\":" << (record.End - record.Start) * scale;
+			}
+			file << ",\"pid\":0,\"tid\":" << thread.Id << "}";
+		}
+	}
+
+	file << "\n],\"metadata\":{\"maxRecordsPerThread\":" << Profiler::MaxRecordsPerThread << ",\"dropped\":" << DroppedScopes(threads) << "}}\n";
+	return file.good();
+}
+
+template<typename T>
+static void Write(std::ofstream& file, const T& value) {
+	file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+static void WriteString(std::ofstream& file, const std::string& text) {
+	uint16_t length = static_cast<uint16_t>(std::min<size_t>(text.size(), UINT16_MAX));
+	Write(file, length);
+	file.write(text.data(), length);
+}
+
+static bool WriteBinary(const std::wstring& path, const std::vector<ThreadCapture>& threads, double scale) {
+
+	// Name table, deduplicated by content.
+	std::vector<std::string> names;
+	std::unordered_map<std::string, uint32_t> nameIndices;
+	std::unordered_map<const char*, uint32_t> pointerIndices;
+	for (const ThreadCapture& thread : threads) {
+		for (const ProfileRecord& record : thread.Records) {
+			if (pointerIndices.count(record.Name)) {
+				continue;
+			}
+			auto inserted = nameIndices.emplace(record.Name, static_cast<uint32_t>(names.size()));
+			if (inserted.second) {
+				names.push_back(record.Name);
+			}
+			pointerIndices[record.Name] = inserted.first->second;
+		}
+	}
+
+	std::ofstream file(std::filesystem::path(path), std::ios_base::trunc | std::ios_base::binary);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	Write(file, Profiler::Magic);
+	Write(file, Profiler::Version);
+	Write(file, static_cast<uint32_t>(names.size()));
+	for (const std::string& name : names) {
+		WriteString(file, name);
+	}
+
+	Write(file, static_cast<uint32_t>(threads.size()));
+	for (const ThreadCapture& thread : threads) {
+		Write(file, thread.Id);
+		WriteString(file, thread.Name);
+		Write(file, thread.Dropped);
+		Write(file, static_cast<uint32_t>(thread.Records.size()));
+		for (const ProfileRecord& record : thread.Records) {
+			Write(file, pointerIndices[record.Name]);
+			Write(file, record.Depth);
+			Write(file, static_cast<int64_t>((record.Start - g_captureStart) * scale));
+			Write(file, static_cast<int64_t>((record.End - g_captureStart) * scale));
+		}
+	}
+	return file.good();
+}
+
+void Profiler::EndCapture() {
+	if (!IsCapturing()) {
+		return;
+	}
+	g_capturing.store(false, std::memory_order_relaxed);
+
+	// One snapshot and one tick rate for both files, so they describe the
+	// same capture.
+	std::vector<ThreadCapture> threads = Snapshot();
+	double nanosecondsPerTick = NanosecondsPerTick();
+
+	uint64_t dropped = DroppedScopes(threads);
+	if (dropped > 0) {
+		LOG_ERROR(General, L"[Profiler] Dropped %llu scopes past %u records per thread; the capture is truncated\n",
+			static_cast<unsigned long long>(dropped), MaxRecordsPerThread);
+	}
+
+	std::wstring json = g_capturePath + L".json";
+	std::wstring binary = g_capturePath + L".prof";
+	uint32_t frames = g_captureFrames - g_framesRemaining;
+	if (WriteChromeTrace(json, threads, nanosecondsPerTick) && WriteBinary(binary, threads, nanosecondsPerTick)) {
+		LOG_INFO(General, L"[Profiler] Captured %u frames to %s and %s\n", frames, json.c_str(), binary.c_str());
+	} else {
+		LOG_ERROR(General, L"[Profiler] Unable to write capture to %s\n", g_capturePath.c_str());
+	}
+}
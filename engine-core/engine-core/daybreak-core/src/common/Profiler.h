@@ -0,0 +1,141 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#if defined(_M_X64) || defined(_M_IX86)
+	#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+	#include <x86intrin.h>
+#endif
+
+/*
+	Compile-time switch for the profiling markers. With DAYBREAK_PROFILE 0 every
+	PROFILE_* marker expands to nothing; the capture API stays available but has
+	nothing to record. Override from the project's preprocessor definitions.
+*/
+#ifndef DAYBREAK_PROFILE
+	#define DAYBREAK_PROFILE 1
+#endif
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if DAYBREAK_PROFILE
+	// name must outlive the capture (a string literal or __FUNCTION__).
+	#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+	#define PROFILE_FUNCTION() PROFILE_SCOPE(__FUNCTION__)
+#else
+	#define PROFILE_SCOPE(name) do {} while (0)
+	#define PROFILE_FUNCTION() do {} while (0)
+#endif
+
+/*
+	Hierarchical CPU profiler. Scopes are recorded only while a capture is
+	running; otherwise a marker costs one relaxed load. Each thread appends
+	complete scopes (name, start, end, depth) to its own buffer, so recording
+	takes no lock and touches no shared cache line. Buffers are registered once
+	per thread and published with a release store of their record count, which
+	is what the exporters read.
+
+	A capture starts at the first BeginFrame() after BeginCapture() and stops at
+	the BeginFrame() frameCount frames later, when it is written to
+	<path>.json (Chrome trace format, for chrome://tracing or Perfetto) and
+	<path>.prof (compact binary).
+
+	.prof layout, little-endian and byte-packed; strings are a uint16_t byte
+	count followed by UTF-8:
+
+		File	: Magic, Version, uint32_t nameCount, string[nameCount],
+				  uint32_t threadCount, Thread[threadCount]
+		Thread	: uint32_t id, string name, uint32_t dropped, uint32_t recordCount,
+				  Record[recordCount]
+		Record	: uint32_t name index, uint32_t depth, int64_t start (ns), int64_t end (ns)
+
+	Times are relative to the capture start. depth == FrameMarker marks the
+	start of a frame. dropped counts the thread's scopes past
+	MaxRecordsPerThread; the JSON carries it in each thread_name event and the
+	total in its metadata, and a nonzero total is logged when the capture is
+	written.
+*/
+class DAYBREAK_API Profiler {
+	public:
+		static constexpr uint32_t Magic = 0x464F5250; // "PROF"
+		static constexpr uint32_t Version = 2;
+		static constexpr uint32_t FrameMarker = 0xFFFFFFFF;
+
+		// Per thread, per capture; scopes past this are counted as dropped.
+		static constexpr uint32_t MaxRecordsPerThread = 1 << 16;
+
+		/*
+			Records the next frameCount frames and writes them to path (without
+			extension) when done. Ignored while a capture is pending or running.
+		*/
+		static void BeginCapture(uint32_t frameCount, const std::wstring& path);
+		static bool IsCapturing() { return g_capturing.load(std::memory_order_relaxed); }
+
+		/*
+			Stops a running capture early and writes what it recorded. Call at
+			shutdown so a capture longer than the run is not lost.
+		*/
+		static void EndCapture();
+
+		// Called by the game thread at the top of every frame.
+		static void BeginFrame();
+
+		// Names the calling thread in exported captures.
+		static void SetThreadName(const char* name);
+
+		/*
+			Raw timestamp for scope records. On x86 this is the time-stamp counter,
+			which reads in a few nanoseconds where a steady_clock read can cost tens
+			of them; ticks are converted to nanoseconds against steady_clock when a
+			capture is written. Elsewhere it is steady_clock nanoseconds.
+		*/
+		static int64_t Timestamp() {
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+			return static_cast<int64_t>(__rdtsc());
+#else
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+		}
+
+	private:
+		friend class ProfileScope;
+
+		static std::atomic<bool> g_capturing;
+
+		static uint32_t Enter();
+		static void Leave(const char* name, int64_t start, uint32_t depth);
+};
+
+class ProfileScope {
+	public:
+		explicit ProfileScope(const char* name) :
+			m_name(name),
+			m_start(0),
+			m_depth(0),
+			m_active(Profiler::IsCapturing()) {
+			if (m_active) {
+				m_depth = Profiler::Enter();
+				m_start = Profiler::Timestamp();
+			}
+		}
+
+		~ProfileScope() {
+			if (m_active) {
+				Profiler::Leave(m_name, m_start, m_depth);
+			}
+		}
+
+		ProfileScope(const ProfileScope& copy) = delete;
+		ProfileScope& operator=(const ProfileScope& other) = delete;
+
+	private:
+		const char*	m_name;
+		int64_t		m_start;
+		uint32_t	m_depth;
+		bool		m_active;
+};
@@ -0,0 +1,91 @@
+#include "daybreak.h"
+#include "RingAllocator.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace memory {
+
+	RingAllocator::RingAllocator(size_t capacity) :
+		m_capacity(capacity),
+		m_head(0),
+		m_tail(0),
+		m_used(0),
+		m_highWaterMark(0),
+		m_firstId(0),
+		m_allocations(0),
+		m_failedAllocations(0),
+		m_blocks(64) {
+	}
+
+	bool RingAllocator::Allocate(size_t size, size_t alignment, Allocation& allocation) {
+		assert(size > 0 && IsAligned(alignment, alignment) && "Invalid ring allocation.");
+
+		if (m_used == 0) {
+			// Start over at the beginning so an empty ring never has to wrap.
+			m_head = m_tail = 0;
+		}
+
+		size_t offset = AlignUp(m_head, alignment);
+		size_t end = offset + size;
+		size_t blockSize;
+
+		if (m_used == 0 || m_head > m_tail) {
+			// Free space is [head, capacity) followed by [0, tail).
+			if (end <= m_capacity) {
+				blockSize = end - m_head;
+			} else if (size <= m_tail) {
+				// Skip the rest of the ring; the padding is freed with this block.
+				offset = 0;
+				end = size;
+				blockSize = (m_capacity - m_head) + size;
+			} else {
+				m_failedAllocations++;
+				return false;
+			}
+		} else {
+			// Free space is [head, tail).
+			if (end > m_tail) {
+				m_failedAllocations++;
+				return false;
+			}
+			blockSize = end - m_head;
+		}
+
+		m_head = end == m_capacity ? 0 : end;
+		m_used += blockSize;
+		m_highWaterMark = std::max(m_highWaterMark, m_used);
+		m_allocations++;
+
+		allocation.Offset = offset;
+		allocation.Id = m_firstId + m_blocks.Size();
+		m_blocks.PushBack({ m_head, blockSize, PendingFence });
+		return true;
+	}
+
+	void RingAllocator::Tag(uint64_t id, uint64_t fenceValue) {
+		assert(id >= m_firstId && id - m_firstId < m_blocks.Size() && "Unknown ring allocation.");
+		m_blocks[static_cast<size_t>(id - m_firstId)].FenceValue = fenceValue;
+	}
+
+	void RingAllocator::Retire(uint64_t completedFenceValue) {
+		while (!m_blocks.IsEmpty() && m_blocks.Front().FenceValue <= completedFenceValue) {
+			const Block& block = m_blocks.Front();
+			m_tail = block.End;
+			m_used -= block.Size;
+
+			m_blocks.PopFront();
+			m_firstId++;
+		}
+	}
+
+	RingAllocator::Statistics RingAllocator::Stats() const {
+		Statistics stats;
+		stats.Capacity = m_capacity;
+		stats.UsedBytes = m_used;
+		stats.HighWaterMark = m_highWaterMark;
+		stats.Allocations = m_allocations;
+		stats.FailedAllocations = m_failedAllocations;
+		return stats;
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "common/RingQueue.h"
+
+namespace memory {
+
+	/*
+		Offset allocator over a fixed-size ring. Memory is handed out in FIFO
+		order from the head and reclaimed from the tail. Each allocation is tagged
+		with the fence value of the submission that used it, and Retire() frees
+		every allocation at the tail whose fence value has been reached. An
+		allocation that has not been tagged yet holds back everything after it.
+
+		Only offsets are managed, so the same policy can sit in front of any
+		buffer. Not thread-safe.
+	*/
+	class DAYBREAK_API RingAllocator {
+		public:
+			// Fence value of allocations that have not been submitted yet.
+			static const uint64_t PendingFence = UINT64_MAX;
+
+			struct Allocation {
+				size_t		Offset;
+				uint64_t	Id;
+			};
+
+			struct Statistics {
+				size_t		Capacity;
+				size_t		UsedBytes;
+				size_t		HighWaterMark;
+				uint64_t	Allocations;
+				uint64_t	FailedAllocations;
+			};
+
+			explicit RingAllocator(size_t capacity);
+
+			/*
+				Reserves size bytes at the given power-of-two alignment. Returns false
+				if the ring does not currently have room; retire and try again, or
+				allocate elsewhere.
+			*/
+			bool Allocate(size_t size, size_t alignment, Allocation& allocation);
+
+			/*
+				Marks an allocation as reclaimable once fenceValue completes. Tagging
+				with 0 releases it on the next Retire().
+			*/
+			void Tag(uint64_t id, uint64_t fenceValue);
+			void Retire(uint64_t completedFenceValue);
+
+			size_t Capacity() const { return m_capacity; }
+			size_t UsedBytes() const { return m_used; }
+			Statistics Stats() const;
+			void ResetHighWaterMark() { m_highWaterMark = m_used; }
+
+		private:
+			struct Block {
+				size_t		End;		// Ring offset just past the block.
+				size_t		Size;		// Including any padding skipped to wrap.
+				uint64_t	FenceValue;
+			};
+
+			size_t						m_capacity;
+			size_t						m_head;
+			size_t						m_tail;
+			size_t						m_used;
+			size_t						m_highWaterMark;
+			uint64_t					m_firstId;
+			uint64_t					m_allocations;
+			uint64_t					m_failedAllocations;
+			collection::RingQueue<Block>	m_blocks;
+	};
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace collection {
+
+	/*
+		Single-threaded FIFO over a power-of-two ring of slots. Popped slots are
+		moved-from and reused, and the ring only grows (by doubling) when it is
+		full, so a queue that reaches its steady-state depth stops allocating.
+		Unlike std::deque it never frees and reallocates blocks as it cycles.
+	*/
+	template<typename T>
+	class RingQueue {
+		public:
+			explicit RingQueue(size_t capacity = 16);
+
+			void PushBack(T&& value);
+			void PopFront();
+
+			T& Front() { return m_slots[m_head]; }
+			const T& Front() const { return m_slots[m_head]; }
+			T& Back() { return m_slots[(m_head + m_size - 1) & (m_slots.size() - 1)]; }
+			const T& Back() const { return m_slots[(m_head + m_size - 1) & (m_slots.size() - 1)]; }
+
+			// Indexed from the front.
+			T& operator[](size_t index) { return m_slots[(m_head + index) & (m_slots.size() - 1)]; }
+			const T& operator[](size_t index) const { return m_slots[(m_head + index) & (m_slots.size() - 1)]; }
+
+			size_t Size() const { return m_size; }
+			bool IsEmpty() const { return m_size == 0; }
+
+		private:
+			void Grow();
+
+			std::vector<T>	m_slots;
+			size_t			m_head;
+			size_t			m_size;
+	};
+}
+
+template<typename T>
+collection::RingQueue<T>::RingQueue(size_t capacity) :
+	m_head(0),
+	m_size(0) {
+
+	size_t slots = 2;
+	while (slots < capacity) {
+		slots <<= 1;
+	}
+	m_slots.resize(slots);
+}
+
+template<typename T>
+void collection::RingQueue<T>::PushBack(T&& value) {
+	if (m_size == m_slots.size()) {
+		Grow();
+	}
+	m_slots[(m_head + m_size) & (m_slots.size() - 1)] = std::move(value);
+	m_size++;
+}
+
+template<typename T>
+void collection::RingQueue<T>::PopFront() {
+	// Release whatever the slot still owns now rather than when it is reused.
+	m_slots[m_head] = T();
+	m_head = (m_head + 1) & (m_slots.size() - 1);
+	m_size--;
+}
+
+template<typename T>
+void collection::RingQueue<T>::Grow() {
+	std::vector<T> slots(m_slots.size() * 2);
+	for (size_t i = 0; i < m_size; i++) {
+		slots[i] = std::move(m_slots[(m_head + i) & (m_slots.size() - 1)]);
+	}
+	m_slots.swap(slots);
+	m_head = 0;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace collection {
+
+	/*
+		Bounded Chase-Lev work-stealing deque of pointers. The owning thread pushes
+		and pops at the bottom (LIFO, cache-warm); any other thread may steal from
+		the top (FIFO). Only the owner may call Push and Pop. Memory ordering follows
+		Le, Pop, Cohen and Zappa Nardelli, "Correct and Efficient Work-Stealing for
+		Weak Memory Models" (PPoPP 2013).
+	*/
+	template<typename T>
+	class WorkStealingDeque {
+		public:
+			explicit WorkStealingDeque(size_t capacity = 4096);
+
+			WorkStealingDeque(const WorkStealingDeque& copy) = delete;
+			WorkStealingDeque& operator=(const WorkStealingDeque& other) = delete;
+
+			// Returns false if the deque is full.
+			bool Push(T* value);
+			T* Pop();
+			T* Steal();
+
+			bool IsEmpty() const;
+
+		private:
+			std::unique_ptr<std::atomic<T*>[]>	m_values;
+			int64_t								m_mask;
+
+			alignas(64) std::atomic<int64_t>	m_top;
+			alignas(64) std::atomic<int64_t>	m_bottom;
+	};
+}
+
+template<typename T>
+collection::WorkStealingDeque<T>::WorkStealingDeque(size_t capacity) :
+	m_top(0),
+	m_bottom(0) {
+
+	size_t slots = 2;
+	while (slots < capacity) {
+		slots <<= 1;
+	}
+
+	m_mask = static_cast<int64_t>(slots) - 1;
+	m_values = std::make_unique<std::atomic<T*>[]>(slots);
+}
+
+template<typename T>
+bool collection::WorkStealingDeque<T>::Push(T* value) {
+	int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+	int64_t top = m_top.load(std::memory_order_acquire);
+	if (bottom - top > m_mask) {
+		return false;
+	}
+
+	m_values[bottom & m_mask].store(value, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	m_bottom.store(bottom + 1, std::memory_order_relaxed);
+	return true;
+}
+
+template<typename T>
+T* collection::WorkStealingDeque<T>::Pop() {
+	int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+	m_bottom.store(bottom, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t top = m_top.load(std::memory_order_relaxed);
+
+	if (top > bottom) {
+		// Empty.
+		m_bottom.store(bottom + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	T* value = m_values[bottom & m_mask].load(std::memory_order_relaxed);
+	if (top == bottom) {
+		// Last element -- race any thief for it.
+		if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+			value = nullptr;
+		}
+		m_bottom.store(bottom + 1, std::memory_order_relaxed);
+	}
+	return value;
+}
+
+template<typename T>
+T* collection::WorkStealingDeque<T>::Steal() {
+	int64_t top = m_top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t bottom = m_bottom.load(std::memory_order_acquire);
+
+	if (top >= bottom) {
+		return nullptr;
+	}
+
+	T* value = m_values[top & m_mask].load(std::memory_order_relaxed);
+	if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+		return nullptr;
+	}
+	return value;
+}
+
+template<typename T>
+bool collection::WorkStealingDeque<T>::IsEmpty() const {
+	return m_bottom.load(std::memory_order_relaxed) <= m_top.load(std::memory_order_relaxed);
+}
@@ -1,9 +1,13 @@
 #pragma once
 
-#ifdef BUILD_DLL
-	#define DAYBREAK_API __declspec(dllexport)
+#ifdef WIN32
+	#ifdef BUILD_DLL
+		#define DAYBREAK_API __declspec(dllexport)
+	#else
+		#define DAYBREAK_API __declspec(dllimport)
+	#endif
 #else
-	#define DAYBREAK_API __declspec(dllimport)
+	#define DAYBREAK_API __attribute__((visibility("default")))
 #endif
 
 #define MAX_NAME_STRING 256
@@ -50,6 +54,8 @@ namespace std {
         seed ^= hasher(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
     }
 
+#ifdef WIN32
+
     template<>
     struct hash<D3D12_SHADER_RESOURCE_VIEW_DESC>
     {
@@ -176,6 +182,7 @@ namespace std {
             return seed;
         }
     };
+#endif
 }
 
 #if defined(min)
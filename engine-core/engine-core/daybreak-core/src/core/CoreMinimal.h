@@ -6,8 +6,12 @@
 
 #include "common/Logger.h"
 #include "common/Time.h"
+#include "common/Profiler.h"
 
 #include "core/GameSettings.h"
+#include "core/JobSystem.h"
+
+#include "platform/win32/IApplication.h"
 
 #ifdef WIN32
 
@@ -15,11 +19,11 @@
 	#include "platform/win32/SubObject.h"
 	#include "platform/win32/Win32Caption.h"
 	#include "platform/win32/Window.h"
-	#include "platform/win32/IApplication.h"
 
 	#include "platform/dx12/CommandQueue.h"
+	#include "platform/dx12/CommandBatch.h"
 	#include "platform/dx12/Context.h"
 	#include "platform/dx12/Application.h"
-#endif
 
-#include "engine/manager/WindowManager.h"
\ No newline at end of file
+	#include "engine/manager/WindowManager.h"
+#endif
\ No newline at end of file
@@ -10,7 +10,7 @@ GameSettings::GameSettings() {
 	wcscpy_s(inst->m_game_boot_time, Time::get_datetime(true).c_str());
 	wcscpy_s(inst->m_splashURL, L"..\\daybreak-core\\res\\images\\daybreak.bmp");
 
-	inst->m_currentPath = std::wstring(std::filesystem::current_path().c_str());
+	inst->m_currentPath = std::filesystem::current_path().wstring();
 	inst->m_useWARP = false;
 }
 
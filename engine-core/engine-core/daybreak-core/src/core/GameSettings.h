@@ -1,6 +1,8 @@
 #pragma once
 
-#include "resources/ResourceManager.h"
+#ifdef WIN32
+	#include "resources/ResourceManager.h"
+#endif
 
 class DAYBREAK_API GameSettings {
 	
@@ -12,7 +14,9 @@ class DAYBREAK_API GameSettings {
 		WCHAR m_game_name[MAX_NAME_STRING];
 		WCHAR m_game_short_name[MAX_NAME_STRING];
 		WCHAR m_game_boot_time[MAX_NAME_STRING];
+#ifdef WIN32
 		HICON m_game_icon;
+#endif
 		WCHAR m_splashURL[MAX_NAME_STRING];
 
 		std::wstring m_currentPath;
@@ -26,18 +30,25 @@ class DAYBREAK_API GameSettings {
 		~GameSettings();
 
 		static WCHAR* game_name() { return inst->m_game_name; }
-		static void set_game_name(int id) { ResourceManager::load_string(id, inst->m_game_name, MAX_NAME_STRING); }
+		static void set_game_name(const wchar_t* name) { wcsncpy_s(inst->m_game_name, name, _TRUNCATE); }
 
 		static WCHAR* game_short_name() { return inst->m_game_short_name; }
+		static void set_game_short_name(const wchar_t* name) { wcsncpy_s(inst->m_game_short_name, name, _TRUNCATE); }
+
+		static WCHAR* game_boot_time() { return inst->m_game_boot_time; }
+
+		static WCHAR* SplashURL() { return inst->m_splashURL; }
+
+#ifdef WIN32
+		/* Resource-id setters; string table and icon resources only exist on Windows */
+		static void set_game_name(int id) { ResourceManager::load_string(id, inst->m_game_name, MAX_NAME_STRING); }
 		static void set_game_short_name(int id) { ResourceManager::load_string(id, inst->m_game_short_name, MAX_NAME_STRING); }
 
 		static HICON game_icon() { return inst->m_game_icon; }
 		static void set_game_icon(int id) { inst->m_game_icon = ResourceManager::load_icon(id); }
 
-		static WCHAR* game_boot_time() { return inst->m_game_boot_time; }
-
-		static WCHAR* SplashURL() { return inst->m_splashURL; }
 		static void SetSplashURL(int id) { ResourceManager::load_string(id, inst->m_splashURL, MAX_NAME_STRING); }
+#endif
 
 		static bool UseWARP() { return inst->m_useWARP; }
 		static void SetUseWARP(bool useWARP) { inst->m_useWARP = useWARP; }
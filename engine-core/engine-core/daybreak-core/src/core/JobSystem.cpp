@@ -0,0 +1,336 @@
+#include "daybreak.h"
+#include "JobSystem.h"
+
+#include "common/MPMCQueue.h"
+#include "common/WorkStealingDeque.h"
+
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <thread>
+
+namespace jobs {
+
+	struct Job {
+		std::function<void()>	Work;
+		Counter*				Completion;
+	};
+
+	struct Worker {
+		collection::WorkStealingDeque<Job>	Queue;
+		std::thread							Thread;
+	};
+
+	/*
+		Per-thread free list so steady-state job submission does not hit the heap.
+	*/
+	struct JobPool {
+		static const size_t MaxPooledJobs = 1024;
+
+		std::vector<Job*> FreeJobs;
+
+		~JobPool() {
+			for (Job* job : FreeJobs) {
+				delete job;
+			}
+		}
+	};
+
+	static const size_t InjectionQueueSize = 4096;
+	static const uint32_t SpinsBeforeSleep = 64;
+
+	static std::vector<std::unique_ptr<Worker>>		g_workers;
+	static std::unique_ptr<collection::MPMCQueue<Job*>>	g_injectedJobs;
+	static std::atomic_bool							g_running = false;
+
+	static std::atomic<uint32_t>	g_sleepingWorkers = 0;
+	static std::mutex				g_sleepMutex;
+	static std::condition_variable	g_sleepCV;
+
+	static thread_local int32_t		t_workerIndex = -1;
+	static thread_local JobPool		t_jobPool;
+
+	static Job* AllocateJob(std::function<void()> work, Counter* counter) {
+		Job* job;
+		if (t_jobPool.FreeJobs.empty()) {
+			job = new Job();
+		} else {
+			job = t_jobPool.FreeJobs.back();
+			t_jobPool.FreeJobs.pop_back();
+		}
+
+		job->Work = std::move(work);
+		job->Completion = counter;
+		return job;
+	}
+
+	static void FreeJob(Job* job) {
+		job->Work = nullptr;
+		if (t_jobPool.FreeJobs.size() < JobPool::MaxPooledJobs) {
+			t_jobPool.FreeJobs.push_back(job);
+		} else {
+			delete job;
+		}
+	}
+
+	static bool HasQueuedJobs() {
+		if (!g_injectedJobs->IsEmpty()) {
+			return true;
+		}
+		for (const auto& worker : g_workers) {
+			if (!worker->Queue.IsEmpty()) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	static void WakeWorker() {
+		// Pairs with the fence in WorkerThread: either the sleeper sees the new
+		// job, or we see it sleeping and wake it.
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (g_sleepingWorkers.load(std::memory_order_relaxed) > 0) {
+			{
+				std::lock_guard<std::mutex> lock(g_sleepMutex);
+			}
+			g_sleepCV.notify_one();
+		}
+	}
+
+	void JobSystem::Execute(Job* job) {
+		job->Work();
+
+		Counter* counter = job->Completion;
+		FreeJob(job);
+
+		if (counter) {
+			counter->Done();
+		}
+	}
+
+	void JobSystem::Submit(Job* job) {
+		if (!g_running) {
+			Execute(job);
+			return;
+		}
+
+		bool queued = t_workerIndex >= 0 && g_workers[t_workerIndex]->Queue.Push(job);
+		if (!queued) {
+			queued = g_injectedJobs->TryPush(std::move(job));
+		}
+
+		if (!queued) {
+			// Every queue is saturated -- make progress on the caller instead.
+			Execute(job);
+			return;
+		}
+		WakeWorker();
+	}
+
+	static Job* FindJob(int32_t workerIndex) {
+		Job* job = nullptr;
+		if (workerIndex >= 0) {
+			job = g_workers[workerIndex]->Queue.Pop();
+			if (job) {
+				return job;
+			}
+		}
+
+		if (g_injectedJobs->Pop(job)) {
+			return job;
+		}
+
+		uint32_t workerCount = static_cast<uint32_t>(g_workers.size());
+		uint32_t start = workerIndex >= 0 ? workerIndex + 1 : 0;
+		for (uint32_t i = 0; i < workerCount; i++) {
+			uint32_t victim = (start + i) % workerCount;
+			if (static_cast<int32_t>(victim) == workerIndex) {
+				continue;
+			}
+
+			job = g_workers[victim]->Queue.Steal();
+			if (job) {
+				return job;
+			}
+		}
+		return nullptr;
+	}
+
+	void JobSystem::WorkerThread(uint32_t workerIndex) {
+		t_workerIndex = static_cast<int32_t>(workerIndex);
+		Profiler::SetThreadName(("Worker " + std::to_string(workerIndex)).c_str());
+		uint32_t idleSpins = 0;
+
+		while (g_running.load(std::memory_order_acquire)) {
+			Job* job = FindJob(t_workerIndex);
+			if (job) {
+				Execute(job);
+				idleSpins = 0;
+				continue;
+			}
+
+			if (++idleSpins < SpinsBeforeSleep) {
+				std::this_thread::yield();
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(g_sleepMutex);
+			g_sleepingWorkers.fetch_add(1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (!HasQueuedJobs()) {
+				g_sleepCV.wait_for(lock, std::chrono::milliseconds(10));
+			}
+			g_sleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+			idleSpins = 0;
+		}
+	}
+
+	Counter::Counter() :
+		m_pending(0),
+		m_finishing(0) {
+	}
+
+	Counter::~Counter() {
+		assert(IsDone() && "Counter destroyed with jobs still pending.");
+	}
+
+	void Counter::Add(int32_t count) {
+		m_pending.fetch_add(count, std::memory_order_relaxed);
+	}
+
+	void Counter::Done() {
+		// m_finishing is raised before pending can reach zero and dropped as the
+		// very last access, so Wait() cannot return (and the owner cannot destroy
+		// the counter) while this is still using it.
+		m_finishing.fetch_add(1, std::memory_order_relaxed);
+		if (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			std::vector<Job*> continuations;
+			{
+				std::lock_guard<std::mutex> lock(m_continuationMutex);
+				continuations.swap(m_continuations);
+			}
+			for (Job* job : continuations) {
+				JobSystem::Submit(job);
+			}
+		}
+		m_finishing.fetch_sub(1, std::memory_order_release);
+	}
+
+	void Counter::AddContinuation(Job* job) {
+		{
+			std::lock_guard<std::mutex> lock(m_continuationMutex);
+			if (m_pending.load(std::memory_order_acquire) != 0) {
+				m_continuations.push_back(job);
+				return;
+			}
+		}
+		JobSystem::Submit(job);
+	}
+
+	void JobSystem::Initialize(uint32_t workerCount) {
+		if (g_running) {
+			return;
+		}
+
+		if (workerCount == 0) {
+			uint32_t hardwareThreads = std::thread::hardware_concurrency();
+			workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+		}
+
+		g_injectedJobs = std::make_unique<collection::MPMCQueue<Job*>>(InjectionQueueSize);
+		g_workers.clear();
+		for (uint32_t i = 0; i <= workerCount; i++) {
+			g_workers.push_back(std::make_unique<Worker>());
+		}
+
+		// The calling thread becomes worker 0 and helps out from Wait().
+		t_workerIndex = 0;
+		g_running = true;
+		for (uint32_t i = 1; i <= workerCount; i++) {
+			g_workers[i]->Thread = std::thread(&JobSystem::WorkerThread, i);
+		}
+	}
+
+	void JobSystem::Shutdown() {
+		if (!g_running) {
+			return;
+		}
+
+		g_running = false;
+		{
+			std::lock_guard<std::mutex> lock(g_sleepMutex);
+		}
+		g_sleepCV.notify_all();
+
+		for (size_t i = 1; i < g_workers.size(); i++) {
+			g_workers[i]->Thread.join();
+		}
+
+		// Anything still queued runs here so its counters drain.
+		while (Job* job = FindJob(0)) {
+			Execute(job);
+		}
+
+		g_workers.clear();
+		g_injectedJobs.reset();
+		t_workerIndex = -1;
+	}
+
+	bool JobSystem::IsInitialized() {
+		return g_running;
+	}
+
+	void JobSystem::Run(std::function<void()> work, Counter* counter) {
+		if (counter) {
+			counter->Add(1);
+		}
+		Submit(AllocateJob(std::move(work), counter));
+	}
+
+	void JobSystem::RunAfter(Counter& dependency, std::function<void()> work, Counter* counter) {
+		if (counter) {
+			counter->Add(1);
+		}
+		dependency.AddContinuation(AllocateJob(std::move(work), counter));
+	}
+
+	void JobSystem::Wait(Counter& counter) {
+		while (!counter.IsDone()) {
+			Job* job = g_running ? FindJob(t_workerIndex) : nullptr;
+			if (job) {
+				Execute(job);
+			} else {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	void JobSystem::ParallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& body) {
+		if (count == 0) {
+			return;
+		}
+
+		if (grainSize == 0) {
+			grainSize = std::max<size_t>(1, count / (static_cast<size_t>(ThreadCount()) * 4));
+		}
+
+		if (!g_running || count <= grainSize) {
+			body(0, count);
+			return;
+		}
+
+		Counter counter;
+		for (size_t begin = grainSize; begin < count; begin += grainSize) {
+			size_t end = std::min(begin + grainSize, count);
+			Run([&body, begin, end] { body(begin, end); }, &counter);
+		}
+
+		// The first chunk runs on the caller before it starts helping.
+		body(0, grainSize);
+		Wait(counter);
+	}
+
+	uint32_t JobSystem::ThreadCount() {
+		return g_running ? static_cast<uint32_t>(g_workers.size()) : 1;
+	}
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace jobs {
+
+	struct Job;
+
+	/*
+		Tracks a group of outstanding jobs. Run() increments it and each job
+		decrements it on completion; Wait() returns once it reaches zero. Jobs
+		queued with RunAfter() are held back until the counter they depend on
+		drains.
+	*/
+	class DAYBREAK_API Counter {
+		public:
+			Counter();
+			~Counter();
+
+			Counter(const Counter& copy) = delete;
+			Counter& operator=(const Counter& other) = delete;
+
+			/*
+				Pending reaches zero before the last Done() has finished with the
+				counter (it still has continuations to hand off), so a counter only
+				counts as done once no Done() is in flight. Until then a waiter
+				must not return and free it.
+			*/
+			bool IsDone() const {
+				return m_pending.load(std::memory_order_acquire) == 0 && m_finishing.load(std::memory_order_acquire) == 0;
+			}
+
+		private:
+			friend class JobSystem;
+
+			void Add(int32_t count);
+			void Done();
+			void AddContinuation(Job* job);
+
+			std::atomic<int32_t>	m_pending;
+			std::atomic<int32_t>	m_finishing;
+			std::mutex				m_continuationMutex;
+			std::vector<Job*>		m_continuations;
+	};
+
+	/*
+		Work-stealing job scheduler. Every worker owns a Chase-Lev deque: it pushes
+		and pops its own jobs LIFO and steals from the other workers FIFO when it
+		runs dry. The thread that calls Initialize() (the main thread) owns deque 0
+		and runs jobs whenever it waits on a counter. Jobs submitted from threads
+		outside the pool go through a shared MPMC injection queue.
+
+		Only the standard library is used, so the scheduler builds on any platform.
+	*/
+	class DAYBREAK_API JobSystem {
+		public:
+			/*
+				Starts workerCount background workers; 0 picks one per hardware thread
+				minus the calling thread.
+			*/
+			static void Initialize(uint32_t workerCount = 0);
+			static void Shutdown();
+			static bool IsInitialized();
+
+			static void Run(std::function<void()> work, Counter* counter = nullptr);
+
+			/*
+				Queues work to start only after dependency has drained. counter (if
+				given) is incremented immediately.
+			*/
+			static void RunAfter(Counter& dependency, std::function<void()> work, Counter* counter = nullptr);
+
+			/*
+				Blocks until counter reaches zero, executing queued jobs meanwhile.
+			*/
+			static void Wait(Counter& counter);
+
+			/*
+				Splits [0, count) into chunks of at most grainSize and runs body(begin,
+				end) on each, returning when every chunk is finished. grainSize 0 picks
+				a size that gives each thread a few chunks to balance with.
+			*/
+			static void ParallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& body);
+
+			// Number of threads executing jobs, including the main thread.
+			static uint32_t ThreadCount();
+
+		private:
+			friend class Counter;
+
+			static void Submit(Job* job);
+			static void Execute(Job* job);
+			static void WorkerThread(uint32_t workerIndex);
+	};
+}
@@ -18,6 +18,14 @@
 	#pragma comment(lib, "dxguid.lib")
 	#pragma comment(lib, "d3dcompiler.lib")
 
+	#include <assimp/Importer.hpp>
+	#include <assimp/scene.h>
+	#include <assimp/postprocess.h>
+	#pragma comment(lib, "assimp-vc143-mtd.lib")
+#else
+	// Headless builds: POSIX stand-ins for the Win32/MSVC CRT calls the
+	// platform-neutral code uses.
+	#include "platform/posix/PosixCompat.h"
 #endif
 
 #include <string>
@@ -33,10 +41,9 @@
 #include <functional>
 #include <locale>
 #include <codecvt>
-
-#include <assimp/Importer.hpp>
-#include <assimp/scene.h>
-#include <assimp/postprocess.h>
-#pragma comment(lib, "assimp-vc143-mtd.lib")
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 #include "core/Core.h"
\ No newline at end of file
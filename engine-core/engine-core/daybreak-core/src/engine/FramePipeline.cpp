@@ -0,0 +1,120 @@
+#include "daybreak.h"
+#include "FramePipeline.h"
+
+namespace Daybreak {
+
+	using Clock = std::chrono::high_resolution_clock;
+
+	FramePipeline::FramePipeline(RenderFunc render) :
+		m_render(std::move(render)),
+		m_packets(),
+		m_updateFrame(0),
+		m_published(0),
+		m_rendered(0),
+		m_running(true),
+		m_updateMs(0.0),
+		m_updateWaitMs(0.0),
+		m_renderMs(0.0),
+		m_renderWaitMs(0.0),
+		m_handoffMs(0.0) {
+		m_thread = std::thread(&FramePipeline::RenderThread, this);
+	}
+
+	FramePipeline::~FramePipeline() {
+		Drain();
+
+		// Wake the render thread with a frame it will see it must not render.
+		m_running.store(false, std::memory_order_release);
+		m_published.fetch_add(1, std::memory_order_release);
+		m_published.notify_all();
+		m_thread.join();
+	}
+
+	uint32_t FramePipeline::BeginUpdate() {
+		auto waitStart = Clock::now();
+
+		// Frame f reuses the slot of frame f - SnapshotCount; wait for it to be rendered.
+		if (m_updateFrame >= SnapshotCount) {
+			uint64_t required = m_updateFrame - SnapshotCount + 1;
+			uint64_t rendered = m_rendered.load(std::memory_order_acquire);
+			while (rendered < required) {
+				m_rendered.wait(rendered, std::memory_order_acquire);
+				rendered = m_rendered.load(std::memory_order_acquire);
+			}
+		}
+
+		m_updateStart = Clock::now();
+		Store(m_updateWaitMs, m_updateStart - waitStart);
+		return static_cast<uint32_t>(m_updateFrame % SnapshotCount);
+	}
+
+	void FramePipeline::EndUpdate(double alpha) {
+		auto now = Clock::now();
+		Store(m_updateMs, now - m_updateStart);
+
+		Packet& packet = m_packets[m_updateFrame % SnapshotCount];
+		packet.Frame = m_updateFrame;
+		packet.Snapshot = static_cast<uint32_t>(m_updateFrame % SnapshotCount);
+		packet.Alpha = alpha;
+		packet.PublishTime = now;
+
+		m_updateFrame++;
+		m_published.store(m_updateFrame, std::memory_order_release);
+		m_published.notify_one();
+	}
+
+	void FramePipeline::Drain() {
+		uint64_t rendered = m_rendered.load(std::memory_order_acquire);
+		while (rendered < m_updateFrame) {
+			m_rendered.wait(rendered, std::memory_order_acquire);
+			rendered = m_rendered.load(std::memory_order_acquire);
+		}
+	}
+
+	FramePipeline::Statistics FramePipeline::Stats() const {
+		Statistics stats;
+		stats.FramesRendered = m_rendered.load(std::memory_order_relaxed);
+		stats.UpdateMs = m_updateMs.load(std::memory_order_relaxed);
+		stats.UpdateWaitMs = m_updateWaitMs.load(std::memory_order_relaxed);
+		stats.RenderMs = m_renderMs.load(std::memory_order_relaxed);
+		stats.RenderWaitMs = m_renderWaitMs.load(std::memory_order_relaxed);
+		stats.HandoffMs = m_handoffMs.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	void FramePipeline::RenderThread() {
+		Profiler::SetThreadName("Render");
+		uint64_t frame = 0;
+
+		for (;;) {
+			auto waitStart = Clock::now();
+			uint64_t published = m_published.load(std::memory_order_acquire);
+			while (published == frame) {
+				m_published.wait(published, std::memory_order_acquire);
+				published = m_published.load(std::memory_order_acquire);
+			}
+			if (!m_running.load(std::memory_order_acquire)) {
+				break;
+			}
+
+			auto renderStart = Clock::now();
+			Store(m_renderWaitMs, renderStart - waitStart);
+
+			const Packet& packet = m_packets[frame % SnapshotCount];
+			Store(m_handoffMs, renderStart - packet.PublishTime);
+			{
+				PROFILE_SCOPE("Simulation::Render");
+				m_render(packet);
+			}
+			Store(m_renderMs, Clock::now() - renderStart);
+
+			frame++;
+			m_rendered.store(frame, std::memory_order_release);
+			m_rendered.notify_all();
+		}
+	}
+
+	void FramePipeline::Store(std::atomic<double>& stat, Clock::duration duration) {
+		stat.store(std::chrono::duration<double, std::milli>(duration).count(), std::memory_order_relaxed);
+	}
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+
+namespace Daybreak {
+
+	/*
+		Two-stage update/render pipeline. The game thread updates frame N+1 while
+		a dedicated render thread records and submits frame N.
+
+		Render state is double-buffered by the game: frame f owns snapshot slot
+		f % SnapshotCount. BeginUpdate() hands out the slot for the next frame
+		once the render thread has finished reading it, and EndUpdate() publishes
+		the frame. From then on the slot is read-only until the render thread is
+		done with it. The handoff is two atomic counters (frames published and
+		frames rendered) plus a packet per slot; no locks are taken. Blocking
+		uses atomic wait/notify.
+
+		Per-stage timings show which side is the bottleneck. A stage that is
+		always waiting on the other one is not it.
+	*/
+	class DAYBREAK_API FramePipeline {
+		public:
+			static const uint32_t SnapshotCount = 2;
+
+			struct Packet {
+				uint64_t										Frame;
+				uint32_t										Snapshot;
+				double											Alpha;
+				std::chrono::high_resolution_clock::time_point	PublishTime;
+			};
+
+			struct Statistics {
+				uint64_t	FramesRendered;
+				double		UpdateMs;
+				double		UpdateWaitMs;
+				double		RenderMs;
+				double		RenderWaitMs;
+				double		HandoffMs;		// Publish to the render thread picking the frame up.
+			};
+
+			using RenderFunc = std::function<void(const Packet& packet)>;
+
+			FramePipeline(RenderFunc render);
+			~FramePipeline();
+
+			FramePipeline(const FramePipeline& copy) = delete;
+			FramePipeline& operator=(const FramePipeline& other) = delete;
+
+			/*
+				Game thread. Blocks until the slot for the next frame is free and
+				returns it.
+			*/
+			uint32_t BeginUpdate();
+
+			/*
+				Game thread. Publishes the frame started by BeginUpdate(), along with
+				its interpolation alpha.
+			*/
+			void EndUpdate(double alpha = 1.0);
+
+			/*
+				Blocks until every published frame has been rendered. The render
+				thread stays idle until the next EndUpdate(), so the caller may touch
+				render state (e.g. to resize).
+			*/
+			void Drain();
+
+			Statistics Stats() const;
+
+		private:
+			void RenderThread();
+			static void Store(std::atomic<double>& stat, std::chrono::high_resolution_clock::duration duration);
+
+			RenderFunc					m_render;
+			Packet						m_packets[SnapshotCount];
+
+			// Game thread only.
+			uint64_t					m_updateFrame;
+			std::chrono::high_resolution_clock::time_point	m_updateStart;
+
+			alignas(64) std::atomic<uint64_t>	m_published;
+			alignas(64) std::atomic<uint64_t>	m_rendered;
+			std::atomic<bool>					m_running;
+
+			std::atomic<double>			m_updateMs;
+			std::atomic<double>			m_updateWaitMs;
+			std::atomic<double>			m_renderMs;
+			std::atomic<double>			m_renderWaitMs;
+			std::atomic<double>			m_handoffMs;
+
+			std::thread					m_thread;
+	};
+}
@@ -1,16 +1,31 @@
 #include "daybreak.h"
 #include "Simulation.h"
-#include "engine/window/SplashScreen.h"
 #include "engine/manager/FPSCounter.h"
-#include "platform/dx12/CommandList.h"
+
+#ifdef WIN32
+	#include "engine/window/SplashScreen.h"
+	#include "platform/dx12/CommandList.h"
+	#include "input/InputManager.h"
+#endif
 
 namespace Daybreak {
 	
-	Simulation::Simulation()
-		: win32::Window(L"MainApplication", nullptr),
-		m_clock() {
-		m_currentUpdate = { 0, 0.0f, 0.0f, m_clock.now() };
+	Simulation::Simulation() :
+#ifdef WIN32
+		win32::Window(L"MainApplication", nullptr),
+#endif
+		m_clock(),
+		m_frame(0),
+		m_tickSeconds(0.0),
+		m_maxTicksPerFrame(8),
+		m_accumulator(0.0),
+		m_droppedTicks(0),
+		m_headless(false),
+		m_stopRequested(false) {
+		m_currentUpdate = { 0, 0.0f, 0.0f, m_clock.now(), 0, 0, 0.0, 0.0 };
+#ifdef WIN32
 		SetSize(DEFAULT_WIDTH, DEFAULT_HEIGHT);
+#endif
 	}
 
 	Simulation::~Simulation() {
@@ -21,15 +36,19 @@ namespace Daybreak {
 		Logger::info(L"Boot Time:\t%s\n", Time::get_datetime().c_str());
 		Logger::info(L"Engine Mode:\t%s\n", Engine::ModeToString().c_str());
 		Logger::info(L"Current Path:\t%s\n", GameSettings::CurrentPath().c_str());
-		
-		// Load
-		Logger::info(L"Registering Simulation window...\n");
-		win32::Window::RegisterNewClass();
-		win32::Window::Build();
-		Logger::info(L"Registering Metrics window...\n");
-		
-		Logger::info(L"Initializing DX12 context...\n");
-		dx12::Application::CreateApplication(L"MainApplication", DEFAULT_WIDTH, DEFAULT_HEIGHT, Handle());
+
+#ifdef WIN32
+		if (!m_headless) {
+			// Load
+			Logger::info(L"Registering Simulation window...\n");
+			win32::Window::RegisterNewClass();
+			win32::Window::Build();
+			Logger::info(L"Registering Metrics window...\n");
+
+			Logger::info(L"Initializing DX12 context...\n");
+			dx12::Application::CreateApplication(L"MainApplication", DEFAULT_WIDTH, DEFAULT_HEIGHT, Handle());
+		}
+#endif
 
 		// End Load
 		Logger::log_debug_seperator();
@@ -38,9 +57,15 @@ namespace Daybreak {
 	void Simulation::Update() { }
 
 	void Simulation::Teardown() {
-		dx12::Application::DestroyApplication();
+		m_pipeline.reset();
+#ifdef WIN32
+		if (dx12::Application::IsInitialized()) {
+			dx12::Application::DestroyApplication();
+		}
+#endif
 	}
 
+#ifdef WIN32
 
 	LRESULT Simulation::MessageHandler(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam) {
 		Logger::debug(L"Simulation Handler: %d\n", message);
@@ -64,17 +89,95 @@ namespace Daybreak {
 			client.bottom - client.top
 		};
 
+		input::Event resize = {};
+		resize.Type = input::EventType::Resize;
+		resize.TimeUs = input::Timestamp();
+		resize.X = event.newWidth;
+		resize.Y = event.newHeight;
+		InputManagerFactory::create().events().Push(resize);
+
+		if (m_pipeline) {
+			m_pipeline->Drain();
+		}
+
 		dx12::Application::Get()->Resize(event.newWidth, event.newHeight);
 		OnResize(event);
 	}
-	
+
+#endif
+
 	void Simulation::Tick() {
-		
-		// Update
+		Profiler::BeginFrame();
+		PROFILE_SCOPE("Simulation::Tick");
+
+		double deltaSeconds = AdvanceClock();
+		if (!m_pipeline) {
+			m_currentUpdate.snapshot = 0;
+			double alpha = RunUpdates(deltaSeconds);
+			OnSnapshot(m_currentUpdate);
+			{
+				PROFILE_SCOPE("Simulation::Render");
+				OnRender({ m_frame++, 0, alpha });
+			}
+			EndFrame(deltaSeconds);
+			return;
+		}
+
+		// Render happens on the pipeline's thread once the update is published.
+		m_currentUpdate.snapshot = m_pipeline->BeginUpdate();
+		double alpha = RunUpdates(deltaSeconds);
+		OnSnapshot(m_currentUpdate);
+		m_pipeline->EndUpdate(alpha);
+		m_frame++;
+		EndFrame(deltaSeconds);
+	}
+
+	void Simulation::RunHeadless(double ticksPerSecond) {
+		m_headless = true;
+
+		PreInitialize();
+		Logger::info(L"[GAME STARTUP] Game Initialization...\n");
+		Initialize();
+		Logger::log_debug_seperator();
+
+		// Nothing renders, so there is no render thread to feed.
+		m_pipeline.reset();
+
+		if (ticksPerSecond > 0.0) {
+			SetFixedTimestep(ticksPerSecond, m_maxTicksPerFrame);
+		} else if (m_tickSeconds <= 0.0) {
+			SetFixedTimestep(DefaultServerTickRate, m_maxTicksPerFrame);
+		}
+		Logger::info(L"Running headless at %.1f ticks per second\n", 1.0 / m_tickSeconds);
+
+		using Clock = std::chrono::high_resolution_clock;
+		m_currentUpdate.lastUpdate = m_clock.now();
+		while (!m_stopRequested.load(std::memory_order_acquire)) {
+			Profiler::BeginFrame();
+			{
+				PROFILE_SCOPE("Simulation::Tick");
+				double deltaSeconds = AdvanceClock();
+				RunUpdates(deltaSeconds);
+				m_frame++;
+				EndFrame(deltaSeconds);
+			}
+
+			// Sleep until the next tick is due. Oversleeping is not lost: the extra
+			// time is in the accumulator on the next pass.
+			auto untilNextTick = std::chrono::duration<double>(m_tickSeconds - m_accumulator);
+			std::this_thread::sleep_until(m_currentUpdate.lastUpdate + std::chrono::duration_cast<Clock::duration>(untilNextTick));
+		}
+
+		Logger::info(L"Headless loop stopped after %llu ticks (%llu dropped)\n",
+			static_cast<unsigned long long>(m_currentUpdate.tick), static_cast<unsigned long long>(m_droppedTicks));
+	}
+
+	double Simulation::AdvanceClock() {
 		auto nowTime = m_clock.now();
 		auto delta = nowTime - m_currentUpdate.lastUpdate;
+		double deltaSeconds = std::chrono::duration<double>(delta).count();
 
-		m_currentUpdate.elapsedSeconds += (delta.count() * 1e-9);
+		m_currentUpdate.elapsedSeconds += deltaSeconds;
 		m_currentUpdate.frameCounter += 1;
 		m_currentUpdate.lastUpdate = nowTime;
 
@@ -89,10 +192,68 @@ namespace Daybreak {
 			m_currentUpdate.frameCounter = 0;
 			m_currentUpdate.elapsedSeconds = 0.0f;
 		}
-		OnUpdate(m_currentUpdate);
+		return deltaSeconds;
+	}
+
+	void Simulation::SetFixedTimestep(double ticksPerSecond, uint32_t maxTicksPerFrame) {
+		m_tickSeconds = ticksPerSecond > 0.0 ? 1.0 / ticksPerSecond : 0.0;
+		m_maxTicksPerFrame = std::max(maxTicksPerFrame, 1u);
+		m_accumulator = 0.0;
+	}
+
+	void Simulation::EndFrame(double deltaSeconds) {
+		double cpuMs = std::chrono::duration<double, std::milli>(m_clock.now() - m_currentUpdate.lastUpdate).count();
+		FPSCounter::RecordFrame(cpuMs, deltaSeconds * 1000.0);
+	}
+
+	double Simulation::RunUpdates(double frameSeconds) {
+		PROFILE_SCOPE("Simulation::Update");
+
+		if (m_tickSeconds <= 0.0) {
+			m_currentUpdate.tick++;
+			m_currentUpdate.deltaSeconds = frameSeconds;
+			m_currentUpdate.simulationTime += frameSeconds;
+			OnUpdate(m_currentUpdate);
+			return 1.0;
+		}
+
+		m_accumulator += frameSeconds;
+
+		// Spiral-of-death guard: if ticks cost more than they simulate, catching
+		// up only makes the next frame longer. Drop what can't be run this frame.
+		double maxAccumulated = m_tickSeconds * m_maxTicksPerFrame;
+		if (m_accumulator > maxAccumulated) {
+			m_droppedTicks += static_cast<uint64_t>((m_accumulator - maxAccumulated) / m_tickSeconds);
+			m_accumulator = maxAccumulated;
+		}
+
+		m_currentUpdate.deltaSeconds = m_tickSeconds;
+		while (m_accumulator >= m_tickSeconds) {
+			m_accumulator -= m_tickSeconds;
+			m_currentUpdate.tick++;
+			m_currentUpdate.simulationTime += m_tickSeconds;
+			OnUpdate(m_currentUpdate);
+		}
+
+		return m_accumulator / m_tickSeconds;
+	}
+
+	void Simulation::SetPipelined(bool pipelined) {
+		if (pipelined == IsPipelined()) {
+			return;
+		}
+
+		if (pipelined) {
+			m_pipeline = std::make_unique<FramePipeline>([this](const FramePipeline::Packet& packet) {
+				OnRender({ packet.Frame, packet.Snapshot, packet.Alpha });
+			});
+		} else {
+			m_pipeline.reset();
+		}
+	}
 
-		// Render
-		OnRender({});
+	FramePipeline::Statistics Simulation::PipelineStats() const {
+		return m_pipeline ? m_pipeline->Stats() : FramePipeline::Statistics{};
 	}
 }
 
@@ -1,8 +1,14 @@
 #pragma once
 
+#include "FramePipeline.h"
+
 namespace Daybreak {
 
+#ifdef WIN32
 	class DAYBREAK_API Simulation : public win32::IApplication, public win32::Window {
+#else
+	class DAYBREAK_API Simulation : public win32::IApplication {
+#endif
 
 		public:
 			struct UpdateEvent {
@@ -10,6 +16,10 @@ namespace Daybreak {
 				double											totalTime;
 				double											elapsedSeconds;
 				std::chrono::high_resolution_clock::time_point	lastUpdate;
+				uint32_t										snapshot;	// Render state slot this update writes.
+				uint64_t										tick;
+				double											deltaSeconds;	// Fixed when a tick rate is set.
+				double											simulationTime;
 			};
 
 			struct ResizeEvent {
@@ -18,7 +28,9 @@ namespace Daybreak {
 			};
 
 			struct RenderEvent {
-
+				uint64_t	frame;
+				uint32_t	snapshot;	// Render state slot to read; immutable while rendering.
+				double		alpha;		// Blend from the previous tick's state (0) to the latest (1).
 			};
 
 			Simulation();
@@ -30,20 +42,91 @@ namespace Daybreak {
 			virtual void Update() override;
 			virtual void Teardown() override;
 
+#ifdef WIN32
 			virtual LRESULT MessageHandler(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam) override;
+#endif
 	
 			virtual void OnUpdate(UpdateEvent event) = 0;
 			virtual void OnRender(RenderEvent event) = 0;
 			virtual void OnResize(ResizeEvent event) = 0;
 
+			/*
+				Called once per frame after the frame's updates (which may be zero or
+				several with a fixed timestep) to copy render state into the event's
+				snapshot slot.
+			*/
+			virtual void OnSnapshot(UpdateEvent) {}
+
+			/*
+				Runs OnUpdate at a fixed rate of ticksPerSecond, as many times per
+				frame as real time requires, and hands OnRender the fraction of a tick
+				left over. At most maxTicksPerFrame run per frame; time beyond that
+				is dropped rather than caught up, so a slow frame cannot snowball.
+				0 goes back to one variable-length update per frame.
+			*/
+			void SetFixedTimestep(double ticksPerSecond, uint32_t maxTicksPerFrame = 8);
+			double TickSeconds() const { return m_tickSeconds; }
+			uint64_t DroppedTicks() const { return m_droppedTicks; }
+
+			/*
+				Runs OnRender on a dedicated render thread, one frame behind OnUpdate.
+				Games that enable it must keep render state in FramePipeline::
+				SnapshotCount slots, write it in OnSnapshot and only touch the slot
+				named by the event.
+				OnResize is called with the render thread idle.
+			*/
+			void SetPipelined(bool pipelined);
+			bool IsPipelined() const { return m_pipeline != nullptr; }
+			FramePipeline::Statistics PipelineStats() const;
+
+			static constexpr double DefaultServerTickRate = 30.0;
+
+			/*
+				Runs the game with no window, swap chain or D3D device: PreInitialize,
+				Initialize, then OnUpdate on a fixed timestep until RequestStop().
+				Between ticks the thread sleeps until the next one is due rather than
+				spinning. ticksPerSecond overrides the rate the game set; if neither
+				sets one, DefaultServerTickRate is used. OnSnapshot and OnRender are
+				never called.
+			*/
+			void RunHeadless(double ticksPerSecond = 0.0);
+
+			// Safe to call from any thread or a signal handler.
+			void RequestStop() { m_stopRequested.store(true, std::memory_order_release); }
+			bool IsHeadless() const { return m_headless; }
+
 		private:
+#ifdef WIN32
 			std::vector<Window*>				m_windows;
+#endif
 			std::chrono::high_resolution_clock	m_clock;
 
 			UpdateEvent							m_currentUpdate;
+			uint64_t							m_frame;
+			std::unique_ptr<FramePipeline>		m_pipeline;
+
+			// Fixed timestep; m_tickSeconds == 0 means variable.
+			double								m_tickSeconds;
+			uint32_t							m_maxTicksPerFrame;
+			double								m_accumulator;
+			uint64_t							m_droppedTicks;
 
+			bool								m_headless;
+			std::atomic<bool>					m_stopRequested;
+
+#ifdef WIN32
 			void Resize();
-			
+#endif
+			double AdvanceClock();
+			void EndFrame(double deltaSeconds);
+
+		protected:
+			/*
+				Advances the simulation by frameSeconds of real time: runs the
+				updates it covers and returns the render alpha. Tick() feeds it the
+				measured frame time; tests feed it fixed ones.
+			*/
+			double RunUpdates(double frameSeconds);
 	};
 }
 
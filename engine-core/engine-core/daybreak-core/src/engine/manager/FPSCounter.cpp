@@ -1,53 +1,194 @@
 #include "daybreak.h"
 #include "FPSCounter.h"
 
+#include <fstream>
+
 namespace FPSCounter {
 
-	double g_fps = 0.0f;
-	std::mutex g_fpsMutex;
+	std::atomic<double> g_fps = 0.0;
+	std::atomic<double> g_frameTime = 0.0;
+	std::atomic<double> g_totalTime = 0.0;
+	std::atomic<int> g_frameCount = 0;
+
+	// One slot per frame; every field is atomic so a racing reader never tears.
+	struct Slot {
+		std::atomic<uint64_t>	Frame;
+		std::atomic<float>		CpuMs;
+		std::atomic<float>		GpuMs;
+		std::atomic<float>		PresentMs;
+		std::atomic<bool>		Hitch;
+	};
 
-	double g_frameTime = 0.0f;
-	std::mutex g_frameTimeMutex;
+	static_assert((HistorySize & (HistorySize - 1)) == 0, "HistorySize must be a power of two");
 
-	double g_totalTime = 0.0f;
-	std::mutex g_totalTimeMutex;
+	static Slot g_history[HistorySize];
+	static std::atomic<uint64_t> g_head = 0;
+	static std::atomic<uint64_t> g_totalHitches = 0;
 
-	int g_frameCount = 0;
-	std::mutex g_frameCountMutex;
+	static std::atomic<double> g_latestGpuMs = 0.0;
+	static std::atomic<double> g_latestPresentMs = 0.0;
+
+	// Writer-only state.
+	static double g_averagePresentMs = 0.0;
 
 	void UpdateFPS(double fps) {
-		const std::lock_guard<std::mutex> lock(g_fpsMutex);
-		g_fps = fps;
+		g_fps.store(fps, std::memory_order_relaxed);
 	}
 
 	void UpdateFrameTime(double framTimeMs) {
-		const std::lock_guard<std::mutex> lock(g_frameTimeMutex);
-		g_frameTime = framTimeMs;
+		g_frameTime.store(framTimeMs, std::memory_order_relaxed);
 	}
 
 	void UpdateTotalTime(double totalTime) {
-		const std::lock_guard<std::mutex> lock(g_totalTimeMutex);
-		g_totalTime = totalTime;
+		g_totalTime.store(totalTime, std::memory_order_relaxed);
 	}
 
 	void UpdateFrameCount(int frameCount) {
-		const std::lock_guard<std::mutex> lock(g_frameCountMutex);
-		g_frameCount = frameCount;
+		g_frameCount.store(frameCount, std::memory_order_relaxed);
 	}
 
 	double FPS() {
-		return g_fps;
+		return g_fps.load(std::memory_order_relaxed);
 	}
 
 	double FrameTime() {
-		return g_frameTime;
+		return g_frameTime.load(std::memory_order_relaxed);
 	}
 
 	double TotalTime() {
-		return g_totalTime;
+		return g_totalTime.load(std::memory_order_relaxed);
 	}
 
 	int FrameCount() {
-		return g_frameCount;
+		return g_frameCount.load(std::memory_order_relaxed);
+	}
+
+	void RecordFrame(double cpuMs, double frameIntervalMs) {
+		double presentMs = g_latestPresentMs.exchange(0.0, std::memory_order_relaxed);
+		if (presentMs <= 0.0) {
+			presentMs = frameIntervalMs;
+		}
+
+		// Warm up the average before judging hitches against it.
+		uint64_t frame = g_head.load(std::memory_order_relaxed);
+		bool hitch = frame >= 16 && presentMs > g_averagePresentMs * HitchFactor;
+		g_averagePresentMs = frame == 0 ? presentMs : g_averagePresentMs * 0.95 + presentMs * 0.05;
+		if (hitch) {
+			g_totalHitches.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		// Readers that see any of the stores below also see that this slot is
+		// being rewritten (see CopySamples).
+		std::atomic_thread_fence(std::memory_order_release);
+
+		Slot& slot = g_history[frame & (HistorySize - 1)];
+		slot.Frame.store(frame, std::memory_order_relaxed);
+		slot.CpuMs.store(static_cast<float>(cpuMs), std::memory_order_relaxed);
+		slot.GpuMs.store(static_cast<float>(g_latestGpuMs.load(std::memory_order_relaxed)), std::memory_order_relaxed);
+		slot.PresentMs.store(static_cast<float>(presentMs), std::memory_order_relaxed);
+		slot.Hitch.store(hitch, std::memory_order_relaxed);
+
+		g_head.store(frame + 1, std::memory_order_release);
+		UpdateFrameTime(presentMs);
+	}
+
+	void RecordGpuTime(double gpuMs) {
+		g_latestGpuMs.store(gpuMs, std::memory_order_relaxed);
+	}
+
+	void RecordPresentInterval(double presentMs) {
+		g_latestPresentMs.store(presentMs, std::memory_order_relaxed);
+	}
+
+	size_t CopySamples(FrameSample* samples, size_t maxCount) {
+		uint64_t head = g_head.load(std::memory_order_acquire);
+		uint64_t count = std::min<uint64_t>({ maxCount, head, HistorySize });
+		uint64_t first = head - count;
+
+		for (uint64_t i = 0; i < count; i++) {
+			const Slot& slot = g_history[(first + i) & (HistorySize - 1)];
+			FrameSample& sample = samples[i];
+			sample.Frame = slot.Frame.load(std::memory_order_relaxed);
+			sample.CpuMs = slot.CpuMs.load(std::memory_order_relaxed);
+			sample.GpuMs = slot.GpuMs.load(std::memory_order_relaxed);
+			sample.PresentMs = slot.PresentMs.load(std::memory_order_relaxed);
+			sample.Hitch = slot.Hitch.load(std::memory_order_relaxed);
+		}
+
+		// Slots the writer has started on since head was read are suspect: frame
+		// h is written into the slot of h - HistorySize before head moves past h.
+		std::atomic_thread_fence(std::memory_order_acquire);
+		uint64_t newHead = g_head.load(std::memory_order_relaxed);
+		uint64_t valid = newHead >= HistorySize ? newHead - HistorySize + 1 : 0;
+		if (valid <= first) {
+			return static_cast<size_t>(count);
+		}
+
+		uint64_t skipped = std::min(valid - first, count);
+		std::move(samples + skipped, samples + count, samples);
+		return static_cast<size_t>(count - skipped);
+	}
+
+	static Percentiles ComputePercentiles(std::vector<float>& values) {
+		Percentiles result = {};
+		if (values.empty()) {
+			return result;
+		}
+
+		auto at = [&values](double percentile) {
+			size_t index = std::min(values.size() - 1, static_cast<size_t>(percentile * values.size()));
+			std::nth_element(values.begin(), values.begin() + index, values.end());
+			return values[index];
+		};
+
+		result.P50 = at(0.50);
+		result.P95 = at(0.95);
+		result.P99 = at(0.99);
+		result.Max = *std::max_element(values.begin(), values.end());
+		return result;
+	}
+
+	FrameStatistics Statistics(size_t window) {
+		std::vector<FrameSample> samples(std::min(window, HistorySize));
+		samples.resize(CopySamples(samples.data(), samples.size()));
+
+		FrameStatistics stats = {};
+		stats.Frames = g_head.load(std::memory_order_relaxed);
+		stats.Samples = static_cast<uint32_t>(samples.size());
+		stats.TotalHitches = g_totalHitches.load(std::memory_order_relaxed);
+
+		std::vector<float> cpu, gpu, present;
+		cpu.reserve(samples.size());
+		gpu.reserve(samples.size());
+		present.reserve(samples.size());
+		for (const FrameSample& sample : samples) {
+			cpu.push_back(sample.CpuMs);
+			present.push_back(sample.PresentMs);
+			if (sample.GpuMs > 0.0f) {
+				gpu.push_back(sample.GpuMs);
+			}
+			stats.Hitches += sample.Hitch ? 1 : 0;
+		}
+
+		stats.Cpu = ComputePercentiles(cpu);
+		stats.Gpu = ComputePercentiles(gpu);
+		stats.Present = ComputePercentiles(present);
+		return stats;
+	}
+
+	bool ExportCSV(const std::wstring& path) {
+		std::vector<FrameSample> samples(HistorySize);
+		samples.resize(CopySamples(samples.data(), samples.size()));
+
+		std::ofstream file(std::filesystem::path(path), std::ios_base::trunc);
+		if (!file.is_open()) {
+			return false;
+		}
+
+		file << "frame,cpu_ms,gpu_ms,present_ms,hitch\n";
+		for (const FrameSample& sample : samples) {
+			file << sample.Frame << ',' << sample.CpuMs << ',' << sample.GpuMs << ',' << sample.PresentMs << ',' << (sample.Hitch ? 1 : 0) << '\n';
+		}
+		return true;
 	}
-}
\ No newline at end of file
+}
@@ -1,7 +1,47 @@
 #pragma once
 
+#include <cstdint>
+#include <string>
+
+/*
+	Frame telemetry. The game thread records one sample per frame into a
+	lock-free ring of the last HistorySize frames; any thread (MetricsWindow,
+	an exporter) can copy the ring and compute percentiles without taking a
+	lock or stalling the writer. A reader that is lapped while copying simply
+	drops the samples that were overwritten.
+*/
 namespace FPSCounter {
 
+	static const size_t HistorySize = 1024;
+
+	// A frame whose present interval exceeds HitchFactor times the running average is a hitch.
+	static constexpr double HitchFactor = 2.0;
+
+	struct FrameSample {
+		uint64_t	Frame;
+		float		CpuMs;		// Game thread time spent on the frame.
+		float		GpuMs;		// Latest measured GPU frame time; lags by the frames in flight. 0 if unknown.
+		float		PresentMs;	// Interval between presents, or between frames when nothing presents.
+		bool		Hitch;
+	};
+
+	struct Percentiles {
+		float P50;
+		float P95;
+		float P99;
+		float Max;
+	};
+
+	struct FrameStatistics {
+		uint64_t	Frames;			// Recorded since startup.
+		uint32_t	Samples;		// Frames the percentiles cover.
+		Percentiles	Cpu;
+		Percentiles	Gpu;			// Over samples with a GPU time only.
+		Percentiles	Present;
+		uint32_t	Hitches;		// Within the sampled frames.
+		uint64_t	TotalHitches;
+	};
+
 	void UpdateFPS(double fps);
 	void UpdateFrameTime(double framTimeMs);
 	void UpdateTotalTime(double totalTime);
@@ -11,4 +51,24 @@ namespace FPSCounter {
 	double FrameTime();
 	double TotalTime();
 	int FrameCount();
-}
\ No newline at end of file
+
+	/*
+		Appends a sample. Game thread only. GPU time and present interval are the
+		latest values reported through RecordGpuTime/RecordPresentInterval.
+	*/
+	void DAYBREAK_API RecordFrame(double cpuMs, double frameIntervalMs);
+	void DAYBREAK_API RecordGpuTime(double gpuMs);
+	void DAYBREAK_API RecordPresentInterval(double presentMs);
+
+	/*
+		Copies up to maxCount of the most recent samples, oldest first, and returns
+		how many were copied. Safe from any thread.
+	*/
+	size_t DAYBREAK_API CopySamples(FrameSample* samples, size_t maxCount);
+
+	// Percentiles over the last window frames. Safe from any thread.
+	FrameStatistics DAYBREAK_API Statistics(size_t window = HistorySize);
+
+	// Writes the ring as CSV. Safe from any thread.
+	bool DAYBREAK_API ExportCSV(const std::wstring& path);
+}
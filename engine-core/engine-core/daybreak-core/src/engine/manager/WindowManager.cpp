@@ -5,6 +5,8 @@
 #include "engine/Simulation.h"
 #include "engine/MetricsWindow.h"
 #include "engine/ControlWindow.h"
+#include "engine/manager/FPSCounter.h"
+#include "common/CmdLineArgs.h"
 
 namespace WindowManagerUtil {
 	
@@ -69,6 +71,23 @@ namespace WindowManagerUtil {
 		m_windowManager->OpenAll();
 	}
 	
+	void RunHeadless(uint32_t ticksPerSecond) {
+		if (m_windowManager == nullptr) {
+			Logger::error(L"WindowManager not created yet!\n");
+			return;
+		}
+
+		Logger::log_debug_seperator();
+		Logger::info(L"[DAYBREAK STARTUP] Daybreak Headless Initialization...\n");
+		m_mainSimulation->RunHeadless(ticksPerSecond);
+	}
+
+	void RequestStop() {
+		if (m_mainSimulation != nullptr) {
+			m_mainSimulation->RequestStop();
+		}
+	}
+
 	void Close() {
 		if (m_windowManager == nullptr) {
 			Logger::error(L"WindowManager not created yet!\n");
@@ -77,6 +96,12 @@ namespace WindowManagerUtil {
 		Logger::info(L"[GAME TEARDOWN] Shutting down...\n");
 		m_mainSimulation->Teardown();
 
+		if (CmdLine::ExportFrameStats()) {
+			std::wstring path = GameSettings::CurrentPath() + L"/framestats.csv";
+			Logger::info(L"Writing frame statistics to %s\n", path.c_str());
+			FPSCounter::ExportCSV(path);
+		}
+
 		delete m_mainSimulation;
 		delete m_windowManager;
 	}
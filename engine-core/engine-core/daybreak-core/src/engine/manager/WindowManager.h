@@ -7,6 +7,10 @@ namespace WindowManagerUtil {
 	void DAYBREAK_API Tick();
 	void DAYBREAK_API Open();
 	void DAYBREAK_API Close();
+
+	/* SERVER mode: runs the simulation headless in place of Initialize/Open/Tick */
+	void DAYBREAK_API RunHeadless(uint32_t ticksPerSecond);
+	void DAYBREAK_API RequestStop();
 }
 
 class DAYBREAK_API WindowManager {
@@ -6,7 +6,7 @@
 namespace Daybreak {
 
 	MetricsWindow::MetricsWindow() : win32::Window(L"Metrics Window", nullptr) {
-		SetSize(400, 400);
+		SetSize(560, 400);
 	}
 	
 	MetricsWindow::~MetricsWindow() {
@@ -14,52 +14,43 @@ namespace Daybreak {
 	
 	void MetricsWindow::Paint(HDC hdc) {
 		// Logger::info(L"Window Size: %d %d %d %d\n", clientRect->left, clientRect->top, clientRect->right, clientRect->bottom);
+		FPSCounter::FrameStatistics stats = FPSCounter::Statistics();
+		auto percentiles = [](const FPSCounter::Percentiles& p) {
+			wchar_t text[64];
+			swprintf_s(text, L"%.2f / %.2f / %.2f / %.2f", p.P50, p.P95, p.P99, p.Max);
+			return std::wstring(text);
+		};
+
+		PaintRow(hdc, 0, L"FPS: ", std::to_wstring(FPSCounter::FPS()));
+		PaintRow(hdc, 1, L"Total Time (s): ", std::to_wstring(FPSCounter::TotalTime()));
+		PaintRow(hdc, 2, L"CPU (p50/95/99/max ms): ", percentiles(stats.Cpu));
+		PaintRow(hdc, 3, L"GPU (p50/95/99/max ms): ", percentiles(stats.Gpu));
+		PaintRow(hdc, 4, L"Present (p50/95/99/max ms): ", percentiles(stats.Present));
+		PaintRow(hdc, 5, L"Hitches (recent / total): ", std::to_wstring(stats.Hitches) + L" / " + std::to_wstring(stats.TotalHitches));
+	}
+
+	void MetricsWindow::PaintRow(HDC hdc, int row, const wchar_t* label, const std::wstring& value) {
 		RECT clientRect;
 		GetClientRect(Handle(), &clientRect);
 		int middle = (clientRect.right - clientRect.left) / 2;
 		RECT textRect = { 
 			clientRect.left + 30, 
-			clientRect.top, 
+			clientRect.top + row * 30, 
 			middle,
-			clientRect.top + 30 
+			clientRect.top + (row + 1) * 30 
 		};
 		
 		SetBkMode(hdc, TRANSPARENT);
 		SetTextColor(hdc, RGB(255, 255, 255));
-		DrawText(hdc, L"FPS: ", -1, &textRect, DT_LEFT | DT_NOCLIP | DT_SINGLELINE | DT_VCENTER);
-	
-
-		std::wstring fps = std::to_wstring(FPSCounter::FPS());
-		textRect = {
-			middle,
-			clientRect.top,
-			clientRect.right,
-			clientRect.top + 30
-		};
-		DrawText(hdc, fps.c_str(), -1, &textRect, DT_CENTER | DT_NOCLIP | DT_SINGLELINE | DT_VCENTER);
-		SetBkMode(hdc, OPAQUE);
-
-		// Total Time
-		textRect = {
-			clientRect.left + 30,
-			clientRect.top + 30,
-			middle,
-			clientRect.top + 60
-		};
-
-		SetBkMode(hdc, TRANSPARENT);
-		SetTextColor(hdc, RGB(255, 255, 255));
-		DrawText(hdc, L"Total Time (s): ", -1, &textRect, DT_LEFT | DT_NOCLIP | DT_SINGLELINE | DT_VCENTER);
-
+		DrawText(hdc, label, -1, &textRect, DT_LEFT | DT_NOCLIP | DT_SINGLELINE | DT_VCENTER);
 
-		std::wstring totalTime = std::to_wstring(FPSCounter::TotalTime());
 		textRect = {
 			middle,
-			clientRect.top + 30,
+			clientRect.top + row * 30,
 			clientRect.right,
-			clientRect.top + 60
+			clientRect.top + (row + 1) * 30
 		};
-		DrawText(hdc, totalTime.c_str(), -1, &textRect, DT_CENTER | DT_NOCLIP | DT_SINGLELINE | DT_VCENTER);
+		DrawText(hdc, value.c_str(), -1, &textRect, DT_CENTER | DT_NOCLIP | DT_SINGLELINE | DT_VCENTER);
 		SetBkMode(hdc, OPAQUE);
 	}
-}
+}
\ No newline at end of file
@@ -9,5 +9,8 @@ namespace Daybreak {
 		~MetricsWindow();
 
 		virtual void Paint(HDC hdc) override;
+
+	private:
+		void PaintRow(HDC hdc, int row, const wchar_t* label, const std::wstring& value);
 	};
 }
@@ -0,0 +1,340 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <vector>
+
+#include "MeshSplit.h"
+#include "VertexPacking.h"
+
+/*
+	On-disk layout of .bmesh files. mesh-bake runs the Assimp import offline
+	and writes the result here; at runtime the file is mapped and the blobs are
+	handed to the upload path as they are, with nothing parsed or converted.
+
+	All integers are little-endian. The header, the mesh table and every blob
+	start on an Alignment boundary, so a mapped file can be read in place.
+
+		File		: Header, MeshRecord[MeshCount], LodRecord[LodCount], blobs
+		Header		: Magic, Version, MeshCount, VertexStride, uint64_t FileSize, AABB bounds,
+					  LodCount, Layout
+		MeshRecord	: uint64_t vertex offset, uint64_t index offset, uint32_t vertex count,
+					  uint32_t index count, uint32_t index size, uint32_t material, AABB bounds,
+					  first LOD, LOD count, PositionTransform
+		LodRecord	: uint32_t start index, uint32_t index count, float error
+		Vertex blob	: vertices in the file's Layout [vertex count]
+		Index blob	: uint16_t or uint32_t (index size bytes) [index count]
+
+	A mesh's index blob holds all of its levels of detail back to back, each
+	located by one of its LodRecords; the first is the full mesh.
+
+	Every mesh's vertices are stored in the one layout the file was baked for,
+	so a loader asking for that layout uploads them without touching a vertex.
+	Packed positions decode with the mesh's PositionTransform (the identity
+	unless quantized, in which case it spans the mesh's bounds).
+
+	Offsets are from the start of the file. Vertex matches gfx::VertexData byte
+	for byte. This header is shared with mesh-bake and must stay free of engine
+	includes.
+*/
+namespace bmesh {
+
+	static const uint32_t Magic = 0x48534D42; // "BMSH"
+	static const uint32_t Version = 3;
+	static const uint32_t Alignment = 16;
+	static const char Extension[] = ".bmesh";
+
+	struct AABB {
+		float	Min[3];
+		float	Max[3];
+	};
+
+	// Numbered as gfx::VertexFormat.
+	enum class Layout : uint32_t {
+		Full = 0,				// Vertex
+		Packed = 1,				// meshops::PackedVertexFloat
+		PackedQuantized = 2		// meshops::PackedVertex
+	};
+
+	struct Vertex {
+		float	Position[3];
+		float	Normal[3];
+		float	Tangent[3];
+		float	Color[3];
+		float	UV[2];
+	};
+
+	struct Header {
+		uint32_t	Magic;
+		uint32_t	Version;
+		uint32_t	MeshCount;
+		uint32_t	VertexStride;
+		uint64_t	FileSize;
+		AABB		Bounds;
+		uint32_t	LodCount;
+		Layout		VertexLayout;
+		uint32_t	Reserved[2];
+	};
+
+	struct MeshRecord {
+		uint64_t					VertexOffset;
+		uint64_t					IndexOffset;
+		uint32_t					VertexCount;
+		uint32_t					IndexCount;
+		uint32_t					IndexSize;
+		uint32_t					Material;
+		AABB						Bounds;
+		uint32_t					FirstLod;
+		uint32_t					LodCount;
+		meshops::PositionTransform	Position;
+		uint32_t					Reserved[2];
+	};
+
+	struct LodRecord {
+		uint32_t	StartIndex;
+		uint32_t	IndexCount;
+		float		Error;		// See meshops::LodLevel
+		uint32_t	Reserved;
+	};
+
+	static_assert(sizeof(Vertex) == 56, "Vertex must match gfx::VertexData");
+	static_assert(sizeof(Header) % Alignment == 0 && sizeof(MeshRecord) % Alignment == 0 && sizeof(LodRecord) % Alignment == 0, "Tables must keep blobs aligned");
+
+	inline uint32_t StrideOf(Layout layout) {
+		switch (layout) {
+			case Layout::Packed:			return sizeof(meshops::PackedVertexFloat);
+			case Layout::PackedQuantized:	return sizeof(meshops::PackedVertex);
+			default:						return sizeof(Vertex);
+		}
+	}
+
+	inline uint64_t AlignOffset(uint64_t offset) {
+		return (offset + Alignment - 1) & ~static_cast<uint64_t>(Alignment - 1);
+	}
+
+	inline AABB ComputeBounds(const Vertex* vertices, size_t count) {
+		AABB bounds = { { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f } };
+		for (size_t i = 0; i < count; i++) {
+			for (int axis = 0; axis < 3; axis++) {
+				float value = vertices[i].Position[axis];
+				if (i == 0 || value < bounds.Min[axis]) {
+					bounds.Min[axis] = value;
+				}
+				if (i == 0 || value > bounds.Max[axis]) {
+					bounds.Max[axis] = value;
+				}
+			}
+		}
+		return bounds;
+	}
+
+	struct MeshData {
+		std::vector<Vertex>		Vertices;
+		std::vector<uint32_t>	Indices;
+		uint32_t				Material;
+		std::vector<LodRecord>	Lods;		// Ranges of Indices; empty for a single level
+	};
+
+	// Packs vertices into layout (which must not be Full) as the engine's load path does.
+	inline void PackVertices(const std::vector<Vertex>& vertices, Layout layout, const meshops::PositionTransform& transform, std::vector<uint8_t>& out) {
+		out.resize(static_cast<size_t>(StrideOf(layout)) * vertices.size());
+		for (size_t i = 0; i < vertices.size(); i++) {
+			const Vertex& vertex = vertices[i];
+			if (layout == Layout::PackedQuantized) {
+				meshops::PackVertex(vertex.Position, vertex.Normal, vertex.Tangent, vertex.UV, transform, reinterpret_cast<meshops::PackedVertex*>(out.data())[i]);
+			} else {
+				meshops::PackVertex(vertex.Position, vertex.Normal, vertex.Tangent, vertex.UV, transform, reinterpret_cast<meshops::PackedVertexFloat*>(out.data())[i]);
+			}
+		}
+	}
+
+	/*
+		Writes meshes as a .bmesh file with their vertices in layout. Indices are
+		stored as uint16_t unless the mesh needs long indices (see
+		meshops::NeedsLongIndices). A mesh without Lods is written with one level
+		covering all of its indices.
+	*/
+	inline bool Write(std::ostream& out, const std::vector<MeshData>& meshes, Layout layout = Layout::Full) {
+		const uint32_t stride = StrideOf(layout);
+
+		Header header = {};
+		header.Magic = Magic;
+		header.Version = Version;
+		header.MeshCount = static_cast<uint32_t>(meshes.size());
+		header.VertexStride = stride;
+		header.VertexLayout = layout;
+
+		std::vector<MeshRecord> records(meshes.size());
+		std::vector<LodRecord> lods;
+		for (size_t i = 0; i < meshes.size(); i++) {
+			records[i] = {};
+			records[i].FirstLod = static_cast<uint32_t>(lods.size());
+			if (meshes[i].Lods.empty()) {
+				lods.push_back({ 0, static_cast<uint32_t>(meshes[i].Indices.size()), 0.0f, 0 });
+			} else {
+				lods.insert(lods.end(), meshes[i].Lods.begin(), meshes[i].Lods.end());
+			}
+			records[i].LodCount = static_cast<uint32_t>(lods.size()) - records[i].FirstLod;
+		}
+		header.LodCount = static_cast<uint32_t>(lods.size());
+
+		uint64_t tables = sizeof(Header) + sizeof(MeshRecord) * records.size() + sizeof(LodRecord) * lods.size();
+		uint64_t offset = AlignOffset(tables);
+		for (size_t i = 0; i < meshes.size(); i++) {
+			const MeshData& mesh = meshes[i];
+			MeshRecord& record = records[i];
+
+			record.VertexCount = static_cast<uint32_t>(mesh.Vertices.size());
+			record.IndexCount = static_cast<uint32_t>(mesh.Indices.size());
+			record.IndexSize = meshops::NeedsLongIndices(mesh.Vertices.size()) ? sizeof(uint32_t) : sizeof(uint16_t);
+			record.Material = mesh.Material;
+			record.Bounds = ComputeBounds(mesh.Vertices.data(), mesh.Vertices.size());
+			record.Position = layout == Layout::PackedQuantized ? meshops::QuantizationFor(record.Bounds.Min, record.Bounds.Max) : meshops::IdentityTransform();
+
+			record.VertexOffset = offset;
+			offset = AlignOffset(offset + static_cast<uint64_t>(stride) * record.VertexCount);
+			record.IndexOffset = offset;
+			offset = AlignOffset(offset + static_cast<uint64_t>(record.IndexSize) * record.IndexCount);
+
+			for (int axis = 0; axis < 3; axis++) {
+				if (i == 0 || record.Bounds.Min[axis] < header.Bounds.Min[axis]) {
+					header.Bounds.Min[axis] = record.Bounds.Min[axis];
+				}
+				if (i == 0 || record.Bounds.Max[axis] > header.Bounds.Max[axis]) {
+					header.Bounds.Max[axis] = record.Bounds.Max[axis];
+				}
+			}
+		}
+		header.FileSize = offset;
+
+		uint64_t written = 0;
+		auto pad = [&](uint64_t to) {
+			static const char zeros[Alignment] = {};
+			out.write(zeros, static_cast<std::streamsize>(to - written));
+			written = to;
+		};
+
+		out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+		out.write(reinterpret_cast<const char*>(records.data()), sizeof(MeshRecord) * records.size());
+		out.write(reinterpret_cast<const char*>(lods.data()), sizeof(LodRecord) * lods.size());
+		written = tables;
+
+		std::vector<uint16_t> shortIndices;
+		std::vector<uint8_t> packed;
+		for (size_t i = 0; i < meshes.size(); i++) {
+			const MeshData& mesh = meshes[i];
+			const MeshRecord& record = records[i];
+
+			pad(record.VertexOffset);
+			if (layout == Layout::Full) {
+				out.write(reinterpret_cast<const char*>(mesh.Vertices.data()), sizeof(Vertex) * mesh.Vertices.size());
+			} else {
+				PackVertices(mesh.Vertices, layout, record.Position, packed);
+				out.write(reinterpret_cast<const char*>(packed.data()), static_cast<std::streamsize>(packed.size()));
+			}
+			written += static_cast<uint64_t>(stride) * mesh.Vertices.size();
+
+			pad(record.IndexOffset);
+			if (record.IndexSize == sizeof(uint16_t)) {
+				shortIndices.assign(mesh.Indices.begin(), mesh.Indices.end());
+				out.write(reinterpret_cast<const char*>(shortIndices.data()), sizeof(uint16_t) * shortIndices.size());
+			} else {
+				out.write(reinterpret_cast<const char*>(mesh.Indices.data()), sizeof(uint32_t) * mesh.Indices.size());
+			}
+			written += static_cast<uint64_t>(record.IndexSize) * record.IndexCount;
+		}
+		pad(header.FileSize);
+
+		return out.good();
+	}
+
+	/*
+		Read-only view over a .bmesh image in memory (normally a mapped file).
+		Open() checks every table entry against the image size, after which the
+		accessors return pointers straight into it.
+	*/
+	class View {
+		public:
+			View() : m_data(nullptr), m_size(0) {}
+
+			bool Open(const void* data, size_t size) {
+				m_data = static_cast<const uint8_t*>(data);
+				m_size = size;
+
+				if (!m_data || m_size < sizeof(Header) || reinterpret_cast<uintptr_t>(m_data) % Alignment != 0) {
+					return Fail();
+				}
+
+				const Header& header = GetHeader();
+				if (header.Magic != Magic || header.Version != Version || header.VertexLayout > Layout::PackedQuantized ||
+					header.VertexStride != StrideOf(header.VertexLayout) || header.FileSize > m_size) {
+					return Fail();
+				}
+				if (header.MeshCount > (m_size - sizeof(Header)) / sizeof(MeshRecord) ||
+					header.LodCount > (m_size - sizeof(Header) - sizeof(MeshRecord) * header.MeshCount) / sizeof(LodRecord)) {
+					return Fail();
+				}
+
+				for (uint32_t i = 0; i < header.MeshCount; i++) {
+					const MeshRecord& mesh = Mesh(i);
+					if (mesh.IndexSize != sizeof(uint16_t) && mesh.IndexSize != sizeof(uint32_t)) {
+						return Fail();
+					}
+					if (!InRange(mesh.VertexOffset, static_cast<uint64_t>(header.VertexStride) * mesh.VertexCount) ||
+						!InRange(mesh.IndexOffset, static_cast<uint64_t>(mesh.IndexSize) * mesh.IndexCount)) {
+						return Fail();
+					}
+					if (mesh.LodCount == 0 || mesh.FirstLod > header.LodCount || mesh.LodCount > header.LodCount - mesh.FirstLod) {
+						return Fail();
+					}
+					for (uint32_t level = 0; level < mesh.LodCount; level++) {
+						const LodRecord& lod = Lod(mesh, level);
+						if (lod.StartIndex > mesh.IndexCount || lod.IndexCount > mesh.IndexCount - lod.StartIndex) {
+							return Fail();
+						}
+					}
+				}
+				return true;
+			}
+
+			bool IsOpen() const { return m_data != nullptr; }
+
+			const Header& GetHeader() const { return *reinterpret_cast<const Header*>(m_data); }
+			uint32_t MeshCount() const { return GetHeader().MeshCount; }
+			Layout VertexLayout() const { return GetHeader().VertexLayout; }
+			uint32_t VertexStride() const { return GetHeader().VertexStride; }
+
+			const MeshRecord& Mesh(uint32_t index) const {
+				return reinterpret_cast<const MeshRecord*>(m_data + sizeof(Header))[index];
+			}
+
+			const LodRecord& Lod(const MeshRecord& mesh, uint32_t level) const {
+				const uint8_t* table = m_data + sizeof(Header) + sizeof(MeshRecord) * MeshCount();
+				return reinterpret_cast<const LodRecord*>(table)[mesh.FirstLod + level];
+			}
+
+			// The mesh's vertex blob, VertexStride() bytes per vertex.
+			const void* Vertices(const MeshRecord& mesh) const {
+				return m_data + mesh.VertexOffset;
+			}
+
+			const void* Indices(const MeshRecord& mesh) const {
+				return m_data + mesh.IndexOffset;
+			}
+
+		private:
+			bool Fail() {
+				m_data = nullptr;
+				m_size = 0;
+				return false;
+			}
+
+			bool InRange(uint64_t offset, uint64_t length) const {
+				return offset % Alignment == 0 && offset <= m_size && length <= m_size - offset;
+			}
+
+			const uint8_t*	m_data;
+			size_t			m_size;
+	};
+}
@@ -1,6 +1,8 @@
 #include "daybreak.h"
 
 #include "Mesh.h"
+#include "MeshSplit.h"
+#include "Renderer.h"
 
 namespace gfx {
 
@@ -12,22 +14,125 @@ namespace gfx {
 		{ "UV",			0, DXGI_FORMAT_R32G32_FLOAT,	0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
 	};
 
+	// meshops::PackedVertexFloat
+	static const D3D12_INPUT_ELEMENT_DESC g_packedInputElements[] = {
+		{ "POSITION",   0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+		{ "NORMAL",     0, DXGI_FORMAT_R16G16_SNORM,	0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+		{ "TANGENT",    0, DXGI_FORMAT_R16G16_SNORM,	0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+		{ "UV",			0, DXGI_FORMAT_R16G16_FLOAT,	0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+	};
+
+	// meshops::PackedVertex
+	static const D3D12_INPUT_ELEMENT_DESC g_quantizedInputElements[] = {
+		{ "POSITION",   0, DXGI_FORMAT_R16G16B16A16_UNORM, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+		{ "NORMAL",     0, DXGI_FORMAT_R16G16_SNORM,	0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+		{ "TANGENT",    0, DXGI_FORMAT_R16G16_SNORM,	0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+		{ "UV",			0, DXGI_FORMAT_R16G16_FLOAT,	0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+	};
+
 	Mesh::Mesh() :
-		m_indexCount(0) {}
+		m_positionTransform(meshops::IdentityTransform()),
+		m_lods(),
+		m_boundingSphere(0.0f, 0.0f, 0.0f, 0.0f) {}
 
 	Mesh::~Mesh() {}
 
 	std::shared_ptr<Mesh> Mesh::Create(dx12::CommandList& commandList, Vertices& vertices, Indices& indices) {
+		return Create(commandList, vertices.data(), vertices.size(), indices.data(), indices.size(), sizeof(uint16_t));
+	}
+
+	std::shared_ptr<Mesh> Mesh::Create(dx12::CommandList& commandList, Vertices& vertices, Indices32& indices) {
+		return Create(commandList, vertices.data(), vertices.size(), indices.data(), indices.size(), sizeof(uint32_t));
+	}
+
+	std::shared_ptr<Mesh> Mesh::Create(dx12::CommandList& commandList, const VertexData* vertices, size_t vertexCount, const void* indices, size_t indexCount, size_t indexSize) {
+		std::vector<dx12::CommandList::BufferCopy> copies;
+		std::shared_ptr<Mesh> mesh = CreateBatched(copies, vertices, vertexCount, indices, indexCount, indexSize);
+		commandList.CopyBuffers(copies);
+		return mesh;
+	}
+
+	std::shared_ptr<Mesh> Mesh::CreateBatched(std::vector<dx12::CommandList::BufferCopy>& copies, const VertexData* vertices, size_t vertexCount, const void* indices, size_t indexCount, size_t indexSize) {
+		return CreateBatched(copies, VertexFormat::FULL, vertices, vertexCount, meshops::IdentityTransform(), indices, indexCount, indexSize);
+	}
+
+	std::shared_ptr<Mesh> Mesh::CreateBatched(std::vector<dx12::CommandList::BufferCopy>& copies, VertexFormat format, const void* vertices, size_t vertexCount, const meshops::PositionTransform& transform, const void* indices, size_t indexCount, size_t indexSize) {
 		std::shared_ptr<Mesh> mesh = std::make_shared<Mesh>();
-		mesh->Initialize(commandList, vertices, indices);
+		mesh->Initialize(copies, format, vertices, vertexCount, transform, indices, indexCount, indexSize);
 		return mesh;
 	}
 
-	void Mesh::Draw(dx12::CommandList& commandlist) {
+	template<typename Packed>
+	static void PackAll(const VertexData* vertices, size_t vertexCount, const meshops::PositionTransform& transform, Packed* packed) {
+		for (size_t i = 0; i < vertexCount; i++) {
+			const VertexData& vertex = vertices[i];
+			meshops::PackVertex(&vertex.position.x, &vertex.normal.x, &vertex.tangent.x, &vertex.uv.x, transform, packed[i]);
+		}
+	}
+
+	meshops::PositionTransform Mesh::PackVertices(VertexFormat format, const VertexData* vertices, size_t vertexCount, std::vector<uint8_t>& packed) {
+		packed.resize(VertexStride(format) * vertexCount);
+		switch (format) {
+			case VertexFormat::PACKED:
+				PackAll(vertices, vertexCount, meshops::IdentityTransform(), reinterpret_cast<meshops::PackedVertexFloat*>(packed.data()));
+				return meshops::IdentityTransform();
+			case VertexFormat::PACKED_QUANTIZED: {
+				XMFLOAT3 min = vertexCount ? vertices[0].position : XMFLOAT3(0.0f, 0.0f, 0.0f);
+				XMFLOAT3 max = min;
+				for (size_t i = 1; i < vertexCount; i++) {
+					const XMFLOAT3& position = vertices[i].position;
+					min = XMFLOAT3(std::min(min.x, position.x), std::min(min.y, position.y), std::min(min.z, position.z));
+					max = XMFLOAT3(std::max(max.x, position.x), std::max(max.y, position.y), std::max(max.z, position.z));
+				}
+
+				meshops::PositionTransform transform = meshops::QuantizationFor(&min.x, &max.x);
+				PackAll(vertices, vertexCount, transform, reinterpret_cast<meshops::PackedVertex*>(packed.data()));
+				return transform;
+			}
+			default:
+				memcpy(packed.data(), vertices, packed.size());
+				return meshops::IdentityTransform();
+		}
+	}
+
+	size_t Mesh::VertexStride(VertexFormat format) {
+		switch (format) {
+			case VertexFormat::PACKED:				return sizeof(meshops::PackedVertexFloat);
+			case VertexFormat::PACKED_QUANTIZED:	return sizeof(meshops::PackedVertex);
+			default:								return sizeof(VertexData);
+		}
+	}
+
+	D3D12_INPUT_LAYOUT_DESC Mesh::InputLayout(VertexFormat format) {
+		switch (format) {
+			case VertexFormat::PACKED:				return { g_packedInputElements, _countof(g_packedInputElements) };
+			case VertexFormat::PACKED_QUANTIZED:	return { g_quantizedInputElements, _countof(g_quantizedInputElements) };
+			default:								return { VertexData::InputElements, VertexData::InputElementCount };
+		}
+	}
+
+	void Mesh::SetLods(const std::vector<MeshLod>& lods, const XMFLOAT4& boundingSphere) {
+		if (lods.empty()) {
+			throw std::exception("A mesh needs at least one level of detail");
+		}
+		m_lods = lods;
+		m_boundingSphere = boundingSphere;
+	}
+
+	void Mesh::Draw(dx12::CommandList& commandlist, size_t lod) {
 		commandlist.SetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 		commandlist.SetVertexBuffer(0, m_vertexBuffer);
 		commandlist.SetIndexBuffer(m_indexBuffer);
-		commandlist.DrawIndexed(m_indexCount);
+
+		// MeshConstants in PackedVertexShader.hlsl: float4 offset, float4 scale.
+		const meshops::PositionTransform& transform = m_positionTransform;
+		float constants[ConstantCount] = {
+			transform.Offset[0], transform.Offset[1], transform.Offset[2], 0.0f,
+			transform.Scale[0], transform.Scale[1], transform.Scale[2], 0.0f
+		};
+		commandlist.SetGraphics32BitConstants(GeometryRootParameters::MESH_CONSTANTS, constants);
+		const MeshLod& level = m_lods[std::min(lod, m_lods.size() - 1)];
+		commandlist.DrawIndexed(level.IndexCount, 1, level.StartIndex);
 	}
 
 	//std::unique_ptr<Mesh> Mesh::LoadFromFile(const std::string& filePath) {
@@ -122,14 +227,15 @@ namespace gfx {
 	//}
 
 	
-	void Mesh::Initialize(dx12::CommandList& commandList, Vertices& vertices, Indices& indices) {
-		if (vertices.size() >= USHRT_MAX) {
+	void Mesh::Initialize(std::vector<dx12::CommandList::BufferCopy>& copies, VertexFormat format, const void* vertices, size_t vertexCount, const meshops::PositionTransform& transform, const void* indices, size_t indexCount, size_t indexSize) {
+		if (indexSize == sizeof(uint16_t) && meshops::NeedsLongIndices(vertexCount)) {
 			throw std::exception("Too many vertices for 16-bit index buffer");
 		}
 
-		commandList.CopyVertexBuffer(m_vertexBuffer, vertices);
-		commandList.CopyIndexBuffer(m_indexBuffer, indices);
+		copies.push_back({ &m_vertexBuffer, vertexCount, VertexStride(format), vertices });
+		copies.push_back({ &m_indexBuffer, indexCount, indexSize, indices });
 
-		m_indexCount = static_cast<UINT>(indices.size());
+		m_positionTransform = transform;
+		m_lods.assign(1, { 0, static_cast<UINT>(indexCount), 0.0f });
 	}
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include "platform/dx12/CommandList.h"
 #include "platform/dx12/VertexBuffer.h"
 #include "platform/dx12/IndexBuffer.h"
+#include "graphics/VertexFormat.h"
+#include "graphics/VertexPacking.h"
 
 namespace gfx {
     struct DAYBREAK_API VertexData {
@@ -35,18 +37,72 @@ namespace gfx {
         static const D3D12_INPUT_ELEMENT_DESC InputElements[InputElementCount];
     };
 
-    
+    /*
+        One level of detail: a range of the mesh's index buffer. Every level
+        indexes the same vertices. Error bounds how far the level strays from
+        the full mesh, in mesh units (see meshops::GenerateLods).
+    */
+    struct DAYBREAK_API MeshLod {
+        UINT    StartIndex;
+        UINT    IndexCount;
+        float   Error;
+    };
 
     class DAYBREAK_API Mesh {
         public:
             using Vertices = std::vector<VertexData>;
             using Indices = std::vector<uint16_t>;
+            using Indices32 = std::vector<uint32_t>;
             Mesh();
             virtual ~Mesh();
 
             static std::shared_ptr<Mesh> Create(dx12::CommandList& commandList, Vertices& vertices, Indices& indices);
-
-            void Draw(dx12::CommandList& commandlist);
+            static std::shared_ptr<Mesh> Create(dx12::CommandList& commandList, Vertices& vertices, Indices32& indices);
+
+            /*
+                Uploads straight from caller memory (e.g. a mapped .bmesh blob),
+                which only has to stay valid for the duration of the call.
+                indexSize is 2 or 4; 2 allows at most meshops::MaxShortIndexVertices
+                vertices.
+            */
+            static std::shared_ptr<Mesh> Create(dx12::CommandList& commandList, const VertexData* vertices, size_t vertexCount, const void* indices, size_t indexCount, size_t indexSize);
+
+            /*
+                Appends this mesh's buffers to copies instead of uploading them, so
+                a whole model can go through one CommandList::CopyBuffers call.
+            */
+            static std::shared_ptr<Mesh> CreateBatched(std::vector<dx12::CommandList::BufferCopy>& copies, const VertexData* vertices, size_t vertexCount, const void* indices, size_t indexCount, size_t indexSize);
+
+            /*
+                As above for vertices already in format (see PackVertices). transform
+                is handed to the vertex shader to decode quantized positions.
+            */
+            static std::shared_ptr<Mesh> CreateBatched(std::vector<dx12::CommandList::BufferCopy>& copies, VertexFormat format, const void* vertices, size_t vertexCount, const meshops::PositionTransform& transform, const void* indices, size_t indexCount, size_t indexSize);
+
+            /*
+                Converts vertices to format into packed and returns the transform that
+                decodes its positions. PACKED_QUANTIZED quantizes against the bounds of
+                these vertices.
+            */
+            static meshops::PositionTransform PackVertices(VertexFormat format, const VertexData* vertices, size_t vertexCount, std::vector<uint8_t>& packed);
+
+            static size_t VertexStride(VertexFormat format);
+            static D3D12_INPUT_LAYOUT_DESC InputLayout(VertexFormat format);
+
+            // Root constants Draw sets at GeometryRootParameters::MESH_CONSTANTS.
+            static const uint32_t ConstantCount = 8;
+
+            /*
+                Replaces the default single level (all indices, no error). Level 0
+                is the full mesh and errors grow with the level. boundingSphere is
+                centre and radius in mesh units, for projecting Error to the screen.
+            */
+            void SetLods(const std::vector<MeshLod>& lods, const XMFLOAT4& boundingSphere);
+            const std::vector<MeshLod>& Lods() const { return m_lods; }
+            const XMFLOAT4& BoundingSphere() const { return m_boundingSphere; }
+
+            // lod past the last level draws the last level.
+            void Draw(dx12::CommandList& commandlist, size_t lod = 0);
             // static std::unique_ptr<Mesh> LoadFromFile(const std::string& filePath);
 
             // static std::unique_ptr<Mesh> CreateCube(dx12::CommandList& commandList, FXMVECTOR color = {0.196f, 0.573f, 0.035}, float size = 1, bool rhcoords = false);
@@ -56,11 +112,13 @@ namespace gfx {
             Mesh(const Mesh& copy) = delete;
 
             // void CreateBuffers();
-            void Initialize(dx12::CommandList& commandList, Vertices& vertices, Indices& indices);
+            void Initialize(std::vector<dx12::CommandList::BufferCopy>& copies, VertexFormat format, const void* vertices, size_t vertexCount, const meshops::PositionTransform& transform, const void* indices, size_t indexCount, size_t indexSize);
 
-            dx12::VertexBuffer  m_vertexBuffer;
-            dx12::IndexBuffer   m_indexBuffer;
-            UINT                m_indexCount;
+            dx12::VertexBuffer              m_vertexBuffer;
+            dx12::IndexBuffer               m_indexBuffer;
+            meshops::PositionTransform      m_positionTransform;
+            std::vector<MeshLod>            m_lods;
+            XMFLOAT4                        m_boundingSphere;
     };
 }
 
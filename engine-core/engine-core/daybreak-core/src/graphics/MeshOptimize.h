@@ -0,0 +1,331 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/*
+	Index and vertex reordering run at import (gfx::Model) and bake time
+	(mesh-bake): vertex cache order, then overdraw order over the cache-friendly
+	clusters, then vertex fetch order. Triangles are assumed clockwise-front,
+	as Assimp's ConvertToLeftHanded leaves them. Shared with mesh-bake, so this
+	header must stay free of engine includes.
+*/
+namespace meshops {
+
+	// FIFO size used for both optimization and reporting; post-transform
+	// caches on current hardware behave like 16-32 entries.
+	static const uint32_t VertexCacheSize = 16;
+
+	struct CacheStats {
+		float	ACMR;		// Cache misses per triangle (0.5 is the ideal for a regular grid; 3 is no reuse).
+		float	ATVR;		// Cache misses per referenced vertex (1 is ideal).
+	};
+
+	/*
+		Simulates a FIFO post-transform cache over the triangle list. A vertex
+		is a hit while fewer than cacheSize misses have happened since it was
+		loaded.
+	*/
+	inline CacheStats AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize = VertexCacheSize) {
+		std::vector<uint32_t> loaded(vertexCount, 0);
+		std::vector<bool> referenced(vertexCount, false);
+		uint32_t time = cacheSize + 1;
+		size_t misses = 0, unique = 0;
+
+		for (size_t i = 0; i < indexCount; i++) {
+			uint32_t vertex = indices[i];
+			if (time - loaded[vertex] > cacheSize) {
+				loaded[vertex] = time++;
+				misses++;
+			}
+			if (!referenced[vertex]) {
+				referenced[vertex] = true;
+				unique++;
+			}
+		}
+
+		size_t triangles = indexCount / 3;
+		return {
+			triangles ? static_cast<float>(misses) / triangles : 0.0f,
+			unique ? static_cast<float>(misses) / unique : 0.0f
+		};
+	}
+
+	/*
+		Tipsify (Sander, Nehab and Barczak, "Fast Triangle Reordering for Vertex
+		Locality and Reduced Overdraw", SIGGRAPH 2007). Fans around the vertex
+		most likely to still be cached, falling back to recently used vertices
+		and then input order at dead ends. Linear time. Rewrites indices in place
+		and, if clusters is given, appends the first triangle of every run that
+		started at a dead end; OptimizeOverdraw reorders those runs.
+	*/
+	inline void OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount, std::vector<uint32_t>* clusters = nullptr, uint32_t cacheSize = VertexCacheSize) {
+		size_t triangleCount = indexCount / 3;
+		if (triangleCount == 0) {
+			return;
+		}
+
+		// Triangles around each vertex, as offsets into adjacency.
+		std::vector<uint32_t> live(vertexCount, 0);
+		for (size_t i = 0; i < triangleCount * 3; i++) {
+			live[indices[i]]++;
+		}
+		std::vector<uint32_t> offsets(vertexCount + 1, 0);
+		for (size_t v = 0; v < vertexCount; v++) {
+			offsets[v + 1] = offsets[v] + live[v];
+		}
+		std::vector<uint32_t> adjacency(triangleCount * 3);
+		std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+		for (size_t i = 0; i < triangleCount * 3; i++) {
+			adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+
+		std::vector<uint32_t> loaded(vertexCount, 0);
+		std::vector<bool> emitted(triangleCount, false);
+		std::vector<uint32_t> deadEnds;
+		std::vector<uint32_t> candidates;
+		std::vector<uint32_t> output;
+		output.reserve(triangleCount * 3);
+
+		uint32_t time = cacheSize + 1;
+		size_t cursor = 0;
+		int64_t fan = indices[0];
+		if (clusters) {
+			clusters->push_back(0);
+		}
+
+		while (fan >= 0) {
+			candidates.clear();
+			for (uint32_t a = offsets[fan]; a < offsets[fan + 1]; a++) {
+				uint32_t triangle = adjacency[a];
+				if (emitted[triangle]) {
+					continue;
+				}
+				emitted[triangle] = true;
+
+				for (size_t corner = 0; corner < 3; corner++) {
+					uint32_t vertex = indices[triangle * 3 + corner];
+					output.push_back(vertex);
+					deadEnds.push_back(vertex);
+					candidates.push_back(vertex);
+					live[vertex]--;
+					if (time - loaded[vertex] > cacheSize) {
+						loaded[vertex] = time++;
+					}
+				}
+			}
+
+			// Next fan: the candidate that stays cached longest while its
+			// remaining triangles are emitted.
+			fan = -1;
+			int64_t best = -1;
+			for (uint32_t vertex : candidates) {
+				if (live[vertex] == 0) {
+					continue;
+				}
+				int64_t priority = 0;
+				if (time - loaded[vertex] + 2 * live[vertex] <= cacheSize) {
+					priority = time - loaded[vertex];
+				}
+				if (priority > best) {
+					best = priority;
+					fan = vertex;
+				}
+			}
+			if (fan >= 0) {
+				continue;
+			}
+
+			// Dead end: most recently used vertex with work left, else input order.
+			while (!deadEnds.empty() && fan < 0) {
+				uint32_t vertex = deadEnds.back();
+				deadEnds.pop_back();
+				if (live[vertex] > 0) {
+					fan = vertex;
+				}
+			}
+			while (fan < 0 && cursor < triangleCount * 3) {
+				uint32_t vertex = indices[cursor++];
+				if (live[vertex] > 0) {
+					fan = vertex;
+				}
+			}
+			if (fan >= 0 && clusters) {
+				clusters->push_back(static_cast<uint32_t>(output.size() / 3));
+			}
+		}
+
+		std::copy(output.begin(), output.end(), indices);
+	}
+
+	/*
+		Overdraw pass from the same paper. The runs from OptimizeVertexCache are
+		split further wherever the run so far already has a miss rate within
+		threshold of the whole mesh, then sorted so clusters facing away from
+		the mesh centre (the ones likely to occlude the rest) draw first. A
+		larger threshold gives more, smaller clusters: less overdraw for more
+		cache misses. positions are float3 at positionStride bytes apart.
+	*/
+	inline void OptimizeOverdraw(uint32_t* indices, size_t indexCount, const float* positions, size_t vertexCount, size_t positionStride, const std::vector<uint32_t>& clusters, float threshold = 1.05f, uint32_t cacheSize = VertexCacheSize) {
+		size_t triangleCount = indexCount / 3;
+		if (triangleCount == 0 || clusters.empty()) {
+			return;
+		}
+
+		auto position = [&](uint32_t vertex) {
+			return reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + positionStride * vertex);
+		};
+
+		float meshThreshold = threshold * AnalyzeVertexCache(indices, triangleCount * 3, vertexCount, cacheSize).ACMR;
+
+		// Soft boundaries: restart the simulated cache per cluster so each one is
+		// judged as if drawn on its own, which it may be after sorting.
+		std::vector<uint32_t> loaded(vertexCount, 0);
+		uint32_t time = cacheSize + 1;
+		std::vector<uint32_t> boundaries;
+		for (size_t c = 0; c < clusters.size(); c++) {
+			size_t begin = clusters[c];
+			size_t end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+
+			boundaries.push_back(static_cast<uint32_t>(begin));
+			time += cacheSize + 1;
+			size_t start = begin, misses = 0;
+			for (size_t triangle = begin; triangle < end; triangle++) {
+				for (size_t corner = 0; corner < 3; corner++) {
+					uint32_t vertex = indices[triangle * 3 + corner];
+					if (time - loaded[vertex] > cacheSize) {
+						loaded[vertex] = time++;
+						misses++;
+					}
+				}
+
+				size_t triangles = triangle + 1 - start;
+				if (triangle + 1 < end && static_cast<float>(misses) / triangles <= meshThreshold) {
+					boundaries.push_back(static_cast<uint32_t>(triangle + 1));
+					time += cacheSize + 1;
+					start = triangle + 1;
+					misses = 0;
+				}
+			}
+		}
+
+		// Area-weighted centroid and normal per cluster and for the whole mesh.
+		struct Cluster {
+			uint32_t	Begin;
+			uint32_t	End;
+			double		Centroid[3];
+			double		Normal[3];
+			double		Area;
+			double		Key;
+		};
+		std::vector<Cluster> sorted(boundaries.size());
+		double meshCentroid[3] = { 0.0, 0.0, 0.0 };
+		double meshArea = 0.0;
+		for (size_t index = 0; index < boundaries.size(); index++) {
+			Cluster& cluster = sorted[index];
+			cluster = {};
+			cluster.Begin = boundaries[index];
+			cluster.End = index + 1 < boundaries.size() ? boundaries[index + 1] : static_cast<uint32_t>(triangleCount);
+
+			for (uint32_t triangle = cluster.Begin; triangle < cluster.End; triangle++) {
+				const float* a = position(indices[triangle * 3 + 0]);
+				const float* b = position(indices[triangle * 3 + 1]);
+				const float* c = position(indices[triangle * 3 + 2]);
+
+				double ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+				double ac[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+				double normal[3] = {
+					ab[1] * ac[2] - ab[2] * ac[1],
+					ab[2] * ac[0] - ab[0] * ac[2],
+					ab[0] * ac[1] - ab[1] * ac[0]
+				};
+				double area = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+
+				for (int axis = 0; axis < 3; axis++) {
+					cluster.Centroid[axis] += area * (a[axis] + b[axis] + c[axis]) / 3.0;
+					cluster.Normal[axis] += normal[axis];
+				}
+				cluster.Area += area;
+			}
+
+			for (int axis = 0; axis < 3; axis++) {
+				meshCentroid[axis] += cluster.Centroid[axis];
+			}
+			meshArea += cluster.Area;
+		}
+
+		for (Cluster& cluster : sorted) {
+			double length = std::sqrt(cluster.Normal[0] * cluster.Normal[0] + cluster.Normal[1] * cluster.Normal[1] + cluster.Normal[2] * cluster.Normal[2]);
+			cluster.Key = 0.0;
+			if (cluster.Area > 0.0 && length > 0.0) {
+				for (int axis = 0; axis < 3; axis++) {
+					double offset = cluster.Centroid[axis] / cluster.Area - (meshArea > 0.0 ? meshCentroid[axis] / meshArea : 0.0);
+					cluster.Key += offset * cluster.Normal[axis] / length;
+				}
+			}
+		}
+
+		std::stable_sort(sorted.begin(), sorted.end(), [](const Cluster& left, const Cluster& right) {
+			return left.Key > right.Key;
+		});
+
+		std::vector<uint32_t> output;
+		output.reserve(triangleCount * 3);
+		for (const Cluster& cluster : sorted) {
+			output.insert(output.end(), indices + cluster.Begin * 3, indices + cluster.End * 3);
+		}
+		std::copy(output.begin(), output.end(), indices);
+	}
+
+	/*
+		Reorders vertices into first-use order so fetches walk the vertex buffer
+		forwards, remapping indices in place. Vertices no triangle references are
+		dropped.
+	*/
+	template<typename Vertex>
+	inline std::vector<Vertex> OptimizeVertexFetch(const Vertex* vertices, size_t vertexCount, uint32_t* indices, size_t indexCount) {
+		static const uint32_t Unused = ~0u;
+		std::vector<uint32_t> remap(vertexCount, Unused);
+		std::vector<Vertex> reordered;
+		reordered.reserve(vertexCount);
+
+		for (size_t i = 0; i < indexCount; i++) {
+			uint32_t& target = remap[indices[i]];
+			if (target == Unused) {
+				target = static_cast<uint32_t>(reordered.size());
+				reordered.push_back(vertices[indices[i]]);
+			}
+			indices[i] = target;
+		}
+		return reordered;
+	}
+
+	struct OptimizeReport {
+		CacheStats	Before;
+		CacheStats	After;
+		size_t		Triangles;	// Weights for combining ACMR across meshes
+		size_t		Vertices;	// and ATVR (referenced vertices).
+	};
+
+	/*
+		Runs the three passes above over one mesh. Vertex must start with its
+		float3 position (true of gfx::VertexData and bmesh::Vertex).
+	*/
+	template<typename Vertex>
+	inline OptimizeReport OptimizeMesh(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, float overdrawThreshold = 1.05f) {
+		OptimizeReport report;
+		report.Before = AnalyzeVertexCache(indices.data(), indices.size(), vertices.size());
+
+		std::vector<uint32_t> clusters;
+		OptimizeVertexCache(indices.data(), indices.size(), vertices.size(), &clusters);
+		OptimizeOverdraw(indices.data(), indices.size(), reinterpret_cast<const float*>(vertices.data()), vertices.size(), sizeof(Vertex), clusters, overdrawThreshold);
+		vertices = OptimizeVertexFetch(vertices.data(), vertices.size(), indices.data(), indices.size());
+
+		report.After = AnalyzeVertexCache(indices.data(), indices.size(), vertices.size());
+		report.Triangles = indices.size() / 3;
+		report.Vertices = vertices.size();
+		return report;
+	}
+}
@@ -0,0 +1,472 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+#include "MeshOptimize.h"
+
+/*
+	Quadric error metric simplification (Garland and Heckbert, "Surface
+	Simplification Using Quadric Error Metrics", SIGGRAPH 1997) for building
+	LOD chains at import (gfx::Model) and bake time (mesh-bake). Shared with
+	mesh-bake, so this header must stay free of engine includes.
+*/
+namespace meshops {
+
+	static const uint32_t MaxLodCount = 5;		// Including the full mesh.
+	static const float LodReduction = 0.5f;		// Triangle ratio between consecutive levels.
+
+	struct LodLevel {
+		std::vector<uint32_t>	Indices;
+		float					Error;		// Bound on vertex distance from the replaced surface, in mesh units.
+	};
+
+	/*
+		Sum of squared distances to a set of planes, as the symmetric 3x3 A, the
+		vector b and the constant c of p'Ap + 2b'p + c.
+	*/
+	struct Quadric {
+		double	A[6];	// xx, xy, xz, yy, yz, zz
+		double	B[3];
+		double	C;
+
+		void AddPlane(const double normal[3], double distance, double weight) {
+			A[0] += weight * normal[0] * normal[0];
+			A[1] += weight * normal[0] * normal[1];
+			A[2] += weight * normal[0] * normal[2];
+			A[3] += weight * normal[1] * normal[1];
+			A[4] += weight * normal[1] * normal[2];
+			A[5] += weight * normal[2] * normal[2];
+			for (int axis = 0; axis < 3; axis++) {
+				B[axis] += weight * normal[axis] * distance;
+			}
+			C += weight * distance * distance;
+		}
+
+		void Add(const Quadric& other) {
+			for (int i = 0; i < 6; i++) {
+				A[i] += other.A[i];
+			}
+			for (int axis = 0; axis < 3; axis++) {
+				B[axis] += other.B[axis];
+			}
+			C += other.C;
+		}
+
+		double Evaluate(const double p[3]) const {
+			double result =
+				A[0] * p[0] * p[0] + 2.0 * A[1] * p[0] * p[1] + 2.0 * A[2] * p[0] * p[2] +
+				A[3] * p[1] * p[1] + 2.0 * A[4] * p[1] * p[2] + A[5] * p[2] * p[2] +
+				2.0 * (B[0] * p[0] + B[1] * p[1] + B[2] * p[2]) + C;
+			return result > 0.0 ? result : 0.0;
+		}
+	};
+
+	/*
+		Builds up to maxLods - 1 coarser levels of a triangle list, each with about
+		reduction times the triangles of the one before. Levels index the original
+		vertices: every collapse moves a vertex onto a neighbour (half-edge
+		collapse), so no vertex data is added.
+
+		Vertices with the same position are welded first, so UV seams simplify as
+		one surface; a corner that moves across a seam takes whichever twin at the
+		target is closest in UV (uvs may be null). Open borders are kept by extra
+		planes along each border edge and by only collapsing border vertices
+		along the border. Collapses that would flip a triangle or make the
+		surface non-manifold are skipped.
+
+		A level's Error is the square root of the largest quadric cost paid so
+		far, which bounds how far any moved vertex sits from the planes of the
+		original triangles it absorbed. Fewer levels come back when the mesh
+		cannot be reduced further (e.g. tiny or fully bordered meshes). Every
+		level is vertex cache optimized.
+	*/
+	inline std::vector<LodLevel> GenerateLods(const float* positions, size_t positionStride, const float* uvs, size_t uvStride, size_t vertexCount, const uint32_t* indices, size_t indexCount, uint32_t maxLods = MaxLodCount, float reduction = LodReduction) {
+		static const double BorderWeight = 4.0;
+		static const double MinFlipCosine = 0.2;
+		static const uint32_t MaxVertexTriangles = 24;
+
+		std::vector<LodLevel> levels;
+		size_t sourceTriangles = indexCount / 3;
+		if (sourceTriangles == 0 || maxLods < 2) {
+			return levels;
+		}
+
+		auto position = [&](uint32_t vertex) {
+			return reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + positionStride * vertex);
+		};
+		auto uv = [&](uint32_t vertex) {
+			return reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(uvs) + uvStride * vertex);
+		};
+
+		// Weld vertices by position into groups.
+		struct PositionKey {
+			uint32_t	Bits[3];
+			bool operator==(const PositionKey& other) const { return memcmp(Bits, other.Bits, sizeof(Bits)) == 0; }
+		};
+		struct PositionHash {
+			size_t operator()(const PositionKey& key) const {
+				return (static_cast<size_t>(key.Bits[0]) * 73856093u) ^ (static_cast<size_t>(key.Bits[1]) * 19349663u) ^ (static_cast<size_t>(key.Bits[2]) * 83492791u);
+			}
+		};
+
+		std::unordered_map<PositionKey, uint32_t, PositionHash> welded;
+		welded.reserve(vertexCount);
+		std::vector<uint32_t> group(vertexCount);
+		std::vector<double> groupPosition;
+		for (size_t v = 0; v < vertexCount; v++) {
+			PositionKey key;
+			for (int axis = 0; axis < 3; axis++) {
+				float value = position(static_cast<uint32_t>(v))[axis] + 0.0f; // -0 welds with +0
+				memcpy(&key.Bits[axis], &value, sizeof(float));
+			}
+			auto inserted = welded.emplace(key, static_cast<uint32_t>(welded.size()));
+			group[v] = inserted.first->second;
+			if (inserted.second) {
+				const float* p = position(static_cast<uint32_t>(v));
+				groupPosition.insert(groupPosition.end(), { p[0], p[1], p[2] });
+			}
+		}
+		size_t groupCount = welded.size();
+		welded = {};
+
+		std::vector<uint32_t> memberOffsets(groupCount + 1, 0);
+		for (size_t v = 0; v < vertexCount; v++) {
+			memberOffsets[group[v] + 1]++;
+		}
+		for (size_t g = 0; g < groupCount; g++) {
+			memberOffsets[g + 1] += memberOffsets[g];
+		}
+		std::vector<uint32_t> members(vertexCount);
+		{
+			std::vector<uint32_t> fill(memberOffsets.begin(), memberOffsets.end() - 1);
+			for (size_t v = 0; v < vertexCount; v++) {
+				members[fill[group[v]]++] = static_cast<uint32_t>(v);
+			}
+		}
+
+		// Triangles over groups; source keeps the original corners for output.
+		struct Triangle {
+			uint32_t	Corners[3];
+			uint32_t	Source;
+		};
+		std::vector<Triangle> triangles;
+		triangles.reserve(sourceTriangles);
+		for (size_t t = 0; t < sourceTriangles; t++) {
+			uint32_t a = group[indices[t * 3 + 0]], b = group[indices[t * 3 + 1]], c = group[indices[t * 3 + 2]];
+			if (a != b && b != c && a != c) {
+				triangles.push_back({ { a, b, c }, static_cast<uint32_t>(t) });
+			}
+		}
+		if (triangles.empty()) {
+			return levels;
+		}
+
+		std::vector<std::vector<uint32_t>> groupTriangles(groupCount);
+		for (size_t t = 0; t < triangles.size(); t++) {
+			for (uint32_t corner : triangles[t].Corners) {
+				groupTriangles[corner].push_back(static_cast<uint32_t>(t));
+			}
+		}
+
+		auto groupPoint = [&](uint32_t g) { return &groupPosition[g * 3]; };
+		auto normalOf = [&](const double* a, const double* b, const double* c, double normal[3]) {
+			double ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+			double ac[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+			normal[0] = ab[1] * ac[2] - ab[2] * ac[1];
+			normal[1] = ab[2] * ac[0] - ab[0] * ac[2];
+			normal[2] = ab[0] * ac[1] - ab[1] * ac[0];
+			return std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		};
+
+		// Face planes, then a perpendicular plane along every border edge.
+		std::vector<Quadric> quadrics(groupCount, Quadric());
+		std::unordered_map<uint64_t, uint32_t> edgeUse;
+		edgeUse.reserve(triangles.size() * 2);
+		auto edgeKey = [](uint32_t a, uint32_t b) {
+			return a < b ? (static_cast<uint64_t>(a) << 32) | b : (static_cast<uint64_t>(b) << 32) | a;
+		};
+		for (const Triangle& triangle : triangles) {
+			double normal[3];
+			double length = normalOf(groupPoint(triangle.Corners[0]), groupPoint(triangle.Corners[1]), groupPoint(triangle.Corners[2]), normal);
+			if (length > 0.0) {
+				for (double& component : normal) {
+					component /= length;
+				}
+				const double* p = groupPoint(triangle.Corners[0]);
+				double distance = -(normal[0] * p[0] + normal[1] * p[1] + normal[2] * p[2]);
+				for (uint32_t corner : triangle.Corners) {
+					quadrics[corner].AddPlane(normal, distance, 1.0);
+				}
+			}
+			for (int edge = 0; edge < 3; edge++) {
+				edgeUse[edgeKey(triangle.Corners[edge], triangle.Corners[(edge + 1) % 3])]++;
+			}
+		}
+
+		std::vector<bool> border(groupCount, false);
+		for (const Triangle& triangle : triangles) {
+			double normal[3];
+			double length = normalOf(groupPoint(triangle.Corners[0]), groupPoint(triangle.Corners[1]), groupPoint(triangle.Corners[2]), normal);
+			for (int edge = 0; edge < 3; edge++) {
+				uint32_t a = triangle.Corners[edge], b = triangle.Corners[(edge + 1) % 3];
+				if (edgeUse[edgeKey(a, b)] != 1) {
+					continue;
+				}
+				border[a] = border[b] = true;
+				if (length == 0.0) {
+					continue;
+				}
+
+				const double* pa = groupPoint(a);
+				const double* pb = groupPoint(b);
+				double direction[3] = { pb[0] - pa[0], pb[1] - pa[1], pb[2] - pa[2] };
+				double plane[3] = {
+					direction[1] * normal[2] - direction[2] * normal[1],
+					direction[2] * normal[0] - direction[0] * normal[2],
+					direction[0] * normal[1] - direction[1] * normal[0]
+				};
+				double planeLength = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+				if (planeLength == 0.0) {
+					continue;
+				}
+				for (double& component : plane) {
+					component /= planeLength;
+				}
+				double distance = -(plane[0] * pa[0] + plane[1] * pa[1] + plane[2] * pa[2]);
+				quadrics[a].AddPlane(plane, distance, BorderWeight);
+				quadrics[b].AddPlane(plane, distance, BorderWeight);
+			}
+		}
+
+		std::vector<bool> alive(triangles.size(), true);
+		std::vector<bool> removed(groupCount, false);
+		std::vector<uint32_t> version(groupCount, 0);
+		size_t aliveCount = triangles.size();
+
+		auto contains = [&](uint32_t t, uint32_t g) {
+			const uint32_t* corners = triangles[t].Corners;
+			return corners[0] == g || corners[1] == g || corners[2] == g;
+		};
+
+		// Cost of moving from onto to, or infinity if it would tear a border.
+		auto collapseCost = [&](uint32_t from, uint32_t to) {
+			if (border[from]) {
+				uint32_t shared = 0;
+				for (uint32_t t : groupTriangles[from]) {
+					shared += alive[t] && contains(t, to);
+				}
+				if (shared != 1) {
+					return std::numeric_limits<double>::infinity();
+				}
+			}
+			Quadric quadric = quadrics[from];
+			quadric.Add(quadrics[to]);
+			return quadric.Evaluate(groupPoint(to));
+		};
+
+		struct Candidate {
+			double		Cost;
+			uint32_t	From;
+			uint32_t	To;
+			uint32_t	FromVersion;
+			uint32_t	ToVersion;
+			double		Length;		// Squared; breaks ties between equal costs
+
+			bool operator<(const Candidate& other) const {
+				return Cost != other.Cost ? Cost > other.Cost : Length > other.Length;
+			}
+		};
+		std::priority_queue<Candidate> heap;
+		auto pushEdge = [&](uint32_t a, uint32_t b) {
+			double forward = collapseCost(a, b);
+			double backward = collapseCost(b, a);
+			if (forward == std::numeric_limits<double>::infinity() && backward == std::numeric_limits<double>::infinity()) {
+				return;
+			}
+			if (backward < forward) {
+				std::swap(a, b);
+				forward = backward;
+			}
+			const double* pa = groupPoint(a);
+			const double* pb = groupPoint(b);
+			double length = (pb[0] - pa[0]) * (pb[0] - pa[0]) + (pb[1] - pa[1]) * (pb[1] - pa[1]) + (pb[2] - pa[2]) * (pb[2] - pa[2]);
+			heap.push({ forward, a, b, version[a], version[b], length });
+		};
+
+		for (const auto& edge : edgeUse) {
+			pushEdge(static_cast<uint32_t>(edge.first >> 32), static_cast<uint32_t>(edge.first & 0xFFFFFFFF));
+		}
+		edgeUse = {};
+
+		std::vector<uint32_t> stamp(groupCount, 0);
+		uint32_t currentStamp = 0;
+
+		/*
+			Rejects collapses that flip a triangle, pinch the surface or grow a
+			fan past MaxVertexTriangles. Without the cap, flat regions (where
+			every collapse costs zero) keep collapsing onto one survivor, whose
+			fan then grows with the mesh and makes every later collapse linear.
+		*/
+		auto collapseAllowed = [&](uint32_t from, uint32_t to) {
+			uint32_t shared = 0, fromTriangles = 0;
+			for (uint32_t t : groupTriangles[from]) {
+				if (!alive[t]) {
+					continue;
+				}
+				fromTriangles++;
+				if (contains(t, to)) {
+					shared++;
+					continue;
+				}
+
+				const uint32_t* corners = triangles[t].Corners;
+				const double* before[3];
+				const double* after[3];
+				for (int corner = 0; corner < 3; corner++) {
+					before[corner] = groupPoint(corners[corner]);
+					after[corner] = corners[corner] == from ? groupPoint(to) : before[corner];
+				}
+				double normalBefore[3], normalAfter[3];
+				double lengthBefore = normalOf(before[0], before[1], before[2], normalBefore);
+				double lengthAfter = normalOf(after[0], after[1], after[2], normalAfter);
+				double dot = normalBefore[0] * normalAfter[0] + normalBefore[1] * normalAfter[1] + normalBefore[2] * normalAfter[2];
+				if (lengthAfter == 0.0 || dot < MinFlipCosine * lengthBefore * lengthAfter) {
+					return false;
+				}
+			}
+
+			// Link condition: the endpoints may only share the neighbours
+			// opposite the edge.
+			currentStamp += 2;
+			for (uint32_t t : groupTriangles[from]) {
+				if (alive[t]) {
+					for (uint32_t corner : triangles[t].Corners) {
+						stamp[corner] = currentStamp;
+					}
+				}
+			}
+			uint32_t common = 0, toTriangles = 0;
+			for (uint32_t t : groupTriangles[to]) {
+				if (!alive[t]) {
+					continue;
+				}
+				toTriangles++;
+				for (uint32_t corner : triangles[t].Corners) {
+					if (corner != from && corner != to && stamp[corner] == currentStamp) {
+						stamp[corner] = currentStamp + 1;
+						common++;
+					}
+				}
+			}
+			if (common > shared) {
+				return false;
+			}
+
+			// Fans that are already larger (e.g. at the pole of a UV sphere) may
+			// still shrink.
+			uint32_t merged = fromTriangles + toTriangles - 2 * shared;
+			return merged <= MaxVertexTriangles || merged <= std::max(fromTriangles, toTriangles);
+		};
+
+		auto emitLevel = [&](double error) {
+			LodLevel level;
+			level.Error = static_cast<float>(std::sqrt(error));
+			level.Indices.reserve(aliveCount * 3);
+			for (size_t t = 0; t < triangles.size(); t++) {
+				if (!alive[t]) {
+					continue;
+				}
+				for (int corner = 0; corner < 3; corner++) {
+					uint32_t source = indices[triangles[t].Source * 3 + corner];
+					uint32_t target = triangles[t].Corners[corner];
+					if (group[source] != target) {
+						uint32_t best = members[memberOffsets[target]];
+						if (uvs) {
+							float bestDistance = std::numeric_limits<float>::max();
+							for (uint32_t m = memberOffsets[target]; m < memberOffsets[target + 1]; m++) {
+								float du = uv(members[m])[0] - uv(source)[0];
+								float dv = uv(members[m])[1] - uv(source)[1];
+								if (du * du + dv * dv < bestDistance) {
+									bestDistance = du * du + dv * dv;
+									best = members[m];
+								}
+							}
+						}
+						source = best;
+					}
+					level.Indices.push_back(source);
+				}
+			}
+			OptimizeVertexCache(level.Indices.data(), level.Indices.size(), vertexCount);
+			levels.push_back(std::move(level));
+		};
+
+		double error = 0.0;
+		size_t previous = aliveCount;
+		while (levels.size() + 1 < maxLods) {
+			size_t target = static_cast<size_t>(previous * reduction);
+			while (aliveCount > target && !heap.empty()) {
+				Candidate candidate = heap.top();
+				heap.pop();
+
+				uint32_t from = candidate.From, to = candidate.To;
+				if (removed[from] || removed[to] || version[from] != candidate.FromVersion || version[to] != candidate.ToVersion) {
+					continue;
+				}
+				if (!collapseAllowed(from, to)) {
+					continue;
+				}
+
+				for (uint32_t t : groupTriangles[from]) {
+					if (!alive[t]) {
+						continue;
+					}
+					if (contains(t, to)) {
+						alive[t] = false;
+						aliveCount--;
+						continue;
+					}
+					for (uint32_t& corner : triangles[t].Corners) {
+						if (corner == from) {
+							corner = to;
+						}
+					}
+					groupTriangles[to].push_back(t);
+				}
+				groupTriangles[from] = std::vector<uint32_t>();
+				quadrics[to].Add(quadrics[from]);
+				removed[from] = true;
+				version[to]++;
+				error = std::max(error, candidate.Cost);
+
+				// Compact the survivor's triangles and requeue its edges.
+				std::vector<uint32_t>& around = groupTriangles[to];
+				around.erase(std::remove_if(around.begin(), around.end(), [&](uint32_t t) { return !alive[t]; }), around.end());
+				currentStamp += 2;
+				for (uint32_t t : around) {
+					for (uint32_t corner : triangles[t].Corners) {
+						if (corner != to && stamp[corner] != currentStamp) {
+							stamp[corner] = currentStamp;
+							pushEdge(to, corner);
+						}
+					}
+				}
+			}
+
+			// Stop once a level no longer removes a meaningful share.
+			if (aliveCount == 0 || aliveCount > previous * 0.9) {
+				break;
+			}
+			emitLevel(error);
+			previous = aliveCount;
+		}
+		return levels;
+	}
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+	Index-width helpers for meshes too large for 16-bit indices. Shared with
+	mesh-bake, so this header must stay free of engine includes.
+*/
+namespace meshops {
+
+	// Largest vertex count drawn with 16-bit indices. 0xFFFF itself is left
+	// unused since it doubles as the strip cut value.
+	static const uint32_t MaxShortIndexVertices = 0xFFFF;
+
+	inline bool NeedsLongIndices(size_t vertexCount) {
+		return vertexCount > MaxShortIndexVertices;
+	}
+
+	struct Cluster {
+		std::vector<uint32_t>	Vertices;	// Source vertex for each cluster vertex
+		std::vector<uint16_t>	Indices;
+	};
+
+	/*
+		Splits a triangle list into clusters of at most maxVertices vertices so
+		each can be drawn with 16-bit indices. Triangles are taken in order and a
+		new cluster starts whenever the next one would not fit, which keeps the
+		source order (and most of its vertex cache locality); vertices on a cut
+		are duplicated into both clusters.
+	*/
+	inline std::vector<Cluster> SplitForShortIndices(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t maxVertices = MaxShortIndexVertices) {
+		std::vector<Cluster> clusters;
+
+		// remap[v] is v's index in the current cluster while stamp[v] == cluster.
+		std::vector<uint32_t> remap(vertexCount);
+		std::vector<uint32_t> stamp(vertexCount, 0);
+		uint32_t cluster = 1;
+
+		Cluster current;
+		for (size_t triangle = 0; triangle + 2 < indexCount; triangle += 3) {
+			uint32_t added = 0;
+			for (size_t corner = 0; corner < 3; corner++) {
+				added += stamp[indices[triangle + corner]] != cluster;
+			}
+
+			if (current.Vertices.size() + added > maxVertices) {
+				clusters.push_back(std::move(current));
+				current = Cluster();
+				cluster++;
+			}
+
+			for (size_t corner = 0; corner < 3; corner++) {
+				uint32_t vertex = indices[triangle + corner];
+				if (stamp[vertex] != cluster) {
+					stamp[vertex] = cluster;
+					remap[vertex] = static_cast<uint32_t>(current.Vertices.size());
+					current.Vertices.push_back(vertex);
+				}
+				current.Indices.push_back(static_cast<uint16_t>(remap[vertex]));
+			}
+		}
+
+		if (!current.Indices.empty()) {
+			clusters.push_back(std::move(current));
+		}
+		return clusters;
+	}
+
+	template<typename Vertex>
+	inline std::vector<Vertex> GatherVertices(const Vertex* vertices, const Cluster& cluster) {
+		std::vector<Vertex> gathered(cluster.Vertices.size());
+		for (size_t i = 0; i < cluster.Vertices.size(); i++) {
+			gathered[i] = vertices[cluster.Vertices[i]];
+		}
+		return gathered;
+	}
+}
@@ -2,14 +2,74 @@
 #include "Model.h"
 
 #include "Mesh.h"
+#include "BakedMesh.h"
+#include "MeshSplit.h"
+#include "MeshOptimize.h"
+#include "MeshSimplify.h"
+#include "common/MappedFile.h"
 
 namespace gfx {
 	
+	/*
+		One GPU mesh worth of converted data. Only one of the index arrays is
+		filled: 16-bit whenever the vertex count allows, with every level of
+		detail appended after the full mesh. Packed formats replace vertices
+		with packed.
+	*/
+	struct Model::MeshPart {
+		Mesh::Vertices				vertices;
+		Mesh::Indices				indices;
+		Mesh::Indices32				longIndices;
+		std::vector<uint8_t>		packed;
+		meshops::PositionTransform	transform;
+		std::vector<MeshLod>		lods;
+		XMFLOAT4					boundingSphere;
+	};
+
+	static XMFLOAT4 BoundingSphere(const XMFLOAT3& min, const XMFLOAT3& max) {
+		XMVECTOR low = XMLoadFloat3(&min);
+		XMVECTOR high = XMLoadFloat3(&max);
+		XMFLOAT4 sphere;
+		XMStoreFloat4(&sphere, XMVectorSetW((low + high) * 0.5f, XMVectorGetX(XMVector3Length(high - low)) * 0.5f));
+		return sphere;
+	}
+
+	// Centred on the bounds, but with the radius of the farthest vertex.
+	static XMFLOAT4 BoundingSphere(const VertexData* vertices, size_t vertexCount) {
+		if (vertexCount == 0) {
+			return XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f);
+		}
+
+		XMVECTOR min = XMLoadFloat3(&vertices[0].position);
+		XMVECTOR max = min;
+		for (size_t i = 1; i < vertexCount; i++) {
+			XMVECTOR position = XMLoadFloat3(&vertices[i].position);
+			min = XMVectorMin(min, position);
+			max = XMVectorMax(max, position);
+		}
+
+		XMVECTOR centre = (min + max) * 0.5f;
+		XMVECTOR radius = XMVectorZero();
+		for (size_t i = 0; i < vertexCount; i++) {
+			radius = XMVectorMax(radius, XMVector3LengthSq(XMLoadFloat3(&vertices[i].position) - centre));
+		}
+
+		XMFLOAT4 sphere;
+		XMStoreFloat4(&sphere, XMVectorSetW(centre, std::sqrt(XMVectorGetX(radius))));
+		return sphere;
+	}
+
 	Model::Model() : m_meshes() {}
 
 	Model::~Model() {}
 
-	std::shared_ptr<Model> Model::LoadFromFile(dx12::CommandList& commandList, const std::string& file) {
+	std::shared_ptr<Model> Model::LoadFromFile(dx12::CommandList& commandList, const std::string& file, const ModelLoadOptions& options) {
+		PROFILE_SCOPE("Model::LoadFromFile");
+
+		if (std::filesystem::path(file).extension() == bmesh::Extension) {
+			return LoadBaked(commandList, file, options.Format);
+		}
+
 		Assimp::Importer importer;
 		const aiScene* scene = importer.ReadFile(
 			file,
@@ -25,8 +85,133 @@ namespace gfx {
 			throw std::exception(importer.GetErrorString());
 		}
 
+		std::vector<aiMesh*> meshes;
+		CollectAINode(scene->mRootNode, scene, meshes);
+		for (aiMesh* mesh : meshes) {
+			if (!mesh->HasPositions()) {
+				LOG_ERROR(Asset, L"Invalid mesh!\n");
+				throw std::exception("Invalid mesh!");
+			}
+		}
+
+		// Every mesh converts into its own preallocated slot, so the jobs share
+		// nothing and the result keeps the node order.
+		std::vector<std::vector<MeshPart>> parts(meshes.size());
+		std::vector<meshops::OptimizeReport> reports(meshes.size());
+		{
+			PROFILE_SCOPE("Model::ProcessAIMesh");
+			jobs::JobSystem::ParallelFor(meshes.size(), 1, [&](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; i++) {
+					ProcessAIMesh(meshes[i], options, parts[i], reports[i]);
+				}
+			});
+		}
+
+		if (options.OptimizeMeshes) {
+			double missesBefore = 0.0, missesAfter = 0.0;
+			size_t triangles = 0, vertices = 0;
+			for (const meshops::OptimizeReport& report : reports) {
+				missesBefore += report.Before.ACMR * report.Triangles;
+				missesAfter += report.After.ACMR * report.Triangles;
+				triangles += report.Triangles;
+				vertices += report.Vertices;
+			}
+			if (triangles > 0 && vertices > 0) {
+				LOG_INFO(Asset, L"[Model] %S: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", file.c_str(),
+					missesBefore / triangles, missesAfter / triangles, missesBefore / vertices, missesAfter / vertices);
+			}
+		}
+
+		if (options.GenerateLods) {
+			LogLods(file, parts);
+		}
+
+		std::shared_ptr<Model> model = std::make_shared<Model>();
+		std::vector<dx12::CommandList::BufferCopy> copies;
+		copies.reserve(meshes.size() * 2);
+		model->m_meshes.reserve(meshes.size());
+		for (auto& meshParts : parts) {
+			for (MeshPart& part : meshParts) {
+				size_t vertexCount = options.Format == VertexFormat::FULL ? part.vertices.size() : part.packed.size() / Mesh::VertexStride(options.Format);
+				const void* vertices = options.Format == VertexFormat::FULL ? static_cast<const void*>(part.vertices.data()) : part.packed.data();
+				if (part.longIndices.empty()) {
+					model->m_meshes.push_back(Mesh::CreateBatched(copies, options.Format, vertices, vertexCount, part.transform, part.indices.data(), part.indices.size(), sizeof(uint16_t)));
+				} else {
+					model->m_meshes.push_back(Mesh::CreateBatched(copies, options.Format, vertices, vertexCount, part.transform, part.longIndices.data(), part.longIndices.size(), sizeof(uint32_t)));
+				}
+				model->m_meshes.back()->SetLods(part.lods, part.boundingSphere);
+			}
+		}
+		commandList.CopyBuffers(copies);
+		return model;
+	}
+
+	std::shared_ptr<Model> Model::LoadBaked(dx12::CommandList& commandList, const std::string& file, VertexFormat format) {
+		static_assert(sizeof(VertexData) == sizeof(bmesh::Vertex), "Baked vertices must match VertexData");
+		static_assert(static_cast<uint32_t>(VertexFormat::PACKED) == static_cast<uint32_t>(bmesh::Layout::Packed) &&
+			static_cast<uint32_t>(VertexFormat::PACKED_QUANTIZED) == static_cast<uint32_t>(bmesh::Layout::PackedQuantized), "Baked layouts must match VertexFormat");
+
+		MappedFile mapping;
+		bmesh::View view;
+		if (!mapping.Open(file) || !view.Open(mapping.Data(), mapping.Size())) {
+			LOG_ERROR(Asset, L"[Model] %S is missing or not a version %u baked mesh\n", file.c_str(), bmesh::Version);
+			throw std::exception("Invalid baked mesh");
+		}
+
+		// Baked in the requested layout, the vertices upload straight from the
+		// mapping with the transform stored beside them. A file baked in the full
+		// layout can still be packed here on the job threads, one pass over every
+		// vertex; packed layouts cannot be converted back.
+		bmesh::Layout layout = static_cast<bmesh::Layout>(format);
+		bool repack = view.VertexLayout() != layout;
+		if (repack && view.VertexLayout() != bmesh::Layout::Full) {
+			LOG_ERROR(Asset, L"[Model] %S was baked in vertex layout %u, not %u\n", file.c_str(), static_cast<uint32_t>(view.VertexLayout()), static_cast<uint32_t>(layout));
+			throw std::exception("Baked mesh layout mismatch");
+		}
+		if (repack) {
+			LOG_INFO(Asset, L"[Model] %S is baked in the full vertex layout; repacking it (bake with -format to skip this)\n", file.c_str());
+		}
+
+		std::vector<std::vector<uint8_t>> packed(repack ? view.MeshCount() : 0);
+		std::vector<meshops::PositionTransform> transforms(view.MeshCount());
+		for (uint32_t i = 0; i < view.MeshCount(); i++) {
+			transforms[i] = view.Mesh(i).Position;
+		}
+		if (repack) {
+			PROFILE_SCOPE("Mesh::PackVertices");
+			jobs::JobSystem::ParallelFor(view.MeshCount(), 1, [&](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; i++) {
+					const bmesh::MeshRecord& mesh = view.Mesh(static_cast<uint32_t>(i));
+					transforms[i] = Mesh::PackVertices(format, static_cast<const VertexData*>(view.Vertices(mesh)), mesh.VertexCount, packed[i]);
+				}
+			});
+		}
+
 		std::shared_ptr<Model> model = std::make_shared<Model>();
-		model->ProcessAINode(commandList, scene->mRootNode, scene);
+		std::vector<dx12::CommandList::BufferCopy> copies;
+		copies.reserve(view.MeshCount() * 2);
+		model->m_meshes.reserve(view.MeshCount());
+		for (uint32_t i = 0; i < view.MeshCount(); i++) {
+			const bmesh::MeshRecord& mesh = view.Mesh(i);
+			model->m_meshes.push_back(gfx::Mesh::CreateBatched(
+				copies, format,
+				packed.empty() ? view.Vertices(mesh) : packed[i].data(), mesh.VertexCount, transforms[i],
+				view.Indices(mesh), mesh.IndexCount, mesh.IndexSize
+			));
+
+			std::vector<MeshLod> lods(mesh.LodCount);
+			for (uint32_t level = 0; level < mesh.LodCount; level++) {
+				const bmesh::LodRecord& lod = view.Lod(mesh, level);
+				lods[level] = { lod.StartIndex, lod.IndexCount, lod.Error };
+			}
+			model->m_meshes.back()->SetLods(lods, BoundingSphere(
+				XMFLOAT3(mesh.Bounds.Min[0], mesh.Bounds.Min[1], mesh.Bounds.Min[2]),
+				XMFLOAT3(mesh.Bounds.Max[0], mesh.Bounds.Max[1], mesh.Bounds.Max[2])
+			));
+		}
+
+		// The mapping must outlive the staging copies.
+		commandList.CopyBuffers(copies);
 		return model;
 	}
 
@@ -36,28 +221,103 @@ namespace gfx {
 		}
 	}
 
-	void Model::ProcessAINode(dx12::CommandList& commandList, aiNode* node, const aiScene* scene) {
+	/*
+		A level's error is in mesh units; scaled by the model-view matrix and
+		divided by the distance to the nearest point of the bounding sphere it
+		gives an upper bound on the error in pixels. Errors grow with the level,
+		so the search runs from the coarsest level down.
+	*/
+	static size_t SelectLod(const Mesh& mesh, const LodView& view) {
+		const std::vector<MeshLod>& lods = mesh.Lods();
+		const XMFLOAT4& sphere = mesh.BoundingSphere();
+
+		float scale = std::max({
+			XMVectorGetX(XMVector3Length(view.ModelView.r[0])),
+			XMVectorGetX(XMVector3Length(view.ModelView.r[1])),
+			XMVectorGetX(XMVector3Length(view.ModelView.r[2]))
+		});
+		XMVECTOR centre = XMVector3Transform(XMVectorSet(sphere.x, sphere.y, sphere.z, 1.0f), view.ModelView);
+		float distance = XMVectorGetX(XMVector3Length(centre)) - sphere.w * scale;
+		if (distance <= 0.0f) {
+			return 0;
+		}
+
+		for (size_t level = lods.size() - 1; level > 0; level--) {
+			if (lods[level].Error * scale * view.PixelsPerUnit <= view.MaxPixelError * distance) {
+				return level;
+			}
+		}
+		return 0;
+	}
+
+	void Model::Draw(dx12::CommandList& commandList, const LodView& view) {
+		Draw(commandList, view, 0, m_meshes.size());
+	}
+
+	void Model::Draw(dx12::CommandList& commandList, const LodView& view, size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			m_meshes[i]->Draw(commandList, SelectLod(*m_meshes[i], view));
+		}
+	}
+
+	void Model::LogLods(const std::string& file, const std::vector<std::vector<MeshPart>>& parts) {
+		// Meshes with fewer levels count at their coarsest one.
+		size_t triangles[meshops::MaxLodCount] = {};
+		float error[meshops::MaxLodCount] = {};
+		size_t levels = 1;
+		for (const auto& meshParts : parts) {
+			for (const MeshPart& part : meshParts) {
+				levels = std::max(levels, part.lods.size());
+				for (size_t level = 0; level < meshops::MaxLodCount; level++) {
+					const MeshLod& lod = part.lods[std::min(level, part.lods.size() - 1)];
+					triangles[level] += lod.IndexCount / 3;
+					error[level] = std::max(error[level], lod.Error);
+				}
+			}
+		}
+
+		if (triangles[0] == 0) {
+			return;
+		}
+		for (size_t level = 1; level < levels; level++) {
+			LOG_INFO(Asset, L"[Model] %S: LOD%zu %zu triangles (%.1f%%), error %g\n", file.c_str(),
+				level, triangles[level], 100.0 * triangles[level] / triangles[0], error[level]);
+		}
+	}
+
+	void Model::CollectAINode(aiNode* node, const aiScene* scene, std::vector<aiMesh*>& meshes) {
 		for (int i = 0; i < node->mNumMeshes; i++) {
-			aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-			m_meshes.push_back(ProcessAIMesh(commandList, mesh, scene));
+			meshes.push_back(scene->mMeshes[node->mMeshes[i]]);
 		}
 
 		for (int i = 0; i < node->mNumChildren; i++) {
-			ProcessAINode(commandList, node->mChildren[i], scene);
+			CollectAINode(node->mChildren[i], scene, meshes);
 		}
 	}
 
-	std::shared_ptr<Mesh> Model::ProcessAIMesh(dx12::CommandList& commandList, aiMesh* mesh, const aiScene* scene) {
-		Mesh::Vertices vertices;
-		Mesh::Indices indices;
+	template<typename T>
+	static void CopyAIFaces(aiMesh* mesh, std::vector<T>& indices, size_t indexCount) {
+		indices.resize(indexCount);
+		T* index = indices.data();
+		for (int i = 0; i < mesh->mNumFaces; i++) {
+			const aiFace& face = mesh->mFaces[i];
+			for (int j = 0; j < face.mNumIndices; j++) {
+				*index++ = static_cast<T>(face.mIndices[j]);
+			}
+		}
+	}
 
+	void Model::ProcessAIMesh(aiMesh* mesh, const ModelLoadOptions& options, std::vector<MeshPart>& parts, meshops::OptimizeReport& report) {
+		parts.resize(1);
+		Mesh::Vertices& vertices = parts[0].vertices;
+		vertices.resize(mesh->mNumVertices);
 		for (int i = 0; i < mesh->mNumVertices; i++) {
-			VertexData data;
+			VertexData& data = vertices[i];
 			
 			// COLOR -- TODO: Material handling
-			if (mesh->HasVertexColors(i)) {
+			if (mesh->HasVertexColors(0)) {
 				if (i == 0) {
-					Logger::error(L"Vertex color unsupported -- defaulting\n");
+					LOG_ERROR(Asset, L"Vertex color unsupported -- defaulting\n");
 				}
 				data.color = { 0.196f, 0.573f, 0.035 };
 			} else {
@@ -65,15 +325,10 @@ namespace gfx {
 			}
 			
 			// POSITION
-			if (mesh->HasPositions()) {
-				aiVector3D meshVertex = mesh->mVertices[i];
-				data.position.x = meshVertex.x;
-				data.position.y = meshVertex.y;
-				data.position.z = meshVertex.z;
-			} else {
-				Logger::error(L"Invalid mesh!\n");
-				throw std::exception("Invalid mesh!");
-			}
+			aiVector3D meshVertex = mesh->mVertices[i];
+			data.position.x = meshVertex.x;
+			data.position.y = meshVertex.y;
+			data.position.z = meshVertex.z;
 
 			// NORMAL
 			if (mesh->HasNormals()) {
@@ -86,7 +341,7 @@ namespace gfx {
 			}
 		
 			// TEXTURE COORD
-			if (mesh->HasTextureCoords(i)) {
+			if (mesh->HasTextureCoords(0)) {
 				aiVector3D meshUV = mesh->mTextureCoords[0][i];
 				data.uv.x = meshUV.x;
 				data.uv.y = meshUV.y;
@@ -103,17 +358,60 @@ namespace gfx {
 			} else {
 				data.tangent = { 0.0f, 0.0f, 0.0f };
 			}
-
-			vertices.push_back(data);
 		}
 
+		size_t indexCount = 0;
 		for (int i = 0; i < mesh->mNumFaces; i++) {
-			aiFace face = mesh->mFaces[i];
-			for (int j = 0; j < face.mNumIndices; j++) {
-				indices.push_back(face.mIndices[j]);
+			indexCount += mesh->mFaces[i].mNumIndices;
+		}
+
+		Mesh::Indices32& longIndices = parts[0].longIndices;
+		CopyAIFaces(mesh, longIndices, indexCount);
+
+		report = {};
+		if (options.OptimizeMeshes) {
+			report = meshops::OptimizeMesh(vertices, longIndices);
+		}
+
+		if (!meshops::NeedsLongIndices(vertices.size())) {
+			parts[0].indices.assign(longIndices.begin(), longIndices.end());
+			longIndices = Mesh::Indices32();
+		} else if (options.SplitLargeMeshes) {
+			std::vector<meshops::Cluster> clusters = meshops::SplitForShortIndices(longIndices.data(), longIndices.size(), vertices.size());
+			std::vector<MeshPart> split(clusters.size());
+			for (size_t i = 0; i < clusters.size(); i++) {
+				split[i].vertices = meshops::GatherVertices(vertices.data(), clusters[i]);
+				split[i].indices = std::move(clusters[i].Indices);
 			}
+			parts = std::move(split);
 		}
 
-		return gfx::Mesh::Create(commandList, vertices, indices);
+		for (MeshPart& part : parts) {
+			size_t indexCount = part.longIndices.empty() ? part.indices.size() : part.longIndices.size();
+			part.lods.assign(1, { 0, static_cast<UINT>(indexCount), 0.0f });
+			part.boundingSphere = BoundingSphere(part.vertices.data(), part.vertices.size());
+			if (options.GenerateLods && indexCount > 0) {
+				Mesh::Indices32 source = part.longIndices.empty() ? Mesh::Indices32(part.indices.begin(), part.indices.end()) : part.longIndices;
+				std::vector<meshops::LodLevel> levels = meshops::GenerateLods(
+					&part.vertices[0].position.x, sizeof(VertexData), &part.vertices[0].uv.x, sizeof(VertexData), part.vertices.size(),
+					source.data(), source.size()
+				);
+				for (const meshops::LodLevel& level : levels) {
+					part.lods.push_back({ static_cast<UINT>(indexCount), static_cast<UINT>(level.Indices.size()), level.Error });
+					indexCount += level.Indices.size();
+					if (part.longIndices.empty()) {
+						part.indices.insert(part.indices.end(), level.Indices.begin(), level.Indices.end());
+					} else {
+						part.longIndices.insert(part.longIndices.end(), level.Indices.begin(), level.Indices.end());
+					}
+				}
+			}
+
+			part.transform = meshops::IdentityTransform();
+			if (options.Format != VertexFormat::FULL) {
+				part.transform = Mesh::PackVertices(options.Format, part.vertices.data(), part.vertices.size(), part.packed);
+				part.vertices = Mesh::Vertices();
+			}
+		}
 	}
 }
\ No newline at end of file
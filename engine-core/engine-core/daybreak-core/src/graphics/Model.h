@@ -1,25 +1,89 @@
 #pragma once
 
+#include "graphics/VertexFormat.h"
+
+namespace meshops {
+	struct OptimizeReport;
+}
+
 namespace gfx {
 
 	class Mesh;
+	struct VertexData;
+
+	struct DAYBREAK_API ModelLoadOptions {
+		// Split meshes too large for 16-bit indices instead of using 32-bit ones.
+		bool			SplitLargeMeshes = false;
+
+		// Reorder imported meshes for the vertex cache, overdraw and vertex fetch
+		// (graphics/MeshOptimize.h). Baked meshes were optimized by mesh-bake.
+		bool			OptimizeMeshes = true;
+
+		// Layout the meshes are uploaded in; must match the Renderer's.
+		VertexFormat	Format = VertexFormat::FULL;
+
+		// Build up to meshops::MaxLodCount levels of detail per imported mesh
+		// (graphics/MeshSimplify.h). Baked meshes carry the ones mesh-bake built.
+		bool			GenerateLods = true;
+	};
+
+	/*
+		Camera state Draw needs to turn LOD errors into pixels. ModelView takes
+		the model to view space; PixelsPerUnit is the on-screen size of one unit
+		at distance one, i.e. viewport height * cot(fovY / 2) / 2 (the
+		projection's _22 times half the height).
+	*/
+	struct DAYBREAK_API LodView {
+		XMMATRIX		ModelView;
+		float			PixelsPerUnit;
+		float			MaxPixelError = 1.0f;
+	};
 
 	class DAYBREAK_API Model {
 	public:
-		static std::shared_ptr<Model> LoadFromFile(dx12::CommandList& commandList, const std::string& file);
+		/*
+			Files baked by mesh-bake (.bmesh) are mapped and uploaded as stored;
+			anything else goes through a full Assimp import. Imported meshes use
+			16-bit indices when they fit and 32-bit otherwise, unless
+			SplitLargeMeshes is set, in which case oversized meshes are split into
+			16-bit clusters instead. Either way vertices are packed to Format on
+			the load jobs, which also build each mesh's levels of detail.
+		*/
+		static std::shared_ptr<Model> LoadFromFile(dx12::CommandList& commandList, const std::string& file, const ModelLoadOptions& options = ModelLoadOptions());
 
 		Model();
 		virtual ~Model();
 		void Draw(dx12::CommandList& commandList);
 
+		/*
+			Draws every mesh at the coarsest level whose error, projected from the
+			near side of the mesh's bounding sphere, stays within
+			view.MaxPixelError. Meshes the camera is inside of draw in full.
+		*/
+		void Draw(dx12::CommandList& commandList, const LodView& view);
+
+		// As above for meshes [begin, end), to split a model across command lists.
+		void Draw(dx12::CommandList& commandList, const LodView& view, size_t begin, size_t end);
+
+		size_t MeshCount() const { return m_meshes.size(); }
+
 	private:
 		friend struct std::default_delete<Model>;
 
 		
 		Model(const Model& copy) = delete;
 		
-		void ProcessAINode(dx12::CommandList& commandList, aiNode* node, const aiScene* scene);
-		std::shared_ptr<Mesh> ProcessAIMesh(dx12::CommandList& commandList, aiMesh* mesh, const aiScene* scene);
+		static std::shared_ptr<Model> LoadBaked(dx12::CommandList& commandList, const std::string& file, VertexFormat format);
+
+		static void CollectAINode(aiNode* node, const aiScene* scene, std::vector<aiMesh*>& meshes);
+
+		struct MeshPart;
+
+		// Runs on job threads; converts into the caller's preallocated slot.
+		static void ProcessAIMesh(aiMesh* mesh, const ModelLoadOptions& options, std::vector<MeshPart>& parts, meshops::OptimizeReport& report);
+
+		// Logs each level's share of the full triangle count and its worst error.
+		static void LogLods(const std::string& file, const std::vector<std::vector<MeshPart>>& parts);
 
 		using ModelMeshes = std::vector<std::shared_ptr<Mesh>>;
 		ModelMeshes m_meshes;
@@ -2,6 +2,7 @@
 
 #include "Renderer.h"
 #include "graphics/Mesh.h"
+#include "platform/dx12/CommandBatch.h"
 #include "engine/manager/RenderStateManager.h"
 
 namespace gfx {
@@ -21,7 +22,7 @@ namespace gfx {
 	void Renderer::Initialize(const dx12::CommandList& commandList, int initialWidth, int initialHeight) {
 		auto device = dx12::Application::Device();
 
-		Logger::info(L"[Renderer::Initialize] Setup shared pipeline state...\n");
+		LOG_INFO(Render, L"[Renderer::Initialize] Setup shared pipeline state...\n");
 		D3D12_FEATURE_DATA_ROOT_SIGNATURE featureData;
 		featureData.HighestVersion = D3D_ROOT_SIGNATURE_VERSION_1_1;
 		if (FAILED(device->CheckFeatureSupport(D3D12_FEATURE_ROOT_SIGNATURE, &featureData, sizeof(featureData)))) {
@@ -40,25 +41,26 @@ namespace gfx {
 			D3D12_ROOT_SIGNATURE_FLAG_DENY_DOMAIN_SHADER_ROOT_ACCESS |
 			D3D12_ROOT_SIGNATURE_FLAG_DENY_GEOMETRY_SHADER_ROOT_ACCESS;
 	
-		Logger::info(L"[Renderer::Initialize] Loading vertex shader for Geometry Pass...\n");
+		LOG_INFO(Render, L"[Renderer::Initialize] Loading vertex shader for Geometry Pass...\n");
 		ThrowOnFailure(D3DReadFileToBlob(m_shaderPaths.GeometryVertex.c_str(), &m_geometryVertexShader));
 
 		// Load the pixel shader.
-		Logger::info(L"[Renderer::Initialize] Loading pixel shader for Geometry Pass...\n");
+		LOG_INFO(Render, L"[Renderer::Initialize] Loading pixel shader for Geometry Pass...\n");
 		ThrowOnFailure(D3DReadFileToBlob(m_shaderPaths.GeometryPixel.c_str(), &m_geometryPixelShader));
 
-		Logger::info(L"[Renderer::Initialize] Creating root signature for Geometry Pass...\n");
+		LOG_INFO(Render, L"[Renderer::Initialize] Creating root signature for Geometry Pass...\n");
 		CD3DX12_DESCRIPTOR_RANGE1 gpDescriptorRange(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 2);
 
 		CD3DX12_ROOT_PARAMETER1 gpRootParameters[GeometryRootParameters::NUM_PARAMS - 1];
 		gpRootParameters[GeometryRootParameters::MATRICES_CB].InitAsConstantBufferView(0, 0, D3D12_ROOT_DESCRIPTOR_FLAG_NONE, D3D12_SHADER_VISIBILITY_VERTEX);
+		gpRootParameters[GeometryRootParameters::MESH_CONSTANTS].InitAsConstants(Mesh::ConstantCount, 1, 0, D3D12_SHADER_VISIBILITY_VERTEX);
 		// gpRootParameters[GeometryRootParameters::TEXTURES].InitAsDescriptorTable(1, &gpDescriptorRange, D3D12_SHADER_VISIBILITY_PIXEL);
 
 		CD3DX12_VERSIONED_ROOT_SIGNATURE_DESC gpRootSignatureDescription;
 		gpRootSignatureDescription.Init_1_1(_countof(gpRootParameters), gpRootParameters, 1, &linearRepeatSampler, rootSignatureFlags);
 		m_geometryRootSignature.SetRootSignatureDesc(gpRootSignatureDescription.Desc_1_1, featureData.HighestVersion);
 
-		Logger::info(L"[Renderer::Initialize] Setup pipeline state for Geometry Pass...\n");
+		LOG_INFO(Render, L"[Renderer::Initialize] Setup pipeline state for Geometry Pass...\n");
 		D3D12_RT_FORMAT_ARRAY rtvFormats = {};
 		rtvFormats.NumRenderTargets = 3;
 		rtvFormats.RTFormats[0] = backBufferFormat;
@@ -66,7 +68,7 @@ namespace gfx {
 		rtvFormats.RTFormats[2] = backBufferFormat;
 
 		m_geometryPipelineStream.pRootSignature = m_geometryRootSignature.Signature().Get();
-		m_geometryPipelineStream.InputLayout = { gfx::VertexData::InputElements, gfx::VertexData::InputElementCount };
+		m_geometryPipelineStream.InputLayout = gfx::Mesh::InputLayout(m_shaderPaths.GeometryVertexFormat);
 		m_geometryPipelineStream.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
 		m_geometryPipelineStream.VS = CD3DX12_SHADER_BYTECODE(m_geometryVertexShader.Get());
 		m_geometryPipelineStream.PS = CD3DX12_SHADER_BYTECODE(m_geometryPixelShader.Get());
@@ -79,41 +81,54 @@ namespace gfx {
 		};
 		ThrowOnFailure(device->CreatePipelineState(&pipelineStateStreamDesc, IID_PPV_ARGS(&m_geometryPipelineState)));
 
-		Logger::info(L"[Renderer::Initialize] Creating diffuse color buffer...\n");
+		LOG_INFO(Render, L"[Renderer::Initialize] Creating diffuse color buffer...\n");
 		dx12::Texture diffuseTexture = CreateRenderColorTexture(initialWidth, initialHeight, backBufferFormat, sampleDesc, L"Diffuse Buffer");
 
-		Logger::info(L"[Renderer::Initialize] Creating normal color buffer...\n");
+		LOG_INFO(Render, L"[Renderer::Initialize] Creating normal color buffer...\n");
 		dx12::Texture normalTexture = CreateRenderColorTexture(initialWidth, initialHeight, backBufferFormat, sampleDesc, L"Normal Buffer");
 
-		Logger::info(L"[Renderer::Initialize] Creating position color buffer...\n");
+		LOG_INFO(Render, L"[Renderer::Initialize] Creating position color buffer...\n");
 		dx12::Texture positionTexture = CreateRenderColorTexture(initialWidth, initialHeight, backBufferFormat, sampleDesc, L"Position Buffer");
 
-		Logger::info(L"[Renderer::Initialize] Creating depth buffer...\n");
+		LOG_INFO(Render, L"[Renderer::Initialize] Creating depth buffer...\n");
 		dx12::Texture depthTexture = CreateRenderDepthTexture(initialWidth, initialHeight, depthBufferFormat, sampleDesc, L"Depth Buffer");
 
-		Logger::info(L"[TestGame::Initialize] Attaching depth & color buffers...\n");
+		LOG_INFO(Render, L"[TestGame::Initialize] Attaching depth & color buffers...\n");
 		m_renderTarget.AttachTexture(dx12::AttachmentPoint::COLOR_0, diffuseTexture);
 		m_renderTarget.AttachTexture(dx12::AttachmentPoint::COLOR_1, normalTexture);
 		m_renderTarget.AttachTexture(dx12::AttachmentPoint::COLOR_2, positionTexture);
 		m_renderTarget.AttachTexture(dx12::AttachmentPoint::DEPTH_STENCIL, depthTexture);
+
+		m_batch = std::make_unique<dx12::CommandBatch>();
 	}
 
 	void Renderer::BeginRender(std::shared_ptr<dx12::CommandList> commandList) {
+		PROFILE_SCOPE("Renderer::BeginRender");
 		Clear(commandList);
-
-		commandList->SetPipelineState(m_geometryPipelineState.Get());
-		commandList->SetGraphicsRootSignature(m_geometryRootSignature);
-
-		commandList->SetViewport(m_viewport);
-		commandList->SetScissorRect(m_scissorRect);
-		commandList->SetRenderTarget(m_renderTarget);
+		BindGeometryPass(*commandList);
 	}
 
 	void Renderer::EndRender(std::shared_ptr<dx12::CommandList> commandList, std::shared_ptr<dx12::CommandQueue> commandQueue) {
+		PROFILE_SCOPE("Renderer::EndRender");
 		commandQueue->ExecuteCommandList(commandList);
 		dx12::Application::Get()->Present(m_renderTarget.GetTexture(Daybreak::RenderStateManager::GetCurrentAttachment()));
 	}
 
+	void Renderer::Render(uint32_t sliceCount, const DrawSliceFunc& draw) {
+		PROFILE_SCOPE("Renderer::Render");
+		auto clearList = m_batch->CommandList(D3D12_COMMAND_LIST_TYPE_DIRECT);
+		Clear(clearList);
+		m_batch->Submit(0, std::move(clearList));
+
+		m_batch->Record(1, sliceCount, D3D12_COMMAND_LIST_TYPE_DIRECT, [&](uint32_t slice, dx12::CommandList& commandList) {
+			BindGeometryPass(commandList);
+			draw(slice, commandList);
+		});
+
+		m_batch->Execute();
+		dx12::Application::Get()->Present(m_renderTarget.GetTexture(Daybreak::RenderStateManager::GetCurrentAttachment()));
+	}
+
 	void Renderer::Resize(int width, int height) {
 		m_viewport = CD3DX12_VIEWPORT(
 			0.0f, 0.0f,
@@ -133,6 +148,15 @@ namespace gfx {
 		commandList->ClearDepthStencilTexture(m_renderTarget.GetTexture(dx12::AttachmentPoint::DEPTH_STENCIL), D3D12_CLEAR_FLAG_DEPTH);
 	}
 
+	void Renderer::BindGeometryPass(dx12::CommandList& commandList) {
+		commandList.SetPipelineState(m_geometryPipelineState.Get());
+		commandList.SetGraphicsRootSignature(m_geometryRootSignature);
+
+		commandList.SetViewport(m_viewport);
+		commandList.SetScissorRect(m_scissorRect);
+		commandList.SetRenderTarget(m_renderTarget);
+	}
+
 	dx12::Texture Renderer::CreateRenderColorTexture(int initialWidth, int initialHeight, DXGI_FORMAT format, DXGI_SAMPLE_DESC sampleDesc, const std::wstring& name)  {
 		auto colorDesc = CD3DX12_RESOURCE_DESC::Tex2D(
 			format,
@@ -1,22 +1,35 @@
 #pragma once
 
 #include "platform/dx12/RootSignature.h"
+#include "graphics/VertexFormat.h"
+
+#include <functional>
+
+namespace dx12 {
+	class CommandBatch;
+}
 
 namespace gfx {
 
 	struct DAYBREAK_API RenderPassShaders {
 		std::wstring GeometryVertex;
 		std::wstring GeometryPixel;
+
+		// Must match what GeometryVertex reads and what the models were loaded with.
+		VertexFormat GeometryVertexFormat = VertexFormat::FULL;
 	};
 
 	enum GeometryRootParameters {
 		MATRICES_CB,        // ConstantBuffer<Mat> MatCB : register(b0);
+		MESH_CONSTANTS,     // ConstantBuffer<MeshConstants> MeshCB : register(b1); set by Mesh::Draw
 		TEXTURES,           // Texture2D DiffuseTexture : register( t2 );
 		NUM_PARAMS
 	};
 
 	class DAYBREAK_API Renderer {
 		public:
+			using DrawSliceFunc = std::function<void(uint32_t slice, dx12::CommandList& commandList)>;
+
 			Renderer(const RenderPassShaders& shaders);
 			~Renderer();
 
@@ -25,6 +38,15 @@ namespace gfx {
 			void BeginRender(std::shared_ptr<dx12::CommandList> commandList);
 			void EndRender(std::shared_ptr<dx12::CommandList> commandList, std::shared_ptr<dx12::CommandQueue> commandQueue);
 
+			/*
+				Parallel form of BeginRender/EndRender. The targets are cleared in a
+				list of their own, then sliceCount lists are recorded on the job system
+				with the geometry pass bound and draw(slice, list) adding each slice's
+				draws. Everything is submitted in one CommandBatch, clear first and
+				slices in order, before the frame is presented.
+			*/
+			void Render(uint32_t sliceCount, const DrawSliceFunc& draw);
+
 			void Resize(int width, int height);
 
 			dx12::RenderTarget& GetRenderTarget() { return m_renderTarget; }
@@ -34,6 +56,7 @@ namespace gfx {
 			dx12::Texture CreateRenderDepthTexture(int initialWidth, int initialHeight, DXGI_FORMAT format, DXGI_SAMPLE_DESC sampleDesc, const std::wstring& name);
 
 			void Clear(std::shared_ptr<dx12::CommandList> commandList);
+			void BindGeometryPass(dx12::CommandList& commandList);
 			void DepthPass(std::shared_ptr<dx12::CommandList> commandList);
 			void LightingPass(std::shared_ptr<dx12::CommandList> commandList);
 			void PostProcessingPass(std::shared_ptr<dx12::CommandList> commandList);
@@ -43,6 +66,8 @@ namespace gfx {
 			D3D12_VIEWPORT		m_viewport;
 			D3D12_RECT			m_scissorRect;
 
+			std::unique_ptr<dx12::CommandBatch>	m_batch;
+
 			// Geometry Pass Resources
 			struct GeometryPipelineStateStream {
 				CD3DX12_PIPELINE_STATE_STREAM_ROOT_SIGNATURE pRootSignature;
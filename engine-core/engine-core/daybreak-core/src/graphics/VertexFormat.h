@@ -0,0 +1,16 @@
+#pragma once
+
+namespace gfx {
+
+    /*
+        Vertex layout a mesh is uploaded in and the geometry pipeline reads.
+        The packed layouts are described in graphics/VertexPacking.h and decoded
+        by PackedVertexShader.hlsl.
+    */
+    enum class DAYBREAK_API VertexFormat
+    {
+        FULL,                   // VertexData, 56 bytes.
+        PACKED,                 // meshops::PackedVertexFloat, 24 bytes.
+        PACKED_QUANTIZED,       // meshops::PackedVertex, 20 bytes; positions quantized to the mesh bounds.
+    };
+}
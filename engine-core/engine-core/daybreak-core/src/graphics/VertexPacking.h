@@ -0,0 +1,228 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+/*
+	Encode/decode for the compressed vertex formats. Normals and tangents are
+	octahedral-mapped into two snorm16s, UVs are stored as half floats (tiled
+	UVs leave [0, 1], so unorm16 would clamp them) and positions can be
+	quantized to unorm16 against the mesh bounds. The decode side mirrors
+	PackedVertexShader.hlsl. Shared with mesh-bake, so this header must stay
+	free of engine includes.
+*/
+namespace meshops {
+
+	// 20 bytes: quantized position (w unused), octahedral normal and tangent, half UV.
+	struct PackedVertex {
+		uint16_t	Position[4];
+		int16_t		Normal[2];
+		int16_t		Tangent[2];
+		uint16_t	UV[2];
+	};
+
+	// 24 bytes: as PackedVertex but with a full precision position.
+	struct PackedVertexFloat {
+		float		Position[3];
+		int16_t		Normal[2];
+		int16_t		Tangent[2];
+		uint16_t	UV[2];
+	};
+
+	static_assert(sizeof(PackedVertex) == 20 && sizeof(PackedVertexFloat) == 24, "Packed vertices must stay tightly packed");
+
+	/*
+		Decoded position = Offset + stored * Scale, where stored is what the
+		input assembler hands the shader (unorm16 expands to [0, 1]). Unquantized
+		positions use the identity.
+	*/
+	struct PositionTransform {
+		float	Offset[3];
+		float	Scale[3];
+	};
+
+	inline PositionTransform IdentityTransform() {
+		return { { 0.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 1.0f } };
+	}
+
+	inline PositionTransform QuantizationFor(const float min[3], const float max[3]) {
+		PositionTransform transform;
+		for (int axis = 0; axis < 3; axis++) {
+			transform.Offset[axis] = min[axis];
+			transform.Scale[axis] = max[axis] - min[axis];
+		}
+		return transform;
+	}
+
+	inline void QuantizePosition(const float position[3], const PositionTransform& transform, uint16_t out[4]) {
+		for (int axis = 0; axis < 3; axis++) {
+			float scale = transform.Scale[axis];
+			float unit = scale > 0.0f ? (position[axis] - transform.Offset[axis]) / scale : 0.0f;
+			unit = unit < 0.0f ? 0.0f : (unit > 1.0f ? 1.0f : unit);
+			out[axis] = static_cast<uint16_t>(unit * 65535.0f + 0.5f);
+		}
+		out[3] = 0;
+	}
+
+	inline void DequantizePosition(const uint16_t in[4], const PositionTransform& transform, float position[3]) {
+		for (int axis = 0; axis < 3; axis++) {
+			position[axis] = transform.Offset[axis] + (in[axis] / 65535.0f) * transform.Scale[axis];
+		}
+	}
+
+	inline int16_t ToSnorm16(float value) {
+		value = value < -1.0f ? -1.0f : (value > 1.0f ? 1.0f : value);
+		return static_cast<int16_t>(std::lround(value * 32767.0f));
+	}
+
+	// Matches the D3D snorm conversion, which maps -32768 to -1 as well.
+	inline float FromSnorm16(int16_t value) {
+		float unit = value / 32767.0f;
+		return unit < -1.0f ? -1.0f : unit;
+	}
+
+	inline void OctDecode(const int16_t in[2], float out[3]) {
+		float x = FromSnorm16(in[0]);
+		float y = FromSnorm16(in[1]);
+		float z = 1.0f - std::fabs(x) - std::fabs(y);
+		float fold = z < 0.0f ? -z : 0.0f;
+		x += x >= 0.0f ? -fold : fold;
+		y += y >= 0.0f ? -fold : fold;
+
+		float length = std::sqrt(x * x + y * y + z * z);
+		out[0] = x / length;
+		out[1] = y / length;
+		out[2] = z / length;
+	}
+
+	/*
+		Projects a unit vector onto the octahedron and unfolds the lower half
+		over the diagonals. Rounding each coordinate on its own is off by up to
+		a texel diagonally, so the four neighbouring snorm pairs are tried and
+		the one that decodes closest is kept. A zero vector (no tangent) and a
+		NaN or infinite one encode as +Z.
+	*/
+	inline void OctEncode(const float in[3], int16_t out[2]) {
+		float sum = std::fabs(in[0]) + std::fabs(in[1]) + std::fabs(in[2]);
+		out[0] = 0;
+		out[1] = 0;
+		if (sum == 0.0f || !std::isfinite(sum)) {
+			return;
+		}
+
+		float x = in[0] / sum;
+		float y = in[1] / sum;
+		if (in[2] < 0.0f) {
+			float foldedX = (1.0f - std::fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+			float foldedY = (1.0f - std::fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+			x = foldedX;
+			y = foldedY;
+		}
+
+		float length = std::sqrt(in[0] * in[0] + in[1] * in[1] + in[2] * in[2]);
+		float best = -2.0f;
+		for (int i = 0; i < 4; i++) {
+			int16_t candidate[2] = {
+				static_cast<int16_t>(i & 1 ? std::ceil(x * 32767.0f) : std::floor(x * 32767.0f)),
+				static_cast<int16_t>(i & 2 ? std::ceil(y * 32767.0f) : std::floor(y * 32767.0f))
+			};
+
+			float decoded[3];
+			OctDecode(candidate, decoded);
+			float similarity = (decoded[0] * in[0] + decoded[1] * in[1] + decoded[2] * in[2]) / length;
+			if (similarity > best) {
+				best = similarity;
+				out[0] = candidate[0];
+				out[1] = candidate[1];
+			}
+		}
+	}
+
+	// IEEE 754 binary16, round to nearest even; overflow goes to infinity.
+	inline uint16_t ToHalf(float value) {
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+
+		uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+		uint32_t exponent = (bits >> 23) & 0xFF;
+		uint32_t mantissa = bits & 0x7FFFFF;
+
+		if (exponent == 0xFF) {
+			return sign | 0x7C00 | (mantissa ? 0x200 : 0);
+		}
+
+		int32_t halfExponent = static_cast<int32_t>(exponent) - 127 + 15;
+		if (halfExponent >= 31) {
+			return sign | 0x7C00;
+		}
+
+		uint32_t shift;
+		if (halfExponent <= 0) {
+			// Subnormal (or zero): shift the implicit bit into the mantissa.
+			if (halfExponent < -10) {
+				return sign;
+			}
+			mantissa |= 0x800000;
+			shift = static_cast<uint32_t>(14 - halfExponent);
+			halfExponent = 0;
+		} else {
+			shift = 13;
+		}
+
+		uint32_t half = (static_cast<uint32_t>(halfExponent) << 10) | (mantissa >> shift);
+		uint32_t remainder = mantissa & ((1u << shift) - 1);
+		uint32_t midpoint = 1u << (shift - 1);
+		if (remainder > midpoint || (remainder == midpoint && (half & 1))) {
+			half++; // May carry into the exponent, which is still correct.
+		}
+		return sign | static_cast<uint16_t>(half);
+	}
+
+	inline float FromHalf(uint16_t value) {
+		uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+		uint32_t exponent = (value >> 10) & 0x1F;
+		uint32_t mantissa = value & 0x3FF;
+
+		uint32_t bits;
+		if (exponent == 0x1F) {
+			bits = sign | 0x7F800000 | (mantissa << 13);
+		} else if (exponent != 0) {
+			bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+		} else if (mantissa == 0) {
+			bits = sign;
+		} else {
+			// Subnormal: renormalize.
+			exponent = 127 - 15 + 1;
+			while (!(mantissa & 0x400)) {
+				mantissa <<= 1;
+				exponent--;
+			}
+			bits = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+		}
+
+		float result;
+		std::memcpy(&result, &bits, sizeof(result));
+		return result;
+	}
+
+	/*
+		Packs one vertex. Position is quantized against transform for
+		PackedVertex and copied for PackedVertexFloat.
+	*/
+	inline void PackVertex(const float position[3], const float normal[3], const float tangent[3], const float uv[2], const PositionTransform& transform, PackedVertex& out) {
+		QuantizePosition(position, transform, out.Position);
+		OctEncode(normal, out.Normal);
+		OctEncode(tangent, out.Tangent);
+		out.UV[0] = ToHalf(uv[0]);
+		out.UV[1] = ToHalf(uv[1]);
+	}
+
+	inline void PackVertex(const float position[3], const float normal[3], const float tangent[3], const float uv[2], const PositionTransform&, PackedVertexFloat& out) {
+		std::memcpy(out.Position, position, sizeof(out.Position));
+		OctEncode(normal, out.Normal);
+		OctEncode(tangent, out.Tangent);
+		out.UV[0] = ToHalf(uv[0]);
+		out.UV[1] = ToHalf(uv[1]);
+	}
+}
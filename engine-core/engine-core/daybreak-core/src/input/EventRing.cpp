@@ -0,0 +1,48 @@
+#include "daybreak.h"
+#include "EventRing.h"
+
+namespace input {
+
+	EventRing::EventRing(size_t capacity) :
+		m_head(0) {
+
+		size_t slots = 2;
+		while (slots < capacity) {
+			slots <<= 1;
+		}
+
+		m_events.resize(slots);
+		m_mask = slots - 1;
+	}
+
+	uint64_t EventRing::Push(Event event) {
+		event.Sequence = m_head;
+		m_events[m_head & m_mask] = event;
+		return m_head++;
+	}
+
+	bool EventRing::Next(uint64_t& cursor, Event& event, uint64_t* lost) const {
+		uint64_t tail = Tail();
+		if (cursor < tail) {
+			if (lost) {
+				*lost += tail - cursor;
+			}
+			cursor = tail;
+		}
+
+		if (cursor >= m_head) {
+			return false;
+		}
+
+		event = m_events[cursor & m_mask];
+		cursor++;
+		return true;
+	}
+
+	const Event* EventRing::At(uint64_t sequence) const {
+		if (sequence < Tail() || sequence >= m_head) {
+			return nullptr;
+		}
+		return &m_events[sequence & m_mask];
+	}
+}
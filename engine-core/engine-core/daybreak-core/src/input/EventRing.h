@@ -0,0 +1,74 @@
+#pragma once
+
+#include "InputEvent.h"
+
+#include <vector>
+
+namespace input {
+
+	/*
+		Fixed-size ring of the most recent input events. There is one writer (the
+		message pump) and any number of readers, each holding its own cursor, so
+		the game and a replay recorder consume the same stream independently and
+		nothing is removed by reading. A reader that falls more than Capacity()
+		events behind loses the oldest ones instead of stalling the pump.
+
+		Not thread-safe: push and read from the thread that pumps messages.
+	*/
+	class DAYBREAK_API EventRing {
+		public:
+			static const size_t DefaultCapacity = 4096;
+
+			explicit EventRing(size_t capacity = DefaultCapacity);
+
+			// Stamps event.Sequence and returns it.
+			uint64_t Push(Event event);
+
+			/*
+				Copies the event at cursor into event and advances the cursor; false
+				once the reader has caught up. A cursor older than Tail() first moves
+				to Tail(), adding the number of events it skipped to lost (if given).
+			*/
+			bool Next(uint64_t& cursor, Event& event, uint64_t* lost = nullptr) const;
+
+			// Returns the event at sequence, or nullptr if it is not held.
+			const Event* At(uint64_t sequence) const;
+
+			// Sequence of the oldest event still held and one past the newest.
+			uint64_t Tail() const { return m_head > m_events.size() ? m_head - m_events.size() : 0; }
+			uint64_t Head() const { return m_head; }
+
+			size_t Capacity() const { return m_events.size(); }
+
+		private:
+			std::vector<Event>	m_events;
+			uint64_t			m_mask;
+			uint64_t			m_head;
+	};
+
+	/*
+		Upper bound on messages drained per frame, so a window that posts as fast
+		as it is drained (or a WM_TIMER / WM_PAINT loop) cannot hold off the
+		frame.
+	*/
+	static const uint32_t MaxMessagesPerFrame = 1024;
+
+	/*
+		One frame's drain of a platform message queue. peek(message) removes the
+		next message, returning false once the queue is empty; handle(message)
+		processes it and returns false to stop early (e.g. on quit). At most
+		MaxMessagesPerFrame are taken. Returns how many were handled.
+	*/
+	template<typename Message, typename Peek, typename Handle>
+	uint32_t PumpMessages(Peek&& peek, Handle&& handle) {
+		Message message = {};
+		uint32_t handled = 0;
+		while (handled < MaxMessagesPerFrame && peek(message)) {
+			handled++;
+			if (!handle(message)) {
+				break;
+			}
+		}
+		return handled;
+	}
+}
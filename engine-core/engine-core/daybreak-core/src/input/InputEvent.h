@@ -0,0 +1,50 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace input {
+
+	enum class EventType : uint8_t {
+		None,
+		KeyDown,
+		KeyUp,
+		Char,
+		MouseMove,
+		MouseDown,
+		MouseUp,
+		MouseWheel,
+		Resize,
+		Quit
+	};
+
+	enum class MouseButton : uint8_t {
+		None,
+		Left,
+		Right,
+		Middle,
+		X1,
+		X2
+	};
+
+	/*
+		One OS input or window event, stripped of platform types so game code and
+		replay tooling can consume it anywhere. Plain data: safe to memcpy to disk.
+	*/
+	struct Event {
+		uint64_t	Sequence;	// Position in the EventRing; assigned by Push.
+		int64_t		TimeUs;		// When the OS queued it, on the Timestamp() clock.
+		EventType	Type;
+		MouseButton	Button;
+		bool		Repeat;		// KeyDown generated by auto-repeat.
+		uint32_t	Key;		// Platform key code (virtual key on Windows); UTF-16 unit for Char.
+		int32_t		X;			// Client cursor position for mouse events, client size for Resize.
+		int32_t		Y;
+		int32_t		Delta;		// Wheel movement; 120 per notch.
+	};
+
+	// Microseconds on the steady clock used for Event::TimeUs.
+	inline int64_t Timestamp() {
+		return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+}
@@ -2,23 +2,131 @@
 
 #include "InputManager.h"
 
-DX12InputManager::DX12InputManager() : current_msg{ 0 } {}
+#include <windowsx.h>
+
+InputManager::InputManager() :
+	m_events(),
+	m_frameFirstEvent(0),
+	m_stats{} {}
+
+void InputManager::end_frame() {
+	uint64_t head = m_events.Head();
+	uint64_t first = std::max(m_frameFirstEvent, m_events.Tail());
+	m_frameFirstEvent = head;
+
+	m_stats.Frame++;
+	m_stats.Events = static_cast<uint32_t>(head - first);
+	m_stats.TotalEvents += m_stats.Events;
+	if (first == head) {
+		return;
+	}
+
+	// Estimated OS timestamps are not strictly ordered; take the earliest.
+	int64_t oldest = m_events.At(first)->TimeUs;
+	for (uint64_t sequence = first + 1; sequence < head; sequence++) {
+		oldest = std::min(oldest, m_events.At(sequence)->TimeUs);
+	}
+
+	double latency = (input::Timestamp() - oldest) / 1000.0;
+	m_stats.LatencyMs = latency;
+	m_stats.AverageLatencyMs = m_stats.AverageLatencyMs == 0.0 ? latency : m_stats.AverageLatencyMs * 0.95 + latency * 0.05;
+	m_stats.MaxLatencyMs = std::max(m_stats.MaxLatencyMs, latency);
+}
+
+/*
+	Converts the input messages that arrive through the queue. Sent messages
+	(WM_SIZE and friends) bypass the pump and are pushed by the window that
+	handles them.
+*/
+static bool TranslateEvent(const MSG& msg, input::Event& event) {
+	event = {};
+	switch (msg.message) {
+		case WM_KEYDOWN:
+		case WM_SYSKEYDOWN:
+			event.Type = input::EventType::KeyDown;
+			event.Key = static_cast<uint32_t>(msg.wParam);
+			event.Repeat = (msg.lParam & (1 << 30)) != 0;
+			break;
+		case WM_KEYUP:
+		case WM_SYSKEYUP:
+			event.Type = input::EventType::KeyUp;
+			event.Key = static_cast<uint32_t>(msg.wParam);
+			break;
+		case WM_CHAR:
+			event.Type = input::EventType::Char;
+			event.Key = static_cast<uint32_t>(msg.wParam);
+			break;
+		case WM_MOUSEMOVE:
+			event.Type = input::EventType::MouseMove;
+			break;
+		case WM_LBUTTONDOWN:	event.Type = input::EventType::MouseDown;	event.Button = input::MouseButton::Left;	break;
+		case WM_LBUTTONUP:		event.Type = input::EventType::MouseUp;		event.Button = input::MouseButton::Left;	break;
+		case WM_RBUTTONDOWN:	event.Type = input::EventType::MouseDown;	event.Button = input::MouseButton::Right;	break;
+		case WM_RBUTTONUP:		event.Type = input::EventType::MouseUp;		event.Button = input::MouseButton::Right;	break;
+		case WM_MBUTTONDOWN:	event.Type = input::EventType::MouseDown;	event.Button = input::MouseButton::Middle;	break;
+		case WM_MBUTTONUP:		event.Type = input::EventType::MouseUp;		event.Button = input::MouseButton::Middle;	break;
+		case WM_XBUTTONDOWN:
+		case WM_XBUTTONUP:
+			event.Type = msg.message == WM_XBUTTONDOWN ? input::EventType::MouseDown : input::EventType::MouseUp;
+			event.Button = GET_XBUTTON_WPARAM(msg.wParam) == XBUTTON1 ? input::MouseButton::X1 : input::MouseButton::X2;
+			break;
+		case WM_MOUSEWHEEL:
+			event.Type = input::EventType::MouseWheel;
+			event.Delta = GET_WHEEL_DELTA_WPARAM(msg.wParam);
+			break;
+		case WM_QUIT:
+			event.Type = input::EventType::Quit;
+			break;
+		default:
+			return false;
+	}
+
+	if (msg.message >= WM_MOUSEFIRST && msg.message <= WM_MOUSELAST) {
+		POINT point = { GET_X_LPARAM(msg.lParam), GET_Y_LPARAM(msg.lParam) };
+		if (msg.message == WM_MOUSEWHEEL) {
+			// Wheel positions are in screen space.
+			ScreenToClient(msg.hwnd, &point);
+		}
+		event.X = point.x;
+		event.Y = point.y;
+	}
+
+	// MSG::time is the GetTickCount() at which the message was queued; carry
+	// its age over to the steady clock.
+	DWORD age = GetTickCount() - msg.time;
+	event.TimeUs = input::Timestamp() - static_cast<int64_t>(age < 10000 ? age : 0) * 1000;
+	return true;
+}
+
+DX12InputManager::DX12InputManager() : m_quit(false) {}
 
 bool DX12InputManager::handle_exit() {
-	return current_msg.message == WM_QUIT;
+	return m_quit;
 }
 
 bool DX12InputManager::handle_input() {
-	// If there are Window messages then process them.
-	if (PeekMessage(&current_msg, 0, 0, 0, PM_REMOVE)) {
-		TranslateMessage(&current_msg);
-		DispatchMessage(&current_msg);
-		return true;
-	}
-	return false;
+	// Drain everything that is queued; the caller ticks exactly once afterwards.
+	uint32_t handled = input::PumpMessages<MSG>(
+		[](MSG& msg) { return PeekMessage(&msg, 0, 0, 0, PM_REMOVE) != 0; },
+		[this](MSG& msg) {
+			input::Event event;
+			if (TranslateEvent(msg, event)) {
+				events().Push(event);
+			}
+
+			if (msg.message == WM_QUIT) {
+				m_quit = true;
+				return false;
+			}
+
+			TranslateMessage(&msg);
+			DispatchMessage(&msg);
+			return true;
+		});
+	return handled > 0;
 }
 
 InputManager& InputManagerFactory::create() {
 	static DX12InputManager input_manager;
 	return input_manager;
-}
\ No newline at end of file
+}
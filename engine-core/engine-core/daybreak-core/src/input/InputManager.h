@@ -2,9 +2,23 @@
 
 #pragma once
 
+#include "EventRing.h"
+
 class DAYBREAK_API InputManager {
 	
 	public:
+		struct Statistics {
+			uint64_t	Frame;
+			uint32_t	Events;				// Events that arrived for the last frame.
+			uint64_t	TotalEvents;
+			double		LatencyMs;			// Oldest event of the last frame that had any, to end of that frame.
+			double		AverageLatencyMs;
+			double		MaxLatencyMs;
+		};
+
+		InputManager();
+		virtual ~InputManager() {}
+
 		/*
 			Handles checking if an exit command has been issued.
 
@@ -13,9 +27,24 @@ class DAYBREAK_API InputManager {
 		virtual bool handle_exit() = 0;
 
 		/*
-			Performs any logic necessary to consume input.
+			Drains the pending OS messages into events(). Returns true if any were
+			handled.
 		*/
 		virtual bool handle_input() = 0;
+
+		/*
+			Marks the end of the frame that consumed this iteration's input and
+			records how long its oldest event waited.
+		*/
+		void end_frame();
+
+		input::EventRing& events() { return m_events; }
+		const Statistics& stats() const { return m_stats; }
+
+	private:
+		input::EventRing	m_events;
+		uint64_t			m_frameFirstEvent;
+		Statistics			m_stats;
 };
 
 class DAYBREAK_API DX12InputManager : public InputManager {
@@ -27,11 +56,11 @@ class DAYBREAK_API DX12InputManager : public InputManager {
 		bool handle_input();
 	
 	private:
-		MSG current_msg;
+		bool m_quit;
 };
 
 class DAYBREAK_API InputManagerFactory {
 	
 	public:
 		static InputManager& create();
-};
\ No newline at end of file
+};
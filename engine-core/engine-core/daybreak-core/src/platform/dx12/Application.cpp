@@ -1,46 +1,54 @@
 #include "daybreak.h"
 
 #include "Context.h"
+#include "DeferredRelease.h"
 #include "DescriptorAllocator.h"
+#include "GpuAllocator.h"
 #include "Texture.h"
 #include "CommandList.h"
 
-#include "engine/manager/FPSCounter.h"
-
 #include "ResourceStateTracker.h"
 
+#include "engine/manager/FPSCounter.h"
+
 namespace dx12 {
 
 	static Application* g_application = nullptr;
 	static bool g_applicationInitialized = false;
 
-	Application::Application(std::wstring windowTitle, int nFrames) :
+	Application::Application(std::wstring windowTitle, int nFrames, uint32_t framesInFlight) :
 		m_heapSize(0),
 		m_context(),
 		m_swapchain(nullptr),
 		m_nFrames(nFrames),
 		m_currentBackBuffer(0),
 		m_backBufferTextures(nFrames),
-		m_frameFenceValues(nFrames),
+		m_framesInFlight(std::max(framesInFlight, 1u)),
+		m_frameIndex(0),
+		m_frames(m_framesInFlight, FrameInFlight{ 0, {}, false }),
+		m_frameStats{},
+		m_gpuTimer(),
+		m_lastPresentTime(),
 		m_useVSync(TRUE) {
 		m_renderTarget = std::make_shared<RenderTarget>();
+		m_frameStats.FramesInFlight = m_framesInFlight;
 	}
 	
 	Application::~Application() { 
 		Destroy();
 	}
 
-	void Application::CreateApplication(std::wstring windowTitle, int initialWidth, int initialHeight, HWND windowHandle) {
+	void Application::CreateApplication(std::wstring windowTitle, int initialWidth, int initialHeight, HWND windowHandle, uint32_t framesInFlight) {
 		if (!g_application) {
-			Logger::info(L"[Application] Creating global Application instance...\n");
-			g_application = new Application(windowTitle, 3);
+			LOG_INFO(DX12, L"[Application] Creating global Application instance...\n");
+			g_application = new Application(windowTitle, BackBufferCount, framesInFlight);
 			g_application->Initialize(initialWidth, initialHeight, windowHandle);
 		}
 	}
 
 	void Application::DestroyApplication() {
 		if (g_application) {
-			Logger::info(L"[Application] Destorying global Application instance...\n");
+			LOG_INFO(DX12, L"[Application] Destorying global Application instance...\n");
 			delete g_application;
 			g_application = nullptr;
 
@@ -58,7 +66,7 @@ namespace dx12 {
 
 	ComPtr<ID3D12Device2> Application::Device() {
 		if (!g_application || !IsInitialized()) {
-			Logger::error(L"[Application] No application instantiated!\n");
+			LOG_ERROR(DX12, L"[Application] No application instantiated!\n");
 			throw std::exception("No device!");
 		}
 
@@ -72,12 +80,12 @@ namespace dx12 {
 	void Application::Initialize(int initialWidth, int initialHeight, HWND windowHandle) {
 		m_context.Create();
 
-		Logger::info(L"[Application] Setting up backbuffers...\n");
+		LOG_INFO(DX12, L"[Application] Setting up backbuffers...\n");
 		for (int i = 0; i < m_nFrames; i++) {
 			m_backBufferTextures[i].SetName(L"Backbuffer[" + std::to_wstring(i) + L"]");
 		}
 
-		Logger::info(L"[Application] Creating swap chain...\n");
+		LOG_INFO(DX12, L"[Application] Creating swap chain...\n");
 		ID3D12CommandQueue* queue = m_context.GetCommandQueue(D3D12_COMMAND_LIST_TYPE_DIRECT)->D3D12CommandQueue().Get();
 		m_swapchain = CreateSwapChain(initialWidth, initialHeight, windowHandle);
 		m_currentBackBuffer = m_swapchain->GetCurrentBackBufferIndex();
@@ -85,11 +93,12 @@ namespace dx12 {
 		g_applicationInitialized = true;
 
 		UpdateRenderTargetViews();
+
+		m_gpuTimer.Initialize(m_context.Device(), CommandQueue(D3D12_COMMAND_LIST_TYPE_DIRECT), m_framesInFlight);
+		m_gpuTimer.BeginFrame(0);
 	}
 
 	void Application::Resize(int width, int height) {
-		Flush();
-
 		// Release references
 		m_renderTarget->Release();
 		for (int i = 0; i < m_nFrames; i++) {
@@ -97,6 +106,11 @@ namespace dx12 {
 			m_backBufferTextures[i].Reset();
 		}
 
+		// ResizeBuffers fails while any reference to a back buffer is alive,
+		// including copies parked in the deferred release queue. That queue can
+		// only be drained once every queue is idle, so this is a full flush.
+		m_context.Flush();
+
 		DXGI_SWAP_CHAIN_DESC swapChainDesc = {};
 		ThrowOnFailure(m_swapchain->GetDesc(&swapChainDesc));
 		ThrowOnFailure(m_swapchain->ResizeBuffers(m_nFrames, width,
@@ -108,6 +122,8 @@ namespace dx12 {
 	}
 
 	uint32_t Application::Present(const Texture& texture) {
+		PROFILE_SCOPE("Application::Present");
+
 		auto commandQueue = CommandQueue(D3D12_COMMAND_LIST_TYPE_DIRECT);
 		auto commandList = commandQueue->CommandList();
 
@@ -120,26 +136,87 @@ namespace dx12 {
 			}
 		}
 
-		RenderTarget target;
-		target.AttachTexture(AttachmentPoint::COLOR_0, backBuffer);
-
 		commandList->TransitionBarrier(backBuffer, D3D12_RESOURCE_STATE_PRESENT);
+		m_gpuTimer.EndFrame(static_cast<uint32_t>(m_frameIndex % m_framesInFlight), commandList->GraphicsCommandList().Get());
 		commandQueue->ExecuteCommandList(commandList);
 
 		unsigned int syncInterval = m_useVSync ? 1 : 0;
 		unsigned int presentFlags = m_context.IsTearingSupported() && !m_useVSync ? DXGI_PRESENT_ALLOW_TEARING : 0;
 		ThrowOnFailure(m_swapchain->Present(syncInterval, presentFlags));
 
-		m_frameFenceValues[m_currentBackBuffer] = commandQueue->Signal();
-		m_frameFenceValues[m_currentBackBuffer] = FPSCounter::FrameCount();
+		auto& frame = m_frames[m_frameIndex % m_framesInFlight];
+		frame.FenceValue = commandQueue->Signal();
+		frame.PresentTime = std::chrono::high_resolution_clock::now();
+		frame.Pending = true;
+
+		if (m_frameIndex > 0) {
+			FPSCounter::RecordPresentInterval(std::chrono::duration<double, std::milli>(frame.PresentTime - m_lastPresentTime).count());
+		}
+		m_lastPresentTime = frame.PresentTime;
 
+		m_context.ReleaseQueue().EndFrame();
 		m_currentBackBuffer = m_swapchain->GetCurrentBackBufferIndex();
-		commandQueue->WaitForFenceValue(m_frameFenceValues[m_currentBackBuffer]);
+		m_frameIndex++;
+
+		// The next frame reuses the slot of the frame submitted m_framesInFlight
+		// frames ago; only wait if that one is still on the GPU.
+		auto& oldest = m_frames[m_frameIndex % m_framesInFlight];
+		m_frameStats.StallMs = 0.0;
+		if (oldest.Pending && !commandQueue->IsFenceComplete(oldest.FenceValue)) {
+			auto waitStart = std::chrono::high_resolution_clock::now();
+			commandQueue->WaitForFenceValue(oldest.FenceValue);
+			m_frameStats.StallMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - waitStart).count();
+			m_frameStats.Stalls++;
+		}
+
+		RetireCompletedFrames(*commandQueue);
 
-		ReleaseStaleDescriptors(m_frameFenceValues[m_currentBackBuffer]);
+		m_gpuTimer.BeginFrame(static_cast<uint32_t>(m_frameIndex % m_framesInFlight));
 		return m_currentBackBuffer;
 	}
 
+	void Application::RetireCompletedFrames(dx12::CommandQueue& commandQueue) {
+		auto now = std::chrono::high_resolution_clock::now();
+		uint32_t outstanding = 0;
+
+		for (uint32_t slot = 0; slot < m_frames.size(); slot++) {
+			auto& frame = m_frames[slot];
+			if (!frame.Pending) {
+				continue;
+			}
+			if (!commandQueue.IsFenceComplete(frame.FenceValue)) {
+				outstanding++;
+				continue;
+			}
+
+			double latency = std::chrono::duration<double, std::milli>(now - frame.PresentTime).count();
+			m_frameStats.LatencyMs = latency;
+			m_frameStats.AverageLatencyMs = m_frameStats.AverageLatencyMs == 0.0 ? latency : m_frameStats.AverageLatencyMs * 0.95 + latency * 0.05;
+			m_frameStats.MaxLatencyMs = std::max(m_frameStats.MaxLatencyMs, latency);
+			frame.Pending = false;
+
+			FPSCounter::RecordGpuTime(m_gpuTimer.ReadMs(slot));
+		}
+
+		m_frameStats.Frame = m_frameIndex;
+		m_frameStats.FramesInFlight = m_framesInFlight;
+		m_frameStats.Outstanding = outstanding;
+		m_frameStats.CompletedFenceValue = commandQueue.CompletedFenceValue();
+	}
+
+	void Application::SetFramesInFlight(uint32_t framesInFlight) {
+		auto commandQueue = CommandQueue(D3D12_COMMAND_LIST_TYPE_DIRECT);
+		commandQueue->Flush();
+		RetireCompletedFrames(*commandQueue);
+
+		m_framesInFlight = std::max(framesInFlight, 1u);
+		m_frames.assign(m_framesInFlight, FrameInFlight{ 0, {}, false });
+		m_frameStats.FramesInFlight = m_framesInFlight;
+
+		m_gpuTimer.Initialize(m_context.Device(), commandQueue, m_framesInFlight);
+		m_gpuTimer.BeginFrame(static_cast<uint32_t>(m_frameIndex % m_framesInFlight));
+	}
+
 	void Application::Flush() {
 		m_context.Flush();
 	}
@@ -148,11 +225,16 @@ namespace dx12 {
 		return m_context.Allocators()[type]->Allocate(numDescriptors);
 	}
 
-	void Application::ReleaseStaleDescriptors(uint64_t finishedFrame) {
-		auto allocators = m_context.Allocators();
-		for (int i = 0; i < D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES; i++) {
-			allocators[i]->ReleaseStaleDescriptors(finishedFrame);
-		}
+	void Application::DeferRelease(ComPtr<IUnknown> object) {
+		m_context.ReleaseQueue().Release(std::move(object));
+	}
+
+	void Application::DeferRelease(std::function<void()> release) {
+		m_context.ReleaseQueue().Release(std::move(release));
+	}
+
+	ComPtr<ID3D12Resource> Application::CreateResource(const D3D12_RESOURCE_DESC& resourceDesc, D3D12_RESOURCE_STATES initialState, const D3D12_CLEAR_VALUE* clearValue) {
+		return m_context.ResourceAllocator()->CreateResource(resourceDesc, initialState, clearValue);
 	}
 
 	DXGI_SAMPLE_DESC Application::GetMultisampleQualityLevels(DXGI_FORMAT format, UINT numSamples, D3D12_MULTISAMPLE_QUALITY_LEVEL_FLAGS flags) const {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "DescriptorAllocation.h"
+#include "GpuFrameTimer.h"
 #include "RenderTarget.h"
 
 namespace dx12 {
@@ -10,7 +11,29 @@ namespace dx12 {
 	class DAYBREAK_API Application {
 
 		public:
-			static void CreateApplication(std::wstring windowTitle, int initialWidth, int initialHeight, HWND windowHandle);
+			// Swap chain buffers; independent of how many frames the CPU runs ahead.
+			static const int BackBufferCount = 3;
+			static const uint32_t DefaultFramesInFlight = 2;
+
+			/*
+				Frame pacing telemetry. Latency is measured from Present() to the
+				first Present() that sees the frame's fence complete, so it is an
+				upper bound quantized to the frame rate. A stall is a Present() that
+				had to wait because FramesInFlight frames were outstanding.
+			*/
+			struct FrameStatistics {
+				uint64_t	Frame;
+				uint32_t	FramesInFlight;
+				uint32_t	Outstanding;
+				uint64_t	CompletedFenceValue;
+				double		LatencyMs;
+				double		AverageLatencyMs;
+				double		MaxLatencyMs;
+				double		StallMs;
+				uint64_t	Stalls;
+			};
+
+			static void CreateApplication(std::wstring windowTitle, int initialWidth, int initialHeight, HWND windowHandle, uint32_t framesInFlight = DefaultFramesInFlight);
 			static void DestroyApplication();
 
 			static Application* Get();
@@ -21,8 +44,28 @@ namespace dx12 {
 			uint32_t Present(const Texture& texture);
 			void Flush();
 
+			/*
+				Number of frames the CPU may queue before Present() waits on the GPU.
+				Changing it drains the direct queue.
+			*/
+			void SetFramesInFlight(uint32_t framesInFlight);
+			uint32_t FramesInFlight() const { return m_framesInFlight; }
+			uint64_t FrameIndex() const { return m_frameIndex; }
+			const FrameStatistics& FrameStats() const { return m_frameStats; }
+
 			DescriptorAllocation AllocateDescriptors(D3D12_DESCRIPTOR_HEAP_TYPE type, uint32_t numDescriptors = 1);
-			void ReleaseStaleDescriptors(uint64_t finishedFrame);
+
+			/*
+				Releases object (or runs release) once every queue has finished the
+				work submitted up to the end of the current frame.
+			*/
+			void DeferRelease(ComPtr<IUnknown> object);
+			void DeferRelease(std::function<void()> release);
+
+			/*
+				Creates a default-heap resource, placed in a shared heap when it fits.
+			*/
+			ComPtr<ID3D12Resource> CreateResource(const D3D12_RESOURCE_DESC& resourceDesc, D3D12_RESOURCE_STATES initialState, const D3D12_CLEAR_VALUE* clearValue = nullptr);
 
 			DXGI_SAMPLE_DESC GetMultisampleQualityLevels(DXGI_FORMAT format, UINT numSamples, D3D12_MULTISAMPLE_QUALITY_LEVEL_FLAGS flags = D3D12_MULTISAMPLE_QUALITY_LEVELS_FLAG_NONE) const;
 
@@ -38,17 +81,30 @@ namespace dx12 {
 			Context								m_context;
 			ComPtr<IDXGISwapChain4>				m_swapchain;
 
+			struct FrameInFlight {
+				uint64_t										FenceValue;
+				std::chrono::high_resolution_clock::time_point	PresentTime;
+				bool											Pending;
+			};
+
 			// Frame & Fence State
 			int									m_nFrames;
 			int									m_currentBackBuffer;
 			std::vector<Texture>				m_backBufferTextures;
-			std::vector<uint64_t>				m_frameFenceValues;
 			std::shared_ptr<RenderTarget>		m_renderTarget;
 
+			// Ring of the last m_framesInFlight frames, indexed by frame % size.
+			uint32_t							m_framesInFlight;
+			uint64_t							m_frameIndex;
+			std::vector<FrameInFlight>			m_frames;
+			FrameStatistics						m_frameStats;
+			GpuFrameTimer						m_gpuTimer;
+			std::chrono::high_resolution_clock::time_point	m_lastPresentTime;
+
 			// Other
 			bool								m_useVSync;
 
-			Application(std::wstring windowTitle, int nFrames);
+			Application(std::wstring windowTitle, int nFrames, uint32_t framesInFlight);
 			virtual ~Application();
 
 			void Initialize(int initialWidth, int initialHeight, HWND windowHandle);
@@ -59,6 +115,7 @@ namespace dx12 {
 				D3D12_RESOURCE_STATES beforeState, D3D12_RESOURCE_STATES afterState
 			);
 
+			void RetireCompletedFrames(dx12::CommandQueue& commandQueue);
 			void UpdateRenderTargetViews();
 			ComPtr<IDXGISwapChain4> CreateSwapChain(int width, int height, HWND windowHandle);
 	};
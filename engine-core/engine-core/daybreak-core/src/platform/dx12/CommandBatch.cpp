@@ -0,0 +1,114 @@
+#include "daybreak.h"
+#include "CommandBatch.h"
+
+#include "Application.h"
+#include "CommandList.h"
+#include "CommandQueue.h"
+
+#include <algorithm>
+
+namespace dx12 {
+
+	CommandBatch::CommandBatch() {
+		m_queues[DIRECT] = Application::Get()->CommandQueue(D3D12_COMMAND_LIST_TYPE_DIRECT);
+		m_queues[COMPUTE] = Application::Get()->CommandQueue(D3D12_COMMAND_LIST_TYPE_COMPUTE);
+		m_queues[COPY] = Application::Get()->CommandQueue(D3D12_COMMAND_LIST_TYPE_COPY);
+	}
+
+	CommandBatch::~CommandBatch() {
+		assert(m_entries.empty() && "Command batch destroyed with unsubmitted command lists.");
+	}
+
+	CommandBatch::QueueIndex CommandBatch::QueueOf(D3D12_COMMAND_LIST_TYPE type) {
+		switch (type) {
+			case D3D12_COMMAND_LIST_TYPE_COMPUTE:
+				return COMPUTE;
+			case D3D12_COMMAND_LIST_TYPE_COPY:
+				return COPY;
+			case D3D12_COMMAND_LIST_TYPE_DIRECT:
+				return DIRECT;
+			default:
+				assert(false && "Invalid command list type.");
+				return DIRECT;
+		}
+	}
+
+	std::shared_ptr<CommandList> CommandBatch::CommandList(D3D12_COMMAND_LIST_TYPE type) {
+		return m_queues[QueueOf(type)]->CommandList();
+	}
+
+	void CommandBatch::Submit(uint32_t key, std::shared_ptr<dx12::CommandList> commandList) {
+		QueueIndex queue = QueueOf(commandList->CommandListType());
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_entries.push_back({ key, queue, std::move(commandList) });
+	}
+
+	void CommandBatch::Record(uint32_t firstKey, uint32_t count, D3D12_COMMAND_LIST_TYPE type, const RecordFunc& record) {
+		if (!jobs::JobSystem::IsInitialized()) {
+			for (uint32_t slice = 0; slice < count; slice++) {
+				auto commandList = CommandList(type);
+				record(slice, *commandList);
+				Submit(firstKey + slice, std::move(commandList));
+			}
+			return;
+		}
+
+		jobs::JobSystem::ParallelFor(count, 1, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				uint32_t slice = static_cast<uint32_t>(i);
+				auto commandList = CommandList(type);
+				record(slice, *commandList);
+				Submit(firstKey + slice, std::move(commandList));
+			}
+		});
+	}
+
+	CommandBatch::Fences CommandBatch::Execute() {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_submitting.swap(m_entries);
+		}
+
+		// signalled[q] is the fence value of q's latest run in this batch;
+		// waited[q][other] the value of other that q has already waited for.
+		uint64_t signalled[QUEUE_COUNT] = {};
+		uint64_t waited[QUEUE_COUNT][QUEUE_COUNT] = {};
+
+		std::stable_sort(m_submitting.begin(), m_submitting.end(), [](const Entry& a, const Entry& b) {
+			return a.Key < b.Key;
+		});
+
+		for (size_t begin = 0; begin < m_submitting.size();) {
+			QueueIndex queue = m_submitting[begin].Queue;
+			size_t end = begin;
+			for (; end < m_submitting.size() && m_submitting[end].Queue == queue; end++) {
+				m_commandLists.push_back(std::move(m_submitting[end].List));
+			}
+
+			for (int other = 0; other < QUEUE_COUNT; other++) {
+				if (other != queue && signalled[other] > waited[queue][other]) {
+					m_queues[queue]->Wait(*m_queues[other], signalled[other]);
+					waited[queue][other] = signalled[other];
+				}
+			}
+
+			LOG_TRACE(DX12, L"[CommandBatch::Execute] Submitting %zu command lists to queue %d\n", m_commandLists.size(), queue);
+			signalled[queue] = m_queues[queue]->ExecuteCommandLists(m_commandLists);
+			m_commandLists.clear();
+			begin = end;
+		}
+		m_submitting.clear();
+
+		Fences fences;
+		fences.Direct = signalled[DIRECT];
+		fences.Compute = signalled[COMPUTE];
+		fences.Copy = signalled[COPY];
+		return fences;
+	}
+
+	size_t CommandBatch::Size() const {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_entries.size();
+	}
+}
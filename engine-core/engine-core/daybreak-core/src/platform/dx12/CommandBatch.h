@@ -0,0 +1,79 @@
+#pragma once
+
+#include <functional>
+#include <mutex>
+
+namespace dx12 {
+
+	class CommandList;
+	class CommandQueue;
+
+	/*
+		Gathers command lists recorded on several threads, for any of the
+		application's queues, into one ordered submission. Each recorder takes a
+		list with CommandList(), records its slice of the frame and hands it back
+		with Submit() and an ordering key. Execute() sorts the lists by key (ties
+		keep hand-back order) and walks them in that order: each run of lists for
+		the same queue goes out in one ExecuteCommandLists call, so the global
+		resource states are resolved in the same order the GPU runs the lists.
+		Before a run starts on a queue, that queue waits on the fences of the runs
+		submitted ahead of it on the other queues, so key order is execution order
+		across queues too.
+
+		CommandList() and Submit() may be called from any thread; Execute() must
+		not race with them.
+	*/
+	class DAYBREAK_API CommandBatch {
+		public:
+			using RecordFunc = std::function<void(uint32_t slice, dx12::CommandList& commandList)>;
+
+			// Fence value each queue signalled for a batch; 0 if it had no lists there.
+			struct Fences {
+				uint64_t	Direct = 0;
+				uint64_t	Compute = 0;
+				uint64_t	Copy = 0;
+			};
+
+			CommandBatch();
+			~CommandBatch();
+
+			CommandBatch(const CommandBatch& copy) = delete;
+			CommandBatch& operator=(const CommandBatch& other) = delete;
+
+			std::shared_ptr<dx12::CommandList> CommandList(D3D12_COMMAND_LIST_TYPE type = D3D12_COMMAND_LIST_TYPE_DIRECT);
+
+			// The list goes to the queue of its type.
+			void Submit(uint32_t key, std::shared_ptr<dx12::CommandList> commandList);
+
+			/*
+				Records count slices on the job system, slice i into its own list of
+				type submitted with key firstKey + i. Returns once every slice is
+				recorded.
+			*/
+			void Record(uint32_t firstKey, uint32_t count, D3D12_COMMAND_LIST_TYPE type, const RecordFunc& record);
+
+			// Submits everything handed back so far and empties the batch.
+			Fences Execute();
+
+			size_t Size() const;
+
+		private:
+			enum QueueIndex { DIRECT, COMPUTE, COPY, QUEUE_COUNT };
+
+			static QueueIndex QueueOf(D3D12_COMMAND_LIST_TYPE type);
+
+			struct Entry {
+				uint32_t							Key;
+				QueueIndex							Queue;
+				std::shared_ptr<dx12::CommandList>	List;
+			};
+
+			std::shared_ptr<CommandQueue>						m_queues[QUEUE_COUNT];
+			mutable std::mutex									m_mutex;
+			std::vector<Entry>									m_entries;
+
+			// Scratch for Execute(), kept so their capacity is reused across frames.
+			std::vector<Entry>									m_submitting;
+			std::vector<std::shared_ptr<dx12::CommandList>>		m_commandLists;
+	};
+}
@@ -17,14 +17,14 @@ namespace dx12 {
 	std::map<std::wstring, ID3D12Resource*>	CommandList::g_textureCache;
 	std::mutex								CommandList::g_textureCacheMutex;
 
-	CommandList::CommandList(D3D12_COMMAND_LIST_TYPE type) :
+	CommandList::CommandList(D3D12_COMMAND_LIST_TYPE type, UploadRing& uploadRing) :
 		m_type(type) {
 	
 		auto device = Application::Device();
 		ThrowOnFailure(device->CreateCommandAllocator(m_type, IID_PPV_ARGS(&m_allocator)));
 		ThrowOnFailure(device->CreateCommandList(0, m_type, m_allocator.Get(), nullptr, IID_PPV_ARGS(&m_list)));
 
-		m_uploadBuffer = std::make_unique<UploadBuffer>();
+		m_uploadBuffer = std::make_unique<UploadBuffer>(uploadRing);
 		m_resourceStateTracker = std::make_unique<ResourceStateTracker>();
 		for (int i = 0; i < D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES; ++i) {
 			m_dynamicDescriptorHeap[i] = std::make_unique<DynamicDescriptorHeap>(static_cast<D3D12_DESCRIPTOR_HEAP_TYPE>(i));
@@ -104,6 +104,58 @@ namespace dx12 {
 		CopyBuffer(indexBuffer, numIndicies, indexSizeInBytes, indexBufferData);
 	}
 
+	void CommandList::CopyBuffers(std::span<const BufferCopy> copies) {
+		std::vector<size_t> offsets(copies.size());
+		std::vector<ComPtr<ID3D12Resource>> resources(copies.size());
+		size_t uploadSize = 0;
+		for (size_t i = 0; i < copies.size(); i++) {
+			size_t bufferSize = copies[i].numElements * copies[i].elementSize;
+			offsets[i] = uploadSize;
+			uploadSize = AlignUp(uploadSize + bufferSize, 16);
+
+			if (bufferSize > 0) {
+				auto resDesc = CD3DX12_RESOURCE_DESC::Buffer(bufferSize);
+				resources[i] = Application::Get()->CreateResource(resDesc, D3D12_RESOURCE_STATE_COMMON);
+				ResourceStateTracker::AddGlobalResourceState(resources[i].Get(), D3D12_RESOURCE_STATE_COMMON);
+			}
+		}
+
+		if (uploadSize > 0) {
+			// Staged in the queue's upload ring (a dedicated buffer only if the
+			// model is too big for it), released once this list's fence passes.
+			auto upload = m_uploadBuffer->Allocate(uploadSize, 16);
+			uint8_t* uploadData = static_cast<uint8_t*>(upload.cpuAddress);
+			jobs::JobSystem::ParallelFor(copies.size(), 1, [&](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; i++) {
+					if (copies[i].data) {
+						memcpy(uploadData + offsets[i], copies[i].data, copies[i].numElements * copies[i].elementSize);
+					}
+				}
+			});
+
+			for (size_t i = 0; i < copies.size(); i++) {
+				if (resources[i] && copies[i].data) {
+					m_resourceStateTracker->TransitionResource(resources[i].Get(), D3D12_RESOURCE_STATE_COPY_DEST);
+				}
+			}
+			FlushResourceBarriers();
+
+			for (size_t i = 0; i < copies.size(); i++) {
+				if (resources[i] && copies[i].data) {
+					m_list->CopyBufferRegion(resources[i].Get(), 0, upload.resource, upload.offset + offsets[i], copies[i].numElements * copies[i].elementSize);
+				}
+			}
+		}
+
+		for (size_t i = 0; i < copies.size(); i++) {
+			if (resources[i]) {
+				TrackObject(resources[i]);
+			}
+			copies[i].buffer->SetResource(resources[i]);
+			copies[i].buffer->CreateViews(copies[i].numElements, copies[i].elementSize);
+		}
+	}
+
 	void CommandList::SetVertexBuffer(uint32_t slot, const VertexBuffer& vertexBuffer) {
 		TransitionBarrier(vertexBuffer, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
 
@@ -203,15 +255,7 @@ namespace dx12 {
 					break;
 			}
 
-			auto heapProperties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
-			ThrowOnFailure(
-				device->CreateCommittedResource(&heapProperties,
-				D3D12_HEAP_FLAG_NONE,
-				&textureDesc,
-				D3D12_RESOURCE_STATE_COMMON,
-				nullptr,
-				IID_PPV_ARGS(&textureResource))
-			);
+			textureResource = Application::Get()->CreateResource(textureDesc, D3D12_RESOURCE_STATE_COMMON);
 
 			// Update the global state tracker.
 			ResourceStateTracker::AddGlobalResourceState(textureResource.Get(), D3D12_RESOURCE_STATE_COMMON);
@@ -324,6 +368,10 @@ namespace dx12 {
 		m_list->SetGraphicsRootConstantBufferView(rootParameterIndex, heapAllococation.gpuAddress);
 	}
 
+	void CommandList::SetGraphics32BitConstants(uint32_t rootParameterIndex, uint32_t numConstants, const void* constants) {
+		m_list->SetGraphicsRoot32BitConstants(rootParameterIndex, numConstants, constants, 0);
+	}
+
 	void CommandList::SetViewport(const D3D12_VIEWPORT& viewport) {
 		SetViewports({ viewport });
 	}
@@ -454,23 +502,31 @@ namespace dx12 {
 		m_list->Dispatch(numGroupsX, numGroupsY, numGroupsZ);
 	}
 
-	bool CommandList::Close(CommandList& pendingCommandList) {
+	bool CommandList::CloseForSubmit() {
 		// Flush any remaining barriers.
 		FlushResourceBarriers();
 		m_list->Close();
 
-		// Flush pending resource barriers.
-		uint32_t numPendingBarriers = m_resourceStateTracker->FlushPendingResourceBarriers(pendingCommandList);
+		// Resolve pending resource barriers.
+		uint32_t numPendingBarriers = m_resourceStateTracker->ResolvePendingResourceBarriers();
 		// Commit the final resource state to the global state.
 		m_resourceStateTracker->CommitFinalResourceStates();
 		return numPendingBarriers > 0;
 	}
 
+	void CommandList::FlushPendingResourceBarriers(CommandList& pendingCommandList) {
+		m_resourceStateTracker->FlushResolvedResourceBarriers(pendingCommandList);
+	}
+
 	void CommandList::Close() {
 		FlushResourceBarriers();
 		m_list->Close();
 	}
 
+	void CommandList::Submitted(uint64_t fenceValue) {
+		m_uploadBuffer->Submit(fenceValue);
+	}
+
 	void CommandList::Reset() {
 		ThrowOnFailure(m_allocator->Reset());
 		ThrowOnFailure(m_list->Reset(m_allocator.Get(), nullptr));
@@ -645,51 +701,26 @@ namespace dx12 {
 	}
 
 	void CommandList::CopyBuffer(Buffer& buffer, size_t numElements, size_t elementSize, const void* bufferData, D3D12_RESOURCE_FLAGS flags) {
-		auto device = Application::Device();
 		size_t bufferSize = numElements * elementSize;
 
 		ComPtr<ID3D12Resource> d3d12Resource;
 		if (bufferSize == 0) {
 			// This will result in a NULL resource (which may be desired to define a default null resource).
 		} else {
-			auto heapProperties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
 			auto resDesc = CD3DX12_RESOURCE_DESC::Buffer(bufferSize, flags);
-			ThrowOnFailure(device->CreateCommittedResource(
-				&heapProperties,
-				D3D12_HEAP_FLAG_NONE,
-				&resDesc,
-				D3D12_RESOURCE_STATE_COMMON,
-				nullptr,
-				IID_PPV_ARGS(&d3d12Resource))
-			);
+			d3d12Resource = Application::Get()->CreateResource(resDesc, D3D12_RESOURCE_STATE_COMMON);
 
 			// Add the resource to the global resource state tracker.
 			ResourceStateTracker::AddGlobalResourceState(d3d12Resource.Get(), D3D12_RESOURCE_STATE_COMMON);
 			if (bufferData != nullptr) {
-				// Create an upload resource to use as an intermediate buffer to copy the buffer resource 
-				ComPtr<ID3D12Resource> uploadResource;
-				auto heapProperties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
-				auto resDesc = CD3DX12_RESOURCE_DESC::Buffer(bufferSize);
-				ThrowOnFailure(device->CreateCommittedResource(
-					&heapProperties,
-					D3D12_HEAP_FLAG_NONE,
-					&resDesc,
-					D3D12_RESOURCE_STATE_GENERIC_READ,
-					nullptr,
-					IID_PPV_ARGS(&uploadResource)));
-
-				D3D12_SUBRESOURCE_DATA subresourceData = {};
-				subresourceData.pData = bufferData;
-				subresourceData.RowPitch = bufferSize;
-				subresourceData.SlicePitch = subresourceData.RowPitch;
+				// Stage the data in the queue's upload ring.
+				auto upload = m_uploadBuffer->Allocate(bufferSize, 16);
+				memcpy(upload.cpuAddress, bufferData, bufferSize);
 
 				m_resourceStateTracker->TransitionResource(d3d12Resource.Get(), D3D12_RESOURCE_STATE_COPY_DEST);
 				FlushResourceBarriers();
 
-				UpdateSubresources(m_list.Get(), d3d12Resource.Get(), uploadResource.Get(), 0, 0, 1, &subresourceData);
-
-				// Add references to resources so they stay in scope until the command list is reset.
-				TrackObject(uploadResource);
+				m_list->CopyBufferRegion(d3d12Resource.Get(), 0, upload.resource, upload.offset, bufferSize);
 			}
 			TrackObject(d3d12Resource);
 		}
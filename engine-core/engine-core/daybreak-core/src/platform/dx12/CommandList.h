@@ -2,6 +2,8 @@
 
 #include "graphics/TextureType.h"
 
+#include <span>
+
 namespace dx12 {
 
     class DynamicDescriptorHeap;
@@ -11,13 +13,25 @@ namespace dx12 {
     class RenderTarget;
     class Texture;
     class UploadBuffer;
+    class UploadRing;
     class VertexBuffer;
     class IndexBuffer;
     class Buffer;
 
     class DAYBREAK_API CommandList {
         public:
-            CommandList(D3D12_COMMAND_LIST_TYPE type);
+            /*
+                One buffer of a batched upload. data only has to stay valid until
+                CopyBuffers returns.
+            */
+            struct BufferCopy {
+                Buffer*     buffer;
+                size_t      numElements;
+                size_t      elementSize;
+                const void* data;
+            };
+
+            CommandList(D3D12_COMMAND_LIST_TYPE type, UploadRing& uploadRing);
             virtual ~CommandList();
 
             void TransitionBarrier(const Resource& resource, D3D12_RESOURCE_STATES stateAfter, UINT subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, bool flushBarriers = false);
@@ -42,6 +56,14 @@ namespace dx12 {
                 CopyIndexBuffer(indexBuffer, indexBufferData.size(), indexFormat, indexBufferData.data());
             }
 
+            /*
+                Uploads many buffers through one allocation from the queue's upload
+                ring: the staging copies are spread over the job system, then every
+                buffer is copied behind one barrier flush. Replaces an upload
+                resource and flush per buffer when loading multi-mesh assets.
+            */
+            void CopyBuffers(std::span<const BufferCopy> copies);
+
             void SetVertexBuffer(uint32_t slot, const VertexBuffer& vertexBuffer);
             void SetDynamicVertexBuffer(uint32_t slot, size_t numVertices, size_t vertexSize, const void* vertexBufferData);
             template<typename T>
@@ -72,6 +94,14 @@ namespace dx12 {
                 SetGraphicsDynamicConstantBuffer(rootParameterIndex, sizeof(T), &data);
             }
 
+            void SetGraphics32BitConstants(uint32_t rootParameterIndex, uint32_t numConstants, const void* constants);
+            template<typename T>
+            void SetGraphics32BitConstants(uint32_t rootParameterIndex, const T& constants)
+            {
+                static_assert(sizeof(T) % sizeof(uint32_t) == 0, "Size of type must be a multiple of 4 bytes");
+                SetGraphics32BitConstants(rootParameterIndex, sizeof(T) / sizeof(uint32_t), &constants);
+            }
+
             void SetViewport(const D3D12_VIEWPORT& viewport);
             void SetViewports(const std::vector<D3D12_VIEWPORT>& viewports);
 
@@ -110,9 +140,23 @@ namespace dx12 {
 
 
             // Internal only
-            bool Close(CommandList& pendingCommandList);
             void Close();
 
+            /**
+             * Close the command list for submission, resolve its pending barriers against
+             * the global resource state and commit its final states. Must be called with
+             * the ResourceStateTracker locked. Returns true if resolved barriers need to
+             * be recorded into a pending command list with FlushPendingResourceBarriers.
+             */
+            bool CloseForSubmit();
+            void FlushPendingResourceBarriers(CommandList& pendingCommandList);
+
+            /**
+             * Called by the CommandQueue after submitting the command list. fenceValue
+             * is the value signalled once the GPU has finished with it.
+             */
+            void Submitted(uint64_t fenceValue);
+
             /**
              * Reset the command list. This should only be called by the CommandQueue
              * before the command list is returned from CommandQueue::GetCommandList.
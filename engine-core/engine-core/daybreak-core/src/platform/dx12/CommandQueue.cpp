@@ -2,7 +2,11 @@
 #include "CommandQueue.h"
 
 #include "CommandList.h"
+#include "FenceRetirement.h"
 #include "ResourceStateTracker.h"
+#include "UploadRing.h"
+
+#include "common/InlineVector.h"
 
 namespace dx12 {
 	CommandQueue::CommandQueue(D3D12_COMMAND_LIST_TYPE type) : 
@@ -10,15 +14,15 @@ namespace dx12 {
 		m_type(type), 
 		m_queue(nullptr), 
 		m_fence(nullptr), 
-		m_processInFlightCommandLists(true) {
+		m_retirement(nullptr),
+		m_retirementId(0),
+		m_prologue(nullptr),
+		m_availableCommandLists(MaxCommandLists) {
 	}
 
-	CommandQueue::~CommandQueue() {
-		m_processInFlightCommandLists = false;
-		m_processInFlightCommandListsThread.join();
-	}
+	CommandQueue::~CommandQueue() {}
 
-	void CommandQueue::Initialize(ComPtr<ID3D12Device2> device) {
+	void CommandQueue::Initialize(ComPtr<ID3D12Device2> device, FenceRetirement* retirement) {
 		D3D12_COMMAND_QUEUE_DESC desc = {};
 		desc.Type = m_type;
 		desc.Priority = D3D12_COMMAND_QUEUE_PRIORITY_NORMAL;
@@ -26,7 +30,7 @@ namespace dx12 {
 		desc.NodeMask = 0;
 
 		ThrowOnFailure(device->CreateCommandQueue(&desc, IID_PPV_ARGS(&m_queue)));
-		ThrowOnFailure(device->CreateFence(m_fenceValue, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_fence)));
+		ThrowOnFailure(device->CreateFence(m_fenceValue.load(std::memory_order_relaxed), D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_fence)));
 
 		switch (m_type) {
 			case D3D12_COMMAND_LIST_TYPE_COPY:
@@ -40,67 +44,66 @@ namespace dx12 {
 				break;
 		}
 
-		m_processInFlightCommandListsThread = std::thread(&CommandQueue::ProccessInFlightCommandLists, this);
+		m_uploadRing = std::make_unique<dx12::UploadRing>(m_fence, UploadRingSize);
+
+		m_retirement = retirement;
+		m_retirementId = m_retirement->RegisterFence(m_fence, [this](std::shared_ptr<dx12::CommandList> commandList) {
+			RetireCommandList(std::move(commandList));
+		});
 	}
 
 	uint64_t CommandQueue::ExecuteCommandList(std::shared_ptr<dx12::CommandList> commandList) {
-		return ExecuteCommandLists(std::vector<std::shared_ptr<dx12::CommandList>>({ commandList }));
+		return ExecuteCommandLists(std::span<std::shared_ptr<dx12::CommandList>>(&commandList, 1));
 	}
 
-	uint64_t CommandQueue::ExecuteCommandLists(const std::vector<std::shared_ptr<dx12::CommandList>>& commandLists) {
-		ResourceStateTracker::Lock();
+	uint64_t CommandQueue::ExecuteCommandLists(std::span<std::shared_ptr<dx12::CommandList>> commandLists) {
+		PROFILE_SCOPE("CommandQueue::ExecuteCommandLists");
 
-		// Command lists that need to put back on the command list queue.
-		std::vector<std::shared_ptr<dx12::CommandList>> toBeQueued;
-		toBeQueued.reserve(commandLists.size() * 2);
+		// Submitting in consecutive batches keeps the order, and with it the
+		// barrier resolution, unchanged.
+		while (commandLists.size() > MaxBatchSize) {
+			ExecuteCommandLists(commandLists.first(MaxBatchSize));
+			commandLists = commandLists.subspan(MaxBatchSize);
+		}
 
-		// Generate mips command lists.
-		std::vector<std::shared_ptr<dx12::CommandList>> generateMipsCommandLists;
-		generateMipsCommandLists.reserve(commandLists.size());
+		// Every submitted list may need a pending list in front of it.
+		collection::InlineVector<std::shared_ptr<dx12::CommandList>, MaxBatchSize * 2> toBeQueued;
+		collection::InlineVector<ID3D12CommandList*, MaxBatchSize * 2 + 1> d3d12CommandLists;
 
-		// Command lists that need to be executed.
-		std::vector<ID3D12CommandList*> d3d12CommandLists;
-		d3d12CommandLists.reserve(commandLists.size() * 2);
+		ResourceStateTracker::Lock();
 
-		for (auto commandList : commandLists) {
-			auto pendingCommandList = CommandList();
-			bool hasPendingBarriers = commandList->Close(*pendingCommandList);
-			pendingCommandList->Close();
+		if (ID3D12CommandList* prologue = m_prologue.exchange(nullptr, std::memory_order_acquire)) {
+			d3d12CommandLists.PushBack(prologue);
+		}
 
-			// If there are no pending barriers on the pending command list, there is no reason to 
-			// execute an empty command list on the command queue.
-			if (hasPendingBarriers) {
-				d3d12CommandLists.push_back(pendingCommandList->GraphicsCommandList().Get());
-			}
-			d3d12CommandLists.push_back(commandList->GraphicsCommandList().Get());
+		for (auto& commandList : commandLists) {
+			// Only pull a pending command list from the pool if the list actually
+			// has barriers that could not be resolved while it was recorded.
+			if (commandList->CloseForSubmit()) {
+				auto pendingCommandList = CommandList();
+				commandList->FlushPendingResourceBarriers(*pendingCommandList);
+				pendingCommandList->Close();
 
-			toBeQueued.push_back(pendingCommandList);
-			toBeQueued.push_back(commandList);
+				d3d12CommandLists.PushBack(pendingCommandList->GraphicsCommandList().Get());
+				toBeQueued.PushBack(std::move(pendingCommandList));
+			}
+			d3d12CommandLists.PushBack(commandList->GraphicsCommandList().Get());
 
-			/*auto generateMipsCommandList = commandList->GetGenerateMipsCommandList();
-			if (generateMipsCommandList) {
-				generateMipsCommandLists.push_back(generateMipsCommandList);
-			}*/
+			toBeQueued.PushBack(std::move(commandList));
 		}
 
-		UINT numCommandLists = static_cast<UINT>(d3d12CommandLists.size());
-		m_queue->ExecuteCommandLists(numCommandLists, d3d12CommandLists.data());
+		UINT numCommandLists = static_cast<UINT>(d3d12CommandLists.Size());
+		m_queue->ExecuteCommandLists(numCommandLists, d3d12CommandLists.Data());
 		uint64_t fenceValue = Signal();
 
 		ResourceStateTracker::Unlock();
 
-		// Queue command lists for reuse.
-		for (auto commandList : toBeQueued) {
-			m_inFlightCommandLists.Push({ fenceValue, commandList });
+		for (auto& commandList : toBeQueued) {
+			commandList->Submitted(fenceValue);
 		}
 
-		// If there are any command lists that generate mips then execute those
-		// after the initial resource command lists have finished.
-		if (generateMipsCommandLists.size() > 0) {
-			auto computeQueue = Application::Get()->CommandQueue(D3D12_COMMAND_LIST_TYPE_COMPUTE);
-			computeQueue->Wait(*this);
-			computeQueue->ExecuteCommandLists(generateMipsCommandLists);
-		}
+		// Queue command lists for reuse.
+		m_retirement->RetireCommandLists(m_retirementId, fenceValue, std::span<std::shared_ptr<dx12::CommandList>>(toBeQueued.Data(), toBeQueued.Size()));
 
 		return fenceValue;
 	}
@@ -108,16 +111,14 @@ namespace dx12 {
 	std::shared_ptr<CommandList> CommandQueue::CommandList() {
 		std::shared_ptr<dx12::CommandList> commandList;
 
-		if (!m_availableCommandLists.IsEmpty()) {
-			m_availableCommandLists.Pop(commandList);
-		} else {
-			commandList = std::make_shared<dx12::CommandList>(m_type);
+		if (!m_availableCommandLists.Pop(commandList)) {
+			commandList = std::make_shared<dx12::CommandList>(m_type, *m_uploadRing);
 		}
 		return commandList;
 	}
 
 	uint64_t CommandQueue::Signal() {
-		uint64_t fenceValueForSignal = ++m_fenceValue;
+		uint64_t fenceValueForSignal = m_fenceValue.fetch_add(1, std::memory_order_acq_rel) + 1;
 		ThrowOnFailure(m_queue->Signal(m_fence.Get(), fenceValueForSignal));
 		return fenceValueForSignal;
 	}
@@ -139,41 +140,27 @@ namespace dx12 {
 	}
 
 	void CommandQueue::Flush() {
-		std::unique_lock<std::mutex> lock(m_processInFlightCommandListsThreadMutex);
-		m_processInFlightCommandListsThreadCV.wait(lock, [this] { return m_inFlightCommandLists.IsEmpty(); });
-		WaitForFenceValue(m_fenceValue);
+		uint64_t fenceValue = m_fenceValue.load(std::memory_order_acquire);
+		WaitForFenceValue(fenceValue);
+		m_retirement->WaitForRetirement(m_retirementId, fenceValue);
 	}
 
 	void CommandQueue::Wait(const CommandQueue& other) {
-		m_queue->Wait(other.m_fence.Get(), other.m_fenceValue);
+		m_queue->Wait(other.m_fence.Get(), other.LastSignaledFenceValue());
+	}
+
+	void CommandQueue::Wait(const CommandQueue& other, uint64_t fenceValue) {
+		ThrowOnFailure(m_queue->Wait(other.m_fence.Get(), fenceValue));
 	}
 
 	ComPtr<ID3D12CommandQueue> CommandQueue::D3D12CommandQueue() const {
 		return m_queue;
 	}
 
-	void CommandQueue::ProccessInFlightCommandLists() {
-		std::unique_lock<std::mutex> lock(m_processInFlightCommandListsThreadMutex, std::defer_lock);
-
-		while (m_processInFlightCommandLists) {
-			CommandListEntry commandListEntry;
-
-			lock.lock();
-			while (m_inFlightCommandLists.Pop(commandListEntry))
-			{
-				auto fenceValue = std::get<0>(commandListEntry);
-				auto commandList = std::get<1>(commandListEntry);
+	void CommandQueue::RetireCommandList(std::shared_ptr<dx12::CommandList> commandList) {
+		commandList->Reset();
 
-				WaitForFenceValue(fenceValue);
-
-				commandList->Reset();
-
-				m_availableCommandLists.Push(commandList);
-			}
-			lock.unlock();
-			m_processInFlightCommandListsThreadCV.notify_one();
-
-			std::this_thread::yield();
-		}
+		// A full pool means the list is surplus -- let it be destroyed.
+		m_availableCommandLists.TryPush(std::move(commandList));
 	}
 }
\ No newline at end of file
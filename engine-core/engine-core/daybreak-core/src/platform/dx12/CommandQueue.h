@@ -1,21 +1,45 @@
 #pragma once
 
-#include "common/ThreadSafeQueue.h"
+#include <span>
+
+#include "common/MPMCQueue.h"
 
 namespace dx12 {
 
 	class CommandList;
+	class FenceRetirement;
+	class UploadRing;
 
 	class DAYBREAK_API CommandQueue {
 
 		public:
+			// Upper bound on idle command lists kept for reuse per queue.
+			static const size_t MaxCommandLists = 256;
+
+			// Command lists handed to the driver per ExecuteCommandLists call.
+			static const size_t MaxBatchSize = 64;
+
+			// Size of the upload ring shared by this queue's command lists.
+			static const size_t UploadRingSize = MEMSIZE_32MB;
+
 			CommandQueue(D3D12_COMMAND_LIST_TYPE type);
 			virtual ~CommandQueue();
 
-			void Initialize(ComPtr<ID3D12Device2> device);
+			void Initialize(ComPtr<ID3D12Device2> device, FenceRetirement* retirement);
 
 			uint64_t ExecuteCommandList(std::shared_ptr<CommandList> commandList);
-			uint64_t ExecuteCommandLists(const std::vector<std::shared_ptr<CommandList>>& commandLists);
+
+			/*
+				Submits the lists in one batch, in order, moving them out of
+				commandLists. Each list's pending barriers are resolved against the
+				global state left by the lists before it, so lists recorded in
+				parallel stay correct as long as they are passed in the order they
+				should run (see CommandBatch). More than MaxBatchSize lists are split
+				into consecutive batches.
+
+				Does not allocate once the command list pool is warm.
+			*/
+			uint64_t ExecuteCommandLists(std::span<std::shared_ptr<CommandList>> commandLists);
 
 			uint64_t Signal();
 			bool IsFenceComplete(uint64_t fenceValue);
@@ -24,25 +48,43 @@ namespace dx12 {
 
 			void Wait(const CommandQueue& other);
 
+			// Holds this queue's later work until other's fence reaches fenceValue.
+			void Wait(const CommandQueue& other, uint64_t fenceValue);
+
+			/*
+				Value of the most recent Signal(); work submitted so far completes at
+				or before it. Safe to read from any thread while another submits.
+			*/
+			uint64_t LastSignaledFenceValue() const { return m_fenceValue.load(std::memory_order_acquire); }
+			uint64_t CompletedFenceValue() const { return m_fence->GetCompletedValue(); }
+
+			/*
+				Runs list ahead of the lists in the next ExecuteCommandLists call,
+				replacing any list still waiting; nullptr cancels. The caller keeps
+				list closed and alive until that submission completes.
+			*/
+			void QueuePrologue(ID3D12CommandList* list) { m_prologue.store(list, std::memory_order_release); }
+
 			ComPtr<ID3D12CommandQueue> D3D12CommandQueue() const;
 			std::shared_ptr<CommandList> CommandList();
 
-	private:
-		void ProccessInFlightCommandLists();
+			dx12::UploadRing& UploadRing() const { return *m_uploadRing; }
 
-		using CommandListEntry = std::tuple<uint64_t, std::shared_ptr<dx12::CommandList>>;
+	private:
+		void RetireCommandList(std::shared_ptr<dx12::CommandList> commandList);
 
 		D3D12_COMMAND_LIST_TYPE							m_type;
 		ComPtr<ID3D12CommandQueue>						m_queue;
 		ComPtr<ID3D12Fence>								m_fence;
-		uint64_t										m_fenceValue;
+		std::atomic<uint64_t>							m_fenceValue;
+		FenceRetirement*								m_retirement;
+		uint32_t										m_retirementId;
+		std::atomic<ID3D12CommandList*>					m_prologue;
 
-		collection::ThreadSafeQueue<CommandListEntry>					m_inFlightCommandLists;
-		collection::ThreadSafeQueue<std::shared_ptr<dx12::CommandList>>	m_availableCommandLists;
+		// Declared before the pool: pooled command lists release their chunks
+		// into it when they are destroyed.
+		std::unique_ptr<dx12::UploadRing>				m_uploadRing;
 
-		std::thread				m_processInFlightCommandListsThread;
-		std::atomic_bool		m_processInFlightCommandLists;
-		std::mutex				m_processInFlightCommandListsThreadMutex;
-		std::condition_variable	m_processInFlightCommandListsThreadCV;
+		collection::MPMCQueue<std::shared_ptr<dx12::CommandList>>	m_availableCommandLists;
 	};
 }
\ No newline at end of file
@@ -1,6 +1,9 @@
 #include "daybreak.h"
 
+#include "DeferredRelease.h"
 #include "DescriptorAllocator.h"
+#include "FenceRetirement.h"
+#include "GpuAllocator.h"
 
 namespace dx12 {
 	
@@ -15,29 +18,36 @@ namespace dx12 {
 		SetThreadDpiAwarenessContext(DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2);
 
 		if (Engine::GetMode() == EngineMode::DEBUG || Engine::GetMode() == EngineMode::EDITOR) {
-			Logger::info(L"[DX12Context] Enabling debug interface...\n");
+			LOG_INFO(DX12, L"[DX12Context] Enabling debug interface...\n");
 			ComPtr<ID3D12Debug> debugInterface;
 			ThrowOnFailure(D3D12GetDebugInterface(IID_PPV_ARGS(&debugInterface)));
 			debugInterface->EnableDebugLayer();
 		}
 
-		Logger::info(L"[DX12Context] Creating adapter...\n");
+		LOG_INFO(DX12, L"[DX12Context] Creating adapter...\n");
 		m_adapter = CreateAdapter(false);
 
-		Logger::info(L"[DX12Context] Creating device...\n");
+		LOG_INFO(DX12, L"[DX12Context] Creating device...\n");
 		m_device = CreateDevice(m_adapter);
+		m_gpuAllocator = std::make_shared<GpuAllocator>(m_device);
 
-		Logger::info(L"[DX12Context] Creating command queues...\n");
+		LOG_INFO(DX12, L"[DX12Context] Creating command queues...\n");
+		m_fenceRetirement = std::make_unique<FenceRetirement>();
 		m_directQueue = std::make_shared<CommandQueue>(D3D12_COMMAND_LIST_TYPE_DIRECT);
 		m_computeQueue = std::make_shared<CommandQueue>(D3D12_COMMAND_LIST_TYPE_COMPUTE);
 		m_copyQueue = std::make_shared<CommandQueue>(D3D12_COMMAND_LIST_TYPE_COPY);
-		m_directQueue->Initialize(m_device);
-		m_computeQueue->Initialize(m_device);
-		m_copyQueue->Initialize(m_device);
+		m_directQueue->Initialize(m_device, m_fenceRetirement.get());
+		m_computeQueue->Initialize(m_device, m_fenceRetirement.get());
+		m_copyQueue->Initialize(m_device, m_fenceRetirement.get());
+		m_deferredRelease = std::make_unique<DeferredRelease>(std::vector<std::shared_ptr<CommandQueue>>{ m_directQueue, m_computeQueue, m_copyQueue });
+		m_fenceRetirement->SetRetiredCallback([release = m_deferredRelease.get()] {
+			release->Close();
+			release->Collect();
+		});
 
 		m_tearingSupported = TearingSupportAvailable();
 
-		Logger::info(L"[Context] Creating descriptor allocators...\n");
+		LOG_INFO(DX12, L"[Context] Creating descriptor allocators...\n");
 		for (int i = 0; i < D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES; i++) {
 			m_descriptorAllocators[i] = std::make_unique<DescriptorAllocator>(static_cast<D3D12_DESCRIPTOR_HEAP_TYPE>(i));
 		}
@@ -47,6 +57,7 @@ namespace dx12 {
 		m_directQueue->Flush();
 		m_computeQueue->Flush();
 		m_copyQueue->Flush();
+		m_deferredRelease->ReleaseAll();
 	}
 
 	ComPtr<ID3D12DescriptorHeap> Context::CreateDescriptorHeap(UINT numDescriptors, D3D12_DESCRIPTOR_HEAP_TYPE type) {
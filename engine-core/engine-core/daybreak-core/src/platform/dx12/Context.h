@@ -2,7 +2,10 @@
 
 namespace dx12 {
 
+	class DeferredRelease;
 	class DescriptorAllocator;
+	class FenceRetirement;
+	class GpuAllocator;
 
 	class DAYBREAK_API Context {
 
@@ -18,6 +21,8 @@ namespace dx12 {
 			ComPtr<IDXGIAdapter4> Adapter() { return m_adapter; }
 			ComPtr<ID3D12Device2> Device() { return m_device; }
 			std::unique_ptr<DescriptorAllocator>* Allocators() { return m_descriptorAllocators; }
+			std::shared_ptr<GpuAllocator> ResourceAllocator() { return m_gpuAllocator; }
+			DeferredRelease& ReleaseQueue() { return *m_deferredRelease; }
 			std::shared_ptr<CommandQueue> GetCommandQueue(D3D12_COMMAND_LIST_TYPE type) const;
 
 		private:
@@ -27,6 +32,12 @@ namespace dx12 {
 			std::shared_ptr<CommandQueue>			m_computeQueue;
 			std::shared_ptr<CommandQueue>			m_copyQueue;
 			std::unique_ptr<DescriptorAllocator>	m_descriptorAllocators[D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES];
+			std::shared_ptr<GpuAllocator>			m_gpuAllocator;
+			// Declared after the allocators so deferred descriptor frees still have
+			// somewhere to go when it is destroyed.
+			std::unique_ptr<DeferredRelease>		m_deferredRelease;
+			// Declared after the queues so it is destroyed (and drained) first.
+			std::unique_ptr<FenceRetirement>		m_fenceRetirement;
 			bool									m_tearingSupported;
 
 			ComPtr<IDXGIAdapter4> CreateAdapter(bool useWARP);
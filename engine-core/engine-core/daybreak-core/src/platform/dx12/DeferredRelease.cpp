@@ -0,0 +1,155 @@
+#include "daybreak.h"
+#include "DeferredRelease.h"
+
+namespace dx12 {
+
+	DeferredRelease::DeferredRelease(std::vector<std::shared_ptr<CommandQueue>> queues) :
+		m_queues(std::move(queues)),
+		m_pendingObjects(0),
+		m_released(0) {
+		m_current.Frame = 0;
+	}
+
+	DeferredRelease::~DeferredRelease() {
+		ReleaseAll();
+	}
+
+	void DeferredRelease::Release(ComPtr<IUnknown> object) {
+		if (!object) {
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_current.Objects.push_back(std::move(object));
+		m_pendingObjects++;
+	}
+
+	void DeferredRelease::Release(ReleaseFunc release) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_current.Callbacks.push_back(std::move(release));
+		m_pendingObjects++;
+	}
+
+	void DeferredRelease::Close() {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		CloseLocked();
+	}
+
+	uint64_t DeferredRelease::EndFrame() {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		uint64_t frame = m_current.Frame;
+		CloseLocked();
+		m_current.Frame = frame + 1;
+		return frame;
+	}
+
+	void DeferredRelease::CloseLocked() {
+		if (m_current.Size() == 0) {
+			return;
+		}
+
+		// Anything submitted before this point may reference the batch.
+		uint64_t frame = m_current.Frame;
+		m_current.FenceValues.resize(m_queues.size());
+		for (size_t i = 0; i < m_queues.size(); i++) {
+			m_current.FenceValues[i] = m_queues[i]->LastSignaledFenceValue();
+		}
+
+		m_pending.PushBack(std::move(m_current));
+		if (!m_spare.empty()) {
+			m_current = std::move(m_spare.back());
+			m_spare.pop_back();
+		} else {
+			m_current = Batch();
+		}
+		m_current.Frame = frame;
+	}
+
+	size_t DeferredRelease::Collect() {
+		std::lock_guard<std::mutex> collectLock(m_collectMutex);
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			while (!m_pending.IsEmpty() && IsComplete(m_pending.Front())) {
+				m_releasing.push_back(std::move(m_pending.Front()));
+				m_pending.PopFront();
+			}
+		}
+
+		if (m_releasing.empty()) {
+			return 0;
+		}
+
+		// Releasing can run arbitrary destructors and callbacks (which may retire
+		// more objects), so it happens outside the lock.
+		size_t released = 0;
+		for (auto& batch : m_releasing) {
+			released += ReleaseBatch(batch);
+		}
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (auto& batch : m_releasing) {
+			m_spare.push_back(std::move(batch));
+		}
+		m_releasing.clear();
+
+		m_pendingObjects -= released;
+		m_released += released;
+		return released;
+	}
+
+	void DeferredRelease::ReleaseAll() {
+		std::lock_guard<std::mutex> collectLock(m_collectMutex);
+		std::unique_lock<std::mutex> lock(m_mutex);
+		for (;;) {
+			Batch batch;
+			if (!m_pending.IsEmpty()) {
+				batch = std::move(m_pending.Front());
+				m_pending.PopFront();
+			} else if (m_current.Size() > 0) {
+				std::swap(batch, m_current);
+				m_current.Frame = batch.Frame;
+			} else {
+				break;
+			}
+
+			lock.unlock();
+			size_t released = ReleaseBatch(batch);
+			lock.lock();
+
+			m_pendingObjects -= released;
+			m_released += released;
+		}
+	}
+
+	DeferredRelease::Statistics DeferredRelease::Stats() const {
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		Statistics stats;
+		stats.Frame = m_current.Frame;
+		stats.PendingBatches = m_pending.Size();
+		stats.PendingObjects = m_pendingObjects;
+		stats.Released = m_released;
+		return stats;
+	}
+
+	bool DeferredRelease::IsComplete(const Batch& batch) const {
+		for (size_t i = 0; i < m_queues.size(); i++) {
+			if (!m_queues[i]->IsFenceComplete(batch.FenceValues[i])) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	size_t DeferredRelease::ReleaseBatch(Batch& batch) {
+		size_t released = batch.Size();
+
+		batch.Objects.clear();
+		for (auto& callback : batch.Callbacks) {
+			callback();
+		}
+		batch.Callbacks.clear();
+
+		return released;
+	}
+}
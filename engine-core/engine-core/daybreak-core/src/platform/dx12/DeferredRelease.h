@@ -0,0 +1,101 @@
+#pragma once
+
+#include <functional>
+#include <mutex>
+
+#include "common/RingQueue.h"
+
+namespace dx12 {
+
+	class CommandQueue;
+
+	/*
+		Single queue for GPU objects whose last CPU owner has let go while the GPU
+		may still be using them. Released objects go into an open batch; Close()
+		closes it against the fence value each queue has signaled so far, and
+		Collect() releases whole batches once every one of those values has
+		completed. Resources, descriptor ranges and anything else with a release
+		callback share the same path, so nothing needs a full flush just to be
+		destroyed safely.
+
+		The FenceRetirement thread calls Close() and Collect() after each pass
+		that retired command lists, so releases follow the fences even while no
+		frames are presented (loading, for instance). EndFrame() closes the batch
+		at a frame boundary for the frame statistics.
+
+		Release() may be called from any thread. Collect() and ReleaseAll() are
+		serialized against each other, so ReleaseAll() returns only once nothing
+		retired before it is still alive.
+	*/
+	class DAYBREAK_API DeferredRelease {
+		public:
+			using ReleaseFunc = std::function<void()>;
+
+			struct Statistics {
+				uint64_t	Frame;
+				size_t		PendingBatches;
+				size_t		PendingObjects;
+				size_t		Released;
+			};
+
+			DeferredRelease(std::vector<std::shared_ptr<CommandQueue>> queues);
+			~DeferredRelease();
+
+			DeferredRelease(const DeferredRelease& copy) = delete;
+			DeferredRelease& operator=(const DeferredRelease& other) = delete;
+
+			void Release(ComPtr<IUnknown> object);
+			void Release(ReleaseFunc release);
+
+			// Closes the current batch if it holds anything.
+			void Close();
+
+			/*
+				Closes the current batch. Returns the index of the frame that just
+				ended.
+			*/
+			uint64_t EndFrame();
+
+			/*
+				Releases every closed batch whose fence values have all completed,
+				oldest first. Returns the number of objects released.
+			*/
+			size_t Collect();
+
+			/*
+				Releases everything, including the open batch. Only valid once every
+				queue is idle.
+			*/
+			void ReleaseAll();
+
+			Statistics Stats() const;
+
+		private:
+			struct Batch {
+				uint64_t					Frame;
+				std::vector<uint64_t>		FenceValues;
+				std::vector<ComPtr<IUnknown>>	Objects;
+				std::vector<ReleaseFunc>	Callbacks;
+
+				size_t Size() const { return Objects.size() + Callbacks.size(); }
+			};
+
+			void CloseLocked();
+			bool IsComplete(const Batch& batch) const;
+			size_t ReleaseBatch(Batch& batch);
+
+			std::vector<std::shared_ptr<CommandQueue>>	m_queues;
+
+			mutable std::mutex					m_mutex;
+			Batch								m_current;
+			collection::RingQueue<Batch>		m_pending;
+			std::vector<Batch>					m_spare;
+			size_t								m_pendingObjects;
+			size_t								m_released;
+
+			// Held for the whole of Collect() and ReleaseAll(), which release
+			// outside m_mutex.
+			std::mutex							m_collectMutex;
+			std::vector<Batch>					m_releasing;
+	};
+}
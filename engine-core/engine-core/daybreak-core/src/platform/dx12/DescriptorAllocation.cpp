@@ -2,8 +2,6 @@
 #include "DescriptorAllocation.h"
 #include "DescriptorAllocatorPage.h"
 
-#include "engine/manager/FPSCounter.h"
-
 namespace dx12 {
 	DescriptorAllocation::DescriptorAllocation() 
 		: m_descriptor{ 0 },
@@ -54,7 +52,7 @@ namespace dx12 {
 
 	void DescriptorAllocation::Free() {
 		if (!IsNull() && m_page) {
-			// m_page->Free(std::move(*this), FPSCounter::FrameCount());
+			m_page->Free(std::move(*this));
 
 			m_descriptor.ptr = 0;
 			m_nHandles = 0;
@@ -12,14 +12,35 @@ namespace dx12 {
 
 	DescriptorAllocation DescriptorAllocator::Allocate(uint32_t nDescriptors) {
 		std::lock_guard<std::mutex> lock(m_allocationMutex);
+
+		// Pages only come back into the available set once the deferred release
+		// queue has actually returned their descriptors, so look there before
+		// growing.
+		DescriptorAllocation allocation = AllocateFromAvailablePages(nDescriptors);
+		if (allocation.IsNull() && ReclaimPages()) {
+			allocation = AllocateFromAvailablePages(nDescriptors);
+		}
+
+		if (allocation.IsNull()) {
+			m_nDescriptorsPerHeap = std::max(m_nDescriptorsPerHeap, nDescriptors);
+			auto newPage = CreateAllocatorPage();
+			allocation = newPage->Allocate(nDescriptors);
+		}
+
+		return allocation;
+	}
+
+	DescriptorAllocation DescriptorAllocator::AllocateFromAvailablePages(uint32_t nDescriptors) {
 		DescriptorAllocation allocation;
 
-		for (auto iter = m_availableHeaps.begin(); iter != m_availableHeaps.end(); ++iter) {
-			auto page = m_heapPool[*iter];
+		for (auto iter = m_availableHeaps.begin(); iter != m_availableHeaps.end();) {
+			auto& page = m_heapPool[*iter];
 			allocation = page->Allocate(nDescriptors);
 
 			if (page->NumFreeHandles() == 0) {
 				iter = m_availableHeaps.erase(iter);
+			} else {
+				++iter;
 			}
 
 			if (!allocation.IsNull()) {
@@ -27,26 +48,18 @@ namespace dx12 {
 			}
 		}
 
-		if (allocation.IsNull()) {
-			m_nDescriptorsPerHeap = std::max(m_nDescriptorsPerHeap, nDescriptors);
-			auto newPage = CreateAllocatorPage();
-			allocation = newPage->Allocate(nDescriptors);
-		}
-
 		return allocation;
 	}
 
-	void DescriptorAllocator::ReleaseStaleDescriptors(uint64_t frameNumber) {
-		std::lock_guard<std::mutex> lock(m_allocationMutex);
-
+	bool DescriptorAllocator::ReclaimPages() {
+		bool reclaimed = false;
 		for (size_t i = 0; i < m_heapPool.size(); ++i) {
-			auto page = m_heapPool[i];
-			page->ReleaseStaleDescriptors(frameNumber);
-
-			if (page->NumFreeHandles() > 0) {
+			if (m_heapPool[i]->TakeReleased()) {
 				m_availableHeaps.insert(i);
+				reclaimed = true;
 			}
 		}
+		return reclaimed;
 	}
 
 	std::shared_ptr<DescriptorAllocatorPage> DescriptorAllocator::CreateAllocatorPage() {
@@ -12,7 +12,6 @@ namespace dx12 {
 			virtual ~DescriptorAllocator();
 
 			DescriptorAllocation Allocate(uint32_t nDescriptors = 1);
-			void ReleaseStaleDescriptors(uint64_t frameNumber);
 
 		private:
 			using DescriptorHeapPool = std::vector<std::shared_ptr<DescriptorAllocatorPage>>;
@@ -23,6 +22,8 @@ namespace dx12 {
 			std::set<size_t>			m_availableHeaps;
 			std::mutex					m_allocationMutex;
 
+			DescriptorAllocation AllocateFromAvailablePages(uint32_t nDescriptors);
+			bool ReclaimPages();
 			std::shared_ptr<DescriptorAllocatorPage> CreateAllocatorPage();
 	};
 }
\ No newline at end of file
@@ -2,63 +2,48 @@
 
 #include "DescriptorAllocation.h"
 
+#include "common/OffsetAllocator.h"
+
 namespace dx12 {
 
 	class DescriptorAllocatorPage : public std::enable_shared_from_this<DescriptorAllocatorPage> {
 	public:
 		DescriptorAllocatorPage(D3D12_DESCRIPTOR_HEAP_TYPE type, uint32_t nDescriptors);
-		
-		bool HasSpace(uint32_t nDescriptors) const;
+
 		DescriptorAllocation Allocate(uint32_t nDescriptors);
-		void Free(DescriptorAllocation&& descriptorHandle, uint64_t frameNumber);
-		void ReleaseStaleDescriptors(uint64_t frameNumber);
+
+		/*
+			Returns the range through the deferred release queue, so it only
+			becomes allocatable again once the GPU is done with the frame.
+		*/
+		void Free(DescriptorAllocation&& descriptorHandle);
+
+		// True (once) if deferred frees have landed since the last call.
+		bool TakeReleased() { return m_released.exchange(false, std::memory_order_acq_rel); }
 		
 		D3D12_DESCRIPTOR_HEAP_TYPE HeapType() const { return m_heapType; }
-		uint32_t NumFreeHandles() const { return m_nFreeHandles; }
+
+		// Written under m_allocationMutex, read without it by the allocator.
+		uint32_t NumFreeHandles() const { return m_nFreeHandles.load(std::memory_order_acquire); }
 
 	protected:
 		uint32_t ComputeOffset(D3D12_CPU_DESCRIPTOR_HANDLE handle);
-		void AddNewBlock(uint32_t offset, uint32_t nDescriptors);
 		void FreeBlock(uint32_t offset, uint32_t nDescriptors);
+		void ReleaseBlock(uint32_t offset, uint32_t nDescriptors);
 
 	private:
-		struct FreeBlockInfo;
-		struct StaleDescriptorInfo;
-
-		using OffsetType = uint32_t;
-		using SizeType = uint32_t;
-		using FreeListByOffset = std::map<OffsetType, FreeBlockInfo>;
-		using FreeListBySize = std::multimap<SizeType, FreeListByOffset::iterator>;
-		using StaleDescriptorQueue = std::queue<StaleDescriptorInfo>;
-
-		struct FreeBlockInfo {
-			FreeBlockInfo(SizeType size) : Size(size) {}
-
-			SizeType					Size;
-			FreeListBySize::iterator	FreeListBySizeIter;
-		};
-
-		struct StaleDescriptorInfo {
-			StaleDescriptorInfo(OffsetType offset, SizeType size, uint64_t frame)
-				: Offset(offset), 
-				Size(size), 
-				FrameNumber(frame) {}
-
-			OffsetType	Offset;
-			SizeType	Size;
-			uint64_t	FrameNumber;
-		};
-
-		FreeListByOffset								m_freeListByOffset;
-		FreeListBySize									m_freeListBySize;
-		StaleDescriptorQueue							m_staleDescriptors;
+		// Free ranges of the heap, and the allocator node backing each live
+		// allocation by offset (Free() only gets a handle back).
+		memory::OffsetAllocator							m_freeList;
+		std::vector<uint32_t>							m_allocationNodes;
+		std::atomic<bool>								m_released;
 
 		Microsoft::WRL::ComPtr<ID3D12DescriptorHeap>	m_descriptorHeap;
 		D3D12_DESCRIPTOR_HEAP_TYPE						m_heapType;
 		CD3DX12_CPU_DESCRIPTOR_HANDLE					m_baseDescriptor;
 		uint32_t										m_descriptorHandleIncrementSize;
 		uint32_t										m_nDescriptorsInHeap;
-		uint32_t										m_nFreeHandles;
+		std::atomic<uint32_t>							m_nFreeHandles;
 
 		std::mutex										m_allocationMutex;
 	};	
@@ -50,11 +50,14 @@ namespace dx12 {
 		uint32_t numDescriptorsToCommit = ComputeStaleDescriptorCount();
 
 		if (numDescriptorsToCommit > 0) {
+			LOG_TRACE(DX12, L"[DynamicDescriptorHeap] Committing %u descriptors (%u free)\n", numDescriptorsToCommit, m_numFreeHandles);
+
 			auto device = Application::Device();
 			auto graphicsCommandList = commandList.GraphicsCommandList().Get();
 			assert(graphicsCommandList != nullptr);
 
 			if (!m_currentDescriptorHeap || m_numFreeHandles < numDescriptorsToCommit) {
+				LOG_TRACE(DX12, L"[DynamicDescriptorHeap] Requesting new descriptor heap\n");
 				m_currentDescriptorHeap = RequestDescriptorHeap();
 				m_currentCPUDescriptorHandle = m_currentDescriptorHeap->GetCPUDescriptorHandleForHeapStart();
 				m_currentGPUDescriptorHandle = m_currentDescriptorHeap->GetGPUDescriptorHandleForHeapStart();
@@ -0,0 +1,175 @@
+#include "daybreak.h"
+#include "FenceRetirement.h"
+
+#include "CommandList.h"
+
+namespace dx12 {
+
+	FenceRetirement::FenceRetirement() :
+		m_running(true),
+		m_retiring(false) {
+		m_wakeEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+		assert(m_wakeEvent && "Failed to create retirement wake event.");
+
+		m_thread = std::thread(&FenceRetirement::RetirementThread, this);
+	}
+
+	FenceRetirement::~FenceRetirement() {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_running = false;
+		}
+		m_workCV.notify_one();
+		SetEvent(m_wakeEvent);
+		m_thread.join();
+
+		for (auto& fence : m_fences) {
+			CloseHandle(fence->Event);
+		}
+		CloseHandle(m_wakeEvent);
+	}
+
+	uint32_t FenceRetirement::RegisterFence(ComPtr<ID3D12Fence> fence, RetireCommandListFunc onRetire) {
+		auto tracked = std::make_unique<TrackedFence>();
+		tracked->Fence = fence;
+		tracked->Event = CreateEvent(NULL, FALSE, FALSE, NULL);
+		tracked->OnRetire = std::move(onRetire);
+		assert(tracked->Event && "Failed to create fence event handle.");
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_fences.push_back(std::move(tracked));
+		return static_cast<uint32_t>(m_fences.size() - 1);
+	}
+
+	void FenceRetirement::RetireCommandList(uint32_t fenceId, uint64_t fenceValue, std::shared_ptr<CommandList> commandList) {
+		Enqueue(fenceId, { fenceValue, std::move(commandList) });
+	}
+
+	void FenceRetirement::RetireCommandLists(uint32_t fenceId, uint64_t fenceValue, std::span<std::shared_ptr<CommandList>> commandLists) {
+		if (commandLists.empty()) {
+			return;
+		}
+
+		bool wasIdle;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			TrackedFence& fence = *m_fences[fenceId];
+			assert((fence.Pending.IsEmpty() || fence.Pending.Back().FenceValue <= fenceValue) && "Retirements must be queued in fence order.");
+
+			wasIdle = fence.Pending.IsEmpty();
+			for (auto& commandList : commandLists) {
+				fence.Pending.PushBack({ fenceValue, std::move(commandList) });
+			}
+		}
+
+		if (wasIdle) {
+			Wake();
+		}
+	}
+
+	void FenceRetirement::WaitForRetirement(uint32_t fenceId, uint64_t fenceValue) {
+		std::unique_lock<std::mutex> lock(m_mutex);
+		TrackedFence& fence = *m_fences[fenceId];
+		m_retiredCV.wait(lock, [this, &fence, fenceValue] {
+			return !m_retiring && (fence.Pending.IsEmpty() || fence.Pending.Front().FenceValue > fenceValue);
+		});
+	}
+
+	void FenceRetirement::SetRetiredCallback(std::function<void()> onRetired) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_onRetired = std::move(onRetired);
+	}
+
+	void FenceRetirement::Enqueue(uint32_t fenceId, Retirement&& retirement) {
+		bool wasIdle;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			TrackedFence& fence = *m_fences[fenceId];
+			assert((fence.Pending.IsEmpty() || fence.Pending.Back().FenceValue <= retirement.FenceValue) && "Retirements must be queued in fence order.");
+
+			wasIdle = fence.Pending.IsEmpty();
+			fence.Pending.PushBack(std::move(retirement));
+		}
+
+		// The thread is either asleep on the condition variable (nothing in flight)
+		// or blocked on the events of fences that already had work. Only a fence
+		// going from idle to busy needs to interrupt it.
+		if (wasIdle) {
+			Wake();
+		}
+	}
+
+	void FenceRetirement::Wake() {
+		m_workCV.notify_one();
+		SetEvent(m_wakeEvent);
+	}
+
+	bool FenceRetirement::HasPending() const {
+		for (const auto& fence : m_fences) {
+			if (!fence->Pending.IsEmpty()) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void FenceRetirement::RetirementThread() {
+		std::vector<Retirement> ready;
+		std::vector<RetireCommandListFunc*> readyCallbacks;
+		std::vector<HANDLE> waitHandles;
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		for (;;) {
+			m_workCV.wait(lock, [this] { return !m_running || HasPending(); });
+			if (!m_running && !HasPending()) {
+				break;
+			}
+
+			// Pull everything whose fence has already passed, in fence order.
+			for (auto& fence : m_fences) {
+				uint64_t completedValue = fence->Fence->GetCompletedValue();
+				while (!fence->Pending.IsEmpty() && fence->Pending.Front().FenceValue <= completedValue) {
+					ready.push_back(std::move(fence->Pending.Front()));
+					readyCallbacks.push_back(&fence->OnRetire);
+					fence->Pending.PopFront();
+				}
+			}
+
+			if (!ready.empty()) {
+				m_retiring = true;
+				lock.unlock();
+				for (size_t i = 0; i < ready.size(); i++) {
+					if (ready[i].CommandList) {
+						(*readyCallbacks[i])(std::move(ready[i].CommandList));
+					}
+				}
+				ready.clear();
+				readyCallbacks.clear();
+
+				if (m_onRetired) {
+					m_onRetired();
+				}
+				lock.lock();
+
+				m_retiring = false;
+				m_retiredCV.notify_all();
+				continue;
+			}
+
+			// Nothing has completed yet: sleep until the oldest outstanding value of
+			// any busy fence is reached, or until another fence becomes busy.
+			waitHandles.clear();
+			for (auto& fence : m_fences) {
+				if (!fence->Pending.IsEmpty()) {
+					ThrowOnFailure(fence->Fence->SetEventOnCompletion(fence->Pending.Front().FenceValue, fence->Event));
+					waitHandles.push_back(fence->Event);
+				}
+			}
+			waitHandles.push_back(m_wakeEvent);
+
+			lock.unlock();
+			WaitForMultipleObjects(static_cast<DWORD>(waitHandles.size()), waitHandles.data(), FALSE, INFINITE);
+			lock.lock();
+		}
+	}
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <thread>
+
+#include "common/RingQueue.h"
+
+namespace dx12 {
+
+	class CommandList;
+
+	/*
+		Single background thread shared by every CommandQueue that returns command
+		lists to their queue once the GPU is done with them. Work is retired in
+		fence-value order per queue. After every pass that retired something the
+		thread also runs the retired callback, which is how the deferred release
+		queue is collected whether or not frames are being presented.
+
+		The thread blocks on a condition variable while nothing is in flight and
+		on the fences' completion events while something is, so it costs no CPU
+		when idle.
+	*/
+	class DAYBREAK_API FenceRetirement {
+		public:
+			using RetireCommandListFunc = std::function<void(std::shared_ptr<CommandList>)>;
+
+			FenceRetirement();
+			~FenceRetirement();
+
+			FenceRetirement(const FenceRetirement& copy) = delete;
+			FenceRetirement& operator=(const FenceRetirement& other) = delete;
+
+			/*
+				Starts tracking a fence. onRetire is called on the retirement thread
+				for each command list queued against it. Returns the id used by the
+				other calls.
+			*/
+			uint32_t RegisterFence(ComPtr<ID3D12Fence> fence, RetireCommandListFunc onRetire);
+
+			void RetireCommandList(uint32_t fenceId, uint64_t fenceValue, std::shared_ptr<CommandList> commandList);
+
+			/*
+				Queues every list in commandLists (moving them out) under a single
+				lock. Does not allocate once the fence's queue has grown to its
+				steady-state depth.
+			*/
+			void RetireCommandLists(uint32_t fenceId, uint64_t fenceValue, std::span<std::shared_ptr<CommandList>> commandLists);
+
+			/*
+				Blocks until everything queued against fenceId up to fenceValue has
+				been retired.
+			*/
+			void WaitForRetirement(uint32_t fenceId, uint64_t fenceValue);
+
+			/*
+				Runs onRetired on the retirement thread, outside the lock, after every
+				pass that retired work. Set once, before any fence has work queued.
+			*/
+			void SetRetiredCallback(std::function<void()> onRetired);
+
+		private:
+			struct Retirement {
+				uint64_t						FenceValue;
+				std::shared_ptr<CommandList>	CommandList;
+			};
+
+			struct TrackedFence {
+				ComPtr<ID3D12Fence>					Fence;
+				HANDLE								Event;
+				RetireCommandListFunc				OnRetire;
+				collection::RingQueue<Retirement>	Pending;
+			};
+
+			void Enqueue(uint32_t fenceId, Retirement&& retirement);
+			void Wake();
+			bool HasPending() const;
+			void RetirementThread();
+
+			std::vector<std::unique_ptr<TrackedFence>>	m_fences;
+			std::function<void()>						m_onRetired;
+			HANDLE										m_wakeEvent;
+
+			std::thread					m_thread;
+			bool						m_running;
+			bool						m_retiring;
+			mutable std::mutex			m_mutex;
+			std::condition_variable		m_workCV;
+			std::condition_variable		m_retiredCV;
+	};
+}
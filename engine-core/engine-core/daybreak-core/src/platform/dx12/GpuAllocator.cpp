@@ -0,0 +1,136 @@
+#include "daybreak.h"
+#include "GpuAllocator.h"
+
+namespace dx12 {
+
+	// {6A3C5C1E-2F0B-4C5E-9A51-4E1B7E9C2D10}
+	static const GUID PlacementReleaseGuid = { 0x6a3c5c1e, 0x2f0b, 0x4c5e, { 0x9a, 0x51, 0x4e, 0x1b, 0x7e, 0x9c, 0x2d, 0x10 } };
+
+	/*
+		Attached to a placed resource as private data. The resource releases it
+		when it is destroyed, which hands the placement back to the allocator.
+	*/
+	class GpuAllocator::PlacementRelease : public IUnknown {
+		public:
+			PlacementRelease(std::shared_ptr<GpuAllocator> allocator, const memory::PlacementAllocator::Placement& placement) :
+				m_allocator(std::move(allocator)),
+				m_placement(placement),
+				m_refCount(1) {}
+
+			HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** object) override {
+				if (riid == __uuidof(IUnknown)) {
+					*object = static_cast<IUnknown*>(this);
+					AddRef();
+					return S_OK;
+				}
+				*object = nullptr;
+				return E_NOINTERFACE;
+			}
+
+			ULONG STDMETHODCALLTYPE AddRef() override {
+				return ++m_refCount;
+			}
+
+			ULONG STDMETHODCALLTYPE Release() override {
+				ULONG refCount = --m_refCount;
+				if (refCount == 0) {
+					m_allocator->Free(m_placement);
+					delete this;
+				}
+				return refCount;
+			}
+
+		private:
+			std::shared_ptr<GpuAllocator>				m_allocator;
+			memory::PlacementAllocator::Placement		m_placement;
+			std::atomic<ULONG>							m_refCount;
+	};
+
+	GpuAllocator::GpuAllocator(ComPtr<ID3D12Device2> device) :
+		m_device(device) {}
+
+	GpuAllocator::~GpuAllocator() {}
+
+	ComPtr<ID3D12Resource> GpuAllocator::CreateResource(const D3D12_RESOURCE_DESC& resourceDesc, D3D12_RESOURCE_STATES initialState, const D3D12_CLEAR_VALUE* clearValue) {
+		ComPtr<ID3D12Resource> resource;
+		D3D12_RESOURCE_ALLOCATION_INFO info = m_device->GetResourceAllocationInfo(0, 1, &resourceDesc);
+
+		memory::PlacementAllocator::Category category = memory::PlacementAllocator::Category::Texture;
+		if (resourceDesc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER) {
+			category = memory::PlacementAllocator::Category::Buffer;
+		} else if (resourceDesc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)) {
+			category = memory::PlacementAllocator::Category::RenderTarget;
+		}
+
+		memory::PlacementAllocator::Placement placement;
+		ComPtr<ID3D12Heap> heap;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			placement = m_placement.Allocate(info.SizeInBytes, info.Alignment, category);
+			while (m_heaps.size() < m_placement.HeapCount()) {
+				m_heaps.push_back(CreateHeap(m_placement.HeapCategory(static_cast<uint32_t>(m_heaps.size()))));
+			}
+			if (placement.IsPlaced()) {
+				heap = m_heaps[placement.Heap];
+			}
+		}
+
+		if (!placement.IsPlaced()) {
+			auto heapProperties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+			ThrowOnFailure(m_device->CreateCommittedResource(
+				&heapProperties,
+				D3D12_HEAP_FLAG_NONE,
+				&resourceDesc,
+				initialState,
+				clearValue,
+				IID_PPV_ARGS(&resource)
+			));
+		} else {
+			HRESULT hr = m_device->CreatePlacedResource(heap.Get(), placement.Offset, &resourceDesc, initialState, clearValue, IID_PPV_ARGS(&resource));
+			if (FAILED(hr)) {
+				Free(placement);
+				ThrowOnFailure(hr);
+			}
+		}
+
+		// Dedicated placements are only counted, but still go through Free().
+		auto release = new PlacementRelease(shared_from_this(), placement);
+		resource->SetPrivateDataInterface(PlacementReleaseGuid, release);
+		release->Release();
+
+		return resource;
+	}
+
+	memory::PlacementAllocator::Statistics GpuAllocator::Stats() const {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_placement.Stats();
+	}
+
+	void GpuAllocator::Free(const memory::PlacementAllocator::Placement& placement) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_placement.Free(placement);
+	}
+
+	ComPtr<ID3D12Heap> GpuAllocator::CreateHeap(memory::PlacementAllocator::Category category) {
+		D3D12_HEAP_FLAGS flags = D3D12_HEAP_FLAG_NONE;
+		switch (category) {
+			case memory::PlacementAllocator::Category::Buffer:
+				flags = D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS;
+				break;
+			case memory::PlacementAllocator::Category::Texture:
+				flags = D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES;
+				break;
+			case memory::PlacementAllocator::Category::RenderTarget:
+				flags = D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+				break;
+		}
+
+		// MSAA alignment so buddy blocks of 4MB and up can hold multisampled targets.
+		CD3DX12_HEAP_DESC heapDesc(m_placement.HeapSize(), D3D12_HEAP_TYPE_DEFAULT, D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT, flags);
+
+		ComPtr<ID3D12Heap> heap;
+		ThrowOnFailure(m_device->CreateHeap(&heapDesc, IID_PPV_ARGS(&heap)));
+		LOG_DEBUG(DX12, L"[GpuAllocator] Created heap %zu (%llu bytes)\n", m_heaps.size(), m_placement.HeapSize());
+		return heap;
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <mutex>
+
+#include "common/PlacementAllocator.h"
+
+namespace dx12 {
+
+	/*
+		Creates default-heap resources as placed resources inside large shared
+		ID3D12Heaps instead of one committed resource (and one OS heap) each.
+		Placement decisions come from memory::PlacementAllocator; this class owns
+		the heaps and ties each placement's lifetime to its resource, so the space
+		is returned when the last reference to the resource goes away. Resources
+		too big to share a heap fall back to committed resources.
+
+		Thread-safe.
+	*/
+	class DAYBREAK_API GpuAllocator : public std::enable_shared_from_this<GpuAllocator> {
+		public:
+			GpuAllocator(ComPtr<ID3D12Device2> device);
+			~GpuAllocator();
+
+			GpuAllocator(const GpuAllocator& copy) = delete;
+			GpuAllocator& operator=(const GpuAllocator& other) = delete;
+
+			ComPtr<ID3D12Resource> CreateResource(
+				const D3D12_RESOURCE_DESC& resourceDesc,
+				D3D12_RESOURCE_STATES initialState,
+				const D3D12_CLEAR_VALUE* clearValue = nullptr
+			);
+
+			memory::PlacementAllocator::Statistics Stats() const;
+
+		private:
+			class PlacementRelease;
+
+			void Free(const memory::PlacementAllocator::Placement& placement);
+			ComPtr<ID3D12Heap> CreateHeap(memory::PlacementAllocator::Category category);
+
+			ComPtr<ID3D12Device2>				m_device;
+
+			mutable std::mutex					m_mutex;
+			memory::PlacementAllocator			m_placement;
+			std::vector<ComPtr<ID3D12Heap>>		m_heaps;
+	};
+}
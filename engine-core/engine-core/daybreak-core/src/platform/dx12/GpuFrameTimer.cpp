@@ -0,0 +1,83 @@
+#include "daybreak.h"
+#include "GpuFrameTimer.h"
+
+#include "CommandQueue.h"
+
+namespace dx12 {
+
+	GpuFrameTimer::GpuFrameTimer() :
+		m_ticksPerMs(0.0) {}
+
+	GpuFrameTimer::~GpuFrameTimer() {
+		if (m_queue) {
+			m_queue->QueuePrologue(nullptr);
+		}
+	}
+
+	void GpuFrameTimer::Initialize(ComPtr<ID3D12Device2> device, std::shared_ptr<dx12::CommandQueue> queue, uint32_t slotCount) {
+		if (m_queue) {
+			m_queue->QueuePrologue(nullptr);
+		}
+		m_queue = queue;
+		m_allocators.clear();
+		m_beginLists.clear();
+
+		UINT64 frequency = 0;
+		ThrowOnFailure(m_queue->D3D12CommandQueue()->GetTimestampFrequency(&frequency));
+		m_ticksPerMs = frequency / 1000.0;
+
+		D3D12_QUERY_HEAP_DESC queryHeapDesc = {};
+		queryHeapDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+		queryHeapDesc.Count = slotCount * 2;
+		ThrowOnFailure(device->CreateQueryHeap(&queryHeapDesc, IID_PPV_ARGS(&m_queryHeap)));
+		m_queryHeap->SetName(L"GPU Frame Timer");
+
+		auto heapProperties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_READBACK);
+		auto resourceDesc = CD3DX12_RESOURCE_DESC::Buffer(slotCount * 2 * sizeof(uint64_t));
+		ThrowOnFailure(device->CreateCommittedResource(
+			&heapProperties,
+			D3D12_HEAP_FLAG_NONE,
+			&resourceDesc,
+			D3D12_RESOURCE_STATE_COPY_DEST,
+			nullptr,
+			IID_PPV_ARGS(&m_readback)
+		));
+		m_readback->SetName(L"GPU Frame Timer Readback");
+
+		// The begin lists never change, so they are recorded once and resubmitted;
+		// a slot's list is only resubmitted after its previous frame completed.
+		for (uint32_t slot = 0; slot < slotCount; slot++) {
+			ComPtr<ID3D12CommandAllocator> allocator;
+			ComPtr<ID3D12GraphicsCommandList> list;
+			ThrowOnFailure(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&allocator)));
+			ThrowOnFailure(device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, allocator.Get(), nullptr, IID_PPV_ARGS(&list)));
+			list->EndQuery(m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, slot * 2);
+			ThrowOnFailure(list->Close());
+
+			m_allocators.push_back(allocator);
+			m_beginLists.push_back(list);
+		}
+	}
+
+	void GpuFrameTimer::BeginFrame(uint32_t slot) {
+		m_queue->QueuePrologue(m_beginLists[slot].Get());
+	}
+
+	void GpuFrameTimer::EndFrame(uint32_t slot, ID3D12GraphicsCommandList* commandList) {
+		commandList->EndQuery(m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, slot * 2 + 1);
+		commandList->ResolveQueryData(m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, slot * 2, 2, m_readback.Get(), slot * 2 * sizeof(uint64_t));
+	}
+
+	double GpuFrameTimer::ReadMs(uint32_t slot) const {
+		D3D12_RANGE range = { slot * 2 * sizeof(uint64_t), (slot * 2 + 2) * sizeof(uint64_t) };
+		D3D12_RANGE written = { 0, 0 };
+		uint64_t* timestamps = nullptr;
+		ThrowOnFailure(m_readback->Map(0, &range, reinterpret_cast<void**>(&timestamps)));
+
+		uint64_t begin = timestamps[slot * 2];
+		uint64_t end = timestamps[slot * 2 + 1];
+		m_readback->Unmap(0, &written);
+
+		return end > begin ? (end - begin) / m_ticksPerMs : 0.0;
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+
+namespace dx12 {
+
+	class CommandQueue;
+
+	/*
+		Measures each frame's GPU time with a pair of timestamp queries on the
+		direct queue. The begin stamp is a tiny pre-recorded list that the queue
+		runs ahead of the frame's first submission (see CommandQueue::
+		QueuePrologue); the end stamp and the resolve are recorded into the
+		frame's last list. Results are read back once the frame's fence has
+		completed, so there is one query pair per frame in flight and reading
+		never stalls.
+
+		Only the presenting thread uses it.
+	*/
+	class DAYBREAK_API GpuFrameTimer {
+		public:
+			GpuFrameTimer();
+			~GpuFrameTimer();
+
+			GpuFrameTimer(const GpuFrameTimer& copy) = delete;
+			GpuFrameTimer& operator=(const GpuFrameTimer& other) = delete;
+
+			// (Re)creates the queries for slotCount frames in flight. The queue must be idle.
+			void Initialize(ComPtr<ID3D12Device2> device, std::shared_ptr<dx12::CommandQueue> queue, uint32_t slotCount);
+
+			// Stamps the start of slot's frame ahead of the queue's next submission.
+			void BeginFrame(uint32_t slot);
+
+			// Records slot's end stamp and resolve into the frame's last command list.
+			void EndFrame(uint32_t slot, ID3D12GraphicsCommandList* commandList);
+
+			// GPU milliseconds of slot's last frame; its fence must have completed.
+			double ReadMs(uint32_t slot) const;
+
+		private:
+			std::shared_ptr<dx12::CommandQueue>					m_queue;
+			ComPtr<ID3D12QueryHeap>								m_queryHeap;
+			ComPtr<ID3D12Resource>								m_readback;
+			std::vector<ComPtr<ID3D12CommandAllocator>>			m_allocators;
+			std::vector<ComPtr<ID3D12GraphicsCommandList>>		m_beginLists;
+			double												m_ticksPerMs;
+	};
+}
@@ -8,20 +8,11 @@ namespace dx12 {
 		: m_name(name) {}
 
 	Resource::Resource(const D3D12_RESOURCE_DESC& resourceDesc, const D3D12_CLEAR_VALUE* clearValue, const std::wstring& name) {
-		auto device = Application::Device();
 		if (clearValue) {
 			m_clearValue = std::make_unique<D3D12_CLEAR_VALUE>(*clearValue);
 		}
 
-		auto heapProperties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
-		ThrowOnFailure(device->CreateCommittedResource(
-			&heapProperties,
-			D3D12_HEAP_FLAG_NONE,
-			&resourceDesc,
-			D3D12_RESOURCE_STATE_COMMON,
-			m_clearValue.get(),
-			IID_PPV_ARGS(&m_resource)
-		));
+		m_resource = Application::Get()->CreateResource(resourceDesc, D3D12_RESOURCE_STATE_COMMON, m_clearValue.get());
 
 		ResourceStateTracker::AddGlobalResourceState(m_resource.Get(), D3D12_RESOURCE_STATE_COMMON);
 		SetName(name);
@@ -47,7 +38,7 @@ namespace dx12 {
 
 	Resource& Resource::operator=(const Resource& other) {
 		if (this != &other) {
-			m_resource = other.m_resource;
+			Retire(other.m_resource);
 			m_name = other.m_name;
 			if (other.m_clearValue) {
 				m_clearValue = std::make_unique<D3D12_CLEAR_VALUE>(*other.m_clearValue);
@@ -58,7 +49,7 @@ namespace dx12 {
 
 	Resource& Resource::operator=(Resource&& other) {
 		if (this != &other) {
-			m_resource = other.m_resource;
+			Retire(other.m_resource);
 			m_name = other.m_name;
 			m_clearValue = std::move(other.m_clearValue);
 
@@ -69,10 +60,12 @@ namespace dx12 {
 		return *this;
 	}
 
-	Resource::~Resource() { }
+	Resource::~Resource() {
+		Retire(nullptr);
+	}
 
 	void Resource::SetResource(ComPtr<ID3D12Resource> resource, const D3D12_CLEAR_VALUE* clearValue) {
-		m_resource = resource;
+		Retire(resource);
 		if (m_clearValue) {
 			m_clearValue = std::make_unique<D3D12_CLEAR_VALUE>(*clearValue);
 		} else {
@@ -93,6 +86,17 @@ namespace dx12 {
 		m_clearValue.reset();
 	}
 
+	void Resource::Retire(ComPtr<ID3D12Resource> replacement) {
+		if (m_resource && m_resource != replacement && Application::IsInitialized()) {
+			// The GPU may still be reading the resource, so the reference always
+			// goes through the deferred queue. Whether it is the last one cannot be
+			// told safely while copies retire on other threads; if it is not, the
+			// queue just drops a reference some frames later.
+			Application::Get()->DeferRelease(std::move(m_resource));
+		}
+		m_resource = std::move(replacement);
+	}
+
 	D3D12_RESOURCE_DESC Resource::ResourceDesc() const {
 		D3D12_RESOURCE_DESC resDesc = {};
 		if (m_resource) {
@@ -28,6 +28,12 @@ namespace dx12 {
 		);
 
 		void SetName(const std::wstring& name);
+
+		/*
+			Drops the resource immediately. The caller is responsible for making
+			sure the GPU is done with it (swap chain buffers before ResizeBuffers);
+			replacing or destroying a Resource defers the release instead.
+		*/
 		virtual void Reset();
 
 		bool IsValid() const { return m_resource != nullptr; }
@@ -36,6 +42,9 @@ namespace dx12 {
 		D3D12_RESOURCE_DESC ResourceDesc() const;
 
 	protected:
+		// Replaces m_resource, handing the old one to the deferred release queue.
+		void Retire(ComPtr<ID3D12Resource> replacement);
+
 		ComPtr<ID3D12Resource>				m_resource;
 		std::unique_ptr<D3D12_CLEAR_VALUE>	m_clearValue;
 		std::wstring						m_name;
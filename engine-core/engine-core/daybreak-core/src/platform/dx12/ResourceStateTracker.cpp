@@ -17,8 +17,8 @@ namespace dx12 {
 	}
 
 	void ResourceStateTracker::Unlock() {
-        g_resourceStateMutex.unlock();
         g_resourceStateLocked = false;
+        g_resourceStateMutex.unlock();
 	}
 
 	void ResourceStateTracker::AddGlobalResourceState(ID3D12Resource* resource, D3D12_RESOURCE_STATES state) {
@@ -97,11 +97,12 @@ namespace dx12 {
 		ResourceBarrier(CD3DX12_RESOURCE_BARRIER::Aliasing(pResourceBefore, pResourceAfter));
 	}
 
-	uint32_t ResourceStateTracker::FlushPendingResourceBarriers(CommandList& commandList) {
+	uint32_t ResourceStateTracker::ResolvePendingResourceBarriers() {
         assert(g_resourceStateLocked);
 
-        std::vector<D3D12_RESOURCE_BARRIER> resourceBarriers;
-        resourceBarriers.reserve(m_pendingResourceBarriers.size());
+        // Kept as a member so its capacity is reused and steady-state submits do
+        // not allocate.
+        m_resolvedResourceBarriers.clear();
         for (auto pendingBarrier : m_pendingResourceBarriers) {
             if (pendingBarrier.Type == D3D12_RESOURCE_BARRIER_TYPE_TRANSITION) {
                 auto pendingTransition = pendingBarrier.Transition;
@@ -117,27 +118,38 @@ namespace dx12 {
                                 D3D12_RESOURCE_BARRIER newBarrier = pendingBarrier;
                                 newBarrier.Transition.Subresource = subresourceState.first;
                                 newBarrier.Transition.StateBefore = subresourceState.second;
-                                resourceBarriers.push_back(newBarrier);
+                                m_resolvedResourceBarriers.push_back(newBarrier);
                             }
                         }
                     } else {
                         auto globalState = (iter->second).GetSubresourceState(pendingTransition.Subresource);
                         if (pendingTransition.StateAfter != globalState) {
                             pendingBarrier.Transition.StateBefore = globalState;
-                            resourceBarriers.push_back(pendingBarrier);
+                            m_resolvedResourceBarriers.push_back(pendingBarrier);
                         }
                     }
                 }
             }
         }
 
-        UINT numBarriers = static_cast<UINT>(resourceBarriers.size());
+        UINT numBarriers = static_cast<UINT>(m_resolvedResourceBarriers.size());
+        LOG_TRACE(DX12, L"[ResourceStateTracker] Resolved %u of %zu pending barriers\n", numBarriers, m_pendingResourceBarriers.size());
+        m_pendingResourceBarriers.clear();
+        return numBarriers;
+	}
+
+	void ResourceStateTracker::FlushResolvedResourceBarriers(CommandList& commandList) {
+        UINT numBarriers = static_cast<UINT>(m_resolvedResourceBarriers.size());
         if (numBarriers > 0) {
             auto d3d12CommandList = commandList.GraphicsCommandList();
-            d3d12CommandList->ResourceBarrier(numBarriers, resourceBarriers.data());
+            d3d12CommandList->ResourceBarrier(numBarriers, m_resolvedResourceBarriers.data());
+            m_resolvedResourceBarriers.clear();
         }
+	}
 
-        m_pendingResourceBarriers.clear();
+	uint32_t ResourceStateTracker::FlushPendingResourceBarriers(CommandList& commandList) {
+        uint32_t numBarriers = ResolvePendingResourceBarriers();
+        FlushResolvedResourceBarriers(commandList);
         return numBarriers;
 	}
 
@@ -162,6 +174,7 @@ namespace dx12 {
 	void ResourceStateTracker::Reset() {
         m_pendingResourceBarriers.clear();
         m_resourceBarriers.clear();
+        m_resolvedResourceBarriers.clear();
         m_finalResourceState.clear();
 	}
 
@@ -23,6 +23,14 @@ namespace dx12 {
 			void AliasBarrier(const Resource* resourceBefore = nullptr, const Resource* resourceAfter = nullptr);
 	
 			uint32_t FlushPendingResourceBarriers(CommandList& commandList);
+
+			/*
+				Split form of FlushPendingResourceBarriers: resolve against the global
+				state first (requires Lock()), then record only if the count is non-zero
+				so the caller can skip a pending command list when none are needed.
+			*/
+			uint32_t ResolvePendingResourceBarriers();
+			void FlushResolvedResourceBarriers(CommandList& commandList);
 			void FlushResourceBarriers(CommandList& commandList);
 
 			void CommitFinalResourceStates();
@@ -59,6 +67,7 @@ namespace dx12 {
 
 		std::vector<D3D12_RESOURCE_BARRIER>					m_pendingResourceBarriers;
 		std::vector<D3D12_RESOURCE_BARRIER>					m_resourceBarriers;
+		std::vector<D3D12_RESOURCE_BARRIER>					m_resolvedResourceBarriers;
 		std::unordered_map<ID3D12Resource*, ResourceState>	m_finalResourceState;
 
 		static std::unordered_map<ID3D12Resource*, ResourceState>	g_resourceState;
@@ -52,17 +52,7 @@ namespace dx12 {
 			resDesc.Height = std::max(height, 1u);
 			resDesc.DepthOrArraySize = depthOrArraySize;
 
-			auto device = Application::Device();
-
-			auto heapProperties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
-			ThrowOnFailure(device->CreateCommittedResource(
-				&heapProperties,
-				D3D12_HEAP_FLAG_NONE,
-				&resDesc,
-				D3D12_RESOURCE_STATE_COMMON,
-				m_clearValue.get(),
-				IID_PPV_ARGS(&m_resource)
-			));
+			Retire(Application::Get()->CreateResource(resDesc, D3D12_RESOURCE_STATE_COMMON, m_clearValue.get()));
 
 			m_resource->SetName(m_name.c_str());
 			ResourceStateTracker::AddGlobalResourceState(m_resource.Get(), D3D12_RESOURCE_STATE_COMMON);
@@ -1,100 +1,101 @@
 #include "daybreak.h"
 #include "UploadBuffer.h"
 
-namespace dx12 {
-	UploadBuffer::UploadBuffer(size_t pageSize) 
-		: m_pageSize(pageSize) {}
+#include "UploadRing.h"
+
+#include <algorithm>
 
-	UploadBuffer::~UploadBuffer() {}
+namespace dx12 {
+	UploadBuffer::UploadBuffer(UploadRing& ring, size_t chunkSize) :
+		m_ring(ring),
+		m_chunkSize(chunkSize),
+		m_cpuBase(nullptr),
+		m_gpuBase(D3D12_GPU_VIRTUAL_ADDRESS(0)),
+		m_resource(nullptr),
+		m_resourceOffset(0),
+		m_size(0),
+		m_offset(0) {}
+
+	UploadBuffer::~UploadBuffer() {
+		Reset();
+	}
 
 	UploadBuffer::Allocation UploadBuffer::Allocate(size_t sizeBytes, size_t alignment) {
-		if (sizeBytes > m_pageSize) {
-			throw std::bad_alloc();
+		if (sizeBytes > m_ring.LargeAllocationThreshold()) {
+			return AllocateLarge(sizeBytes);
 		}
 
-		// If there is no current page, or the requested allocation exceeds the
-		// remaining space in the current page, request a new page.
-		if (!m_currentPage || !m_currentPage->HasSpace(sizeBytes, alignment)) {
-			m_currentPage = RequestPage();
-		}
-		return m_currentPage->Allocate(sizeBytes, alignment);
-	}
-	
-	void UploadBuffer::Reset() {
-		m_currentPage = nullptr;
-		m_availablePages = m_pagePool;
-		for (auto &page : m_availablePages) {
-			page->Reset();
+		size_t alignedOffset = AlignUp(m_offset, alignment);
+		if (!m_cpuBase || alignedOffset + sizeBytes > m_size) {
+			RequestChunk(sizeBytes, alignment);
+			if (!m_cpuBase) {
+				// The ring is full of in-flight work; don't stall on the GPU.
+				return AllocateLarge(sizeBytes);
+			}
+			alignedOffset = 0;
 		}
-	}
 
-	std::shared_ptr<UploadBuffer::Page> UploadBuffer::RequestPage()
-	{
-		std::shared_ptr<Page> page;
-		if (!m_availablePages.empty()) {
-			page = m_availablePages.front();
-			m_availablePages.pop_front();
-		} else {
-			page = std::make_shared<Page>(m_pageSize);
-			m_pagePool.push_back(page);
-		}
-		return page;
-	}
+		Allocation allocation;
+		allocation.cpuAddress = m_cpuBase + alignedOffset;
+		allocation.gpuAddress = m_gpuBase + alignedOffset;
+		allocation.resource = m_resource;
+		allocation.offset = m_resourceOffset + alignedOffset;
+
+		m_offset = alignedOffset + sizeBytes;
 
-	UploadBuffer::Page::Page(size_t sizeInBytes) :
-		m_pageSize(sizeInBytes), 
-		m_offset(0), 
-		m_cpuBase(nullptr), 
-		m_gpuBase(D3D12_GPU_VIRTUAL_ADDRESS(0)) {
-
-		auto device = Application::Device();
-		auto heapProperties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
-		auto resourceDesc = CD3DX12_RESOURCE_DESC::Buffer(m_pageSize);
-		ThrowOnFailure(device->CreateCommittedResource(
-			&heapProperties,
-			D3D12_HEAP_FLAG_NONE,
-			&resourceDesc,
-			D3D12_RESOURCE_STATE_GENERIC_READ,
-			nullptr,
-			IID_PPV_ARGS(&m_resource)
-		));
-
-		m_gpuBase = m_resource->GetGPUVirtualAddress();
-		m_resource->Map(0, nullptr, &m_cpuBase);
+		return allocation;
 	}
 
-	UploadBuffer::Page::~Page() {
-		m_resource->Unmap(0, nullptr);
+	void UploadBuffer::Submit(uint64_t fenceValue) {
+		for (uint64_t id : m_unsubmittedChunks) {
+			m_ring.Tag(id, fenceValue);
+		}
+		m_unsubmittedChunks.clear();
+
+		// Later allocations must come from a chunk tagged with a later fence.
 		m_cpuBase = nullptr;
-		m_gpuBase = D3D12_GPU_VIRTUAL_ADDRESS(0);
 	}
 
-	bool UploadBuffer::Page::HasSpace(size_t sizeBytes, size_t alignment) const {
-		size_t alignedSize = AlignUp(sizeBytes, alignment);
-		size_t alignedOffset = AlignUp(m_offset, alignment);
+	void UploadBuffer::Reset() {
+		// Chunks that were never submitted were never seen by the GPU.
+		Submit(0);
 
-		return alignedOffset + alignedSize <= m_pageSize;
+		m_largeAllocations.clear();
+		m_size = 0;
+		m_offset = 0;
 	}
 
-	UploadBuffer::Allocation UploadBuffer::Page::Allocate(size_t sizeBytes, size_t alignment) {
-		if (!HasSpace(sizeBytes, alignment)) {
-			throw std::bad_alloc();
+	void UploadBuffer::RequestChunk(size_t sizeBytes, size_t alignment) {
+		// Chunks start on a constant buffer boundary so any smaller alignment
+		// inside them holds.
+		size_t chunkAlignment = std::max<size_t>(alignment, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+		size_t chunkSize = std::max(m_chunkSize, AlignUp(sizeBytes, chunkAlignment));
+
+		UploadRing::Chunk chunk;
+		if (!m_ring.Allocate(chunkSize, chunkAlignment, chunk)) {
+			m_cpuBase = nullptr;
+			return;
 		}
 
-		size_t alignedSize = AlignUp(sizeBytes, alignment);
-		m_offset = AlignUp(m_offset, alignment);
+		m_unsubmittedChunks.push_back(chunk.Id);
+		m_cpuBase = static_cast<uint8_t*>(chunk.CpuAddress);
+		m_gpuBase = chunk.GpuAddress;
+		m_resource = chunk.Resource;
+		m_resourceOffset = chunk.Offset;
+		m_size = chunkSize;
+		m_offset = 0;
+	}
 
-		Allocation allocation;
-		allocation.cpuAddress = static_cast<uint8_t*>(m_cpuBase) + m_offset;
-		allocation.gpuAddress = m_gpuBase + m_offset;
+	UploadBuffer::Allocation UploadBuffer::AllocateLarge(size_t sizeBytes) {
+		ComPtr<ID3D12Resource> resource = m_ring.AllocateLarge(sizeBytes);
 
-		m_offset += alignedSize;
+		Allocation allocation;
+		ThrowOnFailure(resource->Map(0, nullptr, &allocation.cpuAddress));
+		allocation.gpuAddress = resource->GetGPUVirtualAddress();
+		allocation.resource = resource.Get();
+		allocation.offset = 0;
 
+		m_largeAllocations.push_back(std::move(resource));
 		return allocation;
 	}
-
-	void UploadBuffer::Page::Reset()
-	{
-		m_offset = 0;
-	}
-}
\ No newline at end of file
+}
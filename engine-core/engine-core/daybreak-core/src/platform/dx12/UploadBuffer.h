@@ -2,51 +2,57 @@
 
 namespace dx12 {
 
+	class UploadRing;
+
+	/*
+		Per-command-list linear allocator for CPU-written, GPU-read data. Space
+		is taken from the owning queue's UploadRing in chunks and handed out
+		linearly; requests too big for the ring get a dedicated buffer. Nothing is
+		kept across Reset(), so a pooled command list holds no upload memory while
+		idle.
+	*/
 	class DAYBREAK_API UploadBuffer {
 
 		public:
 			struct Allocation {
 				void*						cpuAddress;
 				D3D12_GPU_VIRTUAL_ADDRESS	gpuAddress;
+
+				// Source for CopyBufferRegion; valid until Reset().
+				ID3D12Resource*				resource;
+				size_t						offset;
 			};
 
-			UploadBuffer(size_t pageSize = MEMSIZE_4MB);
+			UploadBuffer(UploadRing& ring, size_t chunkSize = MEMSIZE_64KB);
 			virtual ~UploadBuffer();
 
 			Allocation Allocate(size_t sizeBytes, size_t alignment);
+
+			/*
+				Tags every chunk taken since the last call with the fence value that
+				marks the end of the submission reading them.
+			*/
+			void Submit(uint64_t fenceValue);
 			void Reset();
 
-			size_t PageSize() const { return m_pageSize; }
+			size_t ChunkSize() const { return m_chunkSize; }
 	
 		private:
-			struct Page {
-				
-					Page(size_t sizeBytes);
-					~Page();
-
-					bool HasSpace(size_t sizeBytes, size_t alignment) const;
-					Allocation Allocate(size_t sizeBytes, size_t alignment);
-
-					void Reset();
-
-				private:
-					ComPtr<ID3D12Resource>		m_resource;
-
-					// Base Pointers
-					void* m_cpuBase;
-					D3D12_GPU_VIRTUAL_ADDRESS	m_gpuBase;
-
-					size_t						m_pageSize;
-					size_t						m_offset;
-			};
-
-			using PagePool = std::deque<std::shared_ptr<Page>>;
-
-			PagePool				m_pagePool;
-			PagePool				m_availablePages;
-			size_t					m_pageSize;
-			std::shared_ptr<Page>	m_currentPage;
-
-			std::shared_ptr<Page> RequestPage();
+			void RequestChunk(size_t sizeBytes, size_t alignment);
+			Allocation AllocateLarge(size_t sizeBytes);
+
+			UploadRing&							m_ring;
+			size_t								m_chunkSize;
+
+			// Current chunk
+			uint8_t*							m_cpuBase;
+			D3D12_GPU_VIRTUAL_ADDRESS			m_gpuBase;
+			ID3D12Resource*						m_resource;
+			size_t								m_resourceOffset;
+			size_t								m_size;
+			size_t								m_offset;
+
+			std::vector<uint64_t>				m_unsubmittedChunks;
+			std::vector<ComPtr<ID3D12Resource>>	m_largeAllocations;
 	};
-}
\ No newline at end of file
+}
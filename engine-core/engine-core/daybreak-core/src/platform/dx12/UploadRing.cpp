@@ -0,0 +1,93 @@
+#include "daybreak.h"
+#include "UploadRing.h"
+
+namespace dx12 {
+
+	static ComPtr<ID3D12Resource> CreateUploadResource(size_t size) {
+		ComPtr<ID3D12Resource> resource;
+
+		auto device = Application::Device();
+		auto heapProperties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+		auto resourceDesc = CD3DX12_RESOURCE_DESC::Buffer(size);
+		ThrowOnFailure(device->CreateCommittedResource(
+			&heapProperties,
+			D3D12_HEAP_FLAG_NONE,
+			&resourceDesc,
+			D3D12_RESOURCE_STATE_GENERIC_READ,
+			nullptr,
+			IID_PPV_ARGS(&resource)
+		));
+		return resource;
+	}
+
+	UploadRing::UploadRing(ComPtr<ID3D12Fence> fence, size_t capacity) :
+		m_fence(fence),
+		m_cpuBase(nullptr),
+		m_gpuBase(D3D12_GPU_VIRTUAL_ADDRESS(0)),
+		m_capacity(capacity),
+		m_ring(capacity),
+		m_largeAllocations(0),
+		m_largeAllocationBytes(0) {
+
+		m_resource = CreateUploadResource(m_capacity);
+		m_resource->SetName(L"Upload Ring");
+		m_gpuBase = m_resource->GetGPUVirtualAddress();
+		ThrowOnFailure(m_resource->Map(0, nullptr, &m_cpuBase));
+	}
+
+	UploadRing::~UploadRing() {
+		m_resource->Unmap(0, nullptr);
+		m_cpuBase = nullptr;
+		m_gpuBase = D3D12_GPU_VIRTUAL_ADDRESS(0);
+	}
+
+	bool UploadRing::Allocate(size_t size, size_t alignment, Chunk& chunk) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		// Chunks are large, so polling the fence on every request is cheap and
+		// keeps the used size (and with it the high-water mark) honest.
+		m_ring.Retire(m_fence->GetCompletedValue());
+
+		memory::RingAllocator::Allocation allocation;
+		if (!m_ring.Allocate(size, alignment, allocation)) {
+			return false;
+		}
+
+		chunk.CpuAddress = static_cast<uint8_t*>(m_cpuBase) + allocation.Offset;
+		chunk.GpuAddress = m_gpuBase + allocation.Offset;
+		chunk.Resource = m_resource.Get();
+		chunk.Offset = allocation.Offset;
+		chunk.Id = allocation.Id;
+		return true;
+	}
+
+	void UploadRing::Tag(uint64_t id, uint64_t fenceValue) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_ring.Tag(id, fenceValue);
+	}
+
+	ComPtr<ID3D12Resource> UploadRing::AllocateLarge(size_t size) {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_largeAllocations++;
+			m_largeAllocationBytes += size;
+		}
+		LOG_DEBUG(DX12, L"[UploadRing::AllocateLarge] Dedicated upload buffer of %zu bytes\n", size);
+		return CreateUploadResource(size);
+	}
+
+	UploadRing::Statistics UploadRing::Stats() const {
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		Statistics stats;
+		stats.Ring = m_ring.Stats();
+		stats.LargeAllocations = m_largeAllocations;
+		stats.LargeAllocationBytes = m_largeAllocationBytes;
+		return stats;
+	}
+
+	void UploadRing::ResetHighWaterMark() {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_ring.ResetHighWaterMark();
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <mutex>
+
+#include "common/RingAllocator.h"
+
+namespace dx12 {
+
+	/*
+		Persistently mapped upload heap shared by every command list of one
+		CommandQueue. Command lists carve chunks out of it (see UploadBuffer), the
+		queue tags them with its fence value on submit, and they are reclaimed as
+		soon as that fence passes. The placement policy lives in
+		memory::RingAllocator; this class only owns the D3D12 buffer.
+	*/
+	class DAYBREAK_API UploadRing {
+		public:
+			struct Chunk {
+				void*						CpuAddress;
+				D3D12_GPU_VIRTUAL_ADDRESS	GpuAddress;
+				ID3D12Resource*				Resource;	// Ring buffer and offset, for
+				uint64_t					Offset;		// CopyBufferRegion sources.
+				uint64_t					Id;
+			};
+
+			struct Statistics {
+				memory::RingAllocator::Statistics	Ring;
+				uint64_t							LargeAllocations;
+				uint64_t							LargeAllocationBytes;
+			};
+
+			UploadRing(ComPtr<ID3D12Fence> fence, size_t capacity);
+			~UploadRing();
+
+			UploadRing(const UploadRing& copy) = delete;
+			UploadRing& operator=(const UploadRing& other) = delete;
+
+			/*
+				Returns false if the ring is still full after reclaiming everything
+				the GPU has finished with.
+			*/
+			bool Allocate(size_t size, size_t alignment, Chunk& chunk);
+			void Tag(uint64_t id, uint64_t fenceValue);
+
+			/*
+				Creates a dedicated upload buffer for a request that does not belong in
+				the ring. The caller keeps it alive until the GPU is done with it.
+			*/
+			ComPtr<ID3D12Resource> AllocateLarge(size_t size);
+
+			// Requests above this size go to AllocateLarge.
+			size_t LargeAllocationThreshold() const { return m_capacity / 4; }
+
+			Statistics Stats() const;
+			void ResetHighWaterMark();
+
+		private:
+			ComPtr<ID3D12Fence>			m_fence;
+			ComPtr<ID3D12Resource>		m_resource;
+			void*						m_cpuBase;
+			D3D12_GPU_VIRTUAL_ADDRESS	m_gpuBase;
+			size_t						m_capacity;
+
+			mutable std::mutex			m_mutex;
+			memory::RingAllocator		m_ring;
+			uint64_t					m_largeAllocations;
+			uint64_t					m_largeAllocationBytes;
+	};
+}
@@ -0,0 +1,70 @@
+#include "daybreak.h"
+
+#ifndef WIN32
+
+namespace posix {
+
+	void TranslateFormat(const wchar_t* fmt, wchar_t* out, size_t outSize) {
+		size_t length = 0;
+		auto put = [&](wchar_t c) {
+			if (length + 1 < outSize) {
+				out[length++] = c;
+			}
+		};
+
+		for (const wchar_t* c = fmt; *c; c++) {
+			put(*c);
+			if (*c != L'%') {
+				continue;
+			}
+
+			c++;
+			if (*c == L'%') {
+				put(*c);
+				continue;
+			}
+
+			// Flags, width and precision pass through unchanged.
+			while (*c && (wcschr(L"-+ #0.*", *c) || (*c >= L'0' && *c <= L'9'))) {
+				put(*c++);
+			}
+
+			if (*c == L'h' && (c[1] == L's' || c[1] == L'S')) {
+				// %hs: narrow string.
+				put(L's');
+				c++;
+			} else if (*c == L'l' && (c[1] == L's' || c[1] == L'c')) {
+				// Already standard.
+				put(*c++);
+				put(*c);
+			} else if (*c == L's' || *c == L'c') {
+				put(L'l');
+				put(*c);
+			} else if (*c == L'S') {
+				put(L's');
+			} else if (*c == L'C') {
+				put(L'c');
+			} else if (*c) {
+				put(*c);
+			} else {
+				break;
+			}
+		}
+		out[length] = L'\0';
+	}
+
+	int FormatV(wchar_t* buffer, size_t size, const wchar_t* fmt, va_list args) {
+		wchar_t translated[1024];
+		TranslateFormat(fmt, translated, _countof(translated));
+
+		int written = vswprintf(buffer, size, translated, args);
+		if (written < 0 && size > 0) {
+			// glibc reports truncation as an error; MSVC's _TRUNCATE keeps the prefix.
+			buffer[size - 1] = L'\0';
+			written = static_cast<int>(wcslen(buffer));
+		}
+		return written;
+	}
+}
+
+#endif
@@ -0,0 +1,87 @@
+#pragma once
+
+#ifndef WIN32
+
+#include <cstdarg>
+#include <cstddef>
+#include <cstdio>
+#include <ctime>
+#include <cwchar>
+
+/*
+	Minimal stand-ins for the Win32 types and MSVC secure CRT functions used by
+	the platform-neutral parts of the engine (core, common, engine), so a
+	headless server builds with GCC/Clang without touching every call site.
+
+	MSVC's wide printf treats %s as a wide string and %S / %hs as narrow; glibc
+	follows the C standard (%s narrow, %ls wide). The formatting shims rewrite
+	the format so the engine's existing format strings print correctly.
+*/
+
+typedef wchar_t WCHAR;
+
+#ifndef MAX_PATH
+	#define MAX_PATH 260
+#endif
+
+#ifndef _TRUNCATE
+	#define _TRUNCATE ((size_t)-1)
+#endif
+
+#ifndef _countof
+	#define _countof(array) (sizeof(array) / sizeof((array)[0]))
+#endif
+
+namespace posix {
+
+	/*
+		Writes fmt, with MSVC wide-printf conversions rewritten to their C
+		standard spelling, into out (at most outSize code units, terminated).
+	*/
+	void TranslateFormat(const wchar_t* fmt, wchar_t* out, size_t outSize);
+
+	int FormatV(wchar_t* buffer, size_t size, const wchar_t* fmt, va_list args);
+}
+
+inline void OutputDebugString(const wchar_t* text) {
+	fputws(text, stderr);
+}
+
+inline int localtime_s(tm* result, const time_t* time) {
+	return localtime_r(time, result) ? 0 : -1;
+}
+
+template<size_t Size>
+inline int wcscpy_s(wchar_t (&dest)[Size], const wchar_t* source) {
+	wcsncpy(dest, source, Size - 1);
+	dest[Size - 1] = L'\0';
+	return 0;
+}
+
+template<size_t Size>
+inline int wcscat_s(wchar_t (&dest)[Size], const wchar_t* source) {
+	size_t length = wcslen(dest);
+	if (length + 1 < Size) {
+		wcsncat(dest, source, Size - length - 1);
+	}
+	return 0;
+}
+
+template<size_t Size>
+inline int wcsncpy_s(wchar_t (&dest)[Size], const wchar_t* source, size_t count) {
+	size_t length = count == _TRUNCATE ? Size - 1 : (count < Size - 1 ? count : Size - 1);
+	wcsncpy(dest, source, length);
+	dest[length] = L'\0';
+	return 0;
+}
+
+template<size_t Size>
+inline int vswprintf_s(wchar_t (&buffer)[Size], const wchar_t* fmt, va_list args) {
+	return posix::FormatV(buffer, Size, fmt, args);
+}
+
+inline int _vsnwprintf_s(wchar_t* buffer, size_t size, size_t count, const wchar_t* fmt, va_list args) {
+	return posix::FormatV(buffer, count == _TRUNCATE || count >= size ? size : count + 1, fmt, args);
+}
+
+#endif
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "daybreak.h"
+
+#include "engine/Simulation.h"
+#include "common/CmdLineArgs.h"
+#include "engine/manager/FPSCounter.h"
+
+#include <csignal>
+
+/*
+	Entry point for non-Windows builds. There is no window system or renderer
+	here, so the game always runs as a headless SERVER; SIGINT and SIGTERM stop
+	the tick loop and shut down cleanly.
+*/
+
+extern win32::IApplication* entry_point();
+
+static Daybreak::Simulation* g_headlessSimulation = nullptr;
+
+static void StopHeadless(int) {
+	if (g_headlessSimulation) {
+		g_headlessSimulation->RequestStop();
+	}
+}
+
+int main(int argc, char** argv) {
+
+	// Apply GAME settings to DAYBREAK
+	GameSettings settings;
+	Daybreak::Simulation* simulation = (Daybreak::Simulation*) entry_point();
+	simulation->Settings();
+
+	// Read arguments and initialize logger
+	CmdLine::ReadArguments(argc, argv);
+	Engine::SetMode(EngineMode::SERVER);
+	Logger logger;
+
+	jobs::JobSystem::Initialize(CmdLine::WorkerCount());
+
+	Profiler::SetThreadName("Main");
+	if (CmdLine::ProfileFrames() > 0) {
+		Profiler::BeginCapture(CmdLine::ProfileFrames(), GameSettings::CurrentPath() + L"/profile");
+	}
+
+	g_headlessSimulation = simulation;
+	std::signal(SIGINT, StopHeadless);
+	std::signal(SIGTERM, StopHeadless);
+
+	Logger::log_debug_seperator();
+	Logger::info(L"[DAYBREAK STARTUP] Daybreak Headless Initialization...\n");
+	simulation->RunHeadless(CmdLine::TickRate());
+	Profiler::EndCapture();
+
+	Logger::info(L"[GAME TEARDOWN] Shutting down...\n");
+	simulation->Teardown();
+	if (CmdLine::ExportFrameStats()) {
+		std::wstring path = GameSettings::CurrentPath() + L"/framestats.csv";
+		Logger::info(L"Writing frame statistics to %s\n", path.c_str());
+		FPSCounter::ExportCSV(path);
+	}
+	g_headlessSimulation = nullptr;
+	delete simulation;
+
+	jobs::JobSystem::Shutdown();
+	return 0;
+}
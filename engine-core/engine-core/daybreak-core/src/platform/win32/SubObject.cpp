@@ -31,7 +31,7 @@ namespace win32 {
 	}
 
 	LRESULT SubObject::SetupMessageHandler(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
-		Logger::debug(L"Setup with command: %d\n", msg);
+		LOG_TRACE(Input, L"Setup with command: %d\n", msg);
 		if (msg == WM_NCCREATE) {
 			const CREATESTRUCTW* const pCreate = reinterpret_cast<CREATESTRUCTW*>(lParam);
 			win32::SubObject* const pWnd = static_cast<win32::SubObject*>(pCreate->lpCreateParams);
@@ -49,7 +49,7 @@ namespace win32 {
 
 	LRESULT SubObject::AssignMessageHandler(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
 		win32::SubObject* const pWnd = reinterpret_cast<win32::SubObject*>(GetWindowLongPtr(hWnd, GWLP_USERDATA));
-		Logger::debug(L"Assigning handler with: %d\n", msg);
+		LOG_TRACE(Input, L"Assigning handler with: %d\n", msg);
 		return pWnd->MessageHandler(hWnd, msg, wParam, lParam);
 	}
 
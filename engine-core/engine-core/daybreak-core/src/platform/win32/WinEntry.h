@@ -7,6 +7,11 @@
 
 extern win32::IApplication* entry_point();
 
+static BOOL WINAPI StopHeadless(DWORD controlType) {
+	WindowManagerUtil::RequestStop();
+	return TRUE;
+}
+
 int CALLBACK WinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance, _In_ LPSTR lpCmdLine, _In_ INT nCmdShow) {
 
 	// Apply GAME settings to DAYBREAK
@@ -17,21 +22,45 @@ int CALLBACK WinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
 	CmdLine::ReadArguments();
 	Logger logger;
 
+	jobs::JobSystem::Initialize(CmdLine::WorkerCount());
+
+	Profiler::SetThreadName("Main");
+	if (CmdLine::ProfileFrames() > 0) {
+		Profiler::BeginCapture(CmdLine::ProfileFrames(), GameSettings::CurrentPath() + L"/profile");
+	}
+
+	if (Engine::GetMode() == EngineMode::SERVER) {
+		// Headless: no window, swap chain or D3D device. Runs until the console closes.
+		SetConsoleCtrlHandler(StopHeadless, TRUE);
+		WindowManagerUtil::RunHeadless(CmdLine::TickRate());
+		Profiler::EndCapture();
+		WindowManagerUtil::Close();
+		jobs::JobSystem::Shutdown();
+		return 0;
+	}
+
 	// Initialize
 	Daybreak::RenderStateManager::Create();
 	WindowManagerUtil::Initialize();
 	WindowManagerUtil::Open();
 
+	// Drain every pending message, then always tick once, so a flood of input
+	// or resize messages cannot starve the frame.
 	InputManager& input_manager = InputManagerFactory::create();
-	while (!input_manager.handle_exit()) {
-		bool hasInput = input_manager.handle_input();
-		if (!hasInput) {
-			WindowManagerUtil::Tick();
+	for (;;) {
+		input_manager.handle_input();
+		if (input_manager.handle_exit()) {
+			break;
 		}
+
+		WindowManagerUtil::Tick();
+		input_manager.end_frame();
 	}
+	Profiler::EndCapture();
 
 	WindowManagerUtil::Close();
 	Daybreak::RenderStateManager::Destroy();
+	jobs::JobSystem::Shutdown();
 
 	if (Engine::GetMode() == EngineMode::DEBUG || Engine::GetMode() == EngineMode::EDITOR) {
 		Microsoft::WRL::ComPtr<IDXGIDebug1> dxgi_debug;
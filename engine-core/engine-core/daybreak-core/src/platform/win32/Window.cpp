@@ -34,7 +34,7 @@ namespace win32 {
 	}
 
 	LRESULT Window::MessageHandler(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam) {
-		Logger::debug(L"Window handler: %d\n", message);
+		LOG_TRACE(Input, L"Window handler: %d\n", message);
 		switch (message) {
 			case WM_NCCREATE: { OnNonClientCreate(); }									return true;
 			case WM_NCACTIVATE: { OnNonClientActivate(LOWORD(wParam) != WA_INACTIVE); } return true;
@@ -0,0 +1,122 @@
+#include "daybreak.h"
+#include "Test.h"
+
+#include "common/AsyncLogWriter.h"
+#include "common/BinaryLog.h"
+
+#include <cstdarg>
+#include <fstream>
+#include <unordered_map>
+
+/*
+	Binary log round trip: records written by AsyncLogWriter in binary mode,
+	one per argument type, decoded the way blog-decode does and compared with
+	what printf would have produced at the call site.
+*/
+
+namespace {
+
+	void Push(AsyncLogWriter& writer, const wchar_t* fmt, ...) {
+		va_list args;
+		va_start(args, fmt);
+		writer.Push(L"INFO", fmt, args);
+		va_end(args);
+	}
+
+	// Every Entry in the file, formatted.
+	bool Decode(const std::filesystem::path& path, std::vector<std::wstring>& entries) {
+		std::ifstream input(path, std::ios_base::binary);
+		std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+		blog::Reader reader = { bytes.data(), bytes.data() + bytes.size() };
+		uint32_t magic = 0, version = 0;
+		if (!reader.Read(magic) || !reader.Read(version) || magic != blog::Magic || version != blog::Version) {
+			return false;
+		}
+
+		std::unordered_map<uint32_t, blog::Format> formats;
+		while (reader.Cursor < reader.End) {
+			blog::RecordType type = {};
+			reader.Read(type);
+
+			uint32_t id = 0;
+			if (type == blog::RecordType::Format) {
+				blog::Format format;
+				if (!reader.Read(id) || !reader.ReadString(format.Level) || !reader.ReadString(format.Text)) {
+					return false;
+				}
+				blog::ParseFormat(format.Text.c_str(), format.Args);
+				formats[id] = std::move(format);
+			} else if (type == blog::RecordType::Entry) {
+				int64_t time = 0;
+				uint16_t size = 0;
+				if (!reader.Read(id) || !reader.Read(time) || !reader.Read(size) || reader.Cursor + size > reader.End || !formats.count(id)) {
+					return false;
+				}
+				entries.push_back(blog::FormatEntry(formats[id], { reader.Cursor, reader.Cursor + size }));
+				reader.Cursor += size;
+			} else {
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+TEST(ParseFormatSizes) {
+	std::vector<blog::ArgType> args;
+	blog::ParseFormat(L"%d %lld %ld %zu %f %p %s %hs %S %c %*.*f %%", args);
+
+	blog::ArgType longType = sizeof(long) == 8 ? blog::ArgType::Int64 : blog::ArgType::Int32;
+	blog::ArgType sizeType = sizeof(void*) == 8 ? blog::ArgType::Int64 : blog::ArgType::Int32;
+	std::vector<blog::ArgType> expected = {
+		blog::ArgType::Int32, blog::ArgType::Int64, longType, sizeType, blog::ArgType::Double, blog::ArgType::Pointer,
+		blog::ArgType::WideString, blog::ArgType::NarrowString, blog::ArgType::NarrowString, blog::ArgType::Int32,
+		blog::ArgType::Int32, blog::ArgType::Int32, blog::ArgType::Double
+	};
+	CHECK(args == expected);
+}
+
+TEST(RoundTrip) {
+	std::filesystem::path path = std::filesystem::temp_directory_path() / "daybreak-binary-log.blog";
+	std::filesystem::remove(path);
+
+	long wideLong = sizeof(long) == 8 ? static_cast<long>(1LL << 40) : 123456789L;
+	{
+		AsyncLogWriter writer(path.wstring(), true);
+		CHECK(writer.IsOpen() && writer.IsBinary());
+
+		Push(writer, L"int %d\n", -42);
+		Push(writer, L"int64 %lld\n", 1LL << 40);
+		Push(writer, L"long %ld\n", wideLong);
+		Push(writer, L"double %.3f\n", 3.14159);
+		Push(writer, L"pointer [%p] [%20p] [%-18p]\n", reinterpret_cast<void*>(0x1234), reinterpret_cast<void*>(0xBEEF), reinterpret_cast<void*>(0x1));
+		Push(writer, L"wide %s\n", L"text");
+		Push(writer, L"narrow %hs\n", "bytes");
+		Push(writer, L"char %c\n", L'x');
+		Push(writer, L"star [%*d] [%.*f]\n", 5, 42, 2, 0.5);
+		Push(writer, L"int %d\n", 7);
+	}
+
+	std::vector<std::wstring> entries;
+	CHECK(Decode(path, entries));
+
+	std::vector<std::wstring> expected = {
+		L"int -42\n",
+		L"int64 1099511627776\n",
+		L"long " + std::to_wstring(wideLong) + L"\n",
+		L"double 3.142\n",
+		L"pointer [0000000000001234] [    000000000000BEEF] [0000000000000001  ]\n",
+		L"wide text\n",
+		L"narrow bytes\n",
+		L"char x\n",
+		L"star [   42] [0.50]\n",
+		L"int 7\n"
+	};
+	CHECK(entries.size() == expected.size());
+	for (size_t i = 0; i < entries.size() && i < expected.size(); i++) {
+		CHECK(entries[i] == expected[i]);
+	}
+
+	std::filesystem::remove(path);
+}
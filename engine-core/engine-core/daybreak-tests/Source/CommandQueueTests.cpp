@@ -0,0 +1,114 @@
+#include "daybreak.h"
+#include "Test.h"
+
+#include "platform/dx12/CommandList.h"
+#include "platform/dx12/Texture.h"
+
+#include <crtdbg.h>
+
+/*
+	CommandQueue::ExecuteCommandLists must not allocate once the command list
+	pool is warm, including when a submission is split into several batches
+	and when lists need a pending barrier list in front of them.
+
+	Windows only (daybreak-tests.vcxproj). Allocations are counted with the
+	debug CRT's allocation hook, which sees daybreak-core.dll as well as this
+	executable, so the counting test needs the Debug configuration. Only the
+	submitting thread is counted: the retirement thread resets lists on its
+	own time.
+*/
+
+static DWORD g_countedThread = 0;
+static std::atomic<size_t> g_allocations = 0;
+
+static int CountAllocations(int type, void*, size_t, int, long, const unsigned char*, int) {
+	if (type != _HOOK_FREE && GetCurrentThreadId() == g_countedThread) {
+		g_allocations++;
+	}
+	return TRUE;
+}
+
+class D3D12Scope {
+	public:
+		D3D12Scope() {
+			m_window = CreateWindowExW(0, L"STATIC", L"daybreak-tests", WS_OVERLAPPEDWINDOW, 0, 0, 64, 64, nullptr, nullptr, GetModuleHandleW(nullptr), nullptr);
+			dx12::Application::CreateApplication(L"daybreak-tests", 64, 64, m_window);
+		}
+
+		~D3D12Scope() {
+			dx12::Application::Get()->Flush();
+			dx12::Application::DestroyApplication();
+			DestroyWindow(m_window);
+		}
+
+	private:
+		HWND m_window;
+};
+
+/*
+	Records count lists. Every other list transitions texture to a state its
+	own tracker has not seen, which leaves a pending barrier to resolve at
+	submit (so ExecuteCommandLists pulls a pending list from the pool); the
+	rest record nothing.
+*/
+static void Record(dx12::CommandQueue& queue, dx12::Texture& texture, size_t count, uint32_t round, std::vector<std::shared_ptr<dx12::CommandList>>& lists) {
+	lists.clear();
+	for (size_t i = 0; i < count; i++) {
+		std::shared_ptr<dx12::CommandList> list = queue.CommandList();
+		if (i % 2 == 0) {
+			bool copy = (i / 2 + round) % 2 == 0;
+			list->TransitionBarrier(texture, copy ? D3D12_RESOURCE_STATE_COPY_DEST : D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+		}
+		lists.push_back(std::move(list));
+	}
+}
+
+static size_t CountedSubmit(dx12::CommandQueue& queue, std::vector<std::shared_ptr<dx12::CommandList>>& lists) {
+	size_t before = g_allocations;
+	g_countedThread = GetCurrentThreadId();
+	queue.ExecuteCommandLists(lists);
+	g_countedThread = 0;
+	return g_allocations - before;
+}
+
+TEST(ExecuteCommandListsDoesNotAllocateWhenWarm) {
+#ifndef _DEBUG
+	printf("  skipped: allocation counting needs the debug CRT\n");
+#else
+	D3D12Scope scope;
+	auto queue = dx12::Application::Get()->CommandQueue(D3D12_COMMAND_LIST_TYPE_DIRECT);
+
+	dx12::Texture texture(CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R8G8B8A8_UNORM, 64, 64, 1, 1), nullptr, gfx::TextureType::ALBEDO, L"Barrier target");
+
+	// Past MaxBatchSize so the submission is split, but small enough that the
+	// lists and their pending lists (1.5x) all fit back in the pool.
+	const size_t ListCount = dx12::CommandQueue::MaxBatchSize + dx12::CommandQueue::MaxBatchSize / 2;
+	static_assert(ListCount + ListCount / 2 <= dx12::CommandQueue::MaxCommandLists, "Warm pool must hold every list");
+
+	std::vector<std::shared_ptr<dx12::CommandList>> lists;
+	lists.reserve(ListCount);
+
+	_CRT_ALLOC_HOOK previous = _CrtSetAllocHook(CountAllocations);
+	for (uint32_t round = 0; round < 8; round++) {
+		Record(*queue, texture, ListCount, round, lists);
+		size_t allocations = CountedSubmit(*queue, lists);
+		printf("  round %u: %zu allocations\n", round, allocations);
+
+		// The first rounds fill the pool and grow the retirement queue.
+		if (round >= 2) {
+			CHECK(allocations == 0);
+		}
+
+		// Wait for the lists to come back to the pool.
+		queue->Flush();
+	}
+
+	// A single list, with and without a pending barrier.
+	for (uint32_t round = 0; round < 2; round++) {
+		Record(*queue, texture, 1, round + 1, lists);
+		CHECK(CountedSubmit(*queue, lists) == 0);
+		queue->Flush();
+	}
+	_CrtSetAllocHook(previous);
+#endif
+}
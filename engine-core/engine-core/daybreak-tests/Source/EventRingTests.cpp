@@ -0,0 +1,120 @@
+#include "daybreak.h"
+#include "Test.h"
+
+#include "input/EventRing.h"
+
+#include <deque>
+
+/*
+	Input event ring: FIFO order for independent readers, what a reader loses
+	once the ring wraps past it, and the per-frame bound on draining the
+	platform message queue.
+*/
+
+namespace {
+
+	input::Event KeyDown(uint32_t key) {
+		input::Event event = {};
+		event.Type = input::EventType::KeyDown;
+		event.Key = key;
+		return event;
+	}
+}
+
+TEST(ReadersSeeFifoOrder) {
+	input::EventRing ring(256);
+	for (uint32_t i = 0; i < 100; i++) {
+		CHECK(ring.Push(KeyDown(i)) == i);
+	}
+
+	// Two readers over the same stream, one starting late; reading removes nothing.
+	uint64_t first = 0, second = 40;
+	input::Event event;
+	for (uint32_t i = 0; i < 100; i++) {
+		CHECK(ring.Next(first, event) && event.Sequence == i && event.Key == i);
+	}
+	CHECK(!ring.Next(first, event) && first == 100);
+	for (uint32_t i = 40; i < 100; i++) {
+		CHECK(ring.Next(second, event) && event.Key == i);
+	}
+	CHECK(!ring.Next(second, event));
+
+	ring.Push(KeyDown(100));
+	CHECK(ring.Next(first, event) && event.Key == 100);
+	CHECK(ring.Tail() == 0 && ring.Head() == 101);
+}
+
+TEST(OverflowDropsOldest) {
+	input::EventRing ring(5);
+	CHECK(ring.Capacity() == 8);
+	CHECK(input::EventRing(1).Capacity() == 2 && input::EventRing(1000).Capacity() == 1024);
+
+	for (uint32_t i = 0; i < 8; i++) {
+		ring.Push(KeyDown(i));
+	}
+	CHECK(ring.Tail() == 0 && ring.At(0) && ring.At(0)->Key == 0);
+
+	// Past capacity the oldest events are overwritten, never the pump stalled.
+	for (uint32_t i = 8; i < 20; i++) {
+		ring.Push(KeyDown(i));
+	}
+	CHECK(ring.Tail() == 12 && ring.Head() == 20);
+	CHECK(ring.At(11) == nullptr && ring.At(12) && ring.At(12)->Key == 12 && ring.At(20) == nullptr);
+
+	uint64_t cursor = 3, lost = 0;
+	input::Event event;
+	CHECK(ring.Next(cursor, event, &lost) && event.Key == 12 && lost == 9);
+	for (uint32_t i = 13; i < 20; i++) {
+		CHECK(ring.Next(cursor, event, &lost) && event.Key == i);
+	}
+	CHECK(!ring.Next(cursor, event, &lost) && lost == 9);
+}
+
+TEST(PumpDrainsAtMostMaxPerFrame) {
+	std::deque<int> queue;
+	for (int i = 0; i < 3000; i++) {
+		queue.push_back(i);
+	}
+	auto peek = [&](int& message) {
+		if (queue.empty()) {
+			return false;
+		}
+		message = queue.front();
+		queue.pop_front();
+		return true;
+	};
+
+	input::EventRing ring;
+	auto push = [&](int& message) {
+		ring.Push(KeyDown(static_cast<uint32_t>(message)));
+		return true;
+	};
+
+	// Each frame takes the next MaxMessagesPerFrame messages, in order.
+	uint64_t cursor = 0;
+	uint32_t next = 0;
+	for (uint32_t expected : { input::MaxMessagesPerFrame, input::MaxMessagesPerFrame, 3000 - 2 * input::MaxMessagesPerFrame, 0u }) {
+		CHECK(input::PumpMessages<int>(peek, push) == expected);
+
+		input::Event event;
+		uint32_t read = 0;
+		while (ring.Next(cursor, event)) {
+			CHECK(event.Key == next++);
+			read++;
+		}
+		CHECK(read == expected);
+	}
+
+	// A handler that stops early leaves the rest queued.
+	queue = { 1, 2, -1, 3, 4 };
+	CHECK(input::PumpMessages<int>(peek, [](int& message) { return message >= 0; }) == 3);
+	CHECK(queue.size() == 2);
+
+	// A queue refilled as fast as it drains still ends the frame.
+	queue = { 0 };
+	CHECK(input::PumpMessages<int>(peek, [&](int& message) {
+		queue.push_back(message + 1);
+		return true;
+	}) == input::MaxMessagesPerFrame);
+	CHECK(queue.size() == 1 && queue.front() == static_cast<int>(input::MaxMessagesPerFrame));
+}
@@ -0,0 +1,99 @@
+#include "daybreak.h"
+#include "Test.h"
+
+#include "engine/manager/FPSCounter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <random>
+#include <thread>
+
+/*
+	Frame telemetry ring: percentiles over known samples, the window, hitch
+	counting, and copies taken while the game thread keeps recording (run
+	under -DDAYBREAK_SANITIZE=thread to check the ring against the writer).
+	The ring is process-wide, so each test starts from whatever the previous
+	one left and looks only at the frames it recorded.
+*/
+
+TEST(PercentilesOfKnownSamples) {
+	// 1..512 ms of CPU time in random order, steady 16 ms presents. Half the
+	// ring, so a full copy holds all of them (once the ring has wrapped, a copy
+	// leaves out the slot the writer may be rewriting).
+	const uint32_t count = FPSCounter::HistorySize / 2;
+	std::vector<float> cpu(count);
+	std::iota(cpu.begin(), cpu.end(), 1.0f);
+	std::shuffle(cpu.begin(), cpu.end(), std::mt19937(5));
+
+	FPSCounter::RecordGpuTime(0.0);
+	for (float ms : cpu) {
+		FPSCounter::RecordFrame(ms, 16.0);
+	}
+
+	// Percentile p is the value at index floor(p * n) of the sorted samples.
+	FPSCounter::FrameStatistics stats = FPSCounter::Statistics();
+	CHECK(stats.Frames == count && stats.Samples == count);
+	CHECK(stats.Cpu.P50 == 257.0f && stats.Cpu.P95 == 487.0f && stats.Cpu.P99 == 507.0f && stats.Cpu.Max == 512.0f);
+	CHECK(stats.Present.P50 == 16.0f && stats.Present.Max == 16.0f);
+	CHECK(stats.Gpu.P50 == 0.0f && stats.Gpu.Max == 0.0f);
+	CHECK(stats.Hitches == 0 && stats.TotalHitches == 0);
+
+	// The last 100 frames only, with a GPU time on every other one.
+	for (int i = 0; i < 100; i++) {
+		FPSCounter::RecordGpuTime(i % 2 ? 8.0 : 0.0);
+		FPSCounter::RecordFrame(2000.0 + i, 16.0);
+	}
+	stats = FPSCounter::Statistics(100);
+	CHECK(stats.Samples == 100);
+	CHECK(stats.Cpu.P50 == 2050.0f && stats.Cpu.P95 == 2095.0f && stats.Cpu.P99 == 2099.0f && stats.Cpu.Max == 2099.0f);
+	CHECK(stats.Gpu.P50 == 8.0f && stats.Gpu.Max == 8.0f);
+
+	// A present well over the running average is a hitch.
+	FPSCounter::RecordGpuTime(0.0);
+	FPSCounter::RecordPresentInterval(100.0);
+	FPSCounter::RecordFrame(1.0, 16.0);
+	stats = FPSCounter::Statistics(10);
+	CHECK(stats.Hitches == 1 && stats.TotalHitches == 1 && stats.Present.Max == 100.0f);
+
+	// Oldest first, one sample per frame.
+	std::vector<FPSCounter::FrameSample> samples(FPSCounter::HistorySize * 2);
+	size_t copied = FPSCounter::CopySamples(samples.data(), samples.size());
+	CHECK(copied == count + 101);
+	CHECK(samples[0].Frame == 0 && samples[copied - 1].Frame == count + 100 && samples[copied - 1].Hitch);
+	for (size_t i = 1; i < copied; i++) {
+		CHECK(samples[i].Frame == samples[i - 1].Frame + 1);
+	}
+}
+
+TEST(CopiesWhileWriterRecords) {
+	uint64_t start = FPSCounter::Statistics(1).Frames;
+	const uint64_t frames = 200000;
+	std::atomic<bool> done(false);
+
+	// Each frame's CPU time is its own index, so a sample mixing two frames shows.
+	std::thread writer([&] {
+		for (uint64_t i = 0; i < frames; i++) {
+			FPSCounter::RecordFrame(static_cast<double>(i), 16.0);
+		}
+		done.store(true, std::memory_order_release);
+	});
+
+	std::vector<FPSCounter::FrameSample> samples(FPSCounter::HistorySize);
+	uint64_t copies = 0, failures = 0;
+	while (!done.load(std::memory_order_acquire) || copies == 0) {
+		size_t copied = FPSCounter::CopySamples(samples.data(), samples.size());
+		for (size_t i = 0; i < copied; i++) {
+			const FPSCounter::FrameSample& sample = samples[i];
+			bool consecutive = i == 0 || sample.Frame == samples[i - 1].Frame + 1;
+			bool whole = sample.Frame < start || sample.CpuMs == static_cast<float>(sample.Frame - start);
+			failures += consecutive && whole ? 0 : 1;
+		}
+		FPSCounter::Statistics(256);
+		copies++;
+	}
+	writer.join();
+
+	CHECK(failures == 0);
+	CHECK(FPSCounter::Statistics(1).Frames == start + frames);
+}
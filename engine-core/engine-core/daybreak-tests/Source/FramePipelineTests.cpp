@@ -0,0 +1,91 @@
+#include "daybreak.h"
+#include "Test.h"
+
+#include "engine/FramePipeline.h"
+
+#include <atomic>
+#include <thread>
+
+/*
+	Game/render handoff: frames reach the render thread once each and in
+	order, a snapshot slot is never rewritten while it is being rendered, and
+	the pipeline shuts down cleanly with the render thread blocked waiting.
+*/
+
+using Daybreak::FramePipeline;
+
+TEST(HandsOffInOrder) {
+	const uint64_t frames = 5000;
+
+	// The game's double-buffered render state: each slot holds its frame number.
+	std::atomic<uint64_t> snapshots[FramePipeline::SnapshotCount] = {};
+	std::atomic<uint64_t> expected(0);
+	std::atomic<uint64_t> failures(0);
+
+	{
+		FramePipeline pipeline([&](const FramePipeline::Packet& packet) {
+			uint64_t frame = expected.load(std::memory_order_relaxed);
+			bool ok = packet.Frame == frame && packet.Snapshot == frame % FramePipeline::SnapshotCount &&
+				packet.Alpha == static_cast<double>(frame % 7) / 7.0 &&
+				snapshots[packet.Snapshot].load(std::memory_order_relaxed) == frame;
+
+			// Stall now and then so the game thread has to wait for the slot.
+			if (frame % 64 == 0) {
+				std::this_thread::sleep_for(std::chrono::microseconds(200));
+			}
+			ok = ok && snapshots[packet.Snapshot].load(std::memory_order_relaxed) == frame;
+
+			failures.fetch_add(ok ? 0 : 1, std::memory_order_relaxed);
+			expected.store(frame + 1, std::memory_order_relaxed);
+		});
+
+		for (uint64_t frame = 0; frame < frames; frame++) {
+			uint32_t slot = pipeline.BeginUpdate();
+			CHECK(slot == frame % FramePipeline::SnapshotCount);
+			snapshots[slot].store(frame, std::memory_order_relaxed);
+			pipeline.EndUpdate(static_cast<double>(frame % 7) / 7.0);
+		}
+
+		pipeline.Drain();
+		CHECK(pipeline.Stats().FramesRendered == frames);
+		CHECK(expected.load() == frames);
+	}
+	CHECK(failures.load() == 0);
+}
+
+TEST(ShutsDownWhileRenderThreadWaits) {
+	// Nothing ever published.
+	{
+		FramePipeline pipeline([](const FramePipeline::Packet&) {
+			CHECK(false);
+		});
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+
+	// Drained, so the render thread is blocked on the next frame.
+	std::atomic<uint64_t> rendered(0);
+	{
+		FramePipeline pipeline([&](const FramePipeline::Packet&) {
+			rendered.fetch_add(1, std::memory_order_relaxed);
+		});
+		for (int frame = 0; frame < 3; frame++) {
+			pipeline.BeginUpdate();
+			pipeline.EndUpdate();
+		}
+		pipeline.Drain();
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+	CHECK(rendered.load() == 3);
+
+	// Destroyed straight after a publish: the destructor renders it first.
+	rendered.store(0);
+	{
+		FramePipeline pipeline([&](const FramePipeline::Packet&) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+			rendered.fetch_add(1, std::memory_order_relaxed);
+		});
+		pipeline.BeginUpdate();
+		pipeline.EndUpdate();
+	}
+	CHECK(rendered.load() == 1);
+}
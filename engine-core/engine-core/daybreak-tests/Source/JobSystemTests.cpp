@@ -0,0 +1,118 @@
+#include "Test.h"
+
+#include "daybreak.h"
+#include "core/JobSystem.h"
+
+#include <cstring>
+
+/*
+	Job system scheduling and Counter lifetime. The lifetime cases are the
+	pattern every ParallelFor caller uses: a counter on the stack (or freshly
+	allocated) that is destroyed the moment Wait() returns. Build with
+	-DDAYBREAK_SANITIZE=address to have ASan check them as well.
+*/
+
+static const uint32_t WorkerCount = 3;
+
+struct JobSystemScope {
+	JobSystemScope() { jobs::JobSystem::Initialize(WorkerCount); }
+	~JobSystemScope() { jobs::JobSystem::Shutdown(); }
+};
+
+TEST(ParallelForVisitsEveryIndexOnce) {
+	JobSystemScope scope;
+	std::vector<std::atomic<uint32_t>> visits(100000);
+	for (size_t grain : { size_t(0), size_t(1), size_t(7), size_t(4096) }) {
+		for (auto& visit : visits) {
+			visit = 0;
+		}
+		jobs::JobSystem::ParallelFor(visits.size(), grain, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				visits[i].fetch_add(1, std::memory_order_relaxed);
+			}
+		});
+
+		bool once = true;
+		for (auto& visit : visits) {
+			once &= visit.load() == 1;
+		}
+		CHECK(once);
+	}
+}
+
+TEST(RunAfterStartsOnlyOnceDependencyDrains) {
+	JobSystemScope scope;
+	for (int round = 0; round < 200; round++) {
+		jobs::Counter first, second;
+		std::atomic<int> finished(0);
+		std::atomic<bool> orderViolated(false);
+
+		for (int i = 0; i < 16; i++) {
+			jobs::JobSystem::Run([&] { finished.fetch_add(1); }, &first);
+		}
+		jobs::JobSystem::RunAfter(first, [&] {
+			if (finished.load() != 16) {
+				orderViolated = true;
+			}
+		}, &second);
+
+		jobs::JobSystem::Wait(second);
+		CHECK(first.IsDone());
+		CHECK(!orderViolated.load());
+	}
+}
+
+/*
+	Destroys every counter right after Wait() and reuses its memory for a
+	canary. A Done() still inside the counter (the last job handing off its
+	continuations) would scribble over the canary or trip ASan.
+*/
+TEST(CounterDestroyedRightAfterWait) {
+	JobSystemScope scope;
+	static const int Rounds = 20000;
+	static const uint8_t Pattern = 0xA5;
+
+	std::vector<std::unique_ptr<uint8_t[]>> canaries;
+	int corrupted = 0;
+	for (int round = 0; round < Rounds; round++) {
+		auto counter = std::make_unique<jobs::Counter>();
+		jobs::Counter dependent;
+		int jobCount = 1 + round % 4;
+		for (int i = 0; i < jobCount; i++) {
+			jobs::JobSystem::Run([] {}, counter.get());
+		}
+		jobs::JobSystem::RunAfter(*counter, [] {}, &dependent);
+
+		jobs::JobSystem::Wait(*counter);
+		counter.reset();
+
+		std::unique_ptr<uint8_t[]> canary(new uint8_t[sizeof(jobs::Counter)]);
+		memset(canary.get(), Pattern, sizeof(jobs::Counter));
+		canaries.push_back(std::move(canary));
+
+		jobs::JobSystem::Wait(dependent);
+
+		if (canaries.size() == 256 || round + 1 == Rounds) {
+			// Give any straggling Done() time to land before checking.
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			for (const auto& bytes : canaries) {
+				for (size_t i = 0; i < sizeof(jobs::Counter); i++) {
+					corrupted += bytes[i] != Pattern;
+				}
+			}
+			canaries.clear();
+		}
+	}
+	CHECK(corrupted == 0);
+}
+
+TEST(ParallelForCountersOnTheStack) {
+	JobSystemScope scope;
+	std::atomic<uint64_t> sum(0);
+	for (int round = 0; round < 20000; round++) {
+		jobs::JobSystem::ParallelFor(8, 1, [&](size_t begin, size_t end) {
+			sum.fetch_add(end - begin, std::memory_order_relaxed);
+		});
+	}
+	CHECK(sum.load() == 8ull * 20000);
+}
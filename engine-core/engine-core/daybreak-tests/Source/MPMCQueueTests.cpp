@@ -0,0 +1,175 @@
+#include "Test.h"
+
+#include "common/MPMCQueue.h"
+
+#include <memory>
+#include <thread>
+
+/*
+	MPMCQueue: single-threaded semantics, value lifetime, and every value
+	delivered exactly once (in per-producer order) under contention.
+*/
+
+struct Tracked {
+	static std::atomic<int> Live;
+
+	Tracked() { Live++; }
+	Tracked(const Tracked&) { Live++; }
+	Tracked(Tracked&&) noexcept { Live++; }
+	Tracked& operator=(const Tracked&) = default;
+	Tracked& operator=(Tracked&&) noexcept = default;
+	~Tracked() { Live--; }
+};
+
+std::atomic<int> Tracked::Live = 0;
+
+TEST(FifoAndCapacity) {
+	collection::MPMCQueue<int> queue(5);
+	CHECK(queue.Capacity() == 8);
+	CHECK(queue.IsEmpty());
+
+	for (int i = 0; i < 8; i++) {
+		CHECK(queue.TryPush(std::move(i)));
+	}
+	int rejected = 8;
+	CHECK(!queue.TryPush(std::move(rejected)));
+	CHECK(queue.Size() == 8);
+
+	// Wrap around the ring a few times.
+	int next = 0, pushed = 8;
+	for (int lap = 0; lap < 5; lap++) {
+		int batch[3];
+		size_t count = queue.PopBatch(batch, 3);
+		CHECK(count == 3);
+		for (size_t i = 0; i < count; i++) {
+			CHECK(batch[i] == next++);
+		}
+		for (int i = 0; i < 3; i++) {
+			queue.Push(pushed++);
+		}
+	}
+
+	int value;
+	while (queue.Pop(value)) {
+		CHECK(value == next++);
+	}
+	CHECK(next == pushed);
+	CHECK(queue.IsEmpty());
+}
+
+TEST(FailedTryPushKeepsValue) {
+	collection::MPMCQueue<std::unique_ptr<int>> queue(2);
+	CHECK(queue.TryPush(std::make_unique<int>(1)));
+	CHECK(queue.TryPush(std::make_unique<int>(2)));
+
+	std::unique_ptr<int> value = std::make_unique<int>(3);
+	CHECK(!queue.TryPush(std::move(value)));
+	CHECK(value && *value == 3);
+}
+
+TEST(DestructorDestroysQueuedValues) {
+	{
+		collection::MPMCQueue<Tracked> queue(16);
+		for (int i = 0; i < 10; i++) {
+			queue.Push(Tracked());
+		}
+		Tracked popped;
+		CHECK(queue.Pop(popped));
+		CHECK(Tracked::Live == 10);
+	}
+	CHECK(Tracked::Live == 0);
+}
+
+/*
+	producers x consumers threads over a small queue so it runs full and empty
+	constantly. Values are (producer << 32 | sequence); a consumer must see
+	each producer's sequence increasing, and every value must arrive once.
+	Consumers alternate Pop and PopBatch; with blocking set they take exactly
+	their share with PopWait instead.
+*/
+static void Stress(uint32_t producers, uint32_t consumers, size_t capacity, uint64_t perProducer, bool blocking = false) {
+	collection::MPMCQueue<std::unique_ptr<uint64_t>> queue(capacity);
+	uint64_t total = producers * perProducer;
+
+	std::vector<std::atomic<uint8_t>> delivered(total);
+	std::atomic<uint64_t> received = 0;
+	std::atomic<bool> ordered = true, unique = true;
+
+	std::vector<std::thread> threads;
+	for (uint32_t producer = 0; producer < producers; producer++) {
+		threads.emplace_back([&, producer] {
+			for (uint64_t sequence = 0; sequence < perProducer; sequence++) {
+				queue.Push(std::make_unique<uint64_t>(static_cast<uint64_t>(producer) << 32 | sequence));
+			}
+		});
+	}
+
+	for (uint32_t consumer = 0; consumer < consumers; consumer++) {
+		threads.emplace_back([&, consumer] {
+			std::vector<int64_t> last(producers, -1);
+			auto take = [&](const std::unique_ptr<uint64_t>& value) {
+				uint32_t producer = static_cast<uint32_t>(*value >> 32);
+				int64_t sequence = static_cast<int64_t>(*value & 0xFFFFFFFF);
+				if (sequence <= last[producer]) {
+					ordered = false;
+				}
+				last[producer] = sequence;
+				if (delivered[producer * perProducer + sequence].fetch_add(1) != 0) {
+					unique = false;
+				}
+			};
+
+			std::unique_ptr<uint64_t> batch[8];
+			if (blocking) {
+				for (uint64_t i = 0; i < total / consumers; i++) {
+					queue.PopWait(batch[0]);
+					take(batch[0]);
+					batch[0].reset();
+				}
+				received += total / consumers;
+				return;
+			}
+
+			for (uint32_t round = consumer; received.load() < total; round++) {
+				size_t count = round % 2 ? queue.PopBatch(batch, 8) : (queue.Pop(batch[0]) ? 1 : 0);
+				for (size_t i = 0; i < count; i++) {
+					take(batch[i]);
+					batch[i].reset();
+				}
+				received += count;
+				if (count == 0) {
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+
+	CHECK(ordered);
+	CHECK(unique);
+	CHECK(received == total);
+	CHECK(queue.IsEmpty());
+}
+
+TEST(OneProducerOneConsumer) {
+	Stress(1, 1, 16, 200000);
+}
+
+TEST(ManyProducersManyConsumers) {
+	Stress(4, 4, 16, 50000);
+}
+
+TEST(ManyProducersOneConsumer) {
+	Stress(8, 1, 64, 25000);
+}
+
+TEST(OneProducerManyConsumers) {
+	Stress(1, 8, 4, 200000);
+}
+
+TEST(PopWaitConsumers) {
+	Stress(3, 4, 8, 40000, true);
+}
@@ -0,0 +1,139 @@
+#include "Test.h"
+
+#include "graphics/MeshOptimize.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+
+/*
+	Import-time index and vertex reordering: the cache model on known inputs,
+	that the passes keep every triangle and its winding, the cache improvement
+	on a scrambled mesh, and first-use vertex order.
+*/
+
+struct IdVertex {
+	float		Position[3];
+	uint32_t	Id;			// Index in the source mesh, to follow vertices through the remap.
+};
+
+struct IdMesh {
+	std::vector<IdVertex>	Vertices;
+	std::vector<uint32_t>	Indices;
+};
+
+// A size x size quad grid, rippled so the overdraw pass has normals to sort.
+static IdMesh Grid(uint32_t size) {
+	IdMesh mesh;
+	for (uint32_t y = 0; y <= size; y++) {
+		for (uint32_t x = 0; x <= size; x++) {
+			float u = static_cast<float>(x) / size, v = static_cast<float>(y) / size;
+			mesh.Vertices.push_back({ { u, v, 0.05f * std::sin(u * 17.0f) * std::cos(v * 13.0f) }, static_cast<uint32_t>(mesh.Vertices.size()) });
+		}
+	}
+	for (uint32_t y = 0; y < size; y++) {
+		for (uint32_t x = 0; x < size; x++) {
+			uint32_t a = y * (size + 1) + x, b = a + 1, c = a + size + 1, d = c + 1;
+			mesh.Indices.insert(mesh.Indices.end(), { a, c, b, b, c, d });
+		}
+	}
+	return mesh;
+}
+
+// Triangles in random order, the worst case an exporter can hand over.
+static void ShuffleTriangles(IdMesh& mesh, uint32_t seed) {
+	std::vector<std::array<uint32_t, 3>> triangles;
+	for (size_t i = 0; i < mesh.Indices.size(); i += 3) {
+		triangles.push_back({ mesh.Indices[i], mesh.Indices[i + 1], mesh.Indices[i + 2] });
+	}
+	std::shuffle(triangles.begin(), triangles.end(), std::mt19937(seed));
+	mesh.Indices.clear();
+	for (const auto& triangle : triangles) {
+		mesh.Indices.insert(mesh.Indices.end(), triangle.begin(), triangle.end());
+	}
+}
+
+// Every triangle as source vertex ids, rotated to start at the smallest so
+// winding is kept but the starting corner does not matter.
+static std::vector<std::array<uint32_t, 3>> Triangles(const IdMesh& mesh) {
+	std::vector<std::array<uint32_t, 3>> triangles;
+	for (size_t i = 0; i < mesh.Indices.size(); i += 3) {
+		std::array<uint32_t, 3> triangle = { mesh.Vertices[mesh.Indices[i]].Id, mesh.Vertices[mesh.Indices[i + 1]].Id, mesh.Vertices[mesh.Indices[i + 2]].Id };
+		std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+		triangles.push_back(triangle);
+	}
+	std::sort(triangles.begin(), triangles.end());
+	return triangles;
+}
+
+TEST(CacheModelKnownCases) {
+	uint32_t triangle[] = { 0, 1, 2 };
+	meshops::CacheStats single = meshops::AnalyzeVertexCache(triangle, 3, 3);
+	CHECK(single.ACMR == 3.0f && single.ATVR == 1.0f);
+
+	uint32_t twice[] = { 0, 1, 2, 2, 1, 0 };
+	CHECK(meshops::AnalyzeVertexCache(twice, 6, 3).ACMR == 1.5f);
+
+	// With a 3-entry FIFO, the fourth vertex evicts the first.
+	uint32_t evicted[] = { 0, 1, 2, 3, 4, 5, 0, 1, 2 };
+	CHECK(meshops::AnalyzeVertexCache(evicted, 9, 6, 3).ACMR == 3.0f);
+	CHECK(meshops::AnalyzeVertexCache(evicted, 9, 6, 6).ACMR == 2.0f);
+}
+
+TEST(KeepsTrianglesAndWinding) {
+	for (uint32_t seed : { 1u, 2u, 3u }) {
+		IdMesh mesh = Grid(64);
+		ShuffleTriangles(mesh, seed);
+		auto before = Triangles(mesh);
+
+		meshops::OptimizeMesh(mesh.Vertices, mesh.Indices);
+		CHECK(mesh.Vertices.size() == 65 * 65);
+		CHECK(Triangles(mesh) == before);
+	}
+}
+
+TEST(ImprovesCacheOnShuffledMesh) {
+	IdMesh mesh = Grid(128);
+	ShuffleTriangles(mesh, 7);
+
+	meshops::OptimizeReport report = meshops::OptimizeMesh(mesh.Vertices, mesh.Indices);
+	CHECK(report.Triangles == 128 * 128 * 2);
+	CHECK(report.Vertices == 129 * 129);
+	CHECK(report.Before.ACMR > 2.0f);
+
+	// A regular grid's ideal is 0.5 misses per triangle; Tipsify with a 16
+	// entry FIFO lands well under 1 even after the overdraw pass splits runs.
+	CHECK(report.After.ACMR < 0.9f);
+	CHECK(report.After.ATVR >= 1.0f && report.After.ATVR < 1.8f);
+
+	meshops::CacheStats measured = meshops::AnalyzeVertexCache(mesh.Indices.data(), mesh.Indices.size(), mesh.Vertices.size());
+	CHECK(measured.ACMR == report.After.ACMR);
+}
+
+TEST(VertexFetchIsFirstUseOrder) {
+	IdMesh mesh = Grid(32);
+	ShuffleTriangles(mesh, 11);
+	meshops::OptimizeMesh(mesh.Vertices, mesh.Indices);
+
+	uint32_t next = 0;
+	for (uint32_t index : mesh.Indices) {
+		CHECK(index <= next);
+		if (index == next) {
+			next++;
+		}
+	}
+	CHECK(next == mesh.Vertices.size());
+}
+
+TEST(DropsUnreferencedVertices) {
+	std::vector<IdVertex> vertices = {
+		{ { 0, 0, 0 }, 0 }, { { 9, 9, 9 }, 1 }, { { 1, 0, 0 }, 2 }, { { 0, 1, 0 }, 3 }
+	};
+	std::vector<uint32_t> indices = { 0, 2, 3 };
+	meshops::OptimizeMesh(vertices, indices);
+
+	CHECK(vertices.size() == 3);
+	CHECK(indices[0] == 0 && indices[1] == 1 && indices[2] == 2);
+	CHECK(vertices[0].Id == 0 && vertices[1].Id == 2 && vertices[2].Id == 3);
+}
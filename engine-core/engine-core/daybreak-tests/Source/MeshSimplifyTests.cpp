@@ -0,0 +1,207 @@
+#include "Test.h"
+
+#include "graphics/MeshSimplify.h"
+
+#include <chrono>
+#include <cmath>
+#include <random>
+
+/*
+	LOD generation on synthetic surfaces: reduction per level, the reported
+	error against the measured distance to the original surface, and run time
+	on flat regions (where every collapse costs zero).
+*/
+
+struct SurfaceMesh {
+	std::vector<float>		Positions;	// xyz
+	std::vector<float>		UVs;
+	std::vector<uint32_t>	Indices;
+
+	size_t VertexCount() const { return Positions.size() / 3; }
+	const float* Position(uint32_t vertex) const { return &Positions[vertex * 3]; }
+};
+
+// Grid over (u, v) in [0, 1]; the last row/column duplicates the first when
+// wrapped, which makes a UV seam the simplifier has to weld.
+template<typename Function>
+static SurfaceMesh Surface(int columns, int rows, Function function) {
+	SurfaceMesh mesh;
+	for (int row = 0; row <= rows; row++) {
+		for (int column = 0; column <= columns; column++) {
+			float u = static_cast<float>(column) / columns, v = static_cast<float>(row) / rows;
+			float position[3];
+			function(u, v, position);
+			mesh.Positions.insert(mesh.Positions.end(), position, position + 3);
+			mesh.UVs.insert(mesh.UVs.end(), { u, v });
+		}
+	}
+	for (int row = 0; row < rows; row++) {
+		for (int column = 0; column < columns; column++) {
+			uint32_t a = row * (columns + 1) + column, b = a + 1, c = a + columns + 1, d = c + 1;
+			mesh.Indices.insert(mesh.Indices.end(), { a, c, b, b, c, d });
+		}
+	}
+	return mesh;
+}
+
+static SurfaceMesh FlatGrid(int size) {
+	return Surface(size, size, [](float u, float v, float* p) { p[0] = u; p[1] = v; p[2] = 0.0f; });
+}
+
+static SurfaceMesh BumpySphere(int columns, int rows) {
+	return Surface(columns, rows, [](float u, float v, float* p) {
+		const float Pi = 3.14159265f;
+		float azimuth = u * 2.0f * Pi, polar = v * Pi;
+		float radius = 1.5f + 0.35f * std::sin(7.0f * azimuth) * std::sin(6.0f * polar);
+		p[0] = radius * std::sin(polar) * std::cos(azimuth);
+		p[1] = radius * std::cos(polar);
+		p[2] = radius * std::sin(polar) * std::sin(azimuth);
+	});
+}
+
+static std::vector<meshops::LodLevel> Simplify(const SurfaceMesh& mesh) {
+	return meshops::GenerateLods(mesh.Positions.data(), sizeof(float) * 3, mesh.UVs.data(), sizeof(float) * 2, mesh.VertexCount(), mesh.Indices.data(), mesh.Indices.size());
+}
+
+static double PointTriangleDistance(const float* p, const float* a, const float* b, const float* c) {
+	// Closest point on a triangle (Ericson, Real-Time Collision Detection 5.1.5).
+	double ab[3], ac[3], ap[3], bp[3], cp[3];
+	for (int i = 0; i < 3; i++) {
+		ab[i] = b[i] - a[i];
+		ac[i] = c[i] - a[i];
+		ap[i] = p[i] - a[i];
+		bp[i] = p[i] - b[i];
+		cp[i] = p[i] - c[i];
+	}
+	auto dot = [](const double* x, const double* y) { return x[0] * y[0] + x[1] * y[1] + x[2] * y[2]; };
+	auto distanceTo = [&](double s, double t) {
+		double d[3];
+		for (int i = 0; i < 3; i++) {
+			d[i] = p[i] - (a[i] + s * ab[i] + t * ac[i]);
+		}
+		return std::sqrt(dot(d, d));
+	};
+
+	double d1 = dot(ab, ap), d2 = dot(ac, ap);
+	if (d1 <= 0 && d2 <= 0) return distanceTo(0, 0);
+	double d3 = dot(ab, bp), d4 = dot(ac, bp);
+	if (d3 >= 0 && d4 <= d3) return distanceTo(1, 0);
+	double vc = d1 * d4 - d3 * d2;
+	if (vc <= 0 && d1 >= 0 && d3 <= 0) return distanceTo(d1 / (d1 - d3), 0);
+	double d5 = dot(ab, cp), d6 = dot(ac, cp);
+	if (d6 >= 0 && d5 <= d6) return distanceTo(0, 1);
+	double vb = d5 * d2 - d1 * d6;
+	if (vb <= 0 && d2 >= 0 && d6 <= 0) return distanceTo(0, d2 / (d2 - d6));
+	double va = d3 * d6 - d5 * d4;
+	if (va <= 0 && d4 - d3 >= 0 && d5 - d6 >= 0) {
+		double w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+		return distanceTo(1 - w, w);
+	}
+	double denominator = 1.0 / (va + vb + vc);
+	return distanceTo(vb * denominator, vc * denominator);
+}
+
+static double SurfaceDistance(const SurfaceMesh& mesh, const std::vector<uint32_t>& indices, const float* point) {
+	double best = 1e30;
+	for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+		best = std::min(best, PointTriangleDistance(point, mesh.Position(indices[t]), mesh.Position(indices[t + 1]), mesh.Position(indices[t + 2])));
+	}
+	return best;
+}
+
+static double Area(const SurfaceMesh& mesh, const std::vector<uint32_t>& indices) {
+	double area = 0.0;
+	for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+		const float* a = mesh.Position(indices[t]);
+		const float* b = mesh.Position(indices[t + 1]);
+		const float* c = mesh.Position(indices[t + 2]);
+		double ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] }, ac[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+		double cross[3] = { ab[1] * ac[2] - ab[2] * ac[1], ab[2] * ac[0] - ab[0] * ac[2], ab[0] * ac[1] - ab[1] * ac[0] };
+		area += 0.5 * std::sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+	}
+	return area;
+}
+
+static void CheckLevels(const SurfaceMesh& mesh, const std::vector<meshops::LodLevel>& levels) {
+	CHECK(levels.size() == meshops::MaxLodCount - 1);
+
+	size_t previous = mesh.Indices.size() / 3;
+	float previousError = 0.0f;
+	for (const meshops::LodLevel& level : levels) {
+		size_t triangles = level.Indices.size() / 3;
+		CHECK(level.Indices.size() % 3 == 0);
+		CHECK(triangles <= previous / 2 + 1 && triangles >= previous * 4 / 10);
+		CHECK(level.Error >= previousError);
+
+		bool valid = true;
+		for (size_t t = 0; t + 2 < level.Indices.size(); t += 3) {
+			uint32_t a = level.Indices[t], b = level.Indices[t + 1], c = level.Indices[t + 2];
+			valid &= a < mesh.VertexCount() && b < mesh.VertexCount() && c < mesh.VertexCount() && a != b && b != c && a != c;
+		}
+		CHECK(valid);
+
+		previous = triangles;
+		previousError = level.Error;
+	}
+}
+
+TEST(BumpySphereErrorBoundsMeasuredDistance) {
+	SurfaceMesh mesh = BumpySphere(200, 100);
+	std::vector<meshops::LodLevel> levels = Simplify(mesh);
+	CheckLevels(mesh, levels);
+
+	// Sampled both ways: original vertices to the level, and level triangle
+	// centres back to the original surface.
+	std::mt19937 random(1);
+	for (const meshops::LodLevel& level : levels) {
+		double measured = 0.0;
+		for (int sample = 0; sample < 200; sample++) {
+			uint32_t vertex = mesh.Indices[random() % mesh.Indices.size()];
+			measured = std::max(measured, SurfaceDistance(mesh, level.Indices, mesh.Position(vertex)));
+
+			size_t t = (random() % (level.Indices.size() / 3)) * 3;
+			float centre[3];
+			for (int axis = 0; axis < 3; axis++) {
+				centre[axis] = (mesh.Position(level.Indices[t])[axis] + mesh.Position(level.Indices[t + 1])[axis] + mesh.Position(level.Indices[t + 2])[axis]) / 3.0f;
+			}
+			measured = std::max(measured, SurfaceDistance(mesh, mesh.Indices, centre));
+		}
+		printf("  %5.1f%% of triangles: error %.4f, measured %.4f\n", 100.0 * level.Indices.size() / mesh.Indices.size(), level.Error, measured);
+		CHECK(measured <= level.Error);
+		CHECK(level.Error < 0.2f);
+	}
+}
+
+TEST(FlatGridKeepsItsBorder) {
+	SurfaceMesh mesh = FlatGrid(100);
+	std::vector<meshops::LodLevel> levels = Simplify(mesh);
+	CheckLevels(mesh, levels);
+	for (const meshops::LodLevel& level : levels) {
+		CHECK(level.Error == 0.0f);
+		CHECK(std::fabs(Area(mesh, level.Indices) - 1.0) < 1e-4);
+	}
+}
+
+/*
+	Flat regions used to funnel every zero-cost collapse into one vertex and
+	go quadratic (80k triangles took close to a minute). Run time must now
+	grow roughly linearly: 4x the triangles may cost at most 8x the time.
+*/
+TEST(FlatGridScalesLinearly) {
+	auto time = [](int size) {
+		SurfaceMesh mesh = FlatGrid(size);
+		auto start = std::chrono::steady_clock::now();
+		std::vector<meshops::LodLevel> levels = Simplify(mesh);
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		CHECK(levels.size() == meshops::MaxLodCount - 1);
+		printf("  %zu triangles: %.1f ms\n", mesh.Indices.size() / 3, ms);
+		return ms;
+	};
+
+	double small = time(100);
+	double large = time(200);
+	double larger = time(400);
+	CHECK(large < small * 8.0 + 5.0);
+	CHECK(larger < large * 8.0 + 5.0);
+	CHECK(larger < 5000.0);
+}
@@ -0,0 +1,205 @@
+#include "Test.h"
+
+#include "graphics/BakedMesh.h"
+#include "graphics/MeshSplit.h"
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <sstream>
+
+/*
+	Meshes past the 16-bit index limit: splitting them into clusters that fit
+	(every triangle kept, in order), and the 32-bit index choice bmesh::Write
+	makes for meshes that are not split. Also the packed vertex layouts a
+	.bmesh can be baked in.
+*/
+
+// columns x rows quads; 1100 x 1000 gives 1.1M vertices and 2.2M triangles.
+static std::vector<uint32_t> GridIndices(uint32_t columns, uint32_t rows) {
+	std::vector<uint32_t> indices;
+	indices.reserve(static_cast<size_t>(columns) * rows * 6);
+	for (uint32_t row = 0; row < rows; row++) {
+		for (uint32_t column = 0; column < columns; column++) {
+			uint32_t a = row * (columns + 1) + column, b = a + 1, c = a + columns + 1, d = c + 1;
+			indices.insert(indices.end(), { a, c, b, b, c, d });
+		}
+	}
+	return indices;
+}
+
+// View needs the image on an Alignment boundary, as a mapping would be.
+static bool OpenImage(const std::string& file, std::unique_ptr<uint8_t[]>& storage, bmesh::View& view) {
+	storage.reset(new uint8_t[file.size() + bmesh::Alignment]);
+	uint8_t* image = storage.get() + (bmesh::Alignment - reinterpret_cast<uintptr_t>(storage.get()) % bmesh::Alignment) % bmesh::Alignment;
+	std::copy(file.begin(), file.end(), image);
+	return view.Open(image, file.size());
+}
+
+static void CheckSplit(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t maxVertices) {
+	std::vector<meshops::Cluster> clusters = meshops::SplitForShortIndices(indices.data(), indices.size(), vertexCount, maxVertices);
+	CHECK(!clusters.empty());
+
+	// Mapping every cluster's triangles back to source vertices must give the
+	// source index list back exactly.
+	size_t next = 0;
+	bool fits = true, inRange = true, preserved = true;
+	std::vector<bool> seen(vertexCount, false);
+	for (const meshops::Cluster& cluster : clusters) {
+		fits &= cluster.Vertices.size() <= maxVertices && !cluster.Indices.empty() && cluster.Indices.size() % 3 == 0;
+		for (uint16_t index : cluster.Indices) {
+			if (index >= cluster.Vertices.size()) {
+				inRange = false;
+				continue;
+			}
+			uint32_t vertex = cluster.Vertices[index];
+			preserved &= next < indices.size() && indices[next] == vertex;
+			seen[vertex] = true;
+			next++;
+		}
+	}
+	CHECK(fits);
+	CHECK(inRange);
+	CHECK(preserved);
+	CHECK(next == indices.size());
+	CHECK(std::find(seen.begin(), seen.end(), false) == seen.end());
+
+	printf("  %zu vertices, %zu triangles: %zu clusters of at most %u vertices\n", vertexCount, indices.size() / 3, clusters.size(), maxVertices);
+}
+
+TEST(SplitGridIntoShortIndexClusters) {
+	std::vector<uint32_t> indices = GridIndices(1100, 1000);
+	size_t vertexCount = 1101 * 1001;
+	CHECK(meshops::NeedsLongIndices(vertexCount));
+	CheckSplit(indices, vertexCount, meshops::MaxShortIndexVertices);
+}
+
+// No locality at all: every triangle brings up to three new vertices.
+TEST(SplitShuffledTriangles) {
+	std::vector<uint32_t> indices = GridIndices(1100, 1000);
+	size_t vertexCount = 1101 * 1001;
+
+	std::mt19937 random(7);
+	for (size_t triangle = indices.size() / 3 - 1; triangle > 0; triangle--) {
+		size_t other = random() % (triangle + 1);
+		std::swap_ranges(indices.begin() + triangle * 3, indices.begin() + triangle * 3 + 3, indices.begin() + other * 3);
+	}
+	CheckSplit(indices, vertexCount, meshops::MaxShortIndexVertices);
+}
+
+TEST(SplitWithTightVertexLimit) {
+	std::vector<uint32_t> indices = GridIndices(40, 40);
+	CheckSplit(indices, 41 * 41, 3);
+	CheckSplit(indices, 41 * 41, 100);
+}
+
+TEST(LongIndicesPastShortLimit) {
+	CHECK(!meshops::NeedsLongIndices(0));
+	CHECK(!meshops::NeedsLongIndices(meshops::MaxShortIndexVertices));
+	CHECK(meshops::NeedsLongIndices(meshops::MaxShortIndexVertices + 1));
+	CHECK(meshops::NeedsLongIndices(1101 * 1001));
+}
+
+/*
+	A mesh that stays whole is written with 32-bit indices only when it needs
+	them, and those indices must survive the round trip unclipped.
+*/
+TEST(BakedMeshPicksIndexWidth) {
+	std::vector<bmesh::MeshData> meshes(2);
+
+	meshes[0].Vertices.resize(meshops::MaxShortIndexVertices);
+	meshes[0].Indices = { 0, 1, meshops::MaxShortIndexVertices - 1 };
+	meshes[0].Material = 0;
+
+	meshes[1].Vertices.resize(1101 * 1001);
+	meshes[1].Indices = GridIndices(1100, 1000);
+	meshes[1].Material = 1;
+	for (size_t i = 0; i < meshes[1].Vertices.size(); i++) {
+		meshes[1].Vertices[i] = {};
+		meshes[1].Vertices[i].Position[0] = static_cast<float>(i);
+	}
+
+	std::ostringstream out;
+	CHECK(bmesh::Write(out, meshes));
+
+	std::unique_ptr<uint8_t[]> storage;
+	bmesh::View view;
+	CHECK(OpenImage(out.str(), storage, view));
+	if (!view.IsOpen()) {
+		return;
+	}
+	CHECK(view.MeshCount() == 2);
+
+	const bmesh::MeshRecord& small = view.Mesh(0);
+	CHECK(small.IndexSize == sizeof(uint16_t));
+	const uint16_t* shortIndices = static_cast<const uint16_t*>(view.Indices(small));
+	CHECK(shortIndices[2] == meshops::MaxShortIndexVertices - 1);
+
+	const bmesh::MeshRecord& large = view.Mesh(1);
+	CHECK(large.IndexSize == sizeof(uint32_t));
+	CHECK(large.VertexCount == meshes[1].Vertices.size() && large.IndexCount == meshes[1].Indices.size());
+	const uint32_t* longIndices = static_cast<const uint32_t*>(view.Indices(large));
+	CHECK(std::equal(meshes[1].Indices.begin(), meshes[1].Indices.end(), longIndices));
+	CHECK(static_cast<const bmesh::Vertex*>(view.Vertices(large))[1101 * 1001 - 1].Position[0] == static_cast<float>(1101 * 1001 - 1));
+}
+
+/*
+	Baked in a packed layout, the vertex blobs hold exactly what the load path
+	would upload, and each mesh carries the transform its positions decode with.
+*/
+TEST(BakedMeshStoresPackedLayout) {
+	std::vector<bmesh::MeshData> meshes(2);
+	std::mt19937 random(3);
+	std::uniform_real_distribution<float> coordinate(-5.0f, 5.0f);
+	for (size_t i = 0; i < meshes.size(); i++) {
+		meshes[i].Vertices.resize(300);
+		for (bmesh::Vertex& vertex : meshes[i].Vertices) {
+			vertex = {};
+			for (int axis = 0; axis < 3; axis++) {
+				vertex.Position[axis] = coordinate(random) * static_cast<float>(i + 1);
+			}
+			vertex.Normal[1] = 1.0f;
+			vertex.Tangent[0] = 1.0f;
+			vertex.UV[0] = vertex.Position[0];
+			vertex.UV[1] = vertex.Position[1];
+		}
+		meshes[i].Indices = { 0, 1, 2 };
+		meshes[i].Material = static_cast<uint32_t>(i);
+	}
+
+	for (bmesh::Layout layout : { bmesh::Layout::Packed, bmesh::Layout::PackedQuantized }) {
+		std::ostringstream out;
+		CHECK(bmesh::Write(out, meshes, layout));
+
+		std::unique_ptr<uint8_t[]> storage;
+		bmesh::View view;
+		CHECK(OpenImage(out.str(), storage, view));
+		if (!view.IsOpen()) {
+			continue;
+		}
+		CHECK(view.VertexLayout() == layout && view.VertexStride() == bmesh::StrideOf(layout));
+
+		std::vector<uint8_t> expected;
+		for (uint32_t i = 0; i < view.MeshCount(); i++) {
+			const bmesh::MeshRecord& mesh = view.Mesh(i);
+			meshops::PositionTransform transform = layout == bmesh::Layout::PackedQuantized ?
+				meshops::QuantizationFor(mesh.Bounds.Min, mesh.Bounds.Max) : meshops::IdentityTransform();
+			CHECK(memcmp(&mesh.Position, &transform, sizeof(transform)) == 0);
+
+			bmesh::PackVertices(meshes[i].Vertices, layout, transform, expected);
+			CHECK(mesh.VertexCount == meshes[i].Vertices.size());
+			CHECK(memcmp(view.Vertices(mesh), expected.data(), expected.size()) == 0);
+
+			if (layout == bmesh::Layout::PackedQuantized) {
+				const meshops::PackedVertex* packed = static_cast<const meshops::PackedVertex*>(view.Vertices(mesh));
+				for (uint32_t v = 0; v < mesh.VertexCount; v++) {
+					float position[3];
+					meshops::DequantizePosition(packed[v].Position, mesh.Position, position);
+					for (int axis = 0; axis < 3; axis++) {
+						CHECK(std::fabs(position[axis] - meshes[i].Vertices[v].Position[axis]) <= mesh.Position.Scale[axis] / 65535.0f);
+					}
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,141 @@
+#include "daybreak.h"
+#include "Test.h"
+
+#include "common/OffsetAllocator.h"
+
+#include <random>
+
+/*
+	memory::OffsetAllocator, the free list behind the descriptor heap pages:
+	split and merge, the exact-fit fallback, node exhaustion, and a randomized
+	run checked against a byte-ownership model.
+*/
+
+using memory::OffsetAllocator;
+
+TEST(SplitsAndMergesBack) {
+	OffsetAllocator allocator(1024);
+	OffsetAllocator::Allocation a = allocator.Allocate(100);
+	OffsetAllocator::Allocation b = allocator.Allocate(200);
+	OffsetAllocator::Allocation c = allocator.Allocate(300);
+	CHECK(a.IsValid() && b.IsValid() && c.IsValid());
+	CHECK(a.Offset == 0 && b.Offset == 100 && c.Offset == 300);
+	CHECK(allocator.FreeSize() == 1024 - 600);
+
+	// Freed out of order; the neighbours merge into one block again.
+	allocator.Free(b);
+	allocator.Free(a);
+	allocator.Free(c);
+	CHECK(allocator.FreeSize() == 1024);
+
+	OffsetAllocator::Allocation all = allocator.Allocate(1024);
+	CHECK(all.IsValid() && all.Offset == 0);
+	CHECK(!allocator.CanAllocate(1));
+}
+
+// 1000 is not a bin boundary, so only the exact-fit check can hand out the
+// whole page.
+TEST(ExactSizeOfOnlyBlockFits) {
+	OffsetAllocator allocator(1000);
+	CHECK(allocator.CanAllocate(1000));
+	CHECK(!allocator.CanAllocate(1001));
+
+	OffsetAllocator::Allocation all = allocator.Allocate(1000);
+	CHECK(all.IsValid() && all.Offset == 0);
+	CHECK(allocator.FreeSize() == 0);
+}
+
+// 960 and 1000 file into the same bin. Whichever order they are freed in,
+// the larger one stays at the head where the exact-fit check looks.
+TEST(ExactFitSeesLargestBlockInBin) {
+	for (bool largerFirst : { true, false }) {
+		OffsetAllocator allocator(1000 + 1 + 960 + 1);
+		OffsetAllocator::Allocation large = allocator.Allocate(1000);
+		OffsetAllocator::Allocation fence0 = allocator.Allocate(1);
+		OffsetAllocator::Allocation small = allocator.Allocate(960);
+		OffsetAllocator::Allocation fence1 = allocator.Allocate(1);
+		CHECK(fence0.IsValid() && fence1.IsValid());
+
+		if (largerFirst) {
+			allocator.Free(large);
+			allocator.Free(small);
+		} else {
+			allocator.Free(small);
+			allocator.Free(large);
+		}
+
+		OffsetAllocator::Allocation again = allocator.Allocate(1000);
+		CHECK(again.IsValid() && again.Offset == 0);
+	}
+}
+
+TEST(RunsOutOfNodes) {
+	OffsetAllocator allocator(1024, 4);
+	OffsetAllocator::Allocation a = allocator.Allocate(1);
+	OffsetAllocator::Allocation b = allocator.Allocate(1);
+	OffsetAllocator::Allocation c = allocator.Allocate(1);
+	CHECK(a.IsValid() && b.IsValid() && c.IsValid());
+
+	// The fourth node holds the free remainder, so nothing is left to split
+	// with.
+	CHECK(!allocator.CanAllocate(1));
+	CHECK(!allocator.Allocate(1).IsValid());
+
+	// Freeing c merges it into the remainder, which gives a node back.
+	allocator.Free(c);
+	CHECK(allocator.Allocate(1).IsValid());
+}
+
+TEST(RandomizedAgainstOwnershipModel) {
+	const uint32_t Size = 1 << 20;
+	OffsetAllocator allocator(Size, 4096);
+
+	struct Live {
+		OffsetAllocator::Allocation	Allocation;
+		uint32_t					Size;
+	};
+	std::vector<Live> live;
+	std::vector<uint32_t> owner(Size, 0);
+	uint32_t nextId = 1;
+	uint32_t usedBytes = 0;
+	std::mt19937 random(7);
+
+	for (int step = 0; step < 200000; step++) {
+		bool allocate = live.empty() || (live.size() < 2000 && random() % 2 == 0);
+		if (allocate) {
+			// Mostly small, now and then large, like descriptor ranges.
+			uint32_t size = random() % 8 == 0 ? 1 + random() % 16384 : 1 + random() % 64;
+			OffsetAllocator::Allocation allocation = allocator.Allocate(size);
+			if (!allocation.IsValid()) {
+				continue;
+			}
+
+			CHECK(allocation.Offset + size <= Size);
+			uint32_t id = nextId++;
+			for (uint32_t i = 0; i < size; i++) {
+				CHECK(owner[allocation.Offset + i] == 0);
+				owner[allocation.Offset + i] = id;
+			}
+			live.push_back({ allocation, size });
+			usedBytes += size;
+		} else {
+			size_t index = random() % live.size();
+			Live freed = live[index];
+			live[index] = live.back();
+			live.pop_back();
+
+			for (uint32_t i = 0; i < freed.Size; i++) {
+				owner[freed.Allocation.Offset + i] = 0;
+			}
+			allocator.Free(freed.Allocation);
+			usedBytes -= freed.Size;
+		}
+		CHECK(allocator.FreeSize() == Size - usedBytes);
+	}
+
+	for (const Live& remaining : live) {
+		allocator.Free(remaining.Allocation);
+	}
+	CHECK(allocator.FreeSize() == Size);
+	CHECK(allocator.Allocate(Size).IsValid());
+}
@@ -0,0 +1,241 @@
+#include "daybreak.h"
+#include "Test.h"
+
+#include "common/BuddyAllocator.h"
+#include "common/PlacementAllocator.h"
+
+#include <map>
+#include <random>
+
+/*
+	memory::PlacementAllocator, the placement policy behind dx12::GpuAllocator,
+	and the BuddyAllocator under it: pool size classes, the 64KB/4MB alignment
+	rules, category separation, dedicated fallbacks, page recycling and a
+	randomized run checked for overlaps.
+*/
+
+using memory::BuddyAllocator;
+using memory::PlacementAllocator;
+
+static const uint64_t KB = 1024;
+static const uint64_t MB = 1024 * KB;
+
+TEST(BuddySplitsAndMerges) {
+	BuddyAllocator buddy(1 * MB, 64 * KB);
+	uint64_t a = buddy.Allocate(64 * KB);
+	uint64_t b = buddy.Allocate(128 * KB);
+	uint64_t c = buddy.Allocate(1);
+	CHECK(a == 0 && b == 128 * KB && c == 64 * KB);
+	CHECK(buddy.FreeSize() == 1 * MB - 256 * KB);
+	CHECK(buddy.BlockSize(100 * KB) == 128 * KB);
+
+	buddy.Free(c);
+	buddy.Free(a);
+	buddy.Free(b);
+	CHECK(buddy.IsEmpty());
+	CHECK(buddy.LargestFreeBlock() == 1 * MB);
+	CHECK(buddy.Allocate(1 * MB) == 0);
+	CHECK(buddy.Allocate(1) == BuddyAllocator::NoSpace);
+}
+
+TEST(BuddyRandomizedAgainstOwnershipModel) {
+	const uint64_t MinBlock = 64 * KB;
+	BuddyAllocator buddy(64 * MB, MinBlock);
+	std::vector<uint32_t> owner(64 * MB / MinBlock, 0);
+	std::vector<std::pair<uint64_t, uint64_t>> live;
+	std::mt19937 random(3);
+
+	for (uint32_t step = 1; step < 20000; step++) {
+		if (live.empty() || random() % 2 == 0) {
+			uint64_t size = (1 + random() % 64) * 16 * KB << (random() % 4);
+			uint64_t offset = buddy.Allocate(size);
+			if (offset == BuddyAllocator::NoSpace) {
+				continue;
+			}
+
+			uint64_t block = buddy.BlockSize(size);
+			CHECK(offset % block == 0 && offset + block <= buddy.Size());
+			for (uint64_t i = offset / MinBlock; i < (offset + block) / MinBlock; i++) {
+				CHECK(owner[i] == 0);
+				owner[i] = step;
+			}
+			live.push_back({ offset, block });
+		} else {
+			size_t index = random() % live.size();
+			auto [offset, block] = live[index];
+			live[index] = live.back();
+			live.pop_back();
+
+			for (uint64_t i = offset / MinBlock; i < (offset + block) / MinBlock; i++) {
+				owner[i] = 0;
+			}
+			buddy.Free(offset);
+		}
+	}
+
+	for (auto [offset, block] : live) {
+		buddy.Free(offset);
+	}
+	CHECK(buddy.IsEmpty());
+}
+
+TEST(SmallResourcesShareAPoolPage) {
+	PlacementAllocator allocator;
+	PlacementAllocator::Placement placements[4];
+	for (auto& placement : placements) {
+		placement = allocator.Allocate(40 * KB, 4 * KB, PlacementAllocator::Category::Buffer);
+		CHECK(placement.IsPlaced() && !placement.Dedicated);
+		CHECK(placement.Page == placements[0].Page && placement.Heap == placements[0].Heap);
+		CHECK(placement.Size == 64 * KB && placement.RequestedSize == 40 * KB);
+		CHECK(placement.Offset % (64 * KB) == 0);
+	}
+	CHECK(placements[1].Offset != placements[0].Offset);
+	CHECK(allocator.HeapCount() == 1 && allocator.Stats().PoolPages == 1);
+
+	// The page itself is a 4MB buddy block.
+	uint64_t pageOffset = placements[0].Offset - placements[0].Slot * placements[0].Size;
+	CHECK(pageOffset % (4 * MB) == 0);
+
+	PlacementAllocator::Statistics stats = allocator.Stats();
+	CHECK(stats.ReservedBytes == 4 * 64 * KB && stats.RequestedBytes == 4 * 40 * KB);
+}
+
+TEST(SizeClassesAndBuddyBlocks) {
+	PlacementAllocator allocator;
+	PlacementAllocator::Placement a = allocator.Allocate(100 * KB, 64 * KB, PlacementAllocator::Category::Texture);
+	CHECK(a.Page != PlacementAllocator::NoPage && a.Size == 128 * KB && a.Offset % (128 * KB) == 0);
+
+	PlacementAllocator::Placement b = allocator.Allocate(1 * MB, 64 * KB, PlacementAllocator::Category::Texture);
+	CHECK(b.Page != PlacementAllocator::NoPage && b.Size == 1 * MB);
+	CHECK(b.Page != a.Page);
+
+	// Past MaxPoolSize the request is a buddy block of its own.
+	PlacementAllocator::Placement c = allocator.Allocate(1 * MB + 1, 64 * KB, PlacementAllocator::Category::Texture);
+	CHECK(c.Page == PlacementAllocator::NoPage && c.Size == 2 * MB && c.Offset % (2 * MB) == 0);
+}
+
+// MSAA resources need 4MB alignment, which only a buddy block can give.
+TEST(MsaaAlignmentUsesBuddy) {
+	PlacementAllocator allocator;
+	PlacementAllocator::Placement small = allocator.Allocate(64 * KB, 64 * KB, PlacementAllocator::Category::RenderTarget);
+	PlacementAllocator::Placement msaa = allocator.Allocate(64 * KB, 4 * MB, PlacementAllocator::Category::RenderTarget);
+	CHECK(msaa.Page == PlacementAllocator::NoPage);
+	CHECK(msaa.Size == 4 * MB && msaa.Offset % (4 * MB) == 0);
+	CHECK(msaa.Heap == small.Heap);
+}
+
+TEST(CategoriesNeverShareHeaps) {
+	PlacementAllocator allocator;
+	PlacementAllocator::Placement buffer = allocator.Allocate(64 * KB, 64 * KB, PlacementAllocator::Category::Buffer);
+	PlacementAllocator::Placement texture = allocator.Allocate(64 * KB, 64 * KB, PlacementAllocator::Category::Texture);
+	PlacementAllocator::Placement target = allocator.Allocate(8 * MB, 64 * KB, PlacementAllocator::Category::RenderTarget);
+	CHECK(allocator.HeapCount() == 3);
+	CHECK(buffer.Heap != texture.Heap && texture.Heap != target.Heap && buffer.Heap != target.Heap);
+	CHECK(allocator.HeapCategory(buffer.Heap) == PlacementAllocator::Category::Buffer);
+	CHECK(allocator.HeapCategory(texture.Heap) == PlacementAllocator::Category::Texture);
+	CHECK(allocator.HeapCategory(target.Heap) == PlacementAllocator::Category::RenderTarget);
+}
+
+TEST(LargeRequestsAreDedicated) {
+	PlacementAllocator allocator;
+	PlacementAllocator::Placement half = allocator.Allocate(32 * MB, 64 * KB, PlacementAllocator::Category::Texture);
+	CHECK(half.IsPlaced() && !half.Dedicated);
+
+	PlacementAllocator::Placement large = allocator.Allocate(32 * MB + 1, 64 * KB, PlacementAllocator::Category::Texture);
+	CHECK(large.Dedicated && !large.IsPlaced());
+	CHECK(allocator.Stats().DedicatedAllocations == 1);
+	CHECK(allocator.Stats().ReservedBytes == 32 * MB);
+
+	allocator.Free(large);
+	CHECK(allocator.Stats().DedicatedAllocations == 0);
+}
+
+TEST(HeapsGrowWhenFull) {
+	PlacementAllocator allocator;
+	std::vector<PlacementAllocator::Placement> placements;
+	for (int i = 0; i < 5; i++) {
+		placements.push_back(allocator.Allocate(16 * MB, 64 * KB, PlacementAllocator::Category::Texture));
+	}
+	CHECK(allocator.HeapCount() == 2);
+	CHECK(placements[4].Heap == 1 && placements[4].Offset == 0);
+
+	// Freed space in the first heap is reused before a third is added.
+	allocator.Free(placements[1]);
+	PlacementAllocator::Placement again = allocator.Allocate(16 * MB, 64 * KB, PlacementAllocator::Category::Texture);
+	CHECK(again.Heap == 0 && again.Offset == placements[1].Offset);
+	CHECK(allocator.HeapCount() == 2);
+}
+
+TEST(EmptyPagesReturnToTheirHeap) {
+	PlacementAllocator allocator;
+	std::vector<PlacementAllocator::Placement> placements;
+
+	// Four 1MB slots per 4MB page: three pages.
+	for (int i = 0; i < 12; i++) {
+		placements.push_back(allocator.Allocate(1 * MB, 64 * KB, PlacementAllocator::Category::Buffer));
+	}
+	CHECK(allocator.Stats().PoolPages == 3);
+
+	for (const auto& placement : placements) {
+		allocator.Free(placement);
+	}
+
+	// One empty page stays to absorb the next allocation of its class.
+	PlacementAllocator::Statistics stats = allocator.Stats();
+	CHECK(stats.PoolPages == 1);
+	CHECK(stats.ReservedBytes == 0 && stats.RequestedBytes == 0);
+	CHECK(stats.LargestFreeBlock == 32 * MB);
+}
+
+TEST(RandomizedNoOverlap) {
+	PlacementAllocator allocator;
+	std::vector<PlacementAllocator::Placement> live;
+	std::map<std::pair<uint32_t, uint64_t>, uint64_t> ranges;	// (heap, offset) -> size
+	std::mt19937 random(5);
+
+	auto overlaps = [&](const PlacementAllocator::Placement& placement) {
+		auto next = ranges.lower_bound({ placement.Heap, placement.Offset });
+		if (next != ranges.end() && next->first.first == placement.Heap && next->first.second < placement.Offset + placement.Size) {
+			return true;
+		}
+		if (next != ranges.begin()) {
+			auto prev = std::prev(next);
+			if (prev->first.first == placement.Heap && prev->first.second + prev->second > placement.Offset) {
+				return true;
+			}
+		}
+		return false;
+	};
+
+	for (int step = 0; step < 50000; step++) {
+		if (live.empty() || (live.size() < 2000 && random() % 2 == 0)) {
+			auto category = static_cast<PlacementAllocator::Category>(random() % 3);
+			uint64_t size = random() % 4 == 0 ? 1 + random() % (8 * MB) : 1 + random() % (256 * KB);
+			uint64_t alignment = random() % 16 == 0 ? 4 * MB : 64 * KB;
+
+			PlacementAllocator::Placement placement = allocator.Allocate(size, alignment, category);
+			CHECK(placement.IsPlaced());
+			CHECK(placement.Size >= size && placement.Offset % alignment == 0);
+			CHECK(placement.Offset + placement.Size <= allocator.HeapSize());
+			CHECK(allocator.HeapCategory(placement.Heap) == category);
+			CHECK(!overlaps(placement));
+
+			ranges[{ placement.Heap, placement.Offset }] = placement.Size;
+			live.push_back(placement);
+		} else {
+			size_t index = random() % live.size();
+			PlacementAllocator::Placement placement = live[index];
+			live[index] = live.back();
+			live.pop_back();
+
+			ranges.erase({ placement.Heap, placement.Offset });
+			allocator.Free(placement);
+		}
+	}
+
+	for (const auto& placement : live) {
+		allocator.Free(placement);
+	}
+	PlacementAllocator::Statistics stats = allocator.Stats();
+	CHECK(stats.ReservedBytes == 0 && stats.RequestedBytes == 0);
+}
@@ -0,0 +1,208 @@
+#include "daybreak.h"
+#include "Test.h"
+
+#include "common/Profiler.h"
+
+#include <atomic>
+#include <fstream>
+#include <thread>
+
+/*
+	Profiler captures: the .prof layout for a known set of scopes, and
+	captures started and written while other threads keep recording (run under
+	-DDAYBREAK_SANITIZE=thread to check the export against the writers).
+*/
+
+namespace {
+
+	struct Record {
+		std::string	Name;
+		uint32_t	Depth;
+		int64_t		Start;
+		int64_t		End;
+	};
+
+	struct Thread {
+		uint32_t			Id;
+		std::string			Name;
+		uint32_t			Dropped;
+		std::vector<Record>	Records;
+	};
+
+	template<typename T>
+	T Read(std::ifstream& file) {
+		T value = {};
+		file.read(reinterpret_cast<char*>(&value), sizeof(T));
+		return value;
+	}
+
+	std::string ReadString(std::ifstream& file) {
+		std::string text(Read<uint16_t>(file), '\0');
+		file.read(text.data(), text.size());
+		return text;
+	}
+
+	bool ReadCapture(const std::filesystem::path& path, std::vector<Thread>& threads) {
+		std::ifstream file(path, std::ios_base::binary);
+		if (Read<uint32_t>(file) != Profiler::Magic || Read<uint32_t>(file) != Profiler::Version) {
+			return false;
+		}
+
+		std::vector<std::string> names(Read<uint32_t>(file));
+		for (std::string& name : names) {
+			name = ReadString(file);
+		}
+
+		threads.resize(Read<uint32_t>(file));
+		for (Thread& thread : threads) {
+			thread.Id = Read<uint32_t>(file);
+			thread.Name = ReadString(file);
+			thread.Dropped = Read<uint32_t>(file);
+			thread.Records.resize(Read<uint32_t>(file));
+			for (Record& record : thread.Records) {
+				uint32_t name = Read<uint32_t>(file);
+				record.Name = name < names.size() ? names[name] : "";
+				record.Depth = Read<uint32_t>(file);
+				record.Start = Read<int64_t>(file);
+				record.End = Read<int64_t>(file);
+			}
+		}
+		return file.good();
+	}
+
+	// Also silences the capture's log line, which would need a GameSettings
+	// and a log directory.
+	std::filesystem::path CapturePath(const char* name) {
+		Logger::SetCategoryEnabled(LogCategory::General, false);
+		return std::filesystem::temp_directory_path() / name;
+	}
+}
+
+TEST(BinaryLayout) {
+	std::filesystem::path path = CapturePath("daybreak-profiler-layout");
+	Profiler::SetThreadName("Test");
+	Profiler::BeginCapture(2, path.wstring());
+
+	for (int frame = 0; frame < 3; frame++) {
+		Profiler::BeginFrame();
+		if (Profiler::IsCapturing()) {
+			PROFILE_SCOPE("Outer");
+			PROFILE_SCOPE("Inner");
+		}
+	}
+	CHECK(!Profiler::IsCapturing());
+
+	std::vector<Thread> threads;
+	CHECK(ReadCapture(path.wstring() + L".prof", threads));
+	CHECK(threads.size() == 1);
+	if (threads.size() == 1) {
+		CHECK(threads[0].Name == "Test");
+		CHECK(threads[0].Dropped == 0);
+
+		// Per frame: the marker, then scopes in the order they closed.
+		const std::vector<Record>& records = threads[0].Records;
+		CHECK(records.size() == 6);
+		for (size_t i = 0; i + 2 < records.size(); i += 3) {
+			CHECK(records[i].Name == "Frame" && records[i].Depth == Profiler::FrameMarker);
+			CHECK(records[i + 1].Name == "Inner" && records[i + 1].Depth == 1);
+			CHECK(records[i + 2].Name == "Outer" && records[i + 2].Depth == 0);
+			CHECK(records[i + 2].Start <= records[i + 1].Start && records[i + 1].End <= records[i + 2].End);
+			CHECK(records[i].Start <= records[i + 2].Start);
+		}
+	}
+
+	std::filesystem::remove(path.wstring() + L".prof");
+	std::filesystem::remove(path.wstring() + L".json");
+}
+
+TEST(CountsDroppedScopes) {
+	std::filesystem::path path = CapturePath("daybreak-profiler-dropped");
+	Profiler::BeginCapture(1, path.wstring());
+
+	const uint32_t extra = 100;
+	for (int frame = 0; frame < 2; frame++) {
+		Profiler::BeginFrame();
+		if (Profiler::IsCapturing()) {
+			for (uint32_t i = 0; i < Profiler::MaxRecordsPerThread + extra; i++) {
+				PROFILE_SCOPE("Scope");
+			}
+		}
+	}
+	CHECK(!Profiler::IsCapturing());
+
+	// The frame marker took one record, so one more scope than extra is lost.
+	std::vector<Thread> threads;
+	CHECK(ReadCapture(path.wstring() + L".prof", threads));
+	CHECK(threads.size() == 1);
+	if (threads.size() == 1) {
+		CHECK(threads[0].Records.size() == Profiler::MaxRecordsPerThread);
+		CHECK(threads[0].Dropped == extra + 1);
+	}
+
+	std::ifstream json(std::filesystem::path(path.wstring() + L".json"));
+	std::string text((std::istreambuf_iterator<char>(json)), std::istreambuf_iterator<char>());
+	CHECK(text.find("\"metadata\":{\"maxRecordsPerThread\":" + std::to_string(Profiler::MaxRecordsPerThread) + ",\"dropped\":" + std::to_string(extra + 1) + "}") != std::string::npos);
+
+	std::filesystem::remove(path.wstring() + L".prof");
+	std::filesystem::remove(path.wstring() + L".json");
+}
+
+TEST(CapturesWhileThreadsRecord) {
+	std::filesystem::path path = CapturePath("daybreak-profiler-threads");
+	std::atomic<bool> stop(false);
+
+	// Workers register at different points: some before the first capture,
+	// some while one is running.
+	std::vector<std::thread> workers;
+	for (int i = 0; i < 4; i++) {
+		workers.emplace_back([&stop, i] {
+			if (i % 2 == 0) {
+				Profiler::SetThreadName("Worker");
+			}
+			while (!stop.load(std::memory_order_relaxed)) {
+				{
+					PROFILE_SCOPE("Work");
+					for (int j = 0; j < 8; j++) {
+						PROFILE_SCOPE("Step");
+					}
+				}
+				// Keeps the buffers short of full so each capture writes quickly.
+				std::this_thread::sleep_for(std::chrono::microseconds(10));
+			}
+		});
+	}
+
+	int written = 0;
+	for (int capture = 0; capture < 20; capture++) {
+		Profiler::BeginCapture(3, path.wstring());
+		for (int frame = 0; frame < 4; frame++) {
+			Profiler::BeginFrame();
+			std::this_thread::sleep_for(std::chrono::microseconds(200));
+		}
+		CHECK(!Profiler::IsCapturing());
+
+		std::vector<Thread> threads;
+		CHECK(ReadCapture(path.wstring() + L".prof", threads));
+		for (const Thread& thread : threads) {
+			// Every record is whole: a known name and an end no earlier than its
+			// start. A Work scope open when the capture began is not recorded,
+			// so the Steps inside it show up at depth 0.
+			for (const Record& record : thread.Records) {
+				bool known = (record.Name == "Frame" && record.Depth == Profiler::FrameMarker) ||
+					(record.Name == "Work" && record.Depth == 0) ||
+					(record.Name == "Step" && record.Depth <= 1);
+				CHECK(known && record.End >= record.Start);
+			}
+			CHECK(thread.Records.size() <= Profiler::MaxRecordsPerThread);
+		}
+		written += !threads.empty();
+	}
+	stop.store(true, std::memory_order_relaxed);
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+	CHECK(written == 20);
+
+	std::filesystem::remove(path.wstring() + L".prof");
+	std::filesystem::remove(path.wstring() + L".json");
+}
@@ -0,0 +1,213 @@
+#include "daybreak.h"
+#include "Test.h"
+
+#include "common/RingAllocator.h"
+
+#include <deque>
+#include <random>
+
+/*
+	memory::RingAllocator, the placement policy behind dx12::UploadRing:
+	wrap-around, fence-ordered reclaim, and a randomized run checked against
+	a byte-ownership model.
+*/
+
+using memory::RingAllocator;
+
+TEST(AllocatesInOrderAndAligned) {
+	RingAllocator ring(1024);
+	RingAllocator::Allocation a, b, c;
+	CHECK(ring.Allocate(10, 1, a) && a.Offset == 0);
+	CHECK(ring.Allocate(16, 256, b) && b.Offset == 256);
+	CHECK(ring.Allocate(1, 4, c) && c.Offset == 272);
+	CHECK(b.Id == a.Id + 1 && c.Id == b.Id + 1);
+	CHECK(ring.UsedBytes() == 273);
+}
+
+TEST(FullRingFailsUntilRetired) {
+	RingAllocator ring(256);
+	RingAllocator::Allocation a, b, c;
+	CHECK(ring.Allocate(128, 1, a));
+	CHECK(ring.Allocate(128, 1, b));
+	CHECK(!ring.Allocate(1, 1, c));
+	CHECK(ring.Stats().FailedAllocations == 1);
+
+	ring.Tag(a.Id, 5);
+	ring.Tag(b.Id, 6);
+	ring.Retire(4);
+	CHECK(!ring.Allocate(1, 1, c));
+
+	ring.Retire(5);
+	CHECK(ring.UsedBytes() == 128);
+	CHECK(ring.Allocate(128, 1, c) && c.Offset == 0);
+}
+
+// An allocation that does not fit before the end starts over at 0; the
+// skipped bytes belong to it and come back when it retires.
+TEST(WrapPaddingIsFreedWithItsBlock) {
+	RingAllocator ring(1000);
+	RingAllocator::Allocation a, b, c;
+	CHECK(ring.Allocate(400, 1, a));
+	CHECK(ring.Allocate(400, 1, b));
+	ring.Tag(a.Id, 1);
+	ring.Retire(1);
+
+	CHECK(ring.Allocate(300, 1, c));
+	CHECK(c.Offset == 0);
+	CHECK(ring.UsedBytes() == 400 + 200 + 300);
+
+	ring.Tag(b.Id, 2);
+	ring.Tag(c.Id, 3);
+	ring.Retire(2);
+	CHECK(ring.UsedBytes() == 500);
+	ring.Retire(3);
+	CHECK(ring.UsedBytes() == 0);
+
+	// An empty ring starts over at 0 without wrapping.
+	RingAllocator::Allocation d;
+	CHECK(ring.Allocate(1000, 1, d) && d.Offset == 0);
+}
+
+TEST(UntaggedAllocationHoldsBackLaterOnes) {
+	RingAllocator ring(1024);
+	RingAllocator::Allocation a, b;
+	CHECK(ring.Allocate(100, 1, a));
+	CHECK(ring.Allocate(100, 1, b));
+
+	ring.Tag(b.Id, 1);
+	ring.Retire(10);
+	CHECK(ring.UsedBytes() == 200);
+
+	// Tagging with 0 releases on the next Retire.
+	ring.Tag(a.Id, 0);
+	ring.Retire(0);
+	CHECK(ring.UsedBytes() == 100);
+	ring.Retire(1);
+	CHECK(ring.UsedBytes() == 0);
+}
+
+TEST(HighWaterMark) {
+	RingAllocator ring(1024);
+	RingAllocator::Allocation a, b;
+	CHECK(ring.Allocate(600, 1, a));
+	ring.Tag(a.Id, 1);
+	ring.Retire(1);
+	CHECK(ring.Allocate(100, 1, b));
+
+	RingAllocator::Statistics stats = ring.Stats();
+	CHECK(stats.HighWaterMark == 600 && stats.UsedBytes == 100 && stats.Allocations == 2);
+	ring.ResetHighWaterMark();
+	CHECK(ring.Stats().HighWaterMark == 100);
+}
+
+/*
+	Random sizes and alignments, submitted in batches under increasing fence
+	values and completed in jumps. Every byte handed out is owned by exactly
+	one live allocation, and retired allocations are exactly those whose fence
+	has completed, in order.
+*/
+TEST(RandomizedAgainstOwnershipModel) {
+	const size_t Capacity = 1 << 16;
+	RingAllocator ring(Capacity);
+	std::vector<uint8_t> owned(Capacity, 0);
+
+	struct Live {
+		size_t		Offset;
+		size_t		Size;
+		uint64_t	Id;
+		uint64_t	Fence;
+	};
+	std::deque<Live> live;
+
+	std::mt19937 random(1);
+	uint64_t fence = 0, completed = 0;
+	size_t succeeded = 0, failed = 0;
+	bool aligned = true, inBounds = true, disjoint = true;
+
+	for (int step = 0; step < 200000; step++) {
+		size_t size = 1 + random() % 4000;
+		size_t alignment = size_t(1) << (random() % 9);
+
+		RingAllocator::Allocation allocation;
+		if (ring.Allocate(size, alignment, allocation)) {
+			succeeded++;
+			aligned &= allocation.Offset % alignment == 0;
+			inBounds &= allocation.Offset + size <= Capacity;
+			for (size_t i = 0; i < size && allocation.Offset + i < Capacity; i++) {
+				disjoint &= owned[allocation.Offset + i] == 0;
+				owned[allocation.Offset + i] = 1;
+			}
+			live.push_back({ allocation.Offset, size, allocation.Id, 0 });
+		} else {
+			failed++;
+		}
+
+		// Submit everything recorded so far.
+		if (random() % 3 == 0) {
+			fence++;
+			for (Live& allocation : live) {
+				if (allocation.Fence == 0) {
+					allocation.Fence = fence;
+					ring.Tag(allocation.Id, fence);
+				}
+			}
+		}
+
+		if (random() % 5 == 0 && completed < fence) {
+			completed += 1 + random() % (fence - completed);
+			ring.Retire(completed);
+			while (!live.empty() && live.front().Fence != 0 && live.front().Fence <= completed) {
+				for (size_t i = 0; i < live.front().Size; i++) {
+					owned[live.front().Offset + i] = 0;
+				}
+				live.pop_front();
+			}
+		}
+
+		// Used bytes also count alignment and wrap padding.
+		if (step % 1000 == 0) {
+			size_t owning = 0;
+			for (uint8_t byte : owned) {
+				owning += byte;
+			}
+			CHECK(ring.UsedBytes() >= owning && (owning > 0 || ring.UsedBytes() == 0));
+		}
+	}
+
+	CHECK(aligned);
+	CHECK(inBounds);
+	CHECK(disjoint);
+	CHECK(ring.Stats().Allocations == succeeded && ring.Stats().FailedAllocations == failed);
+	printf("  %zu allocations, %zu full, high-water %zu of %zu bytes\n", succeeded, failed, ring.Stats().HighWaterMark, Capacity);
+}
+
+/*
+	The upload pattern: each frame records a few command lists that take
+	chunks, submits them under the frame's fence, and the GPU completes two
+	frames behind. A ring of three frames' worth never runs out.
+*/
+TEST(FramesInFlightNeverFillTheRing) {
+	const size_t ChunkSize = 64 * 1024;
+	const size_t ChunksPerFrame = 16;
+	const uint64_t FramesInFlight = 2;
+	RingAllocator ring(ChunkSize * ChunksPerFrame * (FramesInFlight + 1));
+
+	std::mt19937 random(9);
+	bool allocated = true;
+	for (uint64_t frame = 1; frame <= 2000; frame++) {
+		if (frame > FramesInFlight) {
+			ring.Retire(frame - FramesInFlight);
+		}
+
+		size_t chunks = 1 + random() % ChunksPerFrame;
+		for (size_t i = 0; i < chunks; i++) {
+			RingAllocator::Allocation allocation;
+			allocated &= ring.Allocate(ChunkSize, 256, allocation);
+			ring.Tag(allocation.Id, frame);
+		}
+	}
+
+	CHECK(allocated);
+	CHECK(ring.Stats().FailedAllocations == 0);
+	CHECK(ring.Stats().HighWaterMark <= ring.Capacity());
+}
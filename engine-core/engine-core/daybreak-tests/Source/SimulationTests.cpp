@@ -0,0 +1,90 @@
+#include "daybreak.h"
+#include "Test.h"
+
+#include "engine/Simulation.h"
+
+/*
+	Fixed timestep accumulator, fed exact frame times: ticks per frame, the
+	render alpha, and the spiral-of-death cap with its dropped tick count. Tick
+	rates are powers of two so every step is exact in binary.
+*/
+
+namespace {
+
+	class StepGame : public Daybreak::Simulation {
+		public:
+			std::vector<UpdateEvent> Updates;
+
+			void Settings() override {}
+			void Initialize() override {}
+			void OnUpdate(UpdateEvent event) override { Updates.push_back(event); }
+			void OnRender(RenderEvent) override {}
+			void OnResize(ResizeEvent) override {}
+
+			// Ticks run for one frame of frameSeconds, and the alpha it returns.
+			size_t Frame(double frameSeconds, double& alpha) {
+				size_t before = Updates.size();
+				alpha = RunUpdates(frameSeconds);
+				return Updates.size() - before;
+			}
+	};
+
+	const double Tick = 1.0 / 64.0;
+}
+
+TEST(AccumulatesPartialTicks) {
+	StepGame game;
+	game.SetFixedTimestep(64.0);
+	CHECK(game.TickSeconds() == Tick);
+
+	double alpha = -1.0;
+	CHECK(game.Frame(2.0 * Tick, alpha) == 2 && alpha == 0.0);
+	CHECK(game.Frame(1.5 * Tick, alpha) == 1 && alpha == 0.5);
+	CHECK(game.Frame(0.25 * Tick, alpha) == 0 && alpha == 0.75);
+	CHECK(game.Frame(1.25 * Tick, alpha) == 2 && alpha == 0.0);
+	CHECK(game.Frame(0.5 * Tick, alpha) == 0 && alpha == 0.5);
+
+	// Consecutive ticks, each a fixed step of simulated time.
+	CHECK(game.Updates.size() == 5);
+	for (size_t i = 0; i < game.Updates.size(); i++) {
+		CHECK(game.Updates[i].tick == i + 1);
+		CHECK(game.Updates[i].deltaSeconds == Tick);
+		CHECK(game.Updates[i].simulationTime == (i + 1) * Tick);
+	}
+	CHECK(game.DroppedTicks() == 0);
+}
+
+TEST(CapsTicksPerFrame) {
+	StepGame game;
+	game.SetFixedTimestep(64.0, 4);
+
+	// Ten ticks due, four run, six dropped; the remainder is not carried.
+	double alpha = -1.0;
+	CHECK(game.Frame(10.0 * Tick, alpha) == 4 && alpha == 0.0);
+	CHECK(game.DroppedTicks() == 6);
+
+	// A partial tick past the cap is dropped with the rest.
+	CHECK(game.Frame(6.5 * Tick, alpha) == 4 && alpha == 0.0);
+	CHECK(game.DroppedTicks() == 8);
+
+	// Exactly at the cap nothing is dropped, and normal frames resume.
+	CHECK(game.Frame(4.0 * Tick, alpha) == 4 && game.DroppedTicks() == 8);
+	CHECK(game.Frame(1.5 * Tick, alpha) == 1 && alpha == 0.5);
+	CHECK(game.Updates.back().simulationTime == 13 * Tick);
+}
+
+TEST(VariableTimestepRunsOncePerFrame) {
+	StepGame game;
+	game.SetFixedTimestep(64.0);
+	double alpha = -1.0;
+	game.Frame(0.5 * Tick, alpha);
+
+	// Switching back drops the accumulated half tick.
+	game.SetFixedTimestep(0.0);
+	CHECK(game.TickSeconds() == 0.0);
+	CHECK(game.Frame(0.25, alpha) == 1 && alpha == 1.0);
+	CHECK(game.Frame(0.0, alpha) == 1 && alpha == 1.0);
+	CHECK(game.Updates.size() == 2);
+	CHECK(game.Updates[0].deltaSeconds == 0.25 && game.Updates[1].deltaSeconds == 0.0);
+	CHECK(game.Updates[1].simulationTime == 0.25);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+/*
+	Minimal harness for the headless test executables. Every TEST in an
+	executable registers itself at static-init time and TestMain.cpp runs them
+	in order (or only those whose name contains argv[1]). CHECK records a
+	failure and carries on; the process exits non-zero if any check failed.
+*/
+namespace test {
+
+	struct Case {
+		const char*	Name;
+		void		(*Run)();
+	};
+
+	std::vector<Case>& Cases();
+	void Fail(const char* file, int line, const char* expression);
+
+	struct Registrar {
+		Registrar(const char* name, void (*run)()) {
+			Cases().push_back({ name, run });
+		}
+	};
+}
+
+#define TEST(name) \
+	static void name(); \
+	static test::Registrar name##Registrar(#name, name); \
+	static void name()
+
+#define CHECK(expression) \
+	do { \
+		if (!(expression)) { \
+			test::Fail(__FILE__, __LINE__, #expression); \
+		} \
+	} while (0)
@@ -0,0 +1,44 @@
+#include "Test.h"
+
+#include <chrono>
+#include <cstring>
+
+namespace test {
+
+	static int g_failures = 0;
+
+	std::vector<Case>& Cases() {
+		static std::vector<Case> cases;
+		return cases;
+	}
+
+	void Fail(const char* file, int line, const char* expression) {
+		g_failures++;
+		printf("  %s(%d): CHECK(%s) failed\n", file, line, expression);
+	}
+}
+
+int main(int argc, char** argv) {
+	const char* filter = argc > 1 ? argv[1] : nullptr;
+
+	int failedCases = 0, ran = 0;
+	for (const test::Case& testCase : test::Cases()) {
+		if (filter && !strstr(testCase.Name, filter)) {
+			continue;
+		}
+
+		int failuresBefore = test::g_failures;
+		auto start = std::chrono::steady_clock::now();
+		testCase.Run();
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		bool passed = test::g_failures == failuresBefore;
+		failedCases += !passed;
+		ran++;
+		printf("[%s] %s (%.1f ms)\n", passed ? "  OK  " : "FAILED", testCase.Name, ms);
+		fflush(stdout);
+	}
+
+	printf("%d of %d tests passed\n", ran - failedCases, ran);
+	return failedCases == 0 && ran > 0 ? 0 : 1;
+}
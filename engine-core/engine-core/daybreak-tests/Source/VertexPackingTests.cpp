@@ -0,0 +1,143 @@
+#include "Test.h"
+
+#include "graphics/VertexPacking.h"
+
+#include <algorithm>
+#include <limits>
+#include <random>
+
+/*
+	Round-trip error of the packed vertex encodings: octahedral normals, half
+	float UVs and quantized positions.
+*/
+
+static const int SampleCount = 2000000;
+
+static double AngleDegrees(const float a[3], const float b[3]) {
+	double cross[3] = {
+		static_cast<double>(a[1]) * b[2] - static_cast<double>(a[2]) * b[1],
+		static_cast<double>(a[2]) * b[0] - static_cast<double>(a[0]) * b[2],
+		static_cast<double>(a[0]) * b[1] - static_cast<double>(a[1]) * b[0]
+	};
+	double sine = std::sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+	double cosine = static_cast<double>(a[0]) * b[0] + static_cast<double>(a[1]) * b[1] + static_cast<double>(a[2]) * b[2];
+	return std::atan2(sine, cosine) * 180.0 / 3.14159265358979323846;
+}
+
+TEST(OctahedralRoundTripError) {
+	std::mt19937 random(7);
+	std::normal_distribution<float> gaussian;
+
+	double worst = 0.0, total = 0.0;
+	for (int i = 0; i < SampleCount; i++) {
+		float normal[3] = { gaussian(random), gaussian(random), gaussian(random) };
+		if (i < 6) {
+			// The axes, including -Z where the fold meets at the corners.
+			for (int axis = 0; axis < 3; axis++) {
+				normal[axis] = axis == i / 2 ? (i % 2 ? -1.0f : 1.0f) : 0.0f;
+			}
+		}
+		float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		for (float& component : normal) {
+			component /= length;
+		}
+
+		int16_t encoded[2];
+		float decoded[3];
+		meshops::OctEncode(normal, encoded);
+		meshops::OctDecode(encoded, decoded);
+
+		double angle = AngleDegrees(normal, decoded);
+		worst = std::max(worst, angle);
+		total += angle;
+	}
+
+	printf("  worst %.4f deg, mean %.4f deg\n", worst, total / SampleCount);
+	CHECK(worst < 0.01);
+}
+
+TEST(OctahedralZeroVectorIsUp) {
+	float zero[3] = { 0.0f, 0.0f, 0.0f };
+	int16_t encoded[2];
+	float decoded[3];
+	meshops::OctEncode(zero, encoded);
+	meshops::OctDecode(encoded, decoded);
+	CHECK(decoded[0] == 0.0f && decoded[1] == 0.0f && decoded[2] == 1.0f);
+}
+
+TEST(OctahedralNonFiniteIsUp) {
+	float nan = std::numeric_limits<float>::quiet_NaN();
+	float inf = std::numeric_limits<float>::infinity();
+	float inputs[][3] = { { nan, 0.0f, 1.0f }, { 0.0f, 0.0f, nan }, { nan, nan, nan }, { inf, 0.0f, 0.0f }, { 1.0f, -inf, 0.0f } };
+	for (const float* input : inputs) {
+		int16_t encoded[2] = { 123, -456 };
+		meshops::OctEncode(input, encoded);
+		CHECK(encoded[0] == 0 && encoded[1] == 0);
+	}
+}
+
+// Every half value survives FromHalf/ToHalf unchanged (NaNs stay NaN).
+TEST(HalfRoundTripIsExact) {
+	uint32_t mismatches = 0;
+	for (uint32_t value = 0; value <= 0xFFFF; value++) {
+		float decoded = meshops::FromHalf(static_cast<uint16_t>(value));
+		uint16_t encoded = meshops::ToHalf(decoded);
+		if (std::isnan(decoded)) {
+			mismatches += (encoded & 0x7C00) != 0x7C00 || (encoded & 0x3FF) == 0;
+		} else {
+			mismatches += encoded != value;
+		}
+	}
+	CHECK(mismatches == 0);
+}
+
+TEST(HalfRoundsToNearest) {
+	std::mt19937 random(11);
+	std::uniform_real_distribution<float> uniform(-64.0f, 64.0f);
+
+	// Normal halves carry 11 significant bits, so round to nearest is off by
+	// at most 2^-11 relative.
+	double worst = 0.0;
+	for (int i = 0; i < SampleCount; i++) {
+		float value = uniform(random);
+		if (std::fabs(value) < 6.2e-5f) {
+			continue;
+		}
+		float decoded = meshops::FromHalf(meshops::ToHalf(value));
+		worst = std::max(worst, static_cast<double>(std::fabs(decoded - value)) / std::fabs(value));
+	}
+	printf("  worst relative error %.3g\n", worst);
+	CHECK(worst <= std::ldexp(1.0, -11));
+
+	CHECK(meshops::ToHalf(-0.0f) == 0x8000);
+	CHECK(meshops::FromHalf(meshops::ToHalf(65504.0f)) == 65504.0f);
+	CHECK(meshops::ToHalf(65520.0f) == 0x7C00);
+	CHECK(meshops::ToHalf(1e6f) == 0x7C00);
+	CHECK(meshops::FromHalf(meshops::ToHalf(std::ldexp(1.0f, -24))) == std::ldexp(1.0f, -24));
+}
+
+TEST(QuantizedPositionWithinHalfStep) {
+	float min[3] = { -3.0f, 0.0f, 10.0f }, max[3] = { 5.0f, 2.0f, 10.0f };
+	meshops::PositionTransform transform = meshops::QuantizationFor(min, max);
+
+	std::mt19937 random(3);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+	double worst[3] = { 0.0, 0.0, 0.0 };
+	for (int i = 0; i < SampleCount; i++) {
+		float position[3] = { -3.0f + unit(random) * 8.0f, unit(random) * 2.0f, 10.0f };
+		uint16_t quantized[4];
+		float decoded[3];
+		meshops::QuantizePosition(position, transform, quantized);
+		meshops::DequantizePosition(quantized, transform, decoded);
+		for (int axis = 0; axis < 3; axis++) {
+			worst[axis] = std::max(worst[axis], static_cast<double>(std::fabs(decoded[axis] - position[axis])));
+		}
+	}
+
+	// Half a step of extent / 65535, with a little slack for float rounding;
+	// the flat axis decodes exactly.
+	CHECK(worst[0] <= 8.0 / 65535.0 / 2.0 * 1.01);
+	CHECK(worst[1] <= 2.0 / 65535.0 / 2.0 * 1.01);
+	CHECK(worst[2] == 0.0);
+}
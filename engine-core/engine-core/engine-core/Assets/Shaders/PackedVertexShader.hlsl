@@ -0,0 +1,74 @@
+#pragma enable_d3d11_debug_symbols
+
+struct Mat
+{
+    matrix Model;
+    matrix View;
+    matrix Projection;
+};
+
+ConstantBuffer<Mat> MatCB : register(b0);
+
+// Position decode for the mesh being drawn, set by gfx::Mesh::Draw.
+struct MeshConstants
+{
+    float4 PositionOffset;
+    float4 PositionScale;
+};
+
+ConstantBuffer<MeshConstants> MeshCB : register(b1);
+
+// gfx::VertexFormat::PACKED and PACKED_QUANTIZED (see graphics/VertexPacking.h).
+struct PackedVertex
+{
+    float3 Position : POSITION;     // float, or unorm16 against the mesh bounds
+    float2 Normal   : NORMAL;       // octahedral snorm16
+    float2 Tangent  : TANGENT;      // octahedral snorm16
+    float2 UV       : UV;           // half
+};
+
+struct VertexShaderOutput
+{
+    float4 Position     : SV_POSITION;
+    float3 Normal       : NORMAL;
+    float3 Tangent      : TANGNT;
+    float3 Color        : COLOR;
+    float2 UV           : UV;
+    float3 WorldPos     : POSITION;
+};
+
+// Mirrors meshops::OctDecode.
+float3 OctDecode(float2 encoded)
+{
+    float3 n = float3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+    float fold = saturate(-n.z);
+    n.xy += n.xy >= 0.0f ? -fold : fold;
+    return normalize(n);
+}
+
+VertexShaderOutput main(PackedVertex IN)
+{
+    VertexShaderOutput OUT;
+
+    float3 position = MeshCB.PositionOffset.xyz + IN.Position * MeshCB.PositionScale.xyz;
+
+    matrix mvp = mul(mul(MatCB.Model, MatCB.View), MatCB.Projection);
+
+    // Calculate output position
+    OUT.Position = mul(float4(position, 1.0f), mvp);
+
+    // Calculate world position
+    OUT.WorldPos = mul(float4(position, 1.0f), MatCB.Model).xyz;
+
+    // Calculate transformed normals
+    OUT.Normal = normalize(mul(OctDecode(IN.Normal), (float3x3) MatCB.Model));
+
+    OUT.Tangent = normalize(mul(OctDecode(IN.Tangent), (float3x3) MatCB.Model));
+
+    // Vertex colour is not stored; this is the placeholder the importer used.
+    OUT.Color = float3(0.196f, 0.573f, 0.035f);
+
+    OUT.UV = IN.UV;
+
+    return OUT;
+}
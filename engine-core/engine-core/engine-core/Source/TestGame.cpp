@@ -25,10 +25,20 @@ class TestGame : public Daybreak::Simulation {
 		void Initialize();
 
 		void OnUpdate(UpdateEvent event);
+		void OnSnapshot(UpdateEvent event);
 		void OnRender(RenderEvent event);
 		void OnResize(ResizeEvent event);
 
 	private:
+		// Everything OnRender reads; written by OnSnapshot into the event's slot.
+		struct RenderState {
+			float PreviousAngle;
+			float Angle;
+			XMMATRIX View;
+			XMMATRIX Projection;
+			float ViewportHeight;
+		};
+
 		std::shared_ptr<gfx::Model> m_cube;
 		FXMVECTOR m_cubePos;
 
@@ -42,9 +52,14 @@ class TestGame : public Daybreak::Simulation {
 		FXMVECTOR m_cameraDir;
 		FXMVECTOR m_cameraUp;
 
-		XMMATRIX m_model;
+		float m_previousAngle;
+		float m_angle;
+		bool m_paused;
+		uint64_t m_inputCursor;
 		XMMATRIX m_view;
 		XMMATRIX m_projection;
+
+		RenderState m_renderState[Daybreak::FramePipeline::SnapshotCount];
 };
 
 ENTRYAPP(TestGame);
@@ -63,14 +78,19 @@ enum RootParameters {
 
 TestGame::TestGame() : 
 	m_fov(45.0),
+	m_previousAngle(0.0f),
+	m_angle(0.0f),
+	m_paused(false),
+	m_inputCursor(0),
 	m_cameraPos(),
 	m_cameraDir(),
 	m_cameraUp(),
 	m_projection(),
 	m_cubePos(),
 	m_renderer({
-		L"../bin/Debug/VertexShader.cso",
-		L"../bin/Debug/PixelShader.cso"
+		L"../bin/Debug/PackedVertexShader.cso",
+		L"../bin/Debug/PixelShader.cso",
+		gfx::VertexFormat::PACKED_QUANTIZED
 	}) {
 	float aspectRatio = DEFAULT_WIDTH / (float)DEFAULT_HEIGHT;
 	m_projection = XMMatrixPerspectiveFovLH(XMConvertToRadians(m_fov), aspectRatio, 0.1f, 100.0f); 
@@ -87,13 +107,24 @@ void TestGame::Settings() {
 }
 
 void TestGame::Initialize() {
+	if (IsHeadless()) {
+		// Server: simulation only, nothing to load onto a GPU.
+		SetFixedTimestep(60.0);
+		return;
+	}
+
 	auto device = dx12::Application::Device();
 	auto commandQueue = dx12::Application::Get()->CommandQueue(D3D12_COMMAND_LIST_TYPE_COPY);
 	auto commandList = commandQueue->CommandList();
 
 	// Upload vertex buffer data
 	Logger::info(L"[TestGame::Initialize] Creating cube mesh...\n");
-	m_cube = gfx::Model::LoadFromFile(*commandList, "./Assets/Models/Backpack/backpack.obj");
+	// Prefer the mesh-bake output when it has been generated; baked with
+	// -format quantized it uploads without repacking.
+	std::string model = "./Assets/Models/Backpack/backpack";
+	gfx::ModelLoadOptions options;
+	options.Format = gfx::VertexFormat::PACKED_QUANTIZED;
+	m_cube = gfx::Model::LoadFromFile(*commandList, std::filesystem::exists(model + ".bmesh") ? model + ".bmesh" : model + ".obj", options);
 
 	Logger::info(L"[TestGame::Initialize] Creating view & projection matrix...\n");
 	const XMVECTOR eyePosition = XMVectorSet(0, 0, -10, 1);
@@ -107,39 +138,64 @@ void TestGame::Initialize() {
 	Logger::info(L"[TestGame::Initialize] Executing command list...\n");
 	auto fenceValue = commandQueue->ExecuteCommandList(commandList);
 	commandQueue->WaitForFenceValue(fenceValue);
+
+	SetFixedTimestep(60.0);
+	SetPipelined(true);
 }
 
 void TestGame::OnUpdate(UpdateEvent event) {
+	// Space pauses the spin.
+	input::Event inputEvent;
+	while (InputManagerFactory::create().events().Next(m_inputCursor, inputEvent)) {
+		if (inputEvent.Type == input::EventType::KeyDown && inputEvent.Key == VK_SPACE && !inputEvent.Repeat) {
+			m_paused = !m_paused;
+		}
+	}
 
-	float angle = static_cast<float>(event.elapsedSeconds * 360.0f);
-	const XMVECTOR rotationAxis = XMVectorSet(0, 1, 1, 0);
-	XMMATRIX m_rotationMatrix = XMMatrixRotationAxis(rotationAxis, XMConvertToRadians(angle));
-	XMMATRIX translationMatrix = XMMatrixIdentity();
-	XMMATRIX scaleMatrix = XMMatrixIdentity();
-	m_model = scaleMatrix * m_rotationMatrix * translationMatrix;
+	m_previousAngle = m_angle;
+	if (m_paused) {
+		return;
+	}
+	m_angle = std::fmod(m_angle + static_cast<float>(event.deltaSeconds * 90.0), 360.0f);
 }
 
-void TestGame::OnRender(RenderEvent event) {
-	dx12::Application* app = dx12::Application::Get();
-
-	auto commandQueue = app->CommandQueue(D3D12_COMMAND_LIST_TYPE_DIRECT);
-	auto commandList = commandQueue->CommandList();
-
-	{
-		m_renderer.BeginRender(commandList);
-
-		Mat matrices;
-		matrices.Model = XMMatrixTranspose(m_model);
-		matrices.View = XMMatrixTranspose(m_view);
-		matrices.Projection = XMMatrixTranspose(m_projection);
-
-		commandList->SetGraphicsDynamicConstantBuffer(RootParameters::MATRICES_CB, matrices);
-		// commandList->SetGraphicsDynamicConstantBuffer(RootParameters::MATRICES_CB, Material::White);
-		// commandList->SetShaderResourceView(RootParameters::TEXTURES, 0, m_MonaLisaTexture, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
-		m_cube->Draw(*commandList);
+void TestGame::OnSnapshot(UpdateEvent event) {
+	RenderState& state = m_renderState[event.snapshot];
+	state.PreviousAngle = m_previousAngle;
+	state.Angle = m_angle;
+	state.View = m_view;
+	state.Projection = m_projection;
+	state.ViewportHeight = static_cast<float>(m_size.cy);
+}
 
-		m_renderer.EndRender(commandList, commandQueue);
-	}
+void TestGame::OnRender(RenderEvent event) {
+	const RenderState& state = m_renderState[event.snapshot];
+
+	// Interpolate between the last two ticks; unwrap across the 360 degree seam.
+	float previousAngle = state.Angle < state.PreviousAngle ? state.PreviousAngle - 360.0f : state.PreviousAngle;
+	float angle = previousAngle + (state.Angle - previousAngle) * static_cast<float>(event.alpha);
+	XMMATRIX model = XMMatrixRotationAxis(XMVectorSet(0, 1, 1, 0), XMConvertToRadians(angle));
+
+	Mat matrices;
+	matrices.Model = XMMatrixTranspose(model);
+	matrices.View = XMMatrixTranspose(state.View);
+	matrices.Projection = XMMatrixTranspose(state.Projection);
+
+	gfx::LodView lodView;
+	lodView.ModelView = model * state.View;
+	lodView.PixelsPerUnit = XMVectorGetY(state.Projection.r[1]) * state.ViewportHeight * 0.5f;
+
+	// One slice per job thread, each recording a contiguous run of the
+	// model's meshes into its own command list.
+	size_t meshCount = m_cube->MeshCount();
+	uint32_t slices = static_cast<uint32_t>(std::clamp<size_t>(meshCount, 1, jobs::JobSystem::ThreadCount()));
+	m_renderer.Render(slices, [&](uint32_t slice, dx12::CommandList& commandList) {
+		commandList.SetGraphicsDynamicConstantBuffer(RootParameters::MATRICES_CB, matrices);
+		// commandList.SetGraphicsDynamicConstantBuffer(RootParameters::MATRICES_CB, Material::White);
+		// commandList.SetShaderResourceView(RootParameters::TEXTURES, 0, m_MonaLisaTexture, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+
+		m_cube->Draw(commandList, lodView, meshCount * slice / slices, meshCount * (slice + 1) / slices);
+	});
 }
 
 void TestGame::OnResize(ResizeEvent event) {
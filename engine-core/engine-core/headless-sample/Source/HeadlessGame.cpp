@@ -0,0 +1,49 @@
+#include "platform/posix/PosixEntry.h"
+
+#include "core/JobSystem.h"
+
+#include <cmath>
+
+/*
+	Minimal SERVER game for the headless build: a fixed 60 Hz simulation that
+	spreads a little work over the job system each tick and stops itself after
+	SessionTicks, or earlier on SIGINT/SIGTERM. -tickrate=N runs it faster.
+*/
+class HeadlessGame : public Daybreak::Simulation {
+	public:
+		static const uint64_t SessionTicks = 300;
+		static const size_t EntityCount = 4096;
+
+		void Settings() override {
+			GameSettings::set_game_name(L"HeadlessSample");
+		}
+
+		void Initialize() override {
+			SetFixedTimestep(60.0);
+			m_positions.assign(EntityCount, 0.0f);
+		}
+
+		void OnUpdate(UpdateEvent event) override {
+			float time = static_cast<float>(event.simulationTime);
+			jobs::JobSystem::ParallelFor(m_positions.size(), 256, [&](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; i++) {
+					m_positions[i] = std::sin(time + static_cast<float>(i));
+				}
+			});
+
+			if (event.tick % 60 == 0) {
+				Logger::info(L"[HeadlessGame] tick %llu, %.2f s simulated\n", static_cast<unsigned long long>(event.tick), event.simulationTime);
+			}
+			if (event.tick >= SessionTicks) {
+				RequestStop();
+			}
+		}
+
+		void OnRender(RenderEvent) override {}
+		void OnResize(ResizeEvent) override {}
+
+	private:
+		std::vector<float> m_positions;
+};
+
+ENTRYAPP(HeadlessGame);
@@ -0,0 +1,431 @@
+#include "graphics/BakedMesh.h"
+#include "graphics/MeshOptimize.h"
+#include "graphics/MeshSimplify.h"
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#include <Windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+/*
+	Offline bake step for gfx::Model. Runs the same Assimp import and vertex
+	conversion the engine does at load and writes the result as a .bmesh file
+	(layout in BakedMesh.h), which the engine then maps instead of importing.
+
+		mesh-bake <input> <output.bmesh> [-split] [-no-optimize] [-no-lods] [-format F] [-bench N]
+
+	Meshes are converted in parallel, one task per mesh, as gfx::Model does,
+	and reordered for the vertex cache, overdraw and vertex fetch unless
+	-no-optimize is given; the ACMR/ATVR before and after is printed. Meshes
+	too large for 16-bit indices are stored with 32-bit ones, or with -split,
+	cut into clusters that each fit 16-bit indices. Each stored mesh then gets
+	its levels of detail (MeshSimplify.h), again one task per mesh, unless
+	-no-lods is given; the triangles and error of every level are printed.
+	-format full|packed|quantized picks the vertex layout the file stores
+	(gfx::VertexFormat FULL, PACKED or PACKED_QUANTIZED; full by default). A
+	model loaded in the layout it was baked in is uploaded straight from the
+	mapping, so bake for the layout the renderer uses.
+	-bench times N runs of the full import against N runs of mapping the baked
+	file and reading every byte of it, and reports how conversion scales with
+	the thread count. Builds anywhere Assimp does: mesh-bake.vcxproj on
+	Windows, and the top-level CMakeLists.txt elsewhere whenever it finds
+	Assimp.
+*/
+
+using Clock = std::chrono::steady_clock;
+
+static const unsigned int ImportFlags =
+	aiProcess_CalcTangentSpace |
+	aiProcess_Triangulate |
+	aiProcess_JoinIdenticalVertices |
+	aiProcess_ValidateDataStructure |
+	aiProcess_SortByPType |
+	aiProcess_ConvertToLeftHanded;
+
+static void Copy(float* out, const aiVector3D& value) {
+	out[0] = value.x;
+	out[1] = value.y;
+	out[2] = value.z;
+}
+
+/*
+	Mirrors gfx::Model::ProcessAIMesh so a baked model is identical to an
+	imported one.
+*/
+static void ConvertMesh(const aiMesh* mesh, bmesh::MeshData& data) {
+	data.Material = mesh->mMaterialIndex;
+	data.Vertices.resize(mesh->mNumVertices);
+
+	for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
+		bmesh::Vertex& vertex = data.Vertices[i];
+		vertex = {};
+
+		// COLOR -- matches the engine's material placeholder
+		vertex.Color[0] = 0.196f;
+		vertex.Color[1] = 0.573f;
+		vertex.Color[2] = 0.035f;
+
+		Copy(vertex.Position, mesh->mVertices[i]);
+		if (mesh->HasNormals()) {
+			Copy(vertex.Normal, mesh->mNormals[i]);
+		}
+		if (mesh->HasTextureCoords(0)) {
+			vertex.UV[0] = mesh->mTextureCoords[0][i].x;
+			vertex.UV[1] = mesh->mTextureCoords[0][i].y;
+		}
+		if (mesh->HasTangentsAndBitangents()) {
+			Copy(vertex.Tangent, mesh->mTangents[i]);
+		}
+	}
+
+	data.Indices.clear();
+	data.Indices.reserve(static_cast<size_t>(mesh->mNumFaces) * 3);
+	for (unsigned int i = 0; i < mesh->mNumFaces; i++) {
+		const aiFace& face = mesh->mFaces[i];
+		data.Indices.insert(data.Indices.end(), face.mIndices, face.mIndices + face.mNumIndices);
+	}
+}
+
+// Same traversal order as gfx::Model::CollectAINode.
+static void CollectNode(const aiNode* node, const aiScene* scene, std::vector<const aiMesh*>& meshes) {
+	for (unsigned int i = 0; i < node->mNumMeshes; i++) {
+		meshes.push_back(scene->mMeshes[node->mMeshes[i]]);
+	}
+	for (unsigned int i = 0; i < node->mNumChildren; i++) {
+		CollectNode(node->mChildren[i], scene, meshes);
+	}
+}
+
+/*
+	Replaces every mesh that needs 32-bit indices with clusters that fit 16-bit
+	ones, keeping the mesh order.
+*/
+static void SplitMeshes(std::vector<bmesh::MeshData>& meshes) {
+	std::vector<bmesh::MeshData> split;
+	split.reserve(meshes.size());
+	for (bmesh::MeshData& mesh : meshes) {
+		if (!meshops::NeedsLongIndices(mesh.Vertices.size())) {
+			split.push_back(std::move(mesh));
+			continue;
+		}
+
+		for (const meshops::Cluster& cluster : meshops::SplitForShortIndices(mesh.Indices.data(), mesh.Indices.size(), mesh.Vertices.size())) {
+			bmesh::MeshData& part = split.emplace_back();
+			part.Vertices = meshops::GatherVertices(mesh.Vertices.data(), cluster);
+			part.Indices.assign(cluster.Indices.begin(), cluster.Indices.end());
+			part.Material = mesh.Material;
+		}
+	}
+	meshes = std::move(split);
+}
+
+// Runs task(i) for every i below count, with threadCount threads pulling
+// indices from a shared counter.
+template<typename Task>
+static void ParallelFor(size_t count, unsigned int threadCount, Task task) {
+	std::atomic<size_t> next(0);
+	auto worker = [&]() {
+		for (size_t i = next++; i < count; i = next++) {
+			task(i);
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (unsigned int i = 1; i < threadCount; i++) {
+		threads.emplace_back(worker);
+	}
+	worker();
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+}
+
+/*
+	Converts every mesh into its own slot of meshes. If reports is given, each
+	mesh is also optimized and its report stored in the matching slot.
+*/
+static void ConvertMeshes(const std::vector<const aiMesh*>& sources, std::vector<bmesh::MeshData>& meshes, unsigned int threadCount, std::vector<meshops::OptimizeReport>* reports = nullptr) {
+	meshes.resize(sources.size());
+	if (reports) {
+		reports->resize(sources.size());
+	}
+
+	ParallelFor(sources.size(), threadCount, [&](size_t i) {
+		ConvertMesh(sources[i], meshes[i]);
+		if (reports) {
+			(*reports)[i] = meshops::OptimizeMesh(meshes[i].Vertices, meshes[i].Indices);
+		}
+	});
+}
+
+/*
+	Appends every mesh's levels of detail to its indices and records their
+	ranges in Lods, the full mesh first. As gfx::Model does at import.
+*/
+static void GenerateLods(std::vector<bmesh::MeshData>& meshes, unsigned int threadCount) {
+	ParallelFor(meshes.size(), threadCount, [&](size_t i) {
+		bmesh::MeshData& mesh = meshes[i];
+		mesh.Lods.assign(1, { 0, static_cast<uint32_t>(mesh.Indices.size()), 0.0f, 0 });
+		if (mesh.Indices.empty()) {
+			return;
+		}
+
+		std::vector<meshops::LodLevel> levels = meshops::GenerateLods(
+			mesh.Vertices[0].Position, sizeof(bmesh::Vertex), mesh.Vertices[0].UV, sizeof(bmesh::Vertex), mesh.Vertices.size(),
+			mesh.Indices.data(), mesh.Indices.size()
+		);
+		for (const meshops::LodLevel& level : levels) {
+			mesh.Lods.push_back({ static_cast<uint32_t>(mesh.Indices.size()), static_cast<uint32_t>(level.Indices.size()), level.Error, 0 });
+			mesh.Indices.insert(mesh.Indices.end(), level.Indices.begin(), level.Indices.end());
+		}
+	});
+}
+
+static const aiScene* Import(Assimp::Importer& importer, const char* path, std::vector<const aiMesh*>& sources) {
+	const aiScene* scene = importer.ReadFile(path, ImportFlags);
+	if (!scene || !scene->mRootNode) {
+		std::cerr << "unable to import " << path << ": " << importer.GetErrorString() << std::endl;
+		return nullptr;
+	}
+
+	sources.clear();
+	CollectNode(scene->mRootNode, scene, sources);
+	return scene;
+}
+
+/*
+	Maps path, validates it and sums every byte the upload would read, so the
+	page faults are part of the timing. Returns false if the file is invalid.
+*/
+static bool ReadBaked(const char* path, uint64_t& checksum) {
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	GetFileSizeEx(file, &fileSize);
+	size_t size = static_cast<size_t>(fileSize.QuadPart);
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	const void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+#else
+	int file = open(path, O_RDONLY);
+	if (file < 0) {
+		return false;
+	}
+	struct stat status;
+	fstat(file, &status);
+	size_t size = static_cast<size_t>(status.st_size);
+	void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if (data == MAP_FAILED) {
+		return false;
+	}
+#endif
+
+	bmesh::View view;
+	bool valid = view.Open(data, size);
+	for (uint32_t i = 0; valid && i < view.MeshCount(); i++) {
+		const bmesh::MeshRecord& mesh = view.Mesh(i);
+		const uint64_t* words = static_cast<const uint64_t*>(view.Vertices(mesh));
+		for (size_t w = 0; w < static_cast<size_t>(view.VertexStride()) * mesh.VertexCount / sizeof(uint64_t); w++) {
+			checksum += words[w];
+		}
+		const uint8_t* indices = static_cast<const uint8_t*>(view.Indices(mesh));
+		for (size_t b = 0; b < static_cast<size_t>(mesh.IndexSize) * mesh.IndexCount; b++) {
+			checksum += indices[b];
+		}
+	}
+
+#ifdef _WIN32
+	if (data) {
+		UnmapViewOfFile(data);
+	}
+	if (mapping) {
+		CloseHandle(mapping);
+	}
+	CloseHandle(file);
+#else
+	munmap(data, size);
+#endif
+	return valid;
+}
+
+static double Milliseconds(Clock::duration duration) {
+	return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+int main(int argc, char** argv) {
+	if (argc < 3) {
+		std::cerr << "usage: mesh-bake <input> <output.bmesh> [-split] [-no-optimize] [-no-lods] [-format full|packed|quantized] [-bench N]" << std::endl;
+		return 1;
+	}
+
+	int benchRuns = 0;
+	bool split = false;
+	bool optimize = true;
+	bool lods = true;
+	bmesh::Layout layout = bmesh::Layout::Full;
+	for (int i = 3; i < argc; i++) {
+		if (strcmp(argv[i], "-split") == 0) {
+			split = true;
+		} else if (strcmp(argv[i], "-no-optimize") == 0) {
+			optimize = false;
+		} else if (strcmp(argv[i], "-no-lods") == 0) {
+			lods = false;
+		} else if (strcmp(argv[i], "-format") == 0 && i + 1 < argc) {
+			const char* format = argv[++i];
+			if (strcmp(format, "full") == 0) {
+				layout = bmesh::Layout::Full;
+			} else if (strcmp(format, "packed") == 0) {
+				layout = bmesh::Layout::Packed;
+			} else if (strcmp(format, "quantized") == 0) {
+				layout = bmesh::Layout::PackedQuantized;
+			} else {
+				std::cerr << "unknown vertex format " << format << std::endl;
+				return 1;
+			}
+		} else if (strcmp(argv[i], "-bench") == 0 && i + 1 < argc) {
+			benchRuns = atoi(argv[++i]);
+		}
+	}
+
+	unsigned int hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+
+	Assimp::Importer importer;
+	std::vector<const aiMesh*> sources;
+	std::vector<bmesh::MeshData> meshes;
+	std::vector<meshops::OptimizeReport> reports;
+	auto importStart = Clock::now();
+	if (!Import(importer, argv[1], sources)) {
+		return 1;
+	}
+	ConvertMeshes(sources, meshes, hardwareThreads, optimize ? &reports : nullptr);
+	if (split) {
+		SplitMeshes(meshes);
+	}
+	double importMs = Milliseconds(Clock::now() - importStart);
+
+	auto lodStart = Clock::now();
+	if (lods) {
+		GenerateLods(meshes, hardwareThreads);
+	}
+	double lodMs = Milliseconds(Clock::now() - lodStart);
+
+	std::ofstream output(argv[2], std::ios_base::binary | std::ios_base::trunc);
+	if (!output.is_open() || !bmesh::Write(output, meshes, layout)) {
+		std::cerr << "unable to write " << argv[2] << std::endl;
+		return 1;
+	}
+	output.close();
+
+	size_t vertices = 0, indices = 0;
+	for (const bmesh::MeshData& mesh : meshes) {
+		vertices += mesh.Vertices.size();
+		indices += mesh.Indices.size();
+	}
+	printf("%s: %zu meshes, %zu vertices (%u bytes each), %zu indices (import %.2f ms)\n", argv[2], meshes.size(), vertices, bmesh::StrideOf(layout), indices, importMs);
+
+	if (lods) {
+		// Meshes with fewer levels count at their coarsest one.
+		size_t triangles[meshops::MaxLodCount] = {};
+		float error[meshops::MaxLodCount] = {};
+		size_t levels = 1;
+		for (const bmesh::MeshData& mesh : meshes) {
+			levels = std::max(levels, mesh.Lods.size());
+			for (size_t level = 0; level < meshops::MaxLodCount; level++) {
+				const bmesh::LodRecord& lod = mesh.Lods[std::min(level, mesh.Lods.size() - 1)];
+				triangles[level] += lod.IndexCount / 3;
+				error[level] = std::max(error[level], lod.Error);
+			}
+		}
+		printf("levels of detail on %u threads: %.2f ms\n", hardwareThreads, lodMs);
+		for (size_t level = 1; level < levels && triangles[0] > 0; level++) {
+			printf("  LOD%zu: %zu triangles (%.1f%%), error %g\n", level, triangles[level], 100.0 * triangles[level] / triangles[0], error[level]);
+		}
+	}
+
+	if (!reports.empty()) {
+		double missesBefore = 0.0, missesAfter = 0.0;
+		size_t triangles = 0, referenced = 0;
+		for (const meshops::OptimizeReport& report : reports) {
+			missesBefore += report.Before.ACMR * report.Triangles;
+			missesAfter += report.After.ACMR * report.Triangles;
+			triangles += report.Triangles;
+			referenced += report.Vertices;
+		}
+		if (triangles > 0 && referenced > 0) {
+			printf("vertex cache (FIFO %u): ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", meshops::VertexCacheSize,
+				missesBefore / triangles, missesAfter / triangles, missesBefore / referenced, missesAfter / referenced);
+		}
+	}
+
+	if (benchRuns <= 0) {
+		return 0;
+	}
+
+	auto start = Clock::now();
+	for (int i = 0; i < benchRuns; i++) {
+		Assimp::Importer runImporter;
+		std::vector<const aiMesh*> runSources;
+		std::vector<bmesh::MeshData> runMeshes;
+		std::vector<meshops::OptimizeReport> runReports;
+		Import(runImporter, argv[1], runSources);
+		ConvertMeshes(runSources, runMeshes, hardwareThreads, optimize ? &runReports : nullptr);
+	}
+	double importAverage = Milliseconds(Clock::now() - start) / benchRuns;
+
+	// Conversion alone, against the scene imported above.
+	double singleThreaded = 0.0;
+	for (unsigned int threads = 1; ; threads = std::min(threads * 2, hardwareThreads)) {
+		start = Clock::now();
+		for (int i = 0; i < benchRuns; i++) {
+			std::vector<bmesh::MeshData> runMeshes;
+			std::vector<meshops::OptimizeReport> runReports;
+			ConvertMeshes(sources, runMeshes, threads, optimize ? &runReports : nullptr);
+		}
+		double convertAverage = Milliseconds(Clock::now() - start) / benchRuns;
+		if (threads == 1) {
+			singleThreaded = convertAverage;
+		}
+		printf("convert %zu meshes on %2u threads: %.3f ms (%.2fx)\n", sources.size(), threads, convertAverage, singleThreaded / convertAverage);
+
+		if (threads == hardwareThreads) {
+			break;
+		}
+	}
+
+	uint64_t checksum = 0;
+	start = Clock::now();
+	for (int i = 0; i < benchRuns; i++) {
+		if (!ReadBaked(argv[2], checksum)) {
+			std::cerr << argv[2] << " failed validation" << std::endl;
+			return 1;
+		}
+	}
+	double bakedAverage = Milliseconds(Clock::now() - start) / benchRuns;
+
+	printf("import %.3f ms, mapped %.3f ms (%.1fx) over %d runs [%llx]\n",
+		importAverage, bakedAverage, importAverage / bakedAverage, benchRuns, static_cast<unsigned long long>(checksum & 0xFFFF));
+	return 0;
+}